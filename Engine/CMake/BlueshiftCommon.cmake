@@ -39,3 +39,37 @@ function(add_framework appname fwname)
     message(STATUS "Found framework ${fwname} at ${FRAMEWORK_${fwname}}")
   endif()
 endfunction(add_framework)
+
+# Adds a command line benchmark linked with the shared benchmark harness in Source/BenchmarkCommon
+function(add_benchmark_executable name)
+  set(SRC_FILES ${ARGN})
+
+  auto_source_group(${SRC_FILES})
+
+  include_directories(
+    ${CMAKE_CURRENT_SOURCE_DIR}
+    ${ENGINE_INCLUDE_DIR}/BenchmarkCommon
+    ${ENGINE_INCLUDE_DIR}/BlueshiftEngine/Public
+    ${ENGINE_INCLUDE_DIR}/Dependencies
+  )
+
+  add_executable(${name} ${SRC_FILES})
+
+  target_link_libraries(${name}
+    BenchmarkCommon
+    BlueshiftEngine
+  )
+
+  set_target_properties(${name} PROPERTIES FOLDER Test)
+
+  if (NOT IOS)
+    set_target_properties(${name} PROPERTIES PREFIX "")
+    set_target_properties(${name} PROPERTIES DEBUG_POSTFIX "_d")
+    set_target_properties(${name} PROPERTIES OUTPUT_NAME ${name})
+    set_target_properties(${name} PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_SOURCE_DIR}/Bin/${ENGINE_BUILD_PLATFORM_DIR})
+  endif ()
+
+  if (WIN32)
+    target_link_libraries(${name} winmm.lib)
+  endif ()
+endfunction(add_benchmark_executable)
@@ -11,6 +11,7 @@ shader "amblit" {
 	
 	generatePerforatedVersion
 	generateGpuSkinningVersion
+	generateInstancedVersion
 
 	glsl_vp {
 		$include "amblit.vp"
@@ -0,0 +1,52 @@
+#ifndef COMPACT_VERTEX_INCLUDED
+#define COMPACT_VERTEX_INCLUDED
+
+// Static meshes may use compact vertices :
+// position is quantized to 16 bits relative to the sub mesh bounds,
+// normal attribute has octahedral normal, tangent angle around the normal and bitangent sign.
+// Generic vertices get the identity (positionScale = 1, positionBias = 0, compactVertex = 0).
+uniform vec3 positionScale;
+uniform vec3 positionBias;
+uniform float compactVertex;
+
+vec4 decodeCompactPosition(vec4 position) {
+	return vec4(position.xyz * positionScale + positionBias, 1.0);
+}
+
+vec3 octDecode(vec2 e) {
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0) {
+		n.xy = (1.0 - abs(e.yx)) * (step(0.0, e.xy) * 2.0 - 1.0);
+	}
+	return normalize(n);
+}
+
+// Must be same as CompactTangentBasis() in the engine
+void compactTangentBasis(vec3 n, out vec3 b1, out vec3 b2) {
+	float s = n.z >= 0.0 ? 1.0 : -1.0;
+	float a = -1.0 / (s + n.z);
+	float b = n.x * n.y * a;
+	b1 = vec3(1.0 + s * n.x * n.x * a, s * b, -s * n.x);
+	b2 = vec3(b, s + n.y * n.y * a, -n.y);
+}
+
+void decodeCompactNormal(vec4 normalTangent, inout vec3 normal) {
+	if (compactVertex > 0.0) {
+		normal = octDecode(normalTangent.xy * 2.0 - 1.0);
+	}
+}
+
+void decodeCompactNormalTangent(vec4 normalTangent, inout vec3 normal, inout vec4 tangent) {
+	if (compactVertex > 0.0) {
+		normal = octDecode(normalTangent.xy * 2.0 - 1.0);
+
+		vec3 b1, b2;
+		compactTangentBasis(normal, b1, b2);
+
+		// byte angle is in [0, 256) steps of a full turn
+		float angle = normalTangent.z * (255.0 / 256.0) * 6.28318530718;
+		tangent = vec4(b1 * cos(angle) + b2 * sin(angle), normalTangent.w * 2.0 - 1.0);
+	}
+}
+
+#endif
@@ -5,6 +5,8 @@ shader "constantColor" {
 	glsl_vp {
 		in vec4 in_position : POSITION;
 
+		$include "compact_vertex.glsl"
+
 		uniform mat4 modelViewProjectionMatrix;
 
 		void main() {
@@ -13,7 +15,7 @@ shader "constantColor" {
 		#ifdef GPU_SKINNING
 			skinningMatrix(in_position, localVertex);
 		#else
-			localVertex = in_position;
+			localVertex = decodeCompactPosition(in_position);
 		#endif
 
 			gl_Position = modelViewProjectionMatrix * localVertex;
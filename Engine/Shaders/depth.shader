@@ -1,5 +1,6 @@
 shader "depth" {
 	generatePerforatedVersion
+	generateInstancedVersion
 	generateGpuSkinningVersion
 
 	glsl_vp {
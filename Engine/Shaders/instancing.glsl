@@ -0,0 +1,42 @@
+#ifndef INSTANCING_INCLUDED
+#define INSTANCING_INCLUDED
+
+// Entity data of each instance written by the front end in the instance buffer
+// 0 ~ 2 : world matrix rows
+// 3     : view origin in the local space of the entity
+#define INSTANCE_DATA_TEXELS 4
+
+#ifdef USE_BUFFER_TEXTURE
+	uniform samplerBuffer instanceDataMap;
+#else
+	uniform sampler2D instanceDataMap;
+#endif
+
+uniform int instanceIndexBase;
+uniform mat4 viewProjectionMatrix;
+
+vec4 fetchInstanceData(int index) {
+	int texelIndex = instanceIndexBase + gl_InstanceID * INSTANCE_DATA_TEXELS + index;
+#ifdef USE_BUFFER_TEXTURE
+	return texelFetch(instanceDataMap, texelIndex);
+#else
+	int width = textureSize(instanceDataMap, 0).x;
+	return texelFetch(instanceDataMap, ivec2(texelIndex % width, texelIndex / width), 0);
+#endif
+}
+
+void fetchInstanceWorldMatrix(out vec4 worldMatrixS, out vec4 worldMatrixT, out vec4 worldMatrixR) {
+	worldMatrixS = fetchInstanceData(0);
+	worldMatrixT = fetchInstanceData(1);
+	worldMatrixR = fetchInstanceData(2);
+}
+
+vec3 fetchInstanceLocalViewOrigin() {
+	return fetchInstanceData(3).xyz;
+}
+
+mat4 instanceModelViewProjectionMatrix(vec4 worldMatrixS, vec4 worldMatrixT, vec4 worldMatrixR) {
+	return viewProjectionMatrix * transpose(mat4(worldMatrixS, worldMatrixT, worldMatrixR, vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
+#endif
@@ -0,0 +1,242 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "BlueshiftEngine.h"
+#include "BenchmarkCommon.h"
+#include "AABBTreeBenchmark.h"
+
+#define WORLD_EXTENTS           BE1::MeterToUnit(200)
+#define NUM_CLUSTERS            32
+#define NUM_QUERIES             256
+#define MAX_BOTTOM_UP_PROXIES   1000
+
+enum BenchDistribution {
+    UniformDistribution,
+    ClusteredDistribution,
+    NumBenchDistributions
+};
+
+static const char *distributionNames[NumBenchDistributions] = {
+    "uniform", "clustered"
+};
+
+struct BenchResult {
+    const char *                distribution;
+    const char *                method;
+    int                         numProxies;
+    double                      buildMsec;
+    float                       areaRatio;
+    int                         height;
+    int                         maxBalance;
+    double                      queryUsec;      // per frustum query
+    double                      numVisible;     // per frustum query
+};
+
+// Pre-generated inputs, so the random number generation isn't timed and every method gets the same ones.
+struct BenchInput {
+    BE1::Array<BE1::AABB>       aabbs;
+    BE1::Array<BE1::Vec3>       jitters;        // displacements for the refit tests
+    BE1::Array<BE1::Frustum>    frustums;
+};
+
+static BE1::Array<BenchResult>  results;
+
+static BE1::Vec3 RandomVec3(BE1::Random &random, float extents) {
+    return BE1::Vec3(random.CRandomFloat() * extents, random.CRandomFloat() * extents, random.CRandomFloat() * extents);
+}
+
+static void MakeInput(BenchInput &input, BenchDistribution distribution, int numProxies, int seed) {
+    BE1::Random random(seed);
+
+    BE1::Vec3 clusterCenters[NUM_CLUSTERS];
+    for (int i = 0; i < NUM_CLUSTERS; i++) {
+        clusterCenters[i] = RandomVec3(random, WORLD_EXTENTS * 0.8f);
+        clusterCenters[i].z *= 0.1f;
+    }
+
+    input.aabbs.SetCount(numProxies);
+    input.jitters.SetCount(numProxies);
+
+    for (int i = 0; i < numProxies; i++) {
+        BE1::Vec3 center;
+        if (distribution == UniformDistribution) {
+            center = RandomVec3(random, WORLD_EXTENTS);
+            center.z *= 0.1f;
+        } else {
+            // Most of the proxies are packed around the cluster centers, like the props in the rooms
+            const float t = random.RandomFloat();
+            center = clusterCenters[random.RandomInt(NUM_CLUSTERS)] + RandomVec3(random, BE1::MeterToUnit(20)) * t * t;
+        }
+
+        const BE1::Vec3 extents = BE1::Vec3(random.RandomFloat(), random.RandomFloat(), random.RandomFloat()) * BE1::MeterToUnit(2) + BE1::Vec3(BE1::MeterToUnit(0.25f));
+
+        input.aabbs[i] = BE1::AABB(center - extents, center + extents);
+        input.jitters[i] = RandomVec3(random, BE1::MeterToUnit(2));
+    }
+
+    input.frustums.SetCount(NUM_QUERIES);
+
+    for (int i = 0; i < NUM_QUERIES; i++) {
+        BE1::Vec3 forward = RandomVec3(random, 1.0f);
+        forward.z = -0.25f;
+        forward.Normalize();
+
+        const float dFar = BE1::MeterToUnit(100);
+
+        BE1::Frustum &frustum = input.frustums[i];
+        frustum.SetOrigin(RandomVec3(random, WORLD_EXTENTS * 0.5f) + BE1::Vec3(0, 0, BE1::MeterToUnit(10)));
+        frustum.SetAxis(forward.ToMat3());
+        frustum.SetSize(BE1::MeterToUnit(0.1f), dFar, dFar, dFar * 0.75f);
+    }
+}
+
+static void CreateProxies(BE1::DynamicAABBTree &tree, const BenchInput &input, BE1::Array<int32_t> &proxyIds) {
+    proxyIds.SetCount(input.aabbs.Count());
+
+    for (int i = 0; i < input.aabbs.Count(); i++) {
+        proxyIds[i] = tree.CreateProxy(input.aabbs[i], 0.0f, nullptr);
+    }
+}
+
+static void AddResult(const char *distribution, const char *method, const BenchInput &input, const BE1::DynamicAABBTree &tree, double buildSeconds) {
+    int numVisible = 0;
+    auto countLeaf = [&numVisible](int32_t proxyId) -> bool {
+        numVisible++;
+        return true;
+    };
+
+    double t0 = BenchmarkSeconds();
+    for (int i = 0; i < input.frustums.Count(); i++) {
+        tree.QueryBatch(input.frustums[i], countLeaf);
+    }
+    double querySeconds = BenchmarkSeconds() - t0;
+
+    BenchResult &result = results.Alloc();
+    result.distribution = distribution;
+    result.method = method;
+    result.numProxies = input.aabbs.Count();
+    result.buildMsec = buildSeconds * 1e3;
+    result.areaRatio = tree.GetAreaRatio();
+    result.height = tree.GetHeight();
+    result.maxBalance = tree.GetMaxBalance();
+    result.queryUsec = querySeconds * 1e6 / input.frustums.Count();
+    result.numVisible = (double)numVisible / input.frustums.Count();
+
+    BE_LOG(L"%-10hs %-22hs %7i proxies %10.2f ms  area ratio %8.2f  height %3i  balance %3i  query %8.2f us (%.1f visible)\n",
+        distribution, method, result.numProxies, result.buildMsec, result.areaRatio, result.height, result.maxBalance, result.queryUsec, result.numVisible);
+}
+
+static void BenchTree(BenchDistribution distribution, int numProxies, bool quick) {
+    const char *distributionName = distributionNames[distribution];
+
+    BenchInput input;
+    MakeInput(input, distribution, numProxies, 0x5eed);
+
+    BE1::Array<int32_t> proxyIds;
+
+    // One by one insertion, as RenderWorld did at the map loading
+    BE1::DynamicAABBTree *incremental = new BE1::DynamicAABBTree;
+    double t0 = BenchmarkSeconds();
+    CreateProxies(*incremental, input, proxyIds);
+    AddResult(distributionName, "incremental", input, *incremental, BenchmarkSeconds() - t0);
+
+    // Bulk insertion built with the binned SAH in parallel
+    BE1::DynamicAABBTree *bulk = new BE1::DynamicAABBTree;
+    t0 = BenchmarkSeconds();
+    bulk->BeginBulkInsert();
+    CreateProxies(*bulk, input, proxyIds);
+    bulk->EndBulkInsert();
+    AddResult(distributionName, "bulk SAH", input, *bulk, BenchmarkSeconds() - t0);
+
+    // Same build on a single thread, rebuilding the incremental tree
+    t0 = BenchmarkSeconds();
+    incremental->RebuildSAH(false);
+    AddResult(distributionName, "rebuild SAH serial", input, *incremental, BenchmarkSeconds() - t0);
+
+    // O(N^3) reference for the small trees only
+    if (!quick && numProxies <= MAX_BOTTOM_UP_PROXIES) {
+        t0 = BenchmarkSeconds();
+        incremental->RebuildBottomUp();
+        AddResult(distributionName, "rebuild bottom-up", input, *incremental, BenchmarkSeconds() - t0);
+    }
+
+    // Every proxy moved a little, refitted keeping the structure
+    t0 = BenchmarkSeconds();
+    for (int i = 0; i < numProxies; i++) {
+        bulk->RefitProxy(proxyIds[i], input.aabbs[i] + input.jitters[i], 0.0f, true);
+    }
+    bulk->Refit();
+    AddResult(distributionName, "refit", input, *bulk, BenchmarkSeconds() - t0);
+
+    t0 = BenchmarkSeconds();
+    bulk->RebuildSAH();
+    AddResult(distributionName, "rebuild SAH after refit", input, *bulk, BenchmarkSeconds() - t0);
+
+    // Same movement with the reinsertion
+    BE1::DynamicAABBTree *moved = new BE1::DynamicAABBTree;
+    moved->BeginBulkInsert();
+    CreateProxies(*moved, input, proxyIds);
+    moved->EndBulkInsert();
+    t0 = BenchmarkSeconds();
+    for (int i = 0; i < numProxies; i++) {
+        moved->MoveProxy(proxyIds[i], input.aabbs[i] + input.jitters[i], 0.0f, BE1::Vec3::zero);
+    }
+    AddResult(distributionName, "move", input, *moved, BenchmarkSeconds() - t0);
+
+    delete incremental;
+    delete bulk;
+    delete moved;
+}
+
+//-------------------------------------------------------------------------------------------------
+// reports
+//-------------------------------------------------------------------------------------------------
+
+static bool WriteReports(const BenchmarkOptions &options) {
+    BenchmarkReport report("distribution,method,proxies,build_ms,area_ratio,height,max_balance,query_us,visible");
+
+    for (int i = 0; i < results.Count(); i++) {
+        const BenchResult &result = results[i];
+        report.AddString(result.distribution);
+        report.AddString(result.method);
+        report.AddInt(result.numProxies);
+        report.AddFloat(result.buildMsec);
+        report.AddFloat(result.areaRatio);
+        report.AddInt(result.height);
+        report.AddInt(result.maxBalance);
+        report.AddFloat(result.queryUsec);
+        report.AddFloat(result.numVisible, "%.1f");
+    }
+
+    return report.Write(options);
+}
+
+bool RunAABBTreeBenchmark(const BenchmarkOptions &options) {
+    static const int proxyCounts[] = { 1000, 10000, 100000 };
+
+    const int numProxyCounts = options.quick ? COUNT_OF(proxyCounts) - 1 : COUNT_OF(proxyCounts);
+
+    results.Clear();
+
+    BE_LOG(L"Benchmarking dynamic AABB tree..\n");
+
+    for (int distribution = 0; distribution < NumBenchDistributions; distribution++) {
+        for (int i = 0; i < numProxyCounts; i++) {
+            BenchTree((BenchDistribution)distribution, proxyCounts[i], options.quick);
+        }
+    }
+
+    return WriteReports(options);
+}
@@ -0,0 +1,24 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+struct BenchmarkOptions;
+
+/// Builds DynamicAABBTree with the incremental insertion, the bulk SAH build and the bottom-up build,
+/// reporting the build time, the tree quality and the frustum query time of each.
+/// options.quick runs with fewer proxies and skips the bottom-up build.
+/// Returns false if the reports couldn't be written.
+bool RunAABBTreeBenchmark(const BenchmarkOptions &options);
@@ -0,0 +1,276 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "BenchmarkCommon.h"
+#include "AllocatorBenchmark.h"
+
+#define NUM_SLOTS               4096
+
+struct BenchAllocator {
+    const char *                name;
+    BE1::MemAllocator::Enum     allocator;
+};
+
+struct BenchResult {
+    BE1::Str                    test;
+    const char *                allocator;
+    int                         numThreads;
+    int                         numOps;
+    double                      nanoseconds;    // per operation
+    double                      speedup;        // relative to the system allocator
+    int64_t                     reservedBytes;  // reserved by the small object allocator after the test
+};
+
+// Pre-generated operations, so the random number generation isn't timed and every allocator runs the same sequence.
+// Each operation toggles a slot, allocating sizes[i] bytes if it was empty and freeing it otherwise.
+struct RandomPattern {
+    BE1::Array<int>             sizes;
+    BE1::Array<int>             slots;
+};
+
+static BE1::Array<BenchResult>  results;
+
+static void MakeRandomPattern(RandomPattern &pattern, int numOps, int minSize, int maxSize, int seed) {
+    BE1::Random random(seed);
+
+    pattern.sizes.SetCount(numOps);
+    pattern.slots.SetCount(numOps);
+
+    for (int i = 0; i < numOps; i++) {
+        // Small sizes are much more frequent, like in the engine
+        const float t = random.RandomFloat();
+        pattern.sizes[i] = minSize + (int)(t * t * t * (maxSize - minSize));
+        pattern.slots[i] = random.RandomInt(NUM_SLOTS);
+    }
+}
+
+static void RunRandomPattern(const RandomPattern &pattern) {
+    void *slots[NUM_SLOTS];
+    memset(slots, 0, sizeof(slots));
+
+    const int *sizes = pattern.sizes.Ptr();
+    const int *slotIndexes = pattern.slots.Ptr();
+
+    for (int i = 0; i < pattern.sizes.Count(); i++) {
+        void *&slot = slots[slotIndexes[i]];
+        if (slot) {
+            BE1::Mem_Free(slot);
+            slot = nullptr;
+        } else {
+            slot = BE1::Mem_Alloc(sizes[i]);
+            *(byte *)slot = 0;
+        }
+    }
+
+    for (int i = 0; i < NUM_SLOTS; i++) {
+        BE1::Mem_Free(slots[i]);
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// tests
+//-------------------------------------------------------------------------------------------------
+
+static double TestRandom(const RandomPattern &pattern) {
+    double startTime = BenchmarkSeconds();
+    RunRandomPattern(pattern);
+    return BenchmarkSeconds() - startTime;
+}
+
+// Grows arrays one element at a time like most of the engine code does
+static double TestArrayGrowth(int numOps) {
+    const int numArrays = 64;
+    const int numElements = numOps / numArrays;
+
+    double startTime = BenchmarkSeconds();
+
+    BE1::Array<BE1::Vec3> arrays[numArrays];
+    for (int i = 0; i < numElements; i++) {
+        for (int j = 0; j < numArrays; j++) {
+            arrays[j].Append(BE1::Vec3::zero);
+        }
+    }
+    for (int j = 0; j < numArrays; j++) {
+        arrays[j].Clear();
+    }
+
+    return BenchmarkSeconds() - startTime;
+}
+
+static double TestStrConcat(int numOps) {
+    const int numStrings = 256;
+
+    double startTime = BenchmarkSeconds();
+
+    BE1::StrArray strings;
+    strings.SetGranularity(numStrings);
+    for (int i = 0; i < numOps; i++) {
+        if (strings.Count() == numStrings) {
+            strings.Clear();
+        }
+        BE1::Str str = "Assets/Textures/";
+        str += BE1::Str(i);
+        str += ".png";
+        strings.Append(str);
+    }
+    strings.Clear();
+
+    return BenchmarkSeconds() - startTime;
+}
+
+// Runs a pattern on every worker of the job system at the same time
+static double TestThreadedRandom(const RandomPattern *patterns, int numThreads) {
+    double startTime = BenchmarkSeconds();
+
+    BE1::JobSystem::ParallelFor(0, numThreads, 1, [patterns](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            RunRandomPattern(patterns[i]);
+        }
+    });
+
+    return BenchmarkSeconds() - startTime;
+}
+
+// Frees the blocks allocated by another job, like the jobs freeing the frame data produced on the other workers
+static double TestCrossThreadFree(int numOps, int numThreads) {
+    const int numBlocks = numOps / numThreads / 2;
+
+    BE1::Array<void *> blocks;
+    blocks.SetCount(numBlocks * numThreads);
+    void **blockPtr = blocks.Ptr();
+
+    double startTime = BenchmarkSeconds();
+
+    BE1::JobSystem::ParallelFor(0, numThreads, 1, [blockPtr, numBlocks](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const int blockSize = 16 + (i * 48) % 256;
+            for (int j = 0; j < numBlocks; j++) {
+                void *block = BE1::Mem_Alloc(blockSize);
+                *(byte *)block = 0;
+                blockPtr[i * numBlocks + j] = block;
+            }
+        }
+    });
+
+    BE1::JobSystem::ParallelFor(0, numThreads, 1, [blockPtr, numBlocks, numThreads](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            void **ownerBlocks = &blockPtr[((i + 1) % numThreads) * numBlocks];
+            for (int j = 0; j < numBlocks; j++) {
+                BE1::Mem_Free(ownerBlocks[j]);
+            }
+        }
+    });
+
+    return BenchmarkSeconds() - startTime;
+}
+
+template <typename TestFunc>
+static void BenchTest(const char *test, const BenchAllocator *allocators, int numAllocators, int numThreads, int numOps, TestFunc testFunc) {
+    double systemSeconds = 0;
+
+    for (int i = 0; i < numAllocators; i++) {
+        BE1::Mem_SetAllocator(allocators[i].allocator);
+
+        // Best of 3 runs
+        double seconds = DBL_MAX;
+        for (int run = 0; run < 3; run++) {
+            seconds = BE1::Min(seconds, testFunc());
+        }
+
+        if (allocators[i].allocator == BE1::MemAllocator::System) {
+            systemSeconds = seconds;
+        }
+
+        BE1::MemAllocatorStats stats;
+        BE1::Mem_GetAllocatorStats(&stats);
+
+        BenchResult &result = results.Alloc();
+        result.test = test;
+        result.allocator = allocators[i].name;
+        result.numThreads = numThreads;
+        result.numOps = numOps;
+        result.nanoseconds = seconds * 1e9 / numOps;
+        result.speedup = systemSeconds > 0 ? systemSeconds / seconds : 1.0;
+        result.reservedBytes = stats.reservedBytes;
+
+        BE_LOG(L"%-24hs %-12hs %2i threads %8.2f ns/op %6.2fx  (%lli KB reserved)\n", test, result.allocator, numThreads,
+            result.nanoseconds, result.speedup, (long long)(result.reservedBytes / 1024));
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// reports
+//-------------------------------------------------------------------------------------------------
+
+static bool WriteReports(const BenchmarkOptions &options) {
+    BenchmarkReport report("test,allocator,threads,ops,ns_per_op,speedup,reserved_bytes");
+
+    for (int i = 0; i < results.Count(); i++) {
+        const BenchResult &result = results[i];
+        report.AddString(result.test.c_str());
+        report.AddString(result.allocator);
+        report.AddInt(result.numThreads);
+        report.AddInt(result.numOps);
+        report.AddFloat(result.nanoseconds);
+        report.AddFloat(result.speedup);
+        report.AddInt(result.reservedBytes);
+    }
+
+    return report.Write(options);
+}
+
+bool RunAllocatorBenchmark(const BenchmarkOptions &options) {
+    static const BenchAllocator allocators[] = {
+        { "System", BE1::MemAllocator::System },
+        { "SmallObject", BE1::MemAllocator::SmallObject }
+    };
+
+    const BE1::MemAllocator::Enum defaultAllocator = BE1::Mem_GetAllocator();
+
+    const int numOps = options.quick ? 400000 : 4000000;
+
+    const int numThreads = BE1::JobSystem::NumWorkers();
+
+    results.Clear();
+
+    BE_LOG(L"Benchmarking allocators..\n");
+
+    // Allocated before the tests, so the patterns don't take part in the measurements
+    RandomPattern smallPattern;
+    MakeRandomPattern(smallPattern, numOps, 8, 256, 0x5eed);
+    RandomPattern mediumPattern;
+    MakeRandomPattern(mediumPattern, numOps, 8, 2048, 0x5eed);
+    RandomPattern largePattern;
+    MakeRandomPattern(largePattern, numOps / 4, 2048, 65536, 0x5eed);
+
+    BE1::Array<RandomPattern> threadPatterns;
+    threadPatterns.SetCount(numThreads);
+    for (int i = 0; i < numThreads; i++) {
+        MakeRandomPattern(threadPatterns[i], numOps / numThreads, 8, 256, 0x5eed + i);
+    }
+
+    BenchTest("random 8-256", allocators, COUNT_OF(allocators), 1, numOps, [&]() { return TestRandom(smallPattern); });
+    BenchTest("random 8-2048", allocators, COUNT_OF(allocators), 1, numOps, [&]() { return TestRandom(mediumPattern); });
+    // Bigger than the small object allocator, both should be the same
+    BenchTest("random 2K-64K", allocators, COUNT_OF(allocators), 1, numOps / 4, [&]() { return TestRandom(largePattern); });
+    BenchTest("array growth", allocators, COUNT_OF(allocators), 1, numOps, [&]() { return TestArrayGrowth(numOps); });
+    BenchTest("str concat", allocators, COUNT_OF(allocators), 1, numOps / 4, [&]() { return TestStrConcat(numOps / 4); });
+    BenchTest("threaded random 8-256", allocators, COUNT_OF(allocators), numThreads, numOps, [&]() { return TestThreadedRandom(threadPatterns.Ptr(), numThreads); });
+    BenchTest("cross thread free", allocators, COUNT_OF(allocators), numThreads, numOps, [&]() { return TestCrossThreadFree(numOps, numThreads); });
+
+    BE1::Mem_SetAllocator(defaultAllocator);
+
+    return WriteReports(options);
+}
@@ -0,0 +1,198 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "BenchmarkCommon.h"
+
+static void SystemLog(const int logLevel, const wchar_t *msg) {
+    printf("%ls", msg);
+}
+
+static void SystemError(const int errLevel, const wchar_t *msg) {
+    printf("ERROR: %ls", msg);
+}
+
+void InitBenchmarkEngine() {
+    BE1::Str enginePath = BE1::PlatformFile::ExecutablePath();
+    enginePath.AppendPath("../../.."); // Strip "Bin/<Platform>/<Configuration>"
+    enginePath.CleanPath();
+    BE1::Engine::InitBase(enginePath, false, SystemLog, SystemError);
+}
+
+void ShutdownBenchmarkEngine() {
+    BE1::Engine::ShutdownBase();
+}
+
+int BenchmarkMain(int argc, char *argv[], benchmarkFunc_t benchmarkFunc) {
+    BenchmarkOptions options;
+    options.quick = false;
+    options.jsonFilename = nullptr;
+    options.csvFilename = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--quick")) {
+            options.quick = true;
+        } else if (!strcmp(argv[i], "--json") && i + 1 < argc) {
+            options.jsonFilename = argv[++i];
+        } else if (!strcmp(argv[i], "--csv") && i + 1 < argc) {
+            options.csvFilename = argv[++i];
+        } else {
+            printf("Usage: %s [--quick] [--json <filename>] [--csv <filename>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    InitBenchmarkEngine();
+
+    bool succeeded = benchmarkFunc(options);
+
+    ShutdownBenchmarkEngine();
+
+    return succeeded ? 0 : 1;
+}
+
+double BenchmarkSeconds() {
+    return BE1::PlatformTime::Cycles() * BE1::PlatformTime::SecondsPerCycles();
+}
+
+const char *BenchmarkCpuName() {
+    const char *cpuName = BE1::GetCpuInfo()->brandString;
+    while (*cpuName == ' ') {
+        cpuName++;
+    }
+    return cpuName;
+}
+
+//-------------------------------------------------------------------------------------------------
+// BenchmarkReport
+//-------------------------------------------------------------------------------------------------
+
+BenchmarkReport::BenchmarkReport(const char *columnNames) {
+    const char *begin = columnNames;
+    for (const char *p = columnNames; ; p++) {
+        if (*p == ',' || *p == '\0') {
+            columns.Append(BE1::Str(begin).Left((int)(p - begin)));
+            if (*p == '\0') {
+                break;
+            }
+            begin = p + 1;
+        }
+    }
+}
+
+void BenchmarkReport::AddValue(const BE1::Str &json, const BE1::Str &csv) {
+    Value &value = values.Alloc();
+    value.json = json;
+    value.csv = csv;
+}
+
+void BenchmarkReport::AddString(const char *value) {
+    BE1::Str json = "\"";
+    BE1::Str csv;
+    bool quoteCsv = false;
+
+    for (const char *p = value; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            json += '\\';
+        }
+        json += *p;
+
+        if (*p == '"') {
+            csv += '"';
+        }
+        if (*p == '"' || *p == ',') {
+            quoteCsv = true;
+        }
+        csv += *p;
+    }
+    json += "\"";
+
+    AddValue(json, quoteCsv ? "\"" + csv + "\"" : csv);
+}
+
+void BenchmarkReport::AddInt(int64_t value) {
+    char buffer[32];
+    BE1::Str::snPrintf(buffer, sizeof(buffer), "%lli", (long long)value);
+    AddValue(buffer, buffer);
+}
+
+void BenchmarkReport::AddFloat(double value, const char *format) {
+    char buffer[64];
+    BE1::Str::snPrintf(buffer, sizeof(buffer), format, value);
+    AddValue(buffer, buffer);
+}
+
+void BenchmarkReport::AddBool(bool value) {
+    AddValue(value ? "true" : "false", value ? "1" : "0");
+}
+
+bool BenchmarkReport::WriteJSON(const char *filename) const {
+    assert(values.Count() % columns.Count() == 0);
+
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        BE_WARNLOG(L"Couldn't open %hs for writing\n", filename);
+        return false;
+    }
+
+    const int numRows = values.Count() / columns.Count();
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"cpu\": \"%s\",\n", BenchmarkCpuName());
+    fprintf(fp, "  \"results\": [\n");
+    for (int row = 0; row < numRows; row++) {
+        fprintf(fp, "    {");
+        for (int column = 0; column < columns.Count(); column++) {
+            fprintf(fp, "%s \"%s\": %s", column > 0 ? "," : "", columns[column].c_str(), values[row * columns.Count() + column].json.c_str());
+        }
+        fprintf(fp, " }%s\n", row < numRows - 1 ? "," : "");
+    }
+    fprintf(fp, "  ]\n");
+    fprintf(fp, "}\n");
+    fclose(fp);
+    return true;
+}
+
+bool BenchmarkReport::WriteCSV(const char *filename) const {
+    assert(values.Count() % columns.Count() == 0);
+
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        BE_WARNLOG(L"Couldn't open %hs for writing\n", filename);
+        return false;
+    }
+
+    for (int column = 0; column < columns.Count(); column++) {
+        fprintf(fp, "%s%s", column > 0 ? "," : "", columns[column].c_str());
+    }
+    fprintf(fp, "\n");
+
+    for (int i = 0; i < values.Count(); i++) {
+        const bool lastColumn = (i % columns.Count()) == columns.Count() - 1;
+        fprintf(fp, "%s%s", values[i].csv.c_str(), lastColumn ? "\n" : ",");
+    }
+    fclose(fp);
+    return true;
+}
+
+bool BenchmarkReport::Write(const BenchmarkOptions &options) const {
+    bool succeeded = true;
+    if (options.jsonFilename) {
+        succeeded &= WriteJSON(options.jsonFilename);
+    }
+    if (options.csvFilename) {
+        succeeded &= WriteCSV(options.csvFilename);
+    }
+    return succeeded;
+}
@@ -0,0 +1,81 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Benchmark common
+
+    Shared harness of the command line benchmarks: the common options,
+    the engine base initialization with the console log callbacks and the
+    JSON/CSV report writers. Each benchmark only implements its own run function.
+
+-------------------------------------------------------------------------------
+*/
+
+struct BenchmarkOptions {
+    bool                quick;              ///< Runs a shorter version of the benchmark
+    const char *        jsonFilename;       ///< Writes the results in JSON if not null
+    const char *        csvFilename;        ///< Writes the results in CSV if not null
+};
+
+typedef bool (*benchmarkFunc_t)(const BenchmarkOptions &options);
+
+/// Parses [--quick] [--json <filename>] [--csv <filename>], runs the benchmark with the engine base initialized,
+/// and returns the exit code of the process. Non-zero if the options are invalid or the benchmark returns false.
+int BenchmarkMain(int argc, char *argv[], benchmarkFunc_t benchmarkFunc);
+
+/// Initializes the engine base with the logs printed on the console, for the benchmarks parsing their own options.
+void InitBenchmarkEngine();
+void ShutdownBenchmarkEngine();
+
+/// Returns the time in seconds from the high resolution counter
+double BenchmarkSeconds();
+
+/// Returns the brand string of the CPU without the leading spaces
+const char *BenchmarkCpuName();
+
+/// Table of the results written in JSON or CSV.
+/// Values are added row by row, one value for each column in the order of the columns.
+class BenchmarkReport {
+public:
+                        /// columns are the comma separated names of the columns
+    explicit            BenchmarkReport(const char *columns);
+
+    void                AddString(const char *value);
+    void                AddInt(int64_t value);
+    void                AddFloat(double value, const char *format = "%.3f");
+    void                AddBool(bool value);
+
+                        /// Writes { "cpu": ..., "results": [ { column: value, ... }, ... ] }
+    bool                WriteJSON(const char *filename) const;
+                        /// Writes the column names in the first line and a row per line
+    bool                WriteCSV(const char *filename) const;
+
+                        /// Writes the files given in the options, returns false if any of them couldn't be written
+    bool                Write(const BenchmarkOptions &options) const;
+
+private:
+    struct Value {
+        BE1::Str        json;
+        BE1::Str        csv;
+    };
+
+    void                AddValue(const BE1::Str &json, const BE1::Str &csv);
+
+    BE1::StrArray       columns;
+    BE1::Array<Value>   values;
+};
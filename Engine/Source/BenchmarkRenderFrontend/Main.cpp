@@ -0,0 +1,71 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "BenchmarkCommon.h"
+#include "RenderFrontendBenchmark.h"
+
+// Usage: BenchmarkRenderFrontend [--entities <n>] [--lights <n>] [--static <n>] [--frames <n>] [--width <n>] [--height <n>] [--serial] [--json <filename>] [--csv <filename>]
+// Runs without a GPU, the engine must be built with WITH_NULL_RENDERER.
+
+int main(int argc, char *argv[]) {
+    RenderFrontendBenchmarkOptions options;
+    options.numEntities = 2000;
+    options.numLights = 32;
+    options.numStaticMeshes = 5000;
+    options.numFrames = 100;
+    options.width = 1280;
+    options.height = 720;
+    options.serial = false;
+    options.jsonFilename = nullptr;
+    options.csvFilename = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--entities") && i + 1 < argc) {
+            options.numEntities = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--lights") && i + 1 < argc) {
+            options.numLights = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--static") && i + 1 < argc) {
+            options.numStaticMeshes = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            options.numFrames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--width") && i + 1 < argc) {
+            options.width = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--height") && i + 1 < argc) {
+            options.height = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--serial")) {
+            options.serial = true;
+        } else if (!strcmp(argv[i], "--json") && i + 1 < argc) {
+            options.jsonFilename = argv[++i];
+        } else if (!strcmp(argv[i], "--csv") && i + 1 < argc) {
+            options.csvFilename = argv[++i];
+        } else {
+            printf("Usage: %s [--entities <n>] [--lights <n>] [--static <n>] [--frames <n>] [--width <n>] [--height <n>] [--serial] [--json <filename>] [--csv <filename>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.numEntities < 0 || options.numLights < 0 || options.numStaticMeshes < 0 || options.numFrames <= 0 || options.width <= 0 || options.height <= 0) {
+        printf("Invalid options\n");
+        return 1;
+    }
+
+    InitBenchmarkEngine();
+
+    bool succeeded = RunRenderFrontendBenchmark(options);
+
+    ShutdownBenchmarkEngine();
+
+    return succeeded ? 0 : 1;
+}
@@ -0,0 +1,428 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "Renderer/RendererNull.h"
+#include "BenchmarkCommon.h"
+#include "RenderFrontendBenchmark.h"
+
+#define WARMUP_FRAMES           10
+#define WORLD_EXTENTS           BE1::MeterToUnit(200)
+
+enum BenchStage {
+    UpdateStage,
+    ViewLightsAndEntitiesStage,
+    AddMeshesStage,
+    AddMeshesForLightsStage,
+    FlushDrawSurfsStage,
+    OptimizeLightsStage,
+    FrontEndStage,
+    BackEndStage,
+    FrameStage,
+    NumBenchStages
+};
+
+static const char *stageNames[NumBenchStages] = {
+    "update", "viewLightsAndEntities", "addMeshes", "addMeshesForLights", "flushDrawSurfs", "optimizeLights", "frontEnd", "backEnd", "frame"
+};
+
+struct BenchStageResult {
+    double                      totalUsec;
+    double                      minUsec;
+    double                      maxUsec;
+};
+
+struct BenchEntity {
+    int                         handle;
+    BE1::SceneEntity::Parms     parms;
+    BE1::Vec3                   center;
+    float                       radius;
+    float                       phase;
+};
+
+struct BenchScene {
+    BE1::Array<BenchEntity *>   entities;           // dynamic entities
+    BE1::Array<BenchEntity *>   staticEntities;
+    BE1::Array<int>             lights;
+};
+
+static BenchStageResult         stageResults[NumBenchStages];
+static double                   numDrawSurfsTotal;
+static BE1::NullRendererStats   rendererStats;
+static int                      measuredFrames;
+
+static void InitEntityParms(BE1::SceneEntity::Parms &parms, BE1::Mesh *mesh, const BE1::Vec3 &origin, float scale) {
+    memset(&parms, 0, sizeof(parms));
+
+    parms.layer = 0;
+    parms.mesh = mesh;
+    parms.aabb = mesh->GetAABB();
+    parms.origin = origin;
+    parms.scale = BE1::Vec3(scale, scale, scale);
+    parms.axis = BE1::Mat3::identity;
+    parms.maxVisDist = WORLD_EXTENTS * 2;
+    parms.materialParms[BE1::SceneEntity::RedParm] = 1.0f;
+    parms.materialParms[BE1::SceneEntity::GreenParm] = 1.0f;
+    parms.materialParms[BE1::SceneEntity::BlueParm] = 1.0f;
+    parms.materialParms[BE1::SceneEntity::AlphaParm] = 1.0f;
+    parms.materialParms[BE1::SceneEntity::TimeScaleParm] = 1.0f;
+    parms.wireframeColor.Set(1, 1, 1, 1);
+    parms.castShadows = true;
+    parms.receiveShadows = true;
+}
+
+static BE1::Vec3 RandomPosition(BE1::Random &random, float height) {
+    return BE1::Vec3(random.CRandomFloat() * WORLD_EXTENTS, random.CRandomFloat() * WORLD_EXTENTS, random.RandomFloat() * height);
+}
+
+// Builds the same scene for the same options, so the results can be compared between runs.
+static void BuildScene(BE1::RenderWorld *renderWorld, const RenderFrontendBenchmarkOptions &options, BenchScene &scene) {
+    BE1::Random random(0x5eed);
+
+    BE1::Mesh *referenceMeshes[] = { BE1::MeshManager::defaultBoxMesh, BE1::MeshManager::defaultSphereMesh };
+
+    for (int i = 0; i < options.numStaticMeshes; i++) {
+        BE1::Mesh *referenceMesh = referenceMeshes[random.RandomInt(COUNT_OF(referenceMeshes))];
+
+        BenchEntity *entity = new BenchEntity;
+        InitEntityParms(entity->parms, referenceMesh->InstantiateMesh(BE1::Mesh::StaticMesh), RandomPosition(random, BE1::MeterToUnit(20)), 1.0f + random.RandomFloat() * 4.0f);
+        entity->center = entity->parms.origin;
+        entity->radius = 0;
+        entity->phase = 0;
+        entity->handle = renderWorld->AddEntity(&entity->parms);
+        scene.staticEntities.Append(entity);
+    }
+
+    for (int i = 0; i < options.numEntities; i++) {
+        BE1::Mesh *referenceMesh = referenceMeshes[random.RandomInt(COUNT_OF(referenceMeshes))];
+
+        BenchEntity *entity = new BenchEntity;
+        InitEntityParms(entity->parms, referenceMesh->InstantiateMesh(BE1::Mesh::StaticMesh), RandomPosition(random, BE1::MeterToUnit(10)), 1.0f + random.RandomFloat());
+        entity->center = entity->parms.origin;
+        entity->radius = BE1::MeterToUnit(1.0f + random.RandomFloat() * 4.0f);
+        entity->phase = random.RandomFloat() * BE1::Math::TwoPi;
+        entity->handle = renderWorld->AddEntity(&entity->parms);
+        scene.entities.Append(entity);
+    }
+
+    for (int i = 0; i < options.numLights; i++) {
+        BE1::SceneLight::Parms parms;
+        memset(&parms, 0, sizeof(parms));
+
+        parms.layer = 0;
+        parms.type = BE1::SceneLight::PointLight;
+        parms.material = BE1::MaterialManager::zeroClampLightMaterial;
+        parms.materialParms[BE1::SceneEntity::RedParm] = 0.5f + random.RandomFloat() * 0.5f;
+        parms.materialParms[BE1::SceneEntity::GreenParm] = 0.5f + random.RandomFloat() * 0.5f;
+        parms.materialParms[BE1::SceneEntity::BlueParm] = 0.5f + random.RandomFloat() * 0.5f;
+        parms.materialParms[BE1::SceneEntity::AlphaParm] = 1.0f;
+        parms.materialParms[BE1::SceneEntity::TimeScaleParm] = 1.0f;
+        parms.intensity = 2.0f;
+        parms.origin = RandomPosition(random, BE1::MeterToUnit(15));
+        parms.axis = BE1::Mat3::identity;
+        float radius = BE1::MeterToUnit(10.0f + random.RandomFloat() * 20.0f);
+        parms.value = BE1::Vec3(radius, radius, radius);
+        parms.zNear = 10.0f;
+        parms.fallOffExponent = 1.25f;
+        parms.maxVisDist = WORLD_EXTENTS * 2;
+        parms.shadowOffsetFactor = 3.0f;
+        parms.shadowOffsetUnits = 200.0f;
+        parms.turnOn = true;
+        parms.castShadows = (i % 4) == 0;
+
+        scene.lights.Append(renderWorld->AddLight(&parms));
+    }
+}
+
+static void FreeScene(BE1::RenderWorld *renderWorld, BenchScene &scene) {
+    for (int i = 0; i < scene.lights.Count(); i++) {
+        renderWorld->RemoveLight(scene.lights[i]);
+    }
+    scene.lights.Clear();
+
+    BE1::Array<BenchEntity *> *entityLists[] = { &scene.entities, &scene.staticEntities };
+    for (int listIndex = 0; listIndex < COUNT_OF(entityLists); listIndex++) {
+        BE1::Array<BenchEntity *> &entities = *entityLists[listIndex];
+        for (int i = 0; i < entities.Count(); i++) {
+            renderWorld->RemoveEntity(entities[i]->handle);
+            BE1::meshManager.ReleaseMesh(entities[i]->parms.mesh);
+            delete entities[i];
+        }
+        entities.Clear();
+    }
+}
+
+// Moves the dynamic entities on a circle around their initial positions, so the dynamic tree is updated every frame.
+static void UpdateScene(BE1::RenderWorld *renderWorld, BenchScene &scene, float time) {
+    for (int i = 0; i < scene.entities.Count(); i++) {
+        BenchEntity *entity = scene.entities[i];
+
+        float s, c;
+        BE1::Math::SinCos(time + entity->phase, s, c);
+        entity->parms.origin = entity->center + BE1::Vec3(c * entity->radius, s * entity->radius, 0);
+
+        renderWorld->UpdateEntity(entity->handle, &entity->parms);
+    }
+}
+
+static void InitViewParms(BE1::SceneView::Parms &viewParms, const RenderFrontendBenchmarkOptions &options) {
+    memset(&viewParms, 0, sizeof(viewParms));
+
+    viewParms.flags = BE1::SceneView::NoSubViews | BE1::SceneView::SkipPostProcess | BE1::SceneView::SkipDebugDraw;
+    viewParms.layerMask = BIT(0);
+    viewParms.renderRect.Set(0, 0, options.width, options.height);
+    viewParms.clearMethod = BE1::SceneView::ColorClear;
+    viewParms.clearColor.Set(0, 0, 0, 1);
+    viewParms.zNear = 4.0f;
+    viewParms.zFar = WORLD_EXTENTS * 4;
+    viewParms.orthogonal = false;
+
+    BE1::SceneView::ComputeFov(90.0f, 1.25f, (float)options.width / options.height, &viewParms.fovX, &viewParms.fovY);
+}
+
+// The camera flies over the scene on a circle, looking at the center of the world.
+static void UpdateViewParms(BE1::SceneView::Parms &viewParms, int time) {
+    float s, c;
+    BE1::Math::SinCos(time * 0.0002f, s, c);
+
+    viewParms.time = time;
+    viewParms.origin = BE1::Vec3(c * WORLD_EXTENTS * 0.5f, s * WORLD_EXTENTS * 0.5f, BE1::MeterToUnit(30));
+
+    BE1::Vec3 forward = -viewParms.origin;
+    forward.Normalize();
+    viewParms.axis = forward.ToMat3();
+}
+
+static void AddStageSample(BenchStage stage, double usec) {
+    BenchStageResult &result = stageResults[stage];
+    result.totalUsec += usec;
+    result.minUsec = BE1::Min(result.minUsec, usec);
+    result.maxUsec = BE1::Max(result.maxUsec, usec);
+}
+
+static void AddRendererStats(const BE1::NullRendererStats &stats) {
+    rendererStats.drawCalls += stats.drawCalls;
+    rendererStats.instancedDrawCalls += stats.instancedDrawCalls;
+    rendererStats.drawIndexes += stats.drawIndexes;
+    rendererStats.drawVerts += stats.drawVerts;
+    rendererStats.clears += stats.clears;
+    rendererStats.stateChanges += stats.stateChanges;
+    rendererStats.shaderBinds += stats.shaderBinds;
+    rendererStats.textureBinds += stats.textureBinds;
+    rendererStats.bufferBinds += stats.bufferBinds;
+    rendererStats.vertexFormatBinds += stats.vertexFormatBinds;
+    rendererStats.renderTargetBinds += stats.renderTargetBinds;
+    rendererStats.constantUpdates += stats.constantUpdates;
+    rendererStats.bufferUploadBytes += stats.bufferUploadBytes;
+    rendererStats.textureUploadBytes += stats.textureUploadBytes;
+}
+
+static double MeanUsec(BenchStage stage) {
+    return stageResults[stage].totalUsec / BE1::Max(measuredFrames, 1);
+}
+
+static double PerFrame(uint64_t count) {
+    return (double)count / BE1::Max(measuredFrames, 1);
+}
+
+//-------------------------------------------------------------------------------------------------
+// reports
+//-------------------------------------------------------------------------------------------------
+
+static bool WriteJSON(const char *filename, const RenderFrontendBenchmarkOptions &options) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        BE_WARNLOG(L"Couldn't open %hs for writing\n", filename);
+        return false;
+    }
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"cpu\": \"%s\",\n", BenchmarkCpuName());
+    fprintf(fp, "  \"entities\": %i,\n", options.numEntities);
+    fprintf(fp, "  \"lights\": %i,\n", options.numLights);
+    fprintf(fp, "  \"static_meshes\": %i,\n", options.numStaticMeshes);
+    fprintf(fp, "  \"frames\": %i,\n", measuredFrames);
+    fprintf(fp, "  \"parallel\": %s,\n", options.serial ? "false" : "true");
+    fprintf(fp, "  \"draw_surfs\": %.1f,\n", numDrawSurfsTotal / BE1::Max(measuredFrames, 1));
+    fprintf(fp, "  \"stages\": [\n");
+    for (int i = 0; i < NumBenchStages; i++) {
+        const BenchStageResult &result = stageResults[i];
+        fprintf(fp, "    { \"stage\": \"%s\", \"mean_us\": %.1f, \"min_us\": %.1f, \"max_us\": %.1f }%s\n",
+            stageNames[i], MeanUsec((BenchStage)i), result.minUsec, result.maxUsec, i < NumBenchStages - 1 ? "," : "");
+    }
+    fprintf(fp, "  ],\n");
+    fprintf(fp, "  \"renderer\": {\n");
+    fprintf(fp, "    \"draw_calls\": %.1f,\n", PerFrame(rendererStats.drawCalls));
+    fprintf(fp, "    \"instanced_draw_calls\": %.1f,\n", PerFrame(rendererStats.instancedDrawCalls));
+    fprintf(fp, "    \"draw_indexes\": %.1f,\n", PerFrame(rendererStats.drawIndexes));
+    fprintf(fp, "    \"draw_verts\": %.1f,\n", PerFrame(rendererStats.drawVerts));
+    fprintf(fp, "    \"state_changes\": %.1f,\n", PerFrame(rendererStats.stateChanges));
+    fprintf(fp, "    \"shader_binds\": %.1f,\n", PerFrame(rendererStats.shaderBinds));
+    fprintf(fp, "    \"texture_binds\": %.1f,\n", PerFrame(rendererStats.textureBinds));
+    fprintf(fp, "    \"buffer_binds\": %.1f,\n", PerFrame(rendererStats.bufferBinds));
+    fprintf(fp, "    \"constant_updates\": %.1f,\n", PerFrame(rendererStats.constantUpdates));
+    fprintf(fp, "    \"buffer_upload_bytes\": %.1f\n", PerFrame(rendererStats.bufferUploadBytes));
+    fprintf(fp, "  }\n");
+    fprintf(fp, "}\n");
+    fclose(fp);
+    return true;
+}
+
+static bool WriteCSV(const char *filename, const RenderFrontendBenchmarkOptions &options) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp) {
+        BE_WARNLOG(L"Couldn't open %hs for writing\n", filename);
+        return false;
+    }
+
+    fprintf(fp, "stage,entities,lights,static_meshes,parallel,mean_us,min_us,max_us\n");
+    for (int i = 0; i < NumBenchStages; i++) {
+        const BenchStageResult &result = stageResults[i];
+        fprintf(fp, "%s,%i,%i,%i,%i,%.1f,%.1f,%.1f\n",
+            stageNames[i], options.numEntities, options.numLights, options.numStaticMeshes, options.serial ? 0 : 1,
+            MeanUsec((BenchStage)i), result.minUsec, result.maxUsec);
+    }
+    fclose(fp);
+    return true;
+}
+
+static void PrintResults() {
+    BE_LOG(L"%-24hs %10hs %10hs %10hs\n", "stage", "mean(us)", "min(us)", "max(us)");
+    for (int i = 0; i < NumBenchStages; i++) {
+        const BenchStageResult &result = stageResults[i];
+        BE_LOG(L"%-24hs %10.1f %10.1f %10.1f\n", stageNames[i], MeanUsec((BenchStage)i), result.minUsec, result.maxUsec);
+    }
+
+    BE_LOG(L"draw surfs: %.1f per frame\n", numDrawSurfsTotal / BE1::Max(measuredFrames, 1));
+    BE_LOG(L"draw calls: %.1f, instanced: %.1f, verts: %.1f, tris: %.1f per frame\n",
+        PerFrame(rendererStats.drawCalls), PerFrame(rendererStats.instancedDrawCalls), 
+        PerFrame(rendererStats.drawVerts), PerFrame(rendererStats.drawIndexes) / 3);
+    BE_LOG(L"state changes: %.1f, shader binds: %.1f, texture binds: %.1f, buffer binds: %.1f, constant updates: %.1f per frame\n",
+        PerFrame(rendererStats.stateChanges), PerFrame(rendererStats.shaderBinds), PerFrame(rendererStats.textureBinds), 
+        PerFrame(rendererStats.bufferBinds), PerFrame(rendererStats.constantUpdates));
+}
+
+bool RunRenderFrontendBenchmark(const RenderFrontendBenchmarkOptions &options) {
+    BE1::NullRenderer::SetContextSize(options.width, options.height);
+
+    BE1::Renderer::Settings settings;
+    settings.colorBits = 32;
+    settings.alphaBits = 8;
+    settings.depthBits = 24;
+    settings.stencilBits = 8;
+    settings.multiSamples = 0;
+
+    BE1::renderSystem.Init(&settings);
+    if (!BE1::renderSystem.IsInitialized()) {
+        BE_WARNLOG(L"Couldn't initialize the render system\n");
+        return false;
+    }
+
+    BE1::RenderContext *renderContext = BE1::renderSystem.AllocRenderContext(true);
+    renderContext->Init(nullptr, options.width, options.height, nullptr, nullptr);
+
+    BE1::RenderWorld *renderWorld = BE1::renderSystem.AllocRenderWorld();
+
+    BE1::CVar *parallelFrontEnd = BE1::cvarSystem.Find(L"r_useParallelFrontEnd");
+    if (parallelFrontEnd) {
+        parallelFrontEnd->SetBool(!options.serial);
+    }
+
+    BenchScene scene;
+    BuildScene(renderWorld, options, scene);
+
+    BE1::SceneView::Parms viewParms;
+    InitViewParms(viewParms, options);
+
+    BE1::SceneView sceneView;
+
+    for (int i = 0; i < NumBenchStages; i++) {
+        stageResults[i].totalUsec = 0;
+        stageResults[i].minUsec = DBL_MAX;
+        stageResults[i].maxUsec = 0;
+    }
+    memset(&rendererStats, 0, sizeof(rendererStats));
+    numDrawSurfsTotal = 0;
+    measuredFrames = 0;
+
+    BE_LOG(L"Benchmarking render frontend: %i entities, %i lights, %i static meshes, %i frames (%hs)..\n",
+        options.numEntities, options.numLights, options.numStaticMeshes, options.numFrames, options.serial ? "serial" : "parallel");
+
+    // Frames are stepped with a fixed time, so every run renders exactly the same views
+    const int frameMsec = 16;
+
+    for (int frame = 0; frame < WARMUP_FRAMES + options.numFrames; frame++) {
+        const int time = frame * frameMsec;
+
+        uint64_t t0 = BE1::PlatformTime::Microseconds();
+
+        UpdateScene(renderWorld, scene, time * 0.001f);
+
+        UpdateViewParms(viewParms, time);
+        sceneView.Update(&viewParms);
+
+        BE1::NullRenderer::ResetStats();
+
+        uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+        renderContext->BeginFrame();
+
+        renderWorld->RenderScene(&sceneView);
+
+        uint64_t t2 = BE1::PlatformTime::Microseconds();
+
+        renderContext->EndFrame();
+
+        uint64_t t3 = BE1::PlatformTime::Microseconds();
+
+        if (frame < WARMUP_FRAMES) {
+            continue;
+        }
+
+        const BE1::RenderCounter &counter = renderContext->renderCounter;
+
+        AddStageSample(UpdateStage, (double)(t1 - t0));
+        AddStageSample(ViewLightsAndEntitiesStage, counter.viewLightsAndEntitiesUsec);
+        AddStageSample(AddMeshesStage, counter.addMeshesUsec);
+        AddStageSample(AddMeshesForLightsStage, counter.addMeshesForLightsUsec);
+        AddStageSample(FlushDrawSurfsStage, counter.flushDrawSurfsUsec);
+        AddStageSample(OptimizeLightsStage, counter.optimizeLightsUsec);
+        AddStageSample(FrontEndStage, (double)(t2 - t1));
+        AddStageSample(BackEndStage, (double)(t3 - t2));
+        AddStageSample(FrameStage, (double)(t3 - t0));
+
+        numDrawSurfsTotal += counter.numDrawSurfs;
+        AddRendererStats(BE1::NullRenderer::GetStats());
+
+        measuredFrames++;
+    }
+
+    PrintResults();
+
+    if (options.jsonFilename) {
+        WriteJSON(options.jsonFilename, options);
+    }
+    if (options.csvFilename) {
+        WriteCSV(options.csvFilename, options);
+    }
+
+    FreeScene(renderWorld, scene);
+
+    renderContext->Shutdown();
+    BE1::renderSystem.FreeRenderContext(renderContext);
+    BE1::renderSystem.FreeRenderWorld(renderWorld);
+    BE1::renderSystem.Shutdown();
+
+    return true;
+}
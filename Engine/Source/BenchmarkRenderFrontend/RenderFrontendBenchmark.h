@@ -0,0 +1,31 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+struct RenderFrontendBenchmarkOptions {
+    int                 numEntities;        ///< Number of dynamic entities which are moved every frame
+    int                 numLights;          ///< Number of point lights
+    int                 numStaticMeshes;    ///< Number of static mesh entities which are never moved
+    int                 numFrames;          ///< Number of measured frames
+    int                 width;              ///< Render width
+    int                 height;             ///< Render height
+    bool                serial;             ///< Runs the frontend without the job system
+    const char *        jsonFilename;       ///< Writes the results in JSON if not null
+    const char *        csvFilename;        ///< Writes the results in CSV if not null
+};
+
+/// Builds a procedural render world and renders it with the null renderer, reporting the time of each frontend stage.
+/// Returns false if the render system couldn't be initialized.
+bool RunRenderFrontendBenchmark(const RenderFrontendBenchmarkOptions &options);
@@ -0,0 +1,719 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "BenchmarkCommon.h"
+#include "SIMDBenchmark.h"
+
+#define MIN_ITERATIONS          5
+#define MAX_ITERATIONS          200
+#define MIN_SECONDS_PER_KERNEL  0.05
+
+struct BenchProcessor {
+    const char *                name;
+    BE1::SIMDProcessor *        processor;
+};
+
+struct BenchResult {
+    BE1::Str                    kernel;
+    BE1::Str                    processor;
+    int                         size;
+    double                      nanoseconds;
+    double                      speedup;        // relative to the generic processor
+    float                       maxError;
+    float                       tolerance;
+    bool                        passed;
+};
+
+static BE1::Array<BenchProcessor>   processors;
+static BE1::Array<BenchResult>      results;
+static bool                         allPassed;
+static double                       secondsPerTick;
+
+// PlatformTime::Cycles() has only microsecond resolution on some platforms, 
+// so the time stamp counter is used on x86 and calibrated against it.
+static uint64_t ReadTimer() {
+#if defined(__X86__)
+    return rdtsc();
+#else
+    return BE1::PlatformTime::Cycles();
+#endif
+}
+
+static void CalibrateTimer() {
+#if defined(__X86__)
+    uint64_t startTicks = rdtsc();
+    uint64_t startCycles = BE1::PlatformTime::Cycles();
+    uint64_t endCycles;
+    do {
+        endCycles = BE1::PlatformTime::Cycles();
+    } while ((endCycles - startCycles) * BE1::PlatformTime::SecondsPerCycles() < 0.1);
+    uint64_t endTicks = rdtsc();
+
+    secondsPerTick = (endCycles - startCycles) * BE1::PlatformTime::SecondsPerCycles() / (double)(endTicks - startTicks);
+#else
+    secondsPerTick = BE1::PlatformTime::SecondsPerCycles();
+#endif
+}
+
+template <typename T>
+class BenchBuffer {
+public:
+    explicit BenchBuffer(int count) { ptr = (T *)BE1::Mem_Alloc16(sizeof(T) * BE1::Max(count, 1)); }
+    ~BenchBuffer() { BE1::Mem_AlignedFree(ptr); }
+
+    operator T *() { return ptr; }
+
+private:
+    T *                         ptr;
+};
+
+static float RelativeError(float a, float b) {
+    return BE1::Math::Fabs(a - b) / BE1::Max(1.0f, BE1::Math::Fabs(b));
+}
+
+static float MaxRelativeError(const float *a, const float *b, int count) {
+    float maxError = 0.0f;
+    for (int i = 0; i < count; i++) {
+        float e = RelativeError(a[i], b[i]);
+        if (e != e) {
+            return e; // NaN
+        }
+        maxError = BE1::Max(maxError, e);
+    }
+    return maxError;
+}
+
+static void RandomFloats(float *dst, int count, float minimum, float maximum) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = BE1::Math::Random(minimum, maximum);
+    }
+}
+
+static void RandomJointPoses(BE1::JointPose *poses, int count) {
+    for (int i = 0; i < count; i++) {
+        poses[i].q = BE1::Quat(BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f));
+        poses[i].q.Normalize();
+        poses[i].t = BE1::Vec3(BE1::Math::Random(-10.0f, 10.0f), BE1::Math::Random(-10.0f, 10.0f), BE1::Math::Random(-10.0f, 10.0f));
+        poses[i].s = BE1::Vec3(BE1::Math::Random(0.5f, 1.5f), BE1::Math::Random(0.5f, 1.5f), BE1::Math::Random(0.5f, 1.5f));
+    }
+}
+
+// Mostly chains of joints like a real skeleton, parents[i] < i
+static void RandomSkeleton(int *parents, int count) {
+    parents[0] = -1;
+    for (int i = 1; i < count; i++) {
+        parents[i] = i - 1 - rand() % BE1::Min(i, 4);
+    }
+}
+
+// Runs a kernel for each processor and records the best time.
+// setup() restores the input data before each run and is not timed, because some kernels work in place.
+// saveReference() is called after the generic processor has run, and error() returns the max error of 
+// the last run against the saved reference.
+template <typename SetupFunc, typename RunFunc, typename SaveFunc, typename ErrorFunc>
+static void BenchKernel(const char *kernel, int size, float tolerance, SetupFunc setup, RunFunc run, SaveFunc saveReference, ErrorFunc error) {
+    double genericSeconds = 0;
+
+    for (int processorIndex = 0; processorIndex < processors.Count(); processorIndex++) {
+        BE1::SIMDProcessor *processor = processors[processorIndex].processor;
+
+        double bestSeconds = 0;
+        double totalSeconds = 0;
+
+        for (int iteration = 0; iteration < MAX_ITERATIONS; iteration++) {
+            if (iteration >= MIN_ITERATIONS && totalSeconds > MIN_SECONDS_PER_KERNEL) {
+                break;
+            }
+
+            setup();
+
+            uint64_t startTicks = ReadTimer();
+            run(processor);
+            uint64_t endTicks = ReadTimer();
+
+            double seconds = (endTicks - startTicks) * secondsPerTick;
+            if (iteration == 0 || seconds < bestSeconds) {
+                bestSeconds = seconds;
+            }
+            totalSeconds += seconds;
+        }
+
+        float maxError = 0.0f;
+        if (processorIndex == 0) {
+            saveReference();
+            genericSeconds = bestSeconds;
+        } else {
+            maxError = error();
+        }
+
+        BenchResult &result = results.Alloc();
+        result.kernel = kernel;
+        result.processor = processors[processorIndex].name;
+        result.size = size;
+        result.nanoseconds = bestSeconds * 1e9;
+        result.speedup = bestSeconds > 0 ? genericSeconds / bestSeconds : 0;
+        result.maxError = maxError;
+        result.tolerance = tolerance;
+        result.passed = maxError <= tolerance; // false for NaN
+
+        if (!result.passed) {
+            allPassed = false;
+        }
+
+        BE_LOG(L"%-40hs %-8hs %7i: %12.0f ns %6.2fx  error %-10g %ls\n", kernel, processors[processorIndex].name, size,
+            result.nanoseconds, result.speedup, maxError, result.passed ? L"" : L"FAILED");
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// float array operations
+//-------------------------------------------------------------------------------------------------
+
+#define BENCH_FLOAT_OP_CONSTANT(name, op, src0, src1, dst, ref, count) \
+    BenchKernel(#name "(float, float[])", count, 1e-6f, \
+        [&]() {}, \
+        [&](BE1::SIMDProcessor *p) { p->op(dst, 3.0f, src1, count); }, \
+        [&]() { memcpy(ref, dst, sizeof(float) * count); }, \
+        [&]() { return MaxRelativeError(dst, ref, count); })
+
+#define BENCH_FLOAT_OP_ARRAY(name, op, src0, src1, dst, ref, count) \
+    BenchKernel(#name "(float[], float[])", count, 1e-6f, \
+        [&]() {}, \
+        [&](BE1::SIMDProcessor *p) { p->op(dst, src0, src1, count); }, \
+        [&]() { memcpy(ref, dst, sizeof(float) * count); }, \
+        [&]() { return MaxRelativeError(dst, ref, count); })
+
+static void BenchFloatOps(int count) {
+    BenchBuffer<float> src0(count);
+    BenchBuffer<float> src1(count);
+    BenchBuffer<float> dst(count);
+    BenchBuffer<float> ref(count);
+
+    RandomFloats(src0, count, -100.0f, 100.0f);
+    // Avoid division by values near zero
+    RandomFloats(src1, count, 1.0f, 100.0f);
+
+    BENCH_FLOAT_OP_CONSTANT(Add, Add, src0, src1, dst, ref, count);
+    BENCH_FLOAT_OP_ARRAY(Add, Add, src0, src1, dst, ref, count);
+    BENCH_FLOAT_OP_CONSTANT(Sub, Sub, src0, src1, dst, ref, count);
+    BENCH_FLOAT_OP_ARRAY(Sub, Sub, src0, src1, dst, ref, count);
+    BENCH_FLOAT_OP_CONSTANT(Mul, Mul, src0, src1, dst, ref, count);
+    BENCH_FLOAT_OP_ARRAY(Mul, Mul, src0, src1, dst, ref, count);
+    BENCH_FLOAT_OP_CONSTANT(Div, Div, src0, src1, dst, ref, count);
+    BENCH_FLOAT_OP_ARRAY(Div, Div, src0, src1, dst, ref, count);
+
+    float sum = 0, refSum = 0, sumAbs = 0;
+    for (int i = 0; i < count; i++) {
+        sumAbs += BE1::Math::Fabs(src0[i]);
+    }
+
+    // Summation order differs between the processors, so the error is relative to the sum of absolute values
+    BenchKernel("Sum", count, 1e-5f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) { sum = p->Sum(src0, count); },
+        [&]() { refSum = sum; },
+        [&]() { return BE1::Math::Fabs(sum - refSum) / BE1::Max(1.0f, sumAbs); });
+}
+
+#undef BENCH_FLOAT_OP_CONSTANT
+#undef BENCH_FLOAT_OP_ARRAY
+
+static void BenchMemoryOps(int count) {
+    BenchBuffer<byte> src(count);
+    BenchBuffer<byte> dst(count);
+    BenchBuffer<byte> ref(count);
+
+    for (int i = 0; i < count; i++) {
+        src[i] = (byte)rand();
+    }
+
+    BenchKernel("Memcpy", count, 0.0f,
+        [&]() { memset(dst, 0, count); },
+        [&](BE1::SIMDProcessor *p) { p->Memcpy(dst, src, count); },
+        [&]() { memcpy(ref, dst, count); },
+        [&]() { return memcmp(dst, ref, count) ? 1.0f : 0.0f; });
+
+    BenchKernel("Memset", count, 0.0f,
+        [&]() { memset(dst, 0, count); },
+        [&](BE1::SIMDProcessor *p) { p->Memset(dst, 0x5a, count); },
+        [&]() { memcpy(ref, dst, count); },
+        [&]() { return memcmp(dst, ref, count) ? 1.0f : 0.0f; });
+}
+
+static void BenchMatrixOps(int numMatrices) {
+    BenchBuffer<float> src0(numMatrices * 16);
+    BenchBuffer<float> src1(numMatrices * 16);
+    BenchBuffer<float> dst(numMatrices * 16);
+    BenchBuffer<float> ref(numMatrices * 16);
+
+    RandomFloats(src0, numMatrices * 16, -10.0f, 10.0f);
+    RandomFloats(src1, numMatrices * 16, -10.0f, 10.0f);
+
+    BenchKernel("MatrixTranspose", numMatrices, 0.0f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) {
+            for (int i = 0; i < numMatrices; i++) {
+                p->MatrixTranspose(dst + i * 16, src0 + i * 16);
+            }
+        },
+        [&]() { memcpy(ref, dst, sizeof(float) * numMatrices * 16); },
+        [&]() { return MaxRelativeError(dst, ref, numMatrices * 16); });
+
+    BenchKernel("MatrixMultiply", numMatrices, 1e-5f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) {
+            for (int i = 0; i < numMatrices; i++) {
+                p->MatrixMultiply(dst + i * 16, src0 + i * 16, src1 + i * 16);
+            }
+        },
+        [&]() { memcpy(ref, dst, sizeof(float) * numMatrices * 16); },
+        [&]() { return MaxRelativeError(dst, ref, numMatrices * 16); });
+}
+
+//-------------------------------------------------------------------------------------------------
+// joint operations
+//-------------------------------------------------------------------------------------------------
+
+static void BenchJointOps(int numJoints) {
+    BenchBuffer<BE1::JointPose> poses(numJoints);
+    BenchBuffer<BE1::JointPose> blendPoses(numJoints);
+    BenchBuffer<BE1::JointPose> dstPoses(numJoints);
+    BenchBuffer<BE1::JointPose> refPoses(numJoints);
+    BenchBuffer<BE1::CompressedJointPose> compressedPoses(numJoints);
+    BenchBuffer<BE1::Mat3x4> mats(numJoints);
+    BenchBuffer<BE1::Mat3x4> mats2(numJoints);
+    BenchBuffer<BE1::Mat3x4> dstMats(numJoints);
+    BenchBuffer<BE1::Mat3x4> refMats(numJoints);
+    BenchBuffer<int> index(numJoints);
+    BenchBuffer<int> parents(numJoints);
+    BenchBuffer<uint16_t> keys(numJoints * 3 + 1);
+    BenchBuffer<int> keyIndexes0(numJoints);
+    BenchBuffer<int> keyIndexes1(numJoints);
+    BenchBuffer<float> fractions(numJoints);
+    BenchBuffer<BE1::Vec3> rangeMins(numJoints);
+    BenchBuffer<BE1::Vec3> rangeScales(numJoints);
+    BenchBuffer<BE1::Vec3> dstVecs(numJoints);
+    BenchBuffer<BE1::Vec3> refVecs(numJoints);
+    BenchBuffer<BE1::Quat> dstQuats(numJoints);
+    BenchBuffer<BE1::Quat> refQuats(numJoints);
+    BenchBuffer<float> frameComponents(numJoints * BE1::JointSampleGroup::NumComponents * 2);
+    BenchBuffer<BE1::JointSampleGroup> sampleGroups((numJoints + 3) / 4);
+
+    RandomJointPoses(poses, numJoints);
+    RandomJointPoses(blendPoses, numJoints);
+    RandomSkeleton(parents, numJoints);
+
+    for (int i = 0; i < numJoints; i++) {
+        index[i] = i;
+
+        compressedPoses[i].q[0] = BE1::CompressedJointPose::QuatToShort(poses[i].q.x);
+        compressedPoses[i].q[1] = BE1::CompressedJointPose::QuatToShort(poses[i].q.y);
+        compressedPoses[i].q[2] = BE1::CompressedJointPose::QuatToShort(poses[i].q.z);
+        for (int j = 0; j < 3; j++) {
+            compressedPoses[i].t[j] = BE1::CompressedJointPose::TranslationToShort(poses[i].t[j]);
+            compressedPoses[i].s[j] = BE1::CompressedJointPose::ScaleToShort(poses[i].s[j]);
+        }
+
+        // rotation keys are used as the vector keys too, any 16-bit words are valid for them
+        BE1::QuantizedJointKey::QuantizeQuat(poses[i].q, &keys[i * 3]);
+        keyIndexes0[i] = i;
+        keyIndexes1[i] = (i + 1) % numJoints;
+        fractions[i] = BE1::Math::Random(0.0f, 1.0f);
+        rangeMins[i] = poses[i].t;
+        rangeScales[i] = BE1::Vec3(0.0001f, 0.0002f, 0.0003f);
+    }
+    keys[numJoints * 3] = 0;
+
+    // two frames of fully animated joints, the unused lanes of the last group repeat the last joint
+    const int numFrameComponents = numJoints * BE1::JointSampleGroup::NumComponents;
+    for (int i = 0; i < numJoints; i++) {
+        const BE1::JointPose *frames[2] = { &poses[i], &blendPoses[i] };
+        for (int f = 0; f < 2; f++) {
+            float *c = &frameComponents[f * numFrameComponents + i * BE1::JointSampleGroup::NumComponents];
+            const BE1::Quat q = frames[f]->q.w < 0.0f ? -frames[f]->q : frames[f]->q;
+            c[0] = frames[f]->t.x; c[1] = frames[f]->t.y; c[2] = frames[f]->t.z;
+            c[3] = q.x; c[4] = q.y; c[5] = q.z;
+            c[6] = frames[f]->s.x; c[7] = frames[f]->s.y; c[8] = frames[f]->s.z;
+        }
+    }
+    for (int lane = 0; lane < ((numJoints + 3) / 4) * 4; lane++) {
+        const int i = BE1::Min(lane, numJoints - 1);
+        BE1::JointSampleGroup &group = sampleGroups[lane >> 2];
+        for (int c = 0; c < BE1::JointSampleGroup::NumComponents; c++) {
+            group.componentOffsets[c][lane & 3] = i * BE1::JointSampleGroup::NumComponents + c;
+            group.componentMasks[c][lane & 3] = ~0;
+            group.baseComponents[c][lane & 3] = 0.0f;
+        }
+        group.baseComponents[BE1::JointSampleGroup::NumComponents][lane & 3] = 1.0f;
+        group.rotationMasks[lane & 3] = ~0;
+        group.jointIndexes[lane & 3] = i;
+    }
+
+    BE1::simdGeneric->ConvertJointPosesToJointMats(mats, poses, numJoints);
+    BE1::simdGeneric->ConvertJointPosesToJointMats(mats2, blendPoses, numJoints);
+
+    const int numPoseFloats = numJoints * sizeof(BE1::JointPose) / sizeof(float);
+    const int numMatFloats = numJoints * sizeof(BE1::Mat3x4) / sizeof(float);
+
+    auto savePoses = [&]() { memcpy(refPoses, dstPoses, sizeof(BE1::JointPose) * numJoints); };
+    auto posesError = [&]() { return MaxRelativeError((const float *)(BE1::JointPose *)dstPoses, (const float *)(BE1::JointPose *)refPoses, numPoseFloats); };
+    auto saveMats = [&]() { memcpy(refMats, dstMats, sizeof(BE1::Mat3x4) * numJoints); };
+    auto matsError = [&]() { return MaxRelativeError((const float *)(BE1::Mat3x4 *)dstMats, (const float *)(BE1::Mat3x4 *)refMats, numMatFloats); };
+    auto resetPoses = [&]() { memcpy(dstPoses, poses, sizeof(BE1::JointPose) * numJoints); };
+    auto resetMats = [&]() { memcpy(dstMats, mats, sizeof(BE1::Mat3x4) * numJoints); };
+
+    BenchKernel("DecompressJoints", numJoints, 1e-5f,
+        resetPoses,
+        [&](BE1::SIMDProcessor *p) { p->DecompressJoints(dstPoses, compressedPoses, index, numJoints); },
+        savePoses, posesError);
+
+    BenchKernel("DecompressVec3Keys", numJoints, 1e-5f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) { p->DecompressVec3Keys(dstVecs, keys, keyIndexes0, keyIndexes1, fractions, rangeMins, rangeScales, numJoints); },
+        [&]() { memcpy(refVecs, dstVecs, sizeof(BE1::Vec3) * numJoints); },
+        [&]() { return MaxRelativeError((const float *)(BE1::Vec3 *)dstVecs, (const float *)(BE1::Vec3 *)refVecs, numJoints * 3); });
+
+    BenchKernel("DecompressQuatKeys", numJoints, 1e-5f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) { p->DecompressQuatKeys(dstQuats, keys, keyIndexes0, keyIndexes1, fractions, numJoints); },
+        [&]() { memcpy(refQuats, dstQuats, sizeof(BE1::Quat) * numJoints); },
+        [&]() { return MaxRelativeError((const float *)(BE1::Quat *)dstQuats, (const float *)(BE1::Quat *)refQuats, numJoints * 4); });
+
+    BenchKernel("SampleJoints", numJoints, 1e-4f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) { p->SampleJoints(dstPoses, sampleGroups, (numJoints + 3) / 4, frameComponents, &frameComponents[numFrameComponents], 0.35f); },
+        savePoses, posesError);
+
+    BenchKernel("BlendJoints", numJoints, 1e-4f,
+        resetPoses,
+        [&](BE1::SIMDProcessor *p) { p->BlendJoints(dstPoses, blendPoses, 0.35f, index, numJoints); },
+        savePoses, posesError);
+
+    BenchKernel("BlendJointsFast", numJoints, 1e-4f,
+        resetPoses,
+        [&](BE1::SIMDProcessor *p) { p->BlendJointsFast(dstPoses, blendPoses, 0.35f, index, numJoints); },
+        savePoses, posesError);
+
+    BenchKernel("AdditiveBlendJoints", numJoints, 1e-4f,
+        resetPoses,
+        [&](BE1::SIMDProcessor *p) { p->AdditiveBlendJoints(dstPoses, blendPoses, 0.35f, index, numJoints); },
+        savePoses, posesError);
+
+    BenchKernel("ConvertJointPosesToJointMats", numJoints, 1e-5f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) { p->ConvertJointPosesToJointMats(dstMats, poses, numJoints); },
+        saveMats, matsError);
+
+    BenchKernel("ConvertJointMatsToJointPoses", numJoints, 1e-4f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) { p->ConvertJointMatsToJointPoses(dstPoses, mats, numJoints); },
+        savePoses, posesError);
+
+    // Errors are accumulated along the joint hierarchy
+    BenchKernel("TransformJoints", numJoints, 1e-3f,
+        resetMats,
+        [&](BE1::SIMDProcessor *p) { p->TransformJoints(dstMats, parents, 0, numJoints - 1); },
+        saveMats, matsError);
+
+    // The root joint has no parent to untransform
+    BenchKernel("UntransformJoints", numJoints, 1e-3f,
+        resetMats,
+        [&](BE1::SIMDProcessor *p) { p->UntransformJoints(dstMats, parents, 1, numJoints - 1); },
+        saveMats, matsError);
+
+    BenchKernel("MultiplyJoints", numJoints, 1e-5f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) { p->MultiplyJoints(dstMats, mats, mats2, numJoints); },
+        saveMats, matsError);
+}
+
+//-------------------------------------------------------------------------------------------------
+// vertex operations
+//-------------------------------------------------------------------------------------------------
+
+static float MaxVertexError(const BE1::VertexLightingGeneric *verts, const BE1::VertexLightingGeneric *refVerts, int numVerts) {
+    float maxError = 0.0f;
+    for (int i = 0; i < numVerts; i++) {
+        float e = MaxRelativeError(&verts[i].xyz.x, &refVerts[i].xyz.x, 3);
+        if (e != e) {
+            return e;
+        }
+        maxError = BE1::Max(maxError, e);
+    }
+    return maxError;
+}
+
+static void BenchTransformVerts(int numVerts) {
+    const int numJoints = 120;
+    const int maxWeightsPerVert = 4;
+
+    BenchBuffer<BE1::JointPose> poses(numJoints);
+    BenchBuffer<BE1::Mat3x4> jointMats(numJoints);
+    BenchBuffer<BE1::Vec4> base(numVerts * maxWeightsPerVert);
+    BenchBuffer<int> index(numVerts * maxWeightsPerVert * 2);
+    BenchBuffer<BE1::VertexLightingGeneric> verts(numVerts);
+    BenchBuffer<BE1::VertexLightingGeneric> refVerts(numVerts);
+
+    RandomJointPoses(poses, numJoints);
+    BE1::simdGeneric->ConvertJointPosesToJointMats(jointMats, poses, numJoints);
+
+    // 1 ~ 4 weights per vertex. base is the vertex position in joint space premultiplied by the weight (w = weight)
+    int numWeights = 0;
+    for (int i = 0; i < numVerts; i++) {
+        int count = 1 + rand() % maxWeightsPerVert;
+        float weightSum = 0.0f;
+        float weights[maxWeightsPerVert];
+        for (int j = 0; j < count; j++) {
+            weights[j] = BE1::Math::Random(0.1f, 1.0f);
+            weightSum += weights[j];
+        }
+
+        BE1::Vec3 position(BE1::Math::Random(-50.0f, 50.0f), BE1::Math::Random(-50.0f, 50.0f), BE1::Math::Random(-50.0f, 50.0f));
+
+        for (int j = 0; j < count; j++) {
+            float w = weights[j] / weightSum;
+            base[numWeights] = BE1::Vec4(position * w, w);
+            index[numWeights * 2 + 0] = (rand() % numJoints) * sizeof(BE1::Mat3x4);
+            index[numWeights * 2 + 1] = j == count - 1 ? 1 : 0;
+            numWeights++;
+        }
+    }
+
+    memset(verts, 0, sizeof(BE1::VertexLightingGeneric) * numVerts);
+
+    BenchKernel("TransformVerts", numVerts, 1e-4f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) { p->TransformVerts(verts, numVerts, jointMats, base, index, numWeights); },
+        [&]() { memcpy(refVerts, verts, sizeof(BE1::VertexLightingGeneric) * numVerts); },
+        [&]() { return MaxVertexError(verts, refVerts, numVerts); });
+}
+
+static void BenchDeriveTriPlanes(int numVerts) {
+    // Bumpy grid mesh
+    const int gridSize = BE1::Max((int)BE1::Math::Sqrt((float)numVerts), 2);
+    numVerts = gridSize * gridSize;
+    const int numIndexes = (gridSize - 1) * (gridSize - 1) * 6;
+    const int numTris = numIndexes / 3;
+
+    BenchBuffer<BE1::VertexLightingGeneric> verts(numVerts);
+    BenchBuffer<int> indexes(numIndexes);
+    BenchBuffer<BE1::Plane> planes(numTris);
+    BenchBuffer<BE1::Plane> refPlanes(numTris);
+
+    memset(verts, 0, sizeof(BE1::VertexLightingGeneric) * numVerts);
+
+    for (int y = 0; y < gridSize; y++) {
+        for (int x = 0; x < gridSize; x++) {
+            verts[y * gridSize + x].xyz = BE1::Vec3(x + BE1::Math::Random(-0.25f, 0.25f), y + BE1::Math::Random(-0.25f, 0.25f), BE1::Math::Random(-1.0f, 1.0f));
+        }
+    }
+
+    int *indexPtr = indexes;
+    for (int y = 0; y < gridSize - 1; y++) {
+        for (int x = 0; x < gridSize - 1; x++) {
+            int v = y * gridSize + x;
+            *indexPtr++ = v;
+            *indexPtr++ = v + 1;
+            *indexPtr++ = v + gridSize;
+            *indexPtr++ = v + 1;
+            *indexPtr++ = v + gridSize + 1;
+            *indexPtr++ = v + gridSize;
+        }
+    }
+
+    // Generic version uses Math::RSqrt which has only ~12 bits precision
+    BenchKernel("DeriveTriPlanes", numTris, 5e-3f,
+        [&]() {},
+        [&](BE1::SIMDProcessor *p) { p->DeriveTriPlanes(planes, verts, numVerts, indexes, numIndexes); },
+        [&]() { memcpy(refPlanes, planes, sizeof(BE1::Plane) * numTris); },
+        [&]() { return MaxRelativeError((const float *)(BE1::Plane *)planes, (const float *)(BE1::Plane *)refPlanes, numTris * 4); });
+}
+
+//-------------------------------------------------------------------------------------------------
+// culling operations
+//-------------------------------------------------------------------------------------------------
+
+// Fraction of the elements which differ more than the given relative error
+static float MismatchRatio(const float *a, const float *b, int count, float maxRelativeError) {
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        float e = RelativeError(a[i], b[i]);
+        if (e != e || e > maxRelativeError) {
+            mismatches++;
+        }
+    }
+    return (float)mismatches / BE1::Max(count, 1);
+}
+
+static void BenchRasterizeOccluders(int numTris) {
+    // Same size with the software occlusion buffer
+    const int width = 256;
+    const int height = 128;
+
+    BenchBuffer<float> depthBuffer(width * height);
+    BenchBuffer<float> refDepthBuffer(width * height);
+    BenchBuffer<BE1::Vec3> triVerts(numTris * 3);
+    BenchBuffer<int> triIndexes(numTris);
+
+    // Occluder sized triangles of both windings, some of them partially off the screen
+    for (int i = 0; i < numTris; i++) {
+        const BE1::Vec3 center(BE1::Math::Random(-16.0f, width + 16.0f), BE1::Math::Random(-16.0f, height + 16.0f), 0.0f);
+        const float size = BE1::Math::Random(4.0f, 48.0f);
+        for (int j = 0; j < 3; j++) {
+            triVerts[i * 3 + j] = center + BE1::Vec3(BE1::Math::Random(-size, size), BE1::Math::Random(-size, size), BE1::Math::Random(0.01f, 1.0f));
+        }
+        triIndexes[i] = i;
+    }
+
+    // Pixel centers very close to the edges may be classified differently since the edge functions
+    // are stepped in a different order, so only a small fraction of the pixels may differ
+    BenchKernel("RasterizeOccluderTriangles", numTris, 1e-3f,
+        [&]() { memset(depthBuffer, 0, sizeof(float) * width * height); },
+        [&](BE1::SIMDProcessor *p) { p->RasterizeOccluderTriangles(depthBuffer, width, triVerts, triIndexes, numTris, 0, 0, width, height); },
+        [&]() { memcpy(refDepthBuffer, depthBuffer, sizeof(float) * width * height); },
+        [&]() { return MismatchRatio(depthBuffer, refDepthBuffer, width * height, 1e-4f); });
+}
+
+static void BenchCullAABBs(int numProxies) {
+    const int numPlanes = 6;
+
+    BenchBuffer<BE1::Vec4> planes(numPlanes);
+    BenchBuffer<float> bounds(numProxies * 6);
+    BenchBuffer<byte> cullBits(numProxies);
+    BenchBuffer<byte> refCullBits(numProxies);
+
+    // Slightly tilted box around the origin, the front sides face outward
+    for (int i = 0; i < numPlanes; i++) {
+        BE1::Vec3 normal(0.0f, 0.0f, 0.0f);
+        normal[i >> 1] = (i & 1) ? -1.0f : 1.0f;
+        normal += BE1::Vec3(BE1::Math::Random(-0.2f, 0.2f), BE1::Math::Random(-0.2f, 0.2f), BE1::Math::Random(-0.2f, 0.2f));
+        normal.Normalize();
+        planes[i] = BE1::Vec4(normal, -BE1::Math::Random(40.0f, 60.0f));
+    }
+
+    // Proxies scattered around the box, most of them are culled like in a real scene
+    for (int i = 0; i < numProxies; i++) {
+        for (int j = 0; j < 3; j++) {
+            bounds[numProxies * j + i] = BE1::Math::Random(-100.0f, 100.0f);
+            bounds[numProxies * (j + 3) + i] = BE1::Math::Random(0.5f, 5.0f);
+        }
+    }
+
+    auto cullBitsError = [&]() {
+        int mismatches = 0;
+        for (int i = 0; i < numProxies; i++) {
+            mismatches += cullBits[i] != refCullBits[i] ? 1 : 0;
+        }
+        return (float)mismatches / numProxies;
+    };
+
+    // Boxes touching a plane may be classified differently with FMA
+    BenchKernel("CullAABBsByPlanes", numProxies, 1e-3f,
+        [&]() { memset(cullBits, 0xff, numProxies); },
+        [&](BE1::SIMDProcessor *p) { p->CullAABBsByPlanes(cullBits, planes, numPlanes, bounds, numProxies, numProxies); },
+        [&]() { memcpy(refCullBits, cullBits, numProxies); },
+        cullBitsError);
+}
+
+//-------------------------------------------------------------------------------------------------
+// reports
+//-------------------------------------------------------------------------------------------------
+
+static bool WriteReports(const BenchmarkOptions &options) {
+    BenchmarkReport report("kernel,processor,size,ns,ns_per_element,speedup,max_error,tolerance,passed");
+
+    for (int i = 0; i < results.Count(); i++) {
+        const BenchResult &result = results[i];
+        report.AddString(result.kernel.c_str());
+        report.AddString(result.processor.c_str());
+        report.AddInt(result.size);
+        report.AddFloat(result.nanoseconds, "%.1f");
+        report.AddFloat(result.nanoseconds / BE1::Max(result.size, 1), "%.4f");
+        report.AddFloat(result.speedup);
+        report.AddFloat(result.maxError, "%g");
+        report.AddFloat(result.tolerance, "%g");
+        report.AddBool(result.passed);
+    }
+
+    return report.Write(options);
+}
+
+bool RunSIMDBenchmark(const BenchmarkOptions &options) {
+    static const BE1::CpuId instructionSets[] = { BE1::CPUID_GENERIC, BE1::CPUID_SSE4, BE1::CPUID_AVX2 };
+    static const char *instructionSetNames[] = { "Generic", "SSE4", "AVX2" };
+
+    static const int floatCounts[] = { 1024, 16384, 262144 };
+    static const int memoryCounts[] = { 4096, 262144, 4194304 };
+    static const int jointCounts[] = { 60, 120, 250 };
+    static const int vertCounts[] = { 10000, 50000, 200000 };
+    static const int occluderCounts[] = { 256, 1024, 4096 };
+    static const int proxyCounts[] = { 1024, 16384, 131072 };
+
+    // Same random data for every run
+    srand(0x5eed);
+
+    CalibrateTimer();
+
+    for (int i = 0; i < COUNT_OF(instructionSets); i++) {
+        BE1::SIMDProcessor *processor = BE1::SIMD::CreateProcessor(instructionSets[i]);
+        if (!processor) {
+            BE_LOG(L"%hs is not supported on this CPU, skipped\n", instructionSetNames[i]);
+            continue;
+        }
+        BenchProcessor &benchProcessor = processors.Alloc();
+        benchProcessor.name = instructionSetNames[i];
+        benchProcessor.processor = processor;
+    }
+
+    results.Clear();
+    allPassed = true;
+
+    const int numSizes = options.quick ? 1 : 3;
+
+    BE_LOG(L"Benchmarking SIMD processors..\n");
+
+    for (int i = 0; i < numSizes; i++) {
+        BenchFloatOps(floatCounts[i]);
+    }
+    for (int i = 0; i < numSizes; i++) {
+        BenchMemoryOps(memoryCounts[i]);
+    }
+    BenchMatrixOps(1024);
+    for (int i = 0; i < numSizes; i++) {
+        BenchJointOps(jointCounts[i]);
+    }
+    for (int i = 0; i < numSizes; i++) {
+        BenchTransformVerts(vertCounts[i]);
+    }
+    for (int i = 0; i < numSizes; i++) {
+        BenchDeriveTriPlanes(vertCounts[i]);
+    }
+    for (int i = 0; i < numSizes; i++) {
+        BenchRasterizeOccluders(occluderCounts[i]);
+    }
+    for (int i = 0; i < numSizes; i++) {
+        BenchCullAABBs(proxyCounts[i]);
+    }
+
+    for (int i = 0; i < processors.Count(); i++) {
+        delete processors[i].processor;
+    }
+    processors.Clear();
+
+    bool reportsWritten = WriteReports(options);
+
+    BE_LOG(L"SIMD benchmark %ls\n", allPassed ? L"passed" : L"FAILED");
+    return allPassed && reportsWritten;
+}
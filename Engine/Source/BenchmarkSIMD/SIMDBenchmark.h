@@ -0,0 +1,22 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+struct BenchmarkOptions;
+
+/// Runs every SIMDProcessor kernel for the Generic, SSE4 and AVX2 processors and checks the results against the Generic one.
+/// options.quick runs the smallest size of each kernel only.
+/// Returns false if any result is out of tolerance or the reports couldn't be written.
+bool RunSIMDBenchmark(const BenchmarkOptions &options);
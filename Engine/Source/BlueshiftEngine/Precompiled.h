@@ -299,6 +299,8 @@ struct is_assignable_all : static_all_of<std::is_assignable<T, Ts>::value...> {}
 #define ALIGN16(x)                  __declspec(align(16)) x
 #define ALIGN32(x)                  __declspec(align(32)) x
 
+#define BE_THREAD_LOCAL             __declspec(thread)
+
 #define _alloca16(x)                ((void *)((((intptr_t)_alloca((x)+15)) + 15) & ~15))
 #define _alloca32(x)                ((void *)((((intptr_t)_alloca((x)+31)) + 31) & ~31))
 
@@ -375,6 +377,8 @@ struct is_assignable_all : static_all_of<std::is_assignable<T, Ts>::value...> {}
 #define ALIGN16(x)                  __attribute__((aligned(16))) x
 #define ALIGN32(x)                  __attribute__((aligned(32))) x
 
+#define BE_THREAD_LOCAL             __thread
+
 #define _alloca                     alloca
 #define _alloca16(x)                ((void *)((((intptr_t)alloca((x)+15)) + 15) & ~15))
 #define _alloca32(x)                ((void *)((((intptr_t)alloca((x)+31)) + 31) & ~31))
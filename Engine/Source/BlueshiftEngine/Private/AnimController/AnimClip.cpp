@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Render/Render.h"
 #include "AnimController/AnimController.h"
 #include "Animator/Animator.h"
 #include "File/FileSystem.h"
@@ -60,7 +61,8 @@ void AnimClip::GetSingleFrame(int frameNum, int numJointIndexes, const int *join
 }
 
 void AnimClip::GetInterpolatedFrame(Anim::FrameInterpolation &frameInterpolation, int numJointIndexes, const int *jointIndexes, JointPose *joints) const {
-    anim->GetInterpolatedFrame(frameInterpolation, numJointIndexes, jointIndexes, joints);
+    // Shared with the other animators playing the same anim at the same time
+    animPoseCache.GetInterpolatedFrame(anim, frameInterpolation, numJointIndexes, jointIndexes, joints);
 }
 
 void AnimClip::GetTranslation(int time, Vec3 &outTranslation) const {
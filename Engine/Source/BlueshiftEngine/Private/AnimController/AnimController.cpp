@@ -115,6 +115,8 @@ AnimController *AnimControllerManager::FindAnimController(const char *hashName)
 }
 
 AnimController *AnimControllerManager::GetAnimController(const char *name) {
+    MemTagScope tagScope(MemTag::Anim);
+
     AnimController *animController = FindAnimController(name);
     if (animController) {
         animController->refCount++;
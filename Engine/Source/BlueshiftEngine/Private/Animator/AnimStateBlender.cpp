@@ -194,7 +194,8 @@ bool AnimStateBlender::BlendFrame(int currentTime, int numJoints, JointPose *ble
         jointFrame = (JointPose *)_alloca16(numJoints * sizeof(jointFrame[0]));
     }
 
-    float time = NormalizedTime(currentTime);
+    // Only the poses are snapped to the phase bucket, the translation and the events keep the exact time
+    float time = animator->SnapToPhaseBucket(NormalizedTime(currentTime));
 
     animState->GetFrame(animator, time, numJoints, jointFrame);
 
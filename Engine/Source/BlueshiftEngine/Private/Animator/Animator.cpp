@@ -22,6 +22,7 @@
 #include "Core/JointPose.h"
 #include "SIMD/SIMD.h"
 #include "Game/Entity.h"
+#include "Core/Profiler.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -29,6 +30,13 @@ Animator::Animator() {
     animController = nullptr;
     numJoints = 0;
     jointMats = nullptr;
+    lodPoses = nullptr;
+    lodTimes[0] = lodTimes[1] = 0;
+    lodFramesLeft = 0;
+    // Derived from the address, so the animators created together get different phases
+    lodPhase = (int)(((uint32_t)((uintptr_t)this >> 4) * 2654435761u) >> 16);
+    lodHasAnim = false;
+    phaseBuckets = 0;
     ignoreRootTranslation = false;
 
     for (int i = 0; i < MaxLayers; i++) {
@@ -53,17 +61,30 @@ void Animator::FreeData() {
         }
     }
 
+    deferredEvents.Clear();
+
     if (jointMats) {
         Mem_AlignedFree(jointMats);
         jointMats = nullptr;
     }
 
+    if (lodPoses) {
+        Mem_AlignedFree(lodPoses);
+        lodPoses = nullptr;
+    }
+    lodJointIndexes.Clear();
+    lodFramesLeft = 0;
+
     numJoints = 0;
     animController = nullptr;
 }
 
 int Animator::Allocated() const {
-    return numJoints * sizeof(jointMats[0]);
+    int size = numJoints * sizeof(jointMats[0]);
+    if (lodPoses) {
+        size += numJoints * 2 * sizeof(lodPoses[0]) + (int)lodJointIndexes.Allocated();
+    }
+    return size;
 }
 
 int Animator::Size() const {
@@ -100,7 +121,7 @@ bool Animator::SetParameterValue(const char *parmName, const float value) {
     return true;
 }
 
-void Animator::UpdateFrame(Entity *entity, int previousTime, int currentTime) {
+void Animator::UpdateFrame(Entity *entity, int previousTime, int currentTime, bool deferEvents) {
     for (int layerIndex = 0; layerIndex < MaxLayers; layerIndex++) {
         const AnimLayer *animLayer = animController->GetAnimLayerByIndex(layerIndex);
         if (!animLayer) {
@@ -117,7 +138,14 @@ void Animator::UpdateFrame(Entity *entity, int previousTime, int currentTime) {
                 stateBlenders[blenderIndex].SetDuration(currentTime, duration);
 
                 // Calls events for each blending states
-                stateBlenders[blenderIndex].CallEvents(entity, previousTime, currentTime);
+                if (!deferEvents) {
+                    stateBlenders[blenderIndex].CallEvents(entity, previousTime, currentTime);
+                } else if (stateBlenders[blenderIndex].animState->NumTimeEvents() > 0) {
+                    DeferredEvents &events = deferredEvents.Alloc();
+                    events.stateBlender = stateBlenders[blenderIndex];
+                    events.fromTime = previousTime;
+                    events.toTime = currentTime;
+                }
             }
         }
 
@@ -187,6 +215,20 @@ void Animator::UpdateFrame(Entity *entity, int previousTime, int currentTime) {
     }
 }
 
+void Animator::CallDeferredEvents(Entity *entity) {
+    if (!deferredEvents.Count()) {
+        return;
+    }
+
+    // Events may change the states of this animator, so take them out before calling
+    Array<DeferredEvents> events;
+    events.Swap(deferredEvents);
+
+    for (int i = 0; i < events.Count(); i++) {
+        events[i].stateBlender.CallEvents(entity, events[i].fromTime, events[i].toTime);
+    }
+}
+
 void Animator::ClearAnimController() {
     FreeData();
 }
@@ -348,27 +390,112 @@ void Animator::PushStateBlenders(int layerNum, int currentTime, int blendDuratio
     stateBlenders[1].BlendOut(currentTime, blendDuration);
 }
 
-void Animator::ComputeFrame(int currentTime) {
+float Animator::SnapToPhaseBucket(float normalizedTime) const {
+    if (phaseBuckets <= 0) {
+        return normalizedTime;
+    }
+
+    return Math::Floor(normalizedTime * phaseBuckets) / phaseBuckets;
+}
+
+void Animator::ComputeFrame(int currentTime, int updateInterval, int frameTime) {
+    BE_PROFILE_SCOPE("Animator::ComputeFrame");
+    MemTagScope tagScope(MemTag::Anim);
+
     const JointPose *bindPoses = animController->GetBindPoses();
     if (!bindPoses) {
         BE_WARNLOG(L"Animator::ComputeFrame: no bindPoses on '%hs'\n", animController->GetHashName());
         return;
     }
 
-    // Temporary buffer for the joint poses of base layer
-    JointPose *jointFrame1 = (JointPose *)_alloca16(numJoints * sizeof(jointFrame1[0]));
+    if (updateInterval <= 1) {
+        lodFramesLeft = 0;
+
+        JointPose *jointFrame = (JointPose *)_alloca16(numJoints * sizeof(jointFrame[0]));
+        if (ComputePoses(currentTime, jointFrame)) {
+            ComputeJointMats(jointFrame);
+        }
+        return;
+    }
+
+    if (!lodPoses) {
+        lodPoses = (JointPose *)Mem_Alloc16(numJoints * 2 * sizeof(lodPoses[0]));
+
+        lodJointIndexes.SetGranularity(1);
+        lodJointIndexes.SetCount(numJoints);
+        for (int i = 0; i < numJoints; i++) {
+            lodJointIndexes[i] = i;
+        }
+    }
+
+    JointPose *lodPoses0 = lodPoses;
+    JointPose *lodPoses1 = lodPoses + numJoints;
+
+    // Sampled poses are valid only while the current time is between them
+    const bool lodPosesValid = lodHasAnim && currentTime >= lodTimes[0] && currentTime <= lodTimes[1];
+
+    if (lodPosesValid && lodFramesLeft > 0) {
+        lodFramesLeft--;
+
+        JointPose *jointFrame = (JointPose *)_alloca16(numJoints * sizeof(jointFrame[0]));
+        InterpolateLodPoses(currentTime, jointFrame);
+
+        ComputeJointMats(jointFrame);
+        return;
+    }
+
+    // Starts from the interpolated poses of the current time to continue the motion smoothly
+    bool hasAnim;
+    if (lodPosesValid) {
+        JointPose *jointFrame = (JointPose *)_alloca16(numJoints * sizeof(jointFrame[0]));
+        InterpolateLodPoses(currentTime, jointFrame);
+
+        simdProcessor->Memcpy(lodPoses0, jointFrame, numJoints * sizeof(lodPoses0[0]));
+        hasAnim = true;
+    } else {
+        hasAnim = ComputePoses(currentTime, lodPoses0);
+    }
+
+    // Samples the next poses ahead to the next update. When the reduced rate starts,
+    // the first interval is shortened by the own phase, so the animators which enter
+    // the reduced rate on the same frame don't sample again on the same frames.
+    const int framesToSample = lodPosesValid ? updateInterval : 1 + lodPhase % updateInterval;
+
+    lodTimes[0] = currentTime;
+    lodTimes[1] = currentTime + framesToSample * Max(frameTime, 1);
+
+    if (ComputePoses(lodTimes[1], lodPoses1)) {
+        hasAnim = true;
+    }
+
+    lodHasAnim = hasAnim;
+    lodFramesLeft = framesToSample - 1;
+
+    if (hasAnim) {
+        ComputeJointMats(lodPoses0);
+    }
+}
+
+void Animator::InterpolateLodPoses(int currentTime, JointPose *jointPoses) const {
+    const float fraction = (float)(currentTime - lodTimes[0]) / (lodTimes[1] - lodTimes[0]);
+
+    simdProcessor->Memcpy(jointPoses, lodPoses, numJoints * sizeof(jointPoses[0]));
+    simdProcessor->BlendJoints(jointPoses, lodPoses + numJoints, fraction, lodJointIndexes.Ptr(), numJoints);
+}
+
+bool Animator::ComputePoses(int currentTime, JointPose *jointPoses) const {
     // Copy bindposes for all joints
     // Masked joints will be calculated against a layer so unmasked joints still have bindposes
-    simdProcessor->Memcpy(jointFrame1, bindPoses, numJoints * sizeof(jointFrame1[0]));
+    simdProcessor->Memcpy(jointPoses, animController->GetBindPoses(), numJoints * sizeof(jointPoses[0]));
 
     bool hasAnim = false;
 
     // Blending animation state only for base layer 
     float blendedWeight = 0.0f;
-    AnimStateBlender *stateBlender = layerAnimStateBlenders[0];
+    const AnimStateBlender *stateBlender = layerAnimStateBlenders[0];
     for (int i = 0; i < MaxBlendersPerLayer; i++, stateBlender++) {
         if (stateBlender->animState) {
-            if (stateBlender->BlendFrame(currentTime, numJoints, jointFrame1, blendedWeight)) {
+            if (stateBlender->BlendFrame(currentTime, numJoints, jointPoses, blendedWeight)) {
                 hasAnim = true;
                 if (blendedWeight >= 1.0f) {
                     break;
@@ -407,21 +534,21 @@ void Animator::ComputeFrame(int currentTime) {
             float layerBlendWeight = blendedWeight * animLayer->GetWeight(); // NOTE: anim layer weight -- is it really necessary ?
 
             if (animLayer->GetBlending() == AnimLayer::Blending::Override) {
-                simdProcessor->BlendJoints(jointFrame1, jointFrame2, layerBlendWeight, maskJoints.Ptr(), maskJoints.Count());
+                simdProcessor->BlendJoints(jointPoses, jointFrame2, layerBlendWeight, maskJoints.Ptr(), maskJoints.Count());
             } else if (animLayer->GetBlending() == AnimLayer::Blending::Additive) {
-                simdProcessor->AdditiveBlendJoints(jointFrame1, jointFrame2, layerBlendWeight, maskJoints.Ptr(), maskJoints.Count());
+                simdProcessor->AdditiveBlendJoints(jointPoses, jointFrame2, layerBlendWeight, maskJoints.Ptr(), maskJoints.Count());
             } else {
                 BE_WARNLOG(L"Animator::ComputeFrame: invalid layer blending method\n");
             }
         }
     }
 
-    if (!hasAnim) {
-        return;
-    }
+    return hasAnim;
+}
 
+void Animator::ComputeJointMats(const JointPose *jointPoses) {
     // Convert the joint quaternions to rotation matrices
-    simdProcessor->ConvertJointPosesToJointMats(jointMats, jointFrame1, numJoints);
+    simdProcessor->ConvertJointPosesToJointMats(jointMats, jointPoses, numJoints);
 
     // Add in the animController offset
     jointMats[0].SetTranslation(jointMats[0].ToTranslationVec3() + animController->GetRootOffset());
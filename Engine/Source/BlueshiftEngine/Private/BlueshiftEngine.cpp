@@ -52,9 +52,17 @@ void Engine::InitBase(const char *baseDir, bool forceGenericSIMD, const streamOu
     PlatformTime::Init();
 
     Math::Init();
+
+    Profiler::Init();
+
+    JobSystem::Init();
 }
 
 void Engine::ShutdownBase() {
+    JobSystem::Shutdown();
+
+    Profiler::Shutdown();
+
     PlatformTime::Shutdown();
     
     SIMD::Shutdown();
@@ -132,6 +132,14 @@ bool ComRenderable::HasRenderEntity(int sceneEntityHandle) const {
     return false;
 }
 
+const SceneEntity *ComRenderable::GetRenderEntity() const {
+    if (sceneEntityHandle == -1) {
+        return nullptr;
+    }
+
+    return renderWorld->GetEntity(sceneEntityHandle);
+}
+
 void ComRenderable::UpdateVisuals() {
     if (!IsEnabled()) {
         return;
@@ -34,6 +34,7 @@ END_EVENTS
 BEGIN_PROPERTIES(ComSkinnedMeshRenderer)
     PROPERTY_ENUM("animationType", "Animation Type", "", "Animation Controller;Single Animation", "0", PropertySpec::ReadWrite),
     PROPERTY_OBJECT("animController", "Anim Controller", "", GuidMapper::defaultAnimControllerGuid.ToString(), AnimControllerAsset::metaObject, PropertySpec::ReadWrite),
+    PROPERTY_INT("animPhaseBuckets", "Anim Phase Buckets", "number of the phase buckets in an anim cycle to share the poses with the crowd, 0 to disable", "0", PropertySpec::ReadWrite),
     PROPERTY_OBJECT("skeleton", "Skeleton", "", "0", SkeletonAsset::metaObject, PropertySpec::ReadWrite),
     PROPERTY_OBJECT("anim", "Animation", "", "0", AnimAsset::metaObject, PropertySpec::ReadWrite),
 END_PROPERTIES
@@ -68,6 +69,11 @@ bool ComSkinnedMeshRenderer::IsConflictComponent(const MetaObject &componentClas
 }
 
 void ComSkinnedMeshRenderer::Purge(bool chainPurge) {
+    GameWorld *gameWorld = GetGameWorld();
+    if (gameWorld) {
+        gameWorld->UnregisterAnimation(this);
+    }
+
     if (jointMats) {
         Mem_AlignedFree(jointMats);
         jointMats = nullptr;
@@ -99,6 +105,8 @@ void ComSkinnedMeshRenderer::Init() {
 
     if (animationType == AnimationControllerType) {
         ChangeAnimController();
+
+        animator.SetPhaseBuckets(props->Get("animPhaseBuckets").As<int>());
         
         animator.ComputeAnimAABBs(referenceMesh);
 
@@ -281,11 +289,29 @@ void ComSkinnedMeshRenderer::Update() {
         }
 
         animator.ClearForceUpdate();*/        
+    }
+
+    // Computed with all the other skinned meshes after updating the entities
+    GetGameWorld()->RegisterAnimation(this);
+}
+
+void ComSkinnedMeshRenderer::ComputeAnimationFrame(int updateInterval) {
+    const GameWorld *gameWorld = GetGameWorld();
 
-        animator.UpdateFrame(GetEntity(), GetGameWorld()->GetPrevTime(), GetGameWorld()->GetTime());
+    if (animationType == AnimationControllerType) {
+        // Events are called in FinishAnimationFrame() on the main thread
+        animator.UpdateFrame(GetEntity(), gameWorld->GetPrevTime(), gameWorld->GetTime(), true);
     }
 
-    UpdateVisuals();
+    ComputePose(gameWorld->GetTime(), updateInterval, gameWorld->GetTime() - gameWorld->GetPrevTime());
+}
+
+void ComSkinnedMeshRenderer::FinishAnimationFrame() {
+    if (animationType == AnimationControllerType) {
+        animator.CallDeferredEvents(GetEntity());
+    }
+
+    ComRenderable::UpdateVisuals();
 }
 
 void ComSkinnedMeshRenderer::UpdateVisuals() {
@@ -295,14 +321,23 @@ void ComSkinnedMeshRenderer::UpdateVisuals() {
 }
 
 void ComSkinnedMeshRenderer::UpdateAnimation(int currentTime) {
+    ComputePose(currentTime);
+
+    ComRenderable::UpdateVisuals();
+}
+
+void ComSkinnedMeshRenderer::ComputePose(int currentTime, int updateInterval, int frameTime) {
     if (animationType == AnimationControllerType) {
-        animator.ComputeFrame(currentTime);
+        // Off-screen skinned mesh keeps the joints of the last update
+        if (updateInterval > 0) {
+            animator.ComputeFrame(currentTime, updateInterval, frameTime);
 
-        BE1::Mat3x4 *jointMats = animator.GetFrame();
+            BE1::Mat3x4 *jointMats = animator.GetFrame();
 
-        // Modify jointMats for IK here !
+            // Modify jointMats for IK here !
 
-        sceneEntity.joints = jointMats;
+            sceneEntity.joints = jointMats;
+        }
 
         // Get AABB from animator
         animator.ComputeAABB(currentTime);
@@ -313,20 +348,20 @@ void ComSkinnedMeshRenderer::UpdateAnimation(int currentTime) {
             BE1::Anim::FrameInterpolation frameInterpolation;
             anim->TimeToFrameInterpolation(time, frameInterpolation);
 
-            JointPose *jointFrame = (JointPose *)_alloca16(skeleton->NumJoints() * sizeof(jointFrame[0]));
-            anim->GetInterpolatedFrame(frameInterpolation, jointIndexes.Count(), jointIndexes.Ptr(), jointFrame);
+            if (updateInterval > 0) {
+                JointPose *jointFrame = (JointPose *)_alloca16(skeleton->NumJoints() * sizeof(jointFrame[0]));
+                animPoseCache.GetInterpolatedFrame(anim, frameInterpolation, jointIndexes.Count(), jointIndexes.Ptr(), jointFrame);
 
-            simdProcessor->ConvertJointPosesToJointMats(jointMats, jointFrame, skeleton->NumJoints());
+                simdProcessor->ConvertJointPosesToJointMats(jointMats, jointFrame, skeleton->NumJoints());
 
-            simdProcessor->TransformJoints(jointMats, jointParents.Ptr(), 1, skeleton->NumJoints() - 1);
+                simdProcessor->TransformJoints(jointMats, jointParents.Ptr(), 1, skeleton->NumJoints() - 1);
+            }
 
             anim->GetAABB(sceneEntity.aabb, frameAABBs, time);
         } else {
             sceneEntity.aabb = referenceMesh->GetAABB();
         }
     }
-
-    ComRenderable::UpdateVisuals();
 }
 
 void ComSkinnedMeshRenderer::MeshUpdated() {
@@ -415,6 +450,11 @@ void ComSkinnedMeshRenderer::PropertyChanged(const char *classname, const char *
         return;
     }
 
+    if (!Str::Cmp(propName, "animPhaseBuckets")) {
+        animator.SetPhaseBuckets(props->Get("animPhaseBuckets").As<int>());
+        return;
+    }
+
     ComMeshRenderer::PropertyChanged(classname, propName);
 }
 
@@ -43,11 +43,11 @@ void HashIndex::Allocate(const int newHashSize, const int newIndexSize) {
     Free();
 
     hashSize = newHashSize;
-    hashTable = new int [hashSize];
+    hashTable = AllocTable(hashSize);
     memset(hashTable, 0xFF, hashSize * sizeof(hashTable[0]));
 
     indexSize = newIndexSize;
-    indexChain = new int [indexSize];
+    indexChain = AllocTable(indexSize);
     memset(indexChain, 0xFF, indexSize * sizeof(indexChain[0]));
     
     hashMask = hashSize - 1;
@@ -56,12 +56,12 @@ void HashIndex::Allocate(const int newHashSize, const int newIndexSize) {
 
 void HashIndex::Free() {
     if (hashTable != EmptyTable) {
-        delete [] hashTable;
+        Mem_Free(hashTable);
         hashTable = EmptyTable;
     }
 
     if (indexChain != EmptyTable) {
-        delete [] indexChain;
+        Mem_Free(indexChain);
         indexChain = EmptyTable;
     }
     lookUpMask = 0;
@@ -89,13 +89,13 @@ void HashIndex::ResizeIndex(const int newIndexSize) {
     int *oldIndexChain = indexChain;
 
     // allocate new index chain data
-    indexChain = new int [newSize];
+    indexChain = AllocTable(newSize);
     // copy old index chain data
     memcpy(indexChain, oldIndexChain, indexSize * sizeof(int));
     // fill -1 for redundant values
     memset(indexChain + indexSize, 0xFF, (newSize - indexSize) * sizeof(int)); 
     // delete old index chain data
-    delete [] oldIndexChain;
+    Mem_Free(oldIndexChain);
     // update new index size
     indexSize = newSize;
 }
@@ -107,7 +107,7 @@ float HashIndex::GetStandardDeviation() const {
 
     int totalItems = 0;
 
-    int *numHashItems = new int [hashSize];
+    int *numHashItems = AllocTable(hashSize);
 
     for (int i = 0; i < hashSize; i++) {
         numHashItems[i] = 0;
@@ -119,7 +119,7 @@ float HashIndex::GetStandardDeviation() const {
 
     // if no items in hash
     if (totalItems <= 1) {
-        delete [] numHashItems;
+        Mem_Free(numHashItems);
         return 0;
     }
 
@@ -130,7 +130,7 @@ float HashIndex::GetStandardDeviation() const {
         s += e * e;
     }
 
-    delete [] numHashItems;
+    Mem_Free(numHashItems);
 
     float v = (float)s / totalItems;
     return sqrtf(v);
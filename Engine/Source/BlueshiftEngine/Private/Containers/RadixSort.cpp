@@ -0,0 +1,182 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Containers/RadixSort.h"
+#include "Core/Heap.h"
+#include "Core/JobSystem.h"
+
+BE_NAMESPACE_BEGIN
+
+static const int RadixBits = 8;
+static const int RadixSize = 1 << RadixBits;
+static const int RadixMask = RadixSize - 1;
+static const int NumPasses = 64 / RadixBits;
+
+// Builds digit histograms of all passes at once
+static void BuildHistograms(const RadixSortPair *pairs, int count, uint32_t histograms[NumPasses][RadixSize]) {
+    memset(histograms, 0, sizeof(uint32_t) * NumPasses * RadixSize);
+
+    for (int i = 0; i < count; i++) {
+        uint64_t key = pairs[i].key;
+        for (int pass = 0; pass < NumPasses; pass++) {
+            histograms[pass][key & RadixMask]++;
+            key >>= RadixBits;
+        }
+    }
+}
+
+// Returns true if all the keys have the same digit in this pass
+static bool IsTrivialPass(const uint32_t histogram[RadixSize], int count, const RadixSortPair *pairs, int shift) {
+    return histogram[(pairs[0].key >> shift) & RadixMask] == (uint32_t)count;
+}
+
+void RadixSort(RadixSortPair *pairs, RadixSortPair *temp, int count) {
+    if (count <= 1) {
+        return;
+    }
+
+    uint32_t histograms[NumPasses][RadixSize];
+    BuildHistograms(pairs, count, histograms);
+
+    RadixSortPair *src = pairs;
+    RadixSortPair *dst = temp;
+
+    for (int pass = 0; pass < NumPasses; pass++) {
+        const int shift = pass * RadixBits;
+        const uint32_t *histogram = histograms[pass];
+
+        if (IsTrivialPass(histogram, count, src, shift)) {
+            continue;
+        }
+
+        uint32_t offsets[RadixSize];
+        uint32_t sum = 0;
+        for (int i = 0; i < RadixSize; i++) {
+            offsets[i] = sum;
+            sum += histogram[i];
+        }
+
+        for (int i = 0; i < count; i++) {
+            const RadixSortPair &pair = src[i];
+            dst[offsets[(pair.key >> shift) & RadixMask]++] = pair;
+        }
+
+        Swap(src, dst);
+    }
+
+    if (src != pairs) {
+        memcpy(pairs, src, count * sizeof(pairs[0]));
+    }
+}
+
+void ParallelRadixSort(RadixSortPair *pairs, RadixSortPair *temp, int count, int minParallelCount) {
+    const int numWorkers = JobSystem::NumWorkers();
+    if (count < minParallelCount || numWorkers <= 1) {
+        RadixSort(pairs, temp, count);
+        return;
+    }
+
+    // Each chunk is processed by one job, chunk boundaries are fixed for all passes
+    const int numChunks = numWorkers * 2;
+    const int chunkSize = (count + numChunks - 1) / numChunks;
+
+    uint32_t histograms[NumPasses][RadixSize];
+    memset(histograms, 0, sizeof(histograms));
+
+    // Too big for the stack
+    typedef uint32_t histograms_t[NumPasses][RadixSize];
+    typedef uint32_t offsets_t[RadixSize];
+    histograms_t *chunkHistograms = (histograms_t *)Mem_Alloc(numChunks * sizeof(histograms_t));
+    offsets_t *chunkOffsets = (offsets_t *)Mem_Alloc(numChunks * sizeof(offsets_t));
+
+    JobSystem::ParallelFor(0, numChunks, 1, [&](int begin, int end) {
+        for (int chunkIndex = begin; chunkIndex < end; chunkIndex++) {
+            const int first = chunkIndex * chunkSize;
+            const int last = Min(first + chunkSize, count);
+            BuildHistograms(pairs + first, Max(last - first, 0), chunkHistograms[chunkIndex]);
+        }
+    });
+
+    for (int chunkIndex = 0; chunkIndex < numChunks; chunkIndex++) {
+        for (int pass = 0; pass < NumPasses; pass++) {
+            for (int i = 0; i < RadixSize; i++) {
+                histograms[pass][i] += chunkHistograms[chunkIndex][pass][i];
+            }
+        }
+    }
+
+    RadixSortPair *src = pairs;
+    RadixSortPair *dst = temp;
+    bool permuted = false;
+
+    for (int pass = 0; pass < NumPasses; pass++) {
+        const int shift = pass * RadixBits;
+
+        if (IsTrivialPass(histograms[pass], count, src, shift)) {
+            continue;
+        }
+
+        // Digit counts of each chunk in the current source order.
+        // The first non-trivial pass can reuse the histograms built above.
+        if (permuted) {
+            JobSystem::ParallelFor(0, numChunks, 1, [&](int begin, int end) {
+                for (int chunkIndex = begin; chunkIndex < end; chunkIndex++) {
+                    uint32_t *histogram = chunkHistograms[chunkIndex][pass];
+                    memset(histogram, 0, sizeof(uint32_t) * RadixSize);
+
+                    const int first = chunkIndex * chunkSize;
+                    const int last = Min(first + chunkSize, count);
+                    for (int i = first; i < last; i++) {
+                        histogram[(src[i].key >> shift) & RadixMask]++;
+                    }
+                }
+            });
+        }
+
+        // Each chunk scatters its keys right after the same digits of the preceding chunks to keep the sort stable
+        uint32_t sum = 0;
+        for (int i = 0; i < RadixSize; i++) {
+            for (int chunkIndex = 0; chunkIndex < numChunks; chunkIndex++) {
+                chunkOffsets[chunkIndex][i] = sum;
+                sum += chunkHistograms[chunkIndex][pass][i];
+            }
+        }
+
+        JobSystem::ParallelFor(0, numChunks, 1, [&](int begin, int end) {
+            for (int chunkIndex = begin; chunkIndex < end; chunkIndex++) {
+                uint32_t *offsets = chunkOffsets[chunkIndex];
+
+                const int first = chunkIndex * chunkSize;
+                const int last = Min(first + chunkSize, count);
+                for (int i = first; i < last; i++) {
+                    const RadixSortPair &pair = src[i];
+                    dst[offsets[(pair.key >> shift) & RadixMask]++] = pair;
+                }
+            }
+        });
+
+        Swap(src, dst);
+        permuted = true;
+    }
+
+    if (src != pairs) {
+        memcpy(pairs, src, count * sizeof(pairs[0]));
+    }
+
+    Mem_Free(chunkOffsets);
+    Mem_Free(chunkHistograms);
+}
+
+BE_NAMESPACE_END
@@ -15,6 +15,8 @@
 #include "Precompiled.h"
 #include "Core/DynamicAABBTree.h"
 #include "Core/Heap.h"
+#include "Core/JobSystem.h"
+#include "SIMD/Simd.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -24,18 +26,22 @@ const float     DISPLACEMENT_MULTIPLIER     = 2.0f;
 DynamicAABBTree::DynamicAABBTree() {
     nodeCapacity = DEFAULT_CAPACITY;
     nodes = (Node *)Mem_Alloc(nodeCapacity * sizeof(nodes[0]));
+    leafBounds = (float *)Mem_Alloc16(nodeCapacity * 6 * sizeof(float));
     Purge();
 }
 
 DynamicAABBTree::~DynamicAABBTree() {
     Mem_Free(nodes);
+    Mem_AlignedFree(leafBounds);
 }
 
 void DynamicAABBTree::Purge(bool clearNodes) {
     if (clearNodes) {
         Mem_Free(nodes);
+        Mem_AlignedFree(leafBounds);
         nodeCapacity = DEFAULT_CAPACITY;
         nodes = (Node *)Mem_Alloc(nodeCapacity * sizeof(nodes[0]));
+        leafBounds = (float *)Mem_Alloc16(nodeCapacity * 6 * sizeof(float));
     }
 
     memset(nodes, 0, nodeCapacity * sizeof(nodes[0]));
@@ -52,6 +58,9 @@ void DynamicAABBTree::Purge(bool clearNodes) {
     freeList = 0;
     root = -1;
     insertionCount = 0;
+    bulkInsert = false;
+    builtAreaRatio = 0.0f;
+    checkedInsertionCount = 0;
 }
 
 // Allocated a node from the pool. Grow the pool if necessary.
@@ -67,6 +76,14 @@ int32_t DynamicAABBTree::AllocNode() {
         memcpy(nodes, oldNodes, nodeCount * sizeof(nodes[0]));
         Mem_Free(oldNodes);
 
+        // Each SoA array is moved to its new offset
+        float *oldLeafBounds = leafBounds;
+        leafBounds = (float *)Mem_Alloc16(nodeCapacity * 6 * sizeof(float));
+        for (int i = 0; i < 6; i++) {
+            memcpy(leafBounds + i * nodeCapacity, oldLeafBounds + i * nodeCount, nodeCount * sizeof(float));
+        }
+        Mem_AlignedFree(oldLeafBounds);
+
         // Build a linked list for the free list. The parent
         // pointer becomes the "next" pointer.
         Node *node = &nodes[nodeCount];
@@ -114,6 +131,8 @@ int32_t DynamicAABBTree::CreateProxy(const AABB &aabb, float expansion, void *us
     nodes[proxyId].userData = userData;
     nodes[proxyId].height = 0;
 
+    UpdateLeafBounds(proxyId);
+
     InsertLeaf(proxyId);
 
     return proxyId;
@@ -164,11 +183,107 @@ bool DynamicAABBTree::MoveProxy(int32_t proxyId, const AABB &aabb, float expansi
 
     nodes[proxyId].aabb = b;
 
+    UpdateLeafBounds(proxyId);
+
     InsertLeaf(proxyId);
     return true;
 }
 
+void DynamicAABBTree::RefitProxy(int32_t proxyId, const AABB &aabb, float expansion, bool deferRefit) {
+    assert(0 <= proxyId && proxyId < nodeCapacity);
+    assert(nodes[proxyId].IsLeaf());
+
+    nodes[proxyId].aabb = aabb;
+    nodes[proxyId].aabb.ExpandSelf(expansion);
+
+    UpdateLeafBounds(proxyId);
+
+    if (deferRefit) {
+        return;
+    }
+
+    // Walk back up the tree fixing AABBs. Ancestors of an unchanged node are unchanged too.
+    int32_t index = nodes[proxyId].parent;
+    while (index != -1) {
+        AABB aabb = nodes[nodes[index].child1].aabb + nodes[nodes[index].child2].aabb;
+        if (aabb == nodes[index].aabb) {
+            break;
+        }
+        nodes[index].aabb = aabb;
+
+        index = nodes[index].parent;
+    }
+}
+
+void DynamicAABBTree::Refit() {
+    if (root == -1 || nodes[root].IsLeaf()) {
+        return;
+    }
+
+    // Parents come before their children in pre-order, so the reversed order refits the children first
+    int32_t *order = (int32_t *)Mem_Alloc(nodeCount * sizeof(int32_t));
+    int32_t count = 0;
+
+    Stack<int32_t> stack(256);
+    stack.Push(root);
+
+    while (!stack.IsEmpty()) {
+        int32_t nodeId = stack.Pop();
+        if (nodes[nodeId].IsLeaf()) {
+            continue;
+        }
+
+        order[count++] = nodeId;
+        stack.Push(nodes[nodeId].child1);
+        stack.Push(nodes[nodeId].child2);
+    }
+
+    for (int32_t i = count - 1; i >= 0; i--) {
+        Node *node = nodes + order[i];
+        const Node *child1 = nodes + node->child1;
+        const Node *child2 = nodes + node->child2;
+
+        node->aabb = child1->aabb + child2->aabb;
+        node->height = 1 + Max(child1->height, child2->height);
+    }
+
+    Mem_Free(order);
+}
+
+void DynamicAABBTree::BeginBulkInsert() {
+    bulkInsert = true;
+}
+
+void DynamicAABBTree::EndBulkInsert() {
+    if (!bulkInsert) {
+        return;
+    }
+
+    bulkInsert = false;
+
+    RebuildSAH();
+}
+
+void DynamicAABBTree::UpdateLeafBounds(int32_t leaf) {
+    const AABB &aabb = nodes[leaf].aabb;
+    const Vec3 center = aabb.Center();
+    const Vec3 extents = aabb[1] - center;
+
+    leafBounds[leaf] = center.x;
+    leafBounds[leaf + nodeCapacity] = center.y;
+    leafBounds[leaf + nodeCapacity * 2] = center.z;
+    leafBounds[leaf + nodeCapacity * 3] = extents.x;
+    leafBounds[leaf + nodeCapacity * 4] = extents.y;
+    leafBounds[leaf + nodeCapacity * 5] = extents.z;
+}
+
 void DynamicAABBTree::InsertLeaf(int32_t leaf) {
+    if (bulkInsert) {
+        // Inserted with all the other leaves in EndBulkInsert()
+        nodes[leaf].parent = -1;
+        return;
+    }
+
     insertionCount++;
 
     if (root == -1) {
@@ -285,6 +400,11 @@ void DynamicAABBTree::RemoveLeaf(int32_t leaf) {
     }
 
     int32_t parent = nodes[leaf].parent;
+    if (parent == -1) {
+        // Not inserted yet in the bulk insertion
+        return;
+    }
+
     int32_t grandParent = nodes[parent].parent;
     int32_t sibling;
     if (nodes[parent].child1 == leaf) {
@@ -678,6 +798,354 @@ void DynamicAABBTree::RebuildBottomUp() {
     Validate();
 }
 
+void DynamicAABBTree::RebuildSAH(bool parallel) {
+    // Build array of leaves. Free the rest.
+    int32_t numLeaves = 0;
+    for (int32_t i = 0; i < nodeCapacity; i++) {
+        if (nodes[i].height < 0) {
+            // free node in pool
+            continue;
+        }
+
+        if (nodes[i].IsLeaf()) {
+            numLeaves++;
+        } else {
+            FreeNode(i);
+        }
+    }
+
+    root = -1;
+
+    if (numLeaves == 0) {
+        return;
+    }
+
+    int32_t *leafIds = (int32_t *)Mem_Alloc(numLeaves * 2 * sizeof(int32_t));
+    int32_t *internalNodes = leafIds + numLeaves;
+
+    int32_t count = 0;
+    for (int32_t i = 0; i < nodeCapacity; i++) {
+        if (nodes[i].height == 0) {
+            leafIds[count++] = i;
+        }
+    }
+
+    // Internal nodes are allocated up front, so the sub trees can be built in parallel.
+    // The node splitting the range at position i takes internalNodes[i - 1].
+    for (int32_t i = 0; i < numLeaves - 1; i++) {
+        internalNodes[i] = AllocNode();
+    }
+
+    root = BuildSAH(leafIds, 0, numLeaves, internalNodes, 0, parallel);
+    nodes[root].parent = -1;
+
+    Mem_Free(leafIds);
+
+    builtAreaRatio = GetAreaRatio();
+    checkedInsertionCount = insertionCount;
+}
+
+// Builds the sub tree of the leaves in range [begin, end) and returns the sub tree root.
+int32_t DynamicAABBTree::BuildSAH(int32_t *leafIds, int begin, int end, const int32_t *internalNodes, int depth, bool parallel) {
+    const int count = end - begin;
+    if (count == 1) {
+        return leafIds[begin];
+    }
+
+    const float *centers[3] = { leafBounds, leafBounds + nodeCapacity, leafBounds + nodeCapacity * 2 };
+
+    Vec3 centerMin(FLT_MAX, FLT_MAX, FLT_MAX);
+    Vec3 centerMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (int i = begin; i < end; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            const float c = centers[axis][leafIds[i]];
+            centerMin[axis] = Min(centerMin[axis], c);
+            centerMax[axis] = Max(centerMax[axis], c);
+        }
+    }
+
+    int mid = begin;
+
+    if (depth < MaxSAHBuildDepth && count > 2) {
+        // Find the split plane between the bins with the minimum SAH cost
+        float bestCost = FLT_MAX;
+        int bestAxis = -1;
+        int bestBin = 0;
+        float bestScale = 0.0f;
+
+        for (int axis = 0; axis < 3; axis++) {
+            const float extent = centerMax[axis] - centerMin[axis];
+            if (extent <= 1e-6f) {
+                continue;
+            }
+
+            const float scale = NumSAHBins * (1.0f - 1e-4f) / extent;
+
+            AABB binAABBs[NumSAHBins];
+            int binCounts[NumSAHBins];
+            for (int bin = 0; bin < NumSAHBins; bin++) {
+                binAABBs[bin].Clear();
+                binCounts[bin] = 0;
+            }
+
+            for (int i = begin; i < end; i++) {
+                const int bin = (int)((centers[axis][leafIds[i]] - centerMin[axis]) * scale);
+                binAABBs[bin] += nodes[leafIds[i]].aabb;
+                binCounts[bin]++;
+            }
+
+            // Sweep from the right side to get the right side areas of each split
+            float rightAreas[NumSAHBins];
+            int rightCounts[NumSAHBins];
+            AABB rightAABB;
+            rightAABB.Clear();
+            int rightCount = 0;
+            for (int bin = NumSAHBins - 1; bin > 0; bin--) {
+                if (binCounts[bin]) {
+                    rightAABB += binAABBs[bin];
+                    rightCount += binCounts[bin];
+                }
+                rightAreas[bin] = rightCount ? rightAABB.Area() : 0.0f;
+                rightCounts[bin] = rightCount;
+            }
+
+            AABB leftAABB;
+            leftAABB.Clear();
+            int leftCount = 0;
+            for (int bin = 1; bin < NumSAHBins; bin++) {
+                if (binCounts[bin - 1]) {
+                    leftAABB += binAABBs[bin - 1];
+                    leftCount += binCounts[bin - 1];
+                }
+                if (!leftCount || !rightCounts[bin]) {
+                    continue;
+                }
+
+                const float cost = leftAABB.Area() * leftCount + rightAreas[bin] * rightCounts[bin];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = bin;
+                    bestScale = scale;
+                }
+            }
+        }
+
+        if (bestAxis >= 0) {
+            // Partition the leaves by the split bin
+            const float *axisCenters = centers[bestAxis];
+            const float axisMin = centerMin[bestAxis];
+            int i = begin;
+            int j = end - 1;
+            while (i <= j) {
+                if ((int)((axisCenters[leafIds[i]] - axisMin) * bestScale) < bestBin) {
+                    i++;
+                } else {
+                    Swap(leafIds[i], leafIds[j]);
+                    j--;
+                }
+            }
+            mid = i;
+        }
+    }
+
+    if (mid <= begin || mid >= end) {
+        // Split at the median of the longest axis
+        const Vec3 extents = centerMax - centerMin;
+        const int axis = extents.x > extents.y ? (extents.x > extents.z ? 0 : 2) : (extents.y > extents.z ? 1 : 2);
+        const float *axisCenters = centers[axis];
+
+        mid = begin + count / 2;
+        std::nth_element(leafIds + begin, leafIds + mid, leafIds + end, [axisCenters](int32_t a, int32_t b) {
+            return axisCenters[a] < axisCenters[b];
+        });
+    }
+
+    int32_t children[2];
+
+    if (parallel && count >= ParallelBuildLeaves) {
+        JobSystem::ParallelFor(0, 2, 1, [&](int childBegin, int childEnd) {
+            for (int i = childBegin; i < childEnd; i++) {
+                children[i] = i == 0 ?
+                    BuildSAH(leafIds, begin, mid, internalNodes, depth + 1, parallel) :
+                    BuildSAH(leafIds, mid, end, internalNodes, depth + 1, parallel);
+            }
+        });
+    } else {
+        children[0] = BuildSAH(leafIds, begin, mid, internalNodes, depth + 1, parallel);
+        children[1] = BuildSAH(leafIds, mid, end, internalNodes, depth + 1, parallel);
+    }
+
+    const int32_t nodeId = internalNodes[mid - 1];
+    Node *node = nodes + nodeId;
+    node->child1 = children[0];
+    node->child2 = children[1];
+    node->userData = nullptr;
+    node->aabb = nodes[children[0]].aabb + nodes[children[1]].aabb;
+    node->height = 1 + Max(nodes[children[0]].height, nodes[children[1]].height);
+
+    nodes[children[0]].parent = nodeId;
+    nodes[children[1]].parent = nodeId;
+
+    return nodeId;
+}
+
+bool DynamicAABBTree::RebuildIfDegraded(float maxAreaRatioGrowth) {
+    if (root == -1 || bulkInsert) {
+        return false;
+    }
+
+    // Computing the area ratio visits all the nodes, so it is checked only after enough insertions
+    if (insertionCount - checkedInsertionCount < Max((int)RebuildCheckInterval, GetProxyCount() / 4)) {
+        return false;
+    }
+    checkedInsertionCount = insertionCount;
+
+    float areaRatio = GetAreaRatio();
+    if (builtAreaRatio <= 0.0f) {
+        // Tree built incrementally, the first check becomes the reference
+        builtAreaRatio = areaRatio;
+        return false;
+    }
+
+    if (areaRatio <= builtAreaRatio * maxAreaRatioGrowth) {
+        return false;
+    }
+
+    RebuildSAH();
+    return true;
+}
+
 #pragma optimize("", off)
 
+// Same separating planes as Frustum::CullAABB() in world space.
+// Left/right and up/down planes pass through the frustum origin.
+void DynamicAABBTree::FrustumToCullPlanes(const Frustum &frustum, Vec4 planes[6]) {
+    const Vec3 &origin = frustum.GetOrigin();
+    const Mat3 &axis = frustum.GetAxis();
+    const float dNear = frustum.GetNearDistance();
+    const float dFar = frustum.GetFarDistance();
+    const float dLeft = frustum.GetLeft();
+    const float dUp = frustum.GetUp();
+
+    Vec3 normals[6];
+    normals[0] = -axis[0];
+    normals[1] = axis[0];
+    normals[2] = axis[1] * dFar - axis[0] * dLeft;
+    normals[3] = -axis[1] * dFar - axis[0] * dLeft;
+    normals[4] = axis[2] * dFar - axis[0] * dUp;
+    normals[5] = -axis[2] * dFar - axis[0] * dUp;
+
+    planes[0] = Vec4(normals[0], dNear - normals[0].Dot(origin));
+    planes[1] = Vec4(normals[1], -dFar - normals[1].Dot(origin));
+    for (int i = 2; i < 6; i++) {
+        planes[i] = Vec4(normals[i], -normals[i].Dot(origin));
+    }
+}
+
+bool DynamicAABBTree::CullAABBByPlanes(const Vec4 planes[6], const AABB &aabb) {
+    const Vec3 center = aabb.Center();
+    const Vec3 extents = aabb[1] - center;
+
+    for (int i = 0; i < 6; i++) {
+        const Vec4 &plane = planes[i];
+        const float d = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        const float r = Math::Fabs(plane.x) * extents.x + Math::Fabs(plane.y) * extents.y + Math::Fabs(plane.z) * extents.z;
+        if (d - r > 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int DynamicAABBTree::CullLeaves(const Vec4 planes[6], int32_t *leafIds, int count) const {
+    if (!count) {
+        return 0;
+    }
+
+    assert(count <= BatchSize);
+
+    // Gather the SoA bounds of the candidates
+    float bounds[6 * BatchSize];
+    byte cullBits[BatchSize];
+
+    for (int i = 0; i < count; i++) {
+        const int32_t leafId = leafIds[i];
+        for (int j = 0; j < 6; j++) {
+            bounds[j * BatchSize + i] = leafBounds[j * nodeCapacity + leafId];
+        }
+    }
+
+    simdProcessor->CullAABBsByPlanes(cullBits, planes, 6, bounds, BatchSize, count);
+
+    int numVisible = 0;
+    for (int i = 0; i < count; i++) {
+        if (!cullBits[i]) {
+            leafIds[numVisible++] = leafIds[i];
+        }
+    }
+    return numVisible;
+}
+
+int DynamicAABBTree::CullParallel(const Vec4 planes[6]) const {
+    if (root == -1) {
+        return 0;
+    }
+
+    int32_t subtrees[MaxParallelSubtrees];
+    int32_t nextSubtrees[MaxParallelSubtrees];
+    int numSubtrees = 0;
+    subtrees[numSubtrees++] = root;
+
+    const int targetSubtrees = Min(JobSystem::NumWorkers() * 4, (int)MaxParallelSubtrees);
+
+    // Split the tree breadth first until there are enough sub trees to distribute
+    while (numSubtrees < targetSubtrees) {
+        int numNext = 0;
+        bool expanded = false;
+
+        for (int i = 0; i < numSubtrees; i++) {
+            const int32_t nodeId = subtrees[i];
+            const Node *node = &nodes[nodeId];
+
+            // Keep the rest of the nodes as they are if there is no room for the children
+            if (node->IsLeaf() || numNext + (numSubtrees - i) + 1 > MaxParallelSubtrees) {
+                nextSubtrees[numNext++] = nodeId;
+                continue;
+            }
+
+            expanded = true;
+
+            if (CullAABBByPlanes(planes, node->aabb)) {
+                continue;
+            }
+
+            nextSubtrees[numNext++] = node->child1;
+            nextSubtrees[numNext++] = node->child2;
+        }
+
+        memcpy(subtrees, nextSubtrees, numNext * sizeof(subtrees[0]));
+        numSubtrees = numNext;
+
+        if (!expanded) {
+            break;
+        }
+    }
+
+    JobSystem::ParallelFor(0, numSubtrees, 1, [this, planes, &subtrees](int begin, int end) {
+        for (int subtreeIndex = begin; subtreeIndex < end; subtreeIndex++) {
+            Array<int32_t> &leaves = subtreeLeaves[subtreeIndex];
+            leaves.SetCount(0, false);
+
+            auto appendLeaf = [&leaves](int32_t proxyId) -> bool {
+                leaves.Append(proxyId);
+                return true;
+            };
+            QueryBatch(subtrees[subtreeIndex], planes, appendLeaf);
+        }
+    });
+
+    return numSubtrees;
+}
+
 BE_NAMESPACE_END
@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Platform/Intrinsics.h"
 #include "Core/Heap.h"
+#include "File/FileSystem.h"
+#include "SmallAllocator.h"
 
 #ifdef __APPLE__
 #include "malloc/malloc.h"
@@ -23,26 +26,313 @@ BE_NAMESPACE_BEGIN
 
 //#define SJPARK
 
+#ifndef BE_DEFAULT_MEM_ALLOCATOR
+#define BE_DEFAULT_MEM_ALLOCATOR    MemAllocator::SmallObject
+#endif
+
+static MemAllocator::Enum   memAllocator = BE_DEFAULT_MEM_ALLOCATOR;
+
+static const char *memTagNames[MemTag::Count] = {
+    "General",
+    "Render",
+    "Anim",
+    "Physics",
+    "Script",
+    "Asset",
+    "Sound",
+    "Containers",
+    "Str"
+};
+
+#if BE_MEMORY_TRACKING
+
+#define MEM_HEADER_MAGIC    0x4d454d42
+
+// Prepended to every block allocated by Mem_*. 16 bytes to keep the alignment of malloc.
+struct MemHeader {
+    uint64_t                size;
+    uint32_t                tag;
+    uint32_t                magic;
+};
+
+// Each tag has its own cache line to avoid false sharing between threads.
+struct MemTagCounters {
+    volatile atomic_t       liveBytes;
+    volatile atomic_t       peakBytes;
+    volatile atomic_t       liveAllocs;
+    volatile atomic_t       totalAllocs;
+    volatile atomic_t       frameAllocs;
+    volatile atomic_t       frameFrees;
+    int                     lastFrameAllocs;
+    int                     lastFrameFrees;
+    char                    pad[64 - 6 * sizeof(atomic_t) - 2 * sizeof(int)];
+};
+
+static MemTagCounters       memTagCounters[MemTag::Count];
+static BE_THREAD_LOCAL int  memCurrentTag = MemTag::General;
+
+static BE_FORCE_INLINE void *TagBlock(void *block, size_t size) {
+    MemHeader *header = (MemHeader *)block;
+    header->size = size;
+    header->tag = memCurrentTag;
+    header->magic = MEM_HEADER_MAGIC;
+    Mem_TrackAlloc((MemTag::Enum)header->tag, size);
+    return header + 1;
+}
+
+static BE_FORCE_INLINE void *UntagBlock(void *ptr) {
+    MemHeader *header = (MemHeader *)ptr - 1;
+    assert(header->magic == MEM_HEADER_MAGIC);
+    Mem_TrackFree((MemTag::Enum)header->tag, (size_t)header->size);
+    return header;
+}
+
+#define MEM_HEADER_SIZE     sizeof(MemHeader)
+
+#else
+
+#define TagBlock(block, size)   (block)
+#define UntagBlock(ptr)         (ptr)
+#define MEM_HEADER_SIZE         0
+
+#endif // BE_MEMORY_TRACKING
+
+MemTag::Enum Mem_SetTag(MemTag::Enum tag) {
+#if BE_MEMORY_TRACKING
+    MemTag::Enum prevTag = (MemTag::Enum)memCurrentTag;
+    memCurrentTag = tag;
+    return prevTag;
+#else
+    return MemTag::General;
+#endif
+}
+
+MemTag::Enum Mem_GetTag() {
+#if BE_MEMORY_TRACKING
+    return (MemTag::Enum)memCurrentTag;
+#else
+    return MemTag::General;
+#endif
+}
+
+void Mem_TrackAlloc(MemTag::Enum tag, size_t size) {
+#if BE_MEMORY_TRACKING
+    MemTagCounters &counters = memTagCounters[tag];
+
+    const atomic_t liveBytes = atomic_add(&counters.liveBytes, (atomic_t)size) + (atomic_t)size;
+    atomic_t peakBytes = counters.peakBytes;
+    while (liveBytes > peakBytes) {
+        const atomic_t prevPeakBytes = atomic_cmpxchg(&counters.peakBytes, liveBytes, peakBytes);
+        if (prevPeakBytes == peakBytes) {
+            break;
+        }
+        peakBytes = prevPeakBytes;
+    }
+
+    atomic_add(&counters.liveAllocs, 1);
+    atomic_add(&counters.totalAllocs, 1);
+    atomic_add(&counters.frameAllocs, 1);
+#endif
+}
+
+void Mem_TrackFree(MemTag::Enum tag, size_t size) {
+#if BE_MEMORY_TRACKING
+    MemTagCounters &counters = memTagCounters[tag];
+
+    atomic_add(&counters.liveBytes, -(atomic_t)size);
+    atomic_add(&counters.liveAllocs, -1);
+    atomic_add(&counters.frameFrees, 1);
+#endif
+}
+
+void Mem_SyncFrame() {
+#if BE_MEMORY_TRACKING
+    for (int i = 0; i < MemTag::Count; i++) {
+        MemTagCounters &counters = memTagCounters[i];
+
+        // Subtract what we read instead of resetting to zero, not to lose the counts from the other threads
+        const atomic_t frameAllocs = atomic_add(&counters.frameAllocs, 0);
+        atomic_add(&counters.frameAllocs, -frameAllocs);
+        const atomic_t frameFrees = atomic_add(&counters.frameFrees, 0);
+        atomic_add(&counters.frameFrees, -frameFrees);
+
+        counters.lastFrameAllocs = (int)frameAllocs;
+        counters.lastFrameFrees = (int)frameFrees;
+    }
+#endif
+}
+
+void Mem_GetTagStats(MemTagStats *stats) {
+    for (int i = 0; i < MemTag::Count; i++) {
+        stats[i].name = memTagNames[i];
+#if BE_MEMORY_TRACKING
+        const MemTagCounters &counters = memTagCounters[i];
+        stats[i].liveBytes = counters.liveBytes;
+        stats[i].peakBytes = counters.peakBytes;
+        stats[i].liveAllocs = counters.liveAllocs;
+        stats[i].totalAllocs = counters.totalAllocs;
+        stats[i].frameAllocs = counters.lastFrameAllocs;
+        stats[i].frameFrees = counters.lastFrameFrees;
+#else
+        stats[i].liveBytes = 0;
+        stats[i].peakBytes = 0;
+        stats[i].liveAllocs = 0;
+        stats[i].totalAllocs = 0;
+        stats[i].frameAllocs = 0;
+        stats[i].frameFrees = 0;
+#endif
+    }
+}
+
+void Mem_PrintStats() {
+#if BE_MEMORY_TRACKING
+    MemTagStats stats[MemTag::Count];
+    Mem_GetTagStats(stats);
+
+    MemTagStats total;
+    memset(&total, 0, sizeof(total));
+
+    BE_LOG(L"tag          live(KB)    peak(KB)    allocs    frame allocs/frees\n");
+    BE_LOG(L"------------ ----------- ----------- --------- ------------------\n");
+
+    for (int i = 0; i < MemTag::Count; i++) {
+        const MemTagStats &s = stats[i];
+        BE_LOG(L"%-12hs %11.1f %11.1f %9i %8i/%-8i\n", s.name,
+            s.liveBytes / 1024.0, s.peakBytes / 1024.0, (int)s.liveAllocs, s.frameAllocs, s.frameFrees);
+
+        total.liveBytes += s.liveBytes;
+        total.peakBytes += s.peakBytes;
+        total.liveAllocs += s.liveAllocs;
+        total.frameAllocs += s.frameAllocs;
+        total.frameFrees += s.frameFrees;
+    }
+
+    BE_LOG(L"------------ ----------- ----------- --------- ------------------\n");
+    // Sum of the peaks is an upper bound, each tag reaches its peak at a different time
+    BE_LOG(L"%-12hs %11.1f %11.1f %9i %8i/%-8i\n", "Total",
+        total.liveBytes / 1024.0, total.peakBytes / 1024.0, (int)total.liveAllocs, total.frameAllocs, total.frameFrees);
+
+    MemAllocatorStats allocatorStats;
+    Mem_GetAllocatorStats(&allocatorStats);
+    BE_LOG(L"small object allocator: %i segments, %i pages, %.1f KB reserved\n",
+        allocatorStats.numSegments, allocatorStats.numPages, allocatorStats.reservedBytes / 1024.0);
+#else
+    BE_LOG(L"memory tracking is disabled (BE_MEMORY_TRACKING)\n");
+#endif
+}
+
+void Mem_SetAllocator(MemAllocator::Enum allocator) {
+    memAllocator = allocator;
+}
+
+MemAllocator::Enum Mem_GetAllocator() {
+    return memAllocator;
+}
+
+void Mem_ThreadExit() {
+    SmallAllocator::FlushThreadCache();
+}
+
+void Mem_GetAllocatorStats(MemAllocatorStats *stats) {
+    stats->numSegments = SmallAllocator::NumSegments();
+    stats->numPages = SmallAllocator::NumPages();
+    stats->reservedBytes = (int64_t)SmallAllocator::ReservedBytes();
+}
+
+bool Mem_WriteStats(const char *filename) {
+    MemTagStats stats[MemTag::Count];
+    Mem_GetTagStats(stats);
+
+    File *fp = fileSystem.OpenFile(filename, File::WriteMode);
+    if (!fp) {
+        BE_WARNLOG(L"Mem_WriteStats: couldn't write %hs\n", filename);
+        return false;
+    }
+
+    fp->Printf("tag,liveBytes,peakBytes,liveAllocs,totalAllocs,frameAllocs,frameFrees\n");
+    for (int i = 0; i < MemTag::Count; i++) {
+        const MemTagStats &s = stats[i];
+        fp->Printf("%s,%lld,%lld,%lld,%lld,%i,%i\n", s.name,
+            (long long)s.liveBytes, (long long)s.peakBytes, (long long)s.liveAllocs, (long long)s.totalAllocs, s.frameAllocs, s.frameFrees);
+    }
+
+    fileSystem.CloseFile(fp);
+    return true;
+}
+
 #ifndef DEBUG_MEMORY
 
+// Blocks of the small object allocator don't have MemHeader, the tag is stored in the page
+static BE_FORCE_INLINE void *SmallAlloc(size_t size, size_t alignment) {
+    if (memAllocator != MemAllocator::SmallObject || size > SmallAllocator::MaxSize) {
+        return nullptr;
+    }
+#if BE_MEMORY_TRACKING
+    void *ptr = SmallAllocator::Alloc(size, alignment, memCurrentTag);
+    if (ptr) {
+        size_t blockSize;
+        int tag;
+        SmallAllocator::GetBlockInfo(ptr, &blockSize, &tag);
+        Mem_TrackAlloc((MemTag::Enum)tag, blockSize);
+    }
+    return ptr;
+#else
+    return SmallAllocator::Alloc(size, alignment, MemTag::General);
+#endif
+}
+
+static void SmallFree(void *ptr) {
+#if BE_MEMORY_TRACKING || defined(SJPARK)
+    size_t blockSize;
+    int tag;
+    SmallAllocator::GetBlockInfo(ptr, &blockSize, &tag);
+#endif
+#if BE_MEMORY_TRACKING
+    Mem_TrackFree((MemTag::Enum)tag, blockSize);
+#endif
+#ifdef SJPARK
+    memset(ptr, 0xfd, blockSize);
+#endif
+    SmallAllocator::Free(ptr);
+}
+
+static void *SystemAlloc(size_t size) {
+    void *block = malloc(size + MEM_HEADER_SIZE);
+    if (!block) {
+        return nullptr;
+    }
+    return TagBlock(block, size);
+}
+
 void *Mem_Alloc(size_t size) {
+    void *ptr = SmallAlloc(size, 16);
+    if (!ptr) {
+        ptr = SystemAlloc(size);
+        if (!ptr) {
+            return nullptr;
+        }
+    }
 #ifdef SJPARK
-    void *ptr =  malloc(size);
     memset(ptr, 0xfc, size);
-    return ptr;
-#else
-    return malloc(size);
 #endif
+    return ptr;
 }
 
 void *Mem_ClearedAlloc(size_t size) {
-    void *r = malloc(size);
-    memset(r, 0, size);
+    void *r = Mem_Alloc(size);
+    if (r) {
+        memset(r, 0, size);
+    }
     return r;
 }
 
 void *Mem_Alloc16(size_t size) {
-    byte *ptr = (byte *)Mem_Alloc(size + sizeof(intptr_t) + 15);
+    void *smallPtr = SmallAlloc(size, 16);
+    if (smallPtr) {
+        return smallPtr;
+    }
+    // Not from Mem_Alloc, the small object allocator must not own the unaligned block
+    byte *ptr = (byte *)SystemAlloc(size + sizeof(intptr_t) + 15);
     if (!ptr) {
         return nullptr;
     }
@@ -52,7 +342,11 @@ void *Mem_Alloc16(size_t size) {
 }
 
 void *Mem_Alloc32(size_t size) {
-    byte *ptr = (byte *)Mem_Alloc(size + sizeof(intptr_t) + 31);
+    void *smallPtr = SmallAlloc(size, 32);
+    if (smallPtr) {
+        return smallPtr;
+    }
+    byte *ptr = (byte *)SystemAlloc(size + sizeof(intptr_t) + 31);
     if (!ptr) {
         return nullptr;
     }
@@ -81,21 +375,30 @@ wchar_t *Mem_AllocWideString(const wchar_t *str) {
 
 void Mem_Free(void *ptr) {
     if (ptr) {
+        if (SmallAllocator::Owns(ptr)) {
+            SmallFree(ptr);
+            return;
+        }
+        void *block = UntagBlock(ptr);
 #ifdef SJPARK
     #ifdef __WIN32__
-        int size = _msize(ptr);
-        memset(ptr, 0xfd, size);
+        int size = _msize(block);
+        memset(block, 0xfd, size);
     #elif defined __APPLE__
-        int size = malloc_size(ptr);
-        memset(ptr, 0xfd, size);
+        int size = malloc_size(block);
+        memset(block, 0xfd, size);
     #endif
 #endif
-        free(ptr);
+        free(block);
     }
 }
 
 void Mem_AlignedFree(void *ptr) {
     if (ptr) {
+        if (SmallAllocator::Owns(ptr)) {
+            SmallFree(ptr);
+            return;
+        }
         Mem_Free((void *)*((intptr_t *)(((byte *)ptr) - sizeof(intptr_t))));
     }
 }
@@ -104,19 +407,21 @@ void Mem_AlignedFree(void *ptr) {
 
 void *DebugMem_Alloc(size_t size, const char *filename, const int lineNumber) {
 #ifdef __WIN32__
-    return _malloc_dbg(size, _NORMAL_BLOCK, filename, lineNumber);
+    void *block = _malloc_dbg(size + MEM_HEADER_SIZE, _NORMAL_BLOCK, filename, lineNumber);
 #else
-    return malloc(size);
+    void *block = malloc(size + MEM_HEADER_SIZE);
 #endif
+    if (!block) {
+        return nullptr;
+    }
+    return TagBlock(block, size);
 }
 
 void *DebugMem_ClearedAlloc(size_t size, const char *filename, const int lineNumber) {
-#ifdef __WIN32__
-    void *r = _malloc_dbg(size, _NORMAL_BLOCK, filename, lineNumber);
-#else
-    void *r = malloc(size);
-#endif
-    memset(r, 0, size);
+    void *r = DebugMem_Alloc(size, filename, lineNumber);
+    if (r) {
+        memset(r, 0, size);
+    }
     return r;
 }
 
@@ -159,10 +464,14 @@ wchar_t *DebugMem_AllocWideString(const wchar_t *str, const char *filename, cons
 }
 
 void DebugMem_Free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    void *block = UntagBlock(ptr);
 #ifdef __WIN32__
-    _free_dbg(ptr, _NORMAL_BLOCK);
+    _free_dbg(block, _NORMAL_BLOCK);
 #else
-    free(ptr);
+    free(block);
 #endif
 }
 
@@ -0,0 +1,378 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Platform/PlatformProcess.h"
+#include "Platform/PlatformThread.h"
+#include "Core/Heap.h"
+#include "Core/JobSystem.h"
+
+BE_NAMESPACE_BEGIN
+
+// Lock-free work stealing deque (Chase-Lev) with a fixed capacity.
+// Push/Pop are called only by the owner worker, Steal can be called by any thread.
+// All shared accesses go through atomic read-modify-write operations which act as full memory barriers.
+class JobQueue {
+public:
+    enum { Mask = JobSystem::MaxJobsPerWorker - 1 };
+
+    void                    Clear() { top = 0; bottom = 0; }
+
+    bool                    Push(Job *job);
+    Job *                   Pop();
+    Job *                   Steal();
+
+    bool                    IsEmpty() const { return bottom <= top; }
+
+private:
+    volatile atomic_t       top;
+    char                    pad0[64 - sizeof(atomic_t)];
+    volatile atomic_t       bottom;
+    char                    pad1[64 - sizeof(atomic_t)];
+    Job *                   jobs[JobSystem::MaxJobsPerWorker];
+};
+
+bool JobQueue::Push(Job *job) {
+    atomic_t b = bottom;
+    if (b - atomic_add(&top, 0) >= JobSystem::MaxJobsPerWorker) {
+        return false;
+    }
+
+    jobs[b & Mask] = job;
+    // Publish the job to the stealers
+    atomic_add(&bottom, 1);
+    return true;
+}
+
+Job *JobQueue::Pop() {
+    atomic_t b = atomic_add(&bottom, -1) - 1;
+    atomic_t t = atomic_add(&top, 0);
+
+    if (t > b) {
+        // Queue was already empty
+        bottom = t;
+        return nullptr;
+    }
+
+    Job *job = jobs[b & Mask];
+    if (t != b) {
+        // There are still jobs left in the queue
+        return job;
+    }
+
+    // This is the last job in the queue. Race against the stealers
+    if (atomic_cmpxchg(&top, t + 1, t) != t) {
+        job = nullptr;
+    }
+    bottom = t + 1;
+    return job;
+}
+
+Job *JobQueue::Steal() {
+    atomic_t t = atomic_add(&top, 0);
+    atomic_t b = atomic_add(&bottom, 0);
+
+    if (t >= b) {
+        return nullptr;
+    }
+
+    Job *job = jobs[t & Mask];
+    // Another thread may have stolen or popped the same job concurrently
+    if (atomic_cmpxchg(&top, t + 1, t) != t) {
+        return nullptr;
+    }
+    return job;
+}
+
+struct JobWorker {
+    JobQueue                queue;
+    Job *                   jobPool;
+    uint32_t                allocatedJobs;      // next slot to probe in jobPool
+    uint32_t                stealIndex;
+    PlatformThread *        thread;
+};
+
+int                         JobSystem::numWorkers = 0;
+
+static JobWorker *          workers;
+static Job *                externalJobPool;                // for threads not owned by the job system
+static volatile atomic_t    externalAllocatedJobs;
+static volatile atomic_t    numSleepingWorkers;
+static volatile bool        terminate;
+static PlatformMutex *      sleepMutex;
+static PlatformCondition *  sleepCondition;
+
+static BE_THREAD_LOCAL int  threadWorkerIndex = -1;
+
+void JobWorker_ThreadProc(void *param);
+
+void JobSystem::Init(int numWorkers) {
+    if (numWorkers < 0) {
+        numWorkers = PlatformProcess::NumberOfLogicalProcessors();
+    }
+    Clamp(numWorkers, 1, (int)MaxWorkers);
+
+    JobSystem::numWorkers = numWorkers;
+
+    terminate = false;
+    numSleepingWorkers = 0;
+    externalAllocatedJobs = 0;
+
+    sleepMutex = PlatformMutex::Create();
+    sleepCondition = PlatformCondition::Create();
+
+    workers = (JobWorker *)Mem_Alloc32(numWorkers * sizeof(workers[0]));
+    for (int i = 0; i < numWorkers; i++) {
+        JobWorker *worker = &workers[i];
+        worker->queue.Clear();
+        worker->jobPool = (Job *)Mem_Alloc32(MaxJobsPerWorker * sizeof(Job));
+        // Every slot starts out as a finished job
+        memset(worker->jobPool, 0, MaxJobsPerWorker * sizeof(Job));
+        worker->allocatedJobs = 0;
+        worker->stealIndex = i + 1;
+        worker->thread = nullptr;
+    }
+
+    externalJobPool = (Job *)Mem_Alloc32(MaxJobsPerWorker * sizeof(Job));
+    memset(externalJobPool, 0, MaxJobsPerWorker * sizeof(Job));
+
+    // The calling thread is the worker 0
+    threadWorkerIndex = 0;
+
+    for (int i = 1; i < numWorkers; i++) {
+        workers[i].thread = PlatformThread::Create(JobWorker_ThreadProc, (void *)(intptr_t)i, 0);
+    }
+
+    BE_LOG(L"JobSystem initialized with %i workers\n", numWorkers);
+}
+
+void JobSystem::Shutdown() {
+    if (!workers) {
+        return;
+    }
+
+    // Set the terminate flag and wake up all the sleeping workers
+    PlatformMutex::Lock(sleepMutex);
+    terminate = true;
+    PlatformCondition::Broadcast(sleepCondition);
+    PlatformMutex::Unlock(sleepMutex);
+
+    // Wait for all the worker threads to exit
+    for (int i = 1; i < numWorkers; i++) {
+        PlatformThread::Wait(workers[i].thread);
+    }
+
+    for (int i = 0; i < numWorkers; i++) {
+        Mem_AlignedFree(workers[i].jobPool);
+    }
+    Mem_AlignedFree(workers);
+    workers = nullptr;
+
+    Mem_AlignedFree(externalJobPool);
+    externalJobPool = nullptr;
+
+    PlatformCondition::Delete(sleepCondition);
+    PlatformMutex::Delete(sleepMutex);
+
+    threadWorkerIndex = -1;
+    numWorkers = 0;
+}
+
+int JobSystem::WorkerIndex() {
+    return threadWorkerIndex;
+}
+
+// Returns a job slot whose previous job has finished, or nullptr if all the slots are still in flight.
+// The returned job is already marked as unfinished.
+static Job *AllocJob() {
+    if (threadWorkerIndex >= 0) {
+        // Only the owner worker allocates from its own pool
+        JobWorker *worker = &workers[threadWorkerIndex];
+        for (int i = 0; i < JobSystem::MaxJobsPerWorker; i++) {
+            Job *job = &worker->jobPool[worker->allocatedJobs++ & (JobSystem::MaxJobsPerWorker - 1)];
+            if (atomic_add(&job->unfinishedJobs, 0) == 0) {
+                job->unfinishedJobs = 1;
+                return job;
+            }
+        }
+    } else {
+        // The external pool is shared by all the foreign threads, so claim the slot atomically
+        for (int i = 0; i < JobSystem::MaxJobsPerWorker; i++) {
+            atomic_t index = atomic_add(&externalAllocatedJobs, 1);
+            Job *job = &externalJobPool[index & (JobSystem::MaxJobsPerWorker - 1)];
+            if (atomic_cmpxchg(&job->unfinishedJobs, 1, 0) == 0) {
+                return job;
+            }
+        }
+    }
+    return nullptr;
+}
+
+Job *JobSystem::TryCreateJob(Job *parent, jobFunction_t function, const void *data, size_t dataSize) {
+    assert(dataSize <= Job::MaxDataSize);
+
+    Job *job = AllocJob();
+    if (!job) {
+        return nullptr;
+    }
+
+    if (parent) {
+        atomic_add(&parent->unfinishedJobs, 1);
+    }
+
+    job->function = function;
+    job->parent = parent;
+    if (dataSize > 0) {
+        memcpy(job->data, data, dataSize);
+    }
+    return job;
+}
+
+Job *JobSystem::CreateJob(jobFunction_t function, const void *data, size_t dataSize) {
+    Job *job = TryCreateJob(nullptr, function, data, dataSize);
+    if (!job) {
+        BE_FATALERROR(L"JobSystem::CreateJob: job ring is full");
+    }
+    return job;
+}
+
+Job *JobSystem::CreateChildJob(Job *parent, jobFunction_t function, const void *data, size_t dataSize) {
+    Job *job = TryCreateJob(parent, function, data, dataSize);
+    if (!job) {
+        BE_FATALERROR(L"JobSystem::CreateChildJob: job ring is full");
+    }
+    return job;
+}
+
+void JobSystem::Finish(Job *job) {
+    // The slot can be reused as soon as the counter drops to zero, so read the parent first
+    Job *parent = job->parent;
+    const atomic_t unfinishedJobs = atomic_add(&job->unfinishedJobs, -1) - 1;
+    if (unfinishedJobs == 0 && parent) {
+        Finish(parent);
+    }
+}
+
+void JobSystem::Execute(Job *job) {
+    if (job->function) {
+        job->function(job, job->data);
+    }
+    Finish(job);
+}
+
+static Job *GetJob(JobWorker *worker) {
+    Job *job = worker->queue.Pop();
+    if (job) {
+        return job;
+    }
+
+    // Own queue is empty, try to steal from the other workers
+    const int numWorkers = JobSystem::NumWorkers();
+    for (int i = 0; i < numWorkers - 1; i++) {
+        JobWorker *victim = &workers[worker->stealIndex++ % numWorkers];
+        if (victim == worker) {
+            continue;
+        }
+        job = victim->queue.Steal();
+        if (job) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+static bool HasAnyJob() {
+    for (int i = 0; i < JobSystem::NumWorkers(); i++) {
+        if (!workers[i].queue.IsEmpty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::Run(Job *job) {
+    if (threadWorkerIndex < 0 || !workers[threadWorkerIndex].queue.Push(job)) {
+        // Not a worker thread or the queue is full, just execute it here
+        Execute(job);
+        return;
+    }
+
+    // Push() is a full barrier, so a worker going to sleep after this point will see the job
+    if (atomic_add(&numSleepingWorkers, 0) > 0) {
+        PlatformMutex::Lock(sleepMutex);
+        PlatformCondition::Signal(sleepCondition);
+        PlatformMutex::Unlock(sleepMutex);
+    }
+}
+
+void JobSystem::Wait(const Job *job) {
+    if (threadWorkerIndex < 0) {
+        while (!IsFinished(job)) {
+            PlatformProcess::Sleep(0);
+        }
+        return;
+    }
+
+    JobWorker *worker = &workers[threadWorkerIndex];
+
+    // Help executing other jobs while waiting
+    while (!IsFinished(job)) {
+        Job *nextJob = GetJob(worker);
+        if (nextJob) {
+            Execute(nextJob);
+        } else {
+            PlatformProcess::Sleep(0);
+        }
+    }
+}
+
+void JobWorker_ThreadProc(void *param) {
+    const int workerIndex = (int)(intptr_t)param;
+    threadWorkerIndex = workerIndex;
+
+    JobWorker *worker = &workers[workerIndex];
+
+    const int maxSpinCount = 64;
+    int spinCount = 0;
+
+    while (!terminate) {
+        Job *job = GetJob(worker);
+        if (job) {
+            JobSystem::Execute(job);
+            spinCount = 0;
+            continue;
+        }
+
+        if (++spinCount < maxSpinCount) {
+            PlatformProcess::Sleep(0);
+            continue;
+        }
+        spinCount = 0;
+
+        // Nothing to do for a while, go to sleep until a new job is pushed
+        PlatformMutex::Lock(sleepMutex);
+        atomic_add(&numSleepingWorkers, 1);
+        if (!terminate && !HasAnyJob()) {
+            PlatformCondition::Wait(sleepCondition, sleepMutex);
+        }
+        atomic_add(&numSleepingWorkers, -1);
+        PlatformMutex::Unlock(sleepMutex);
+    }
+
+    threadWorkerIndex = -1;
+
+    Mem_ThreadExit();
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,438 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Platform/PlatformTime.h"
+#include "Platform/PlatformProcess.h"
+#include "Core/Heap.h"
+#include "Core/Cmds.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
+#include "File/FileSystem.h"
+
+BE_NAMESPACE_BEGIN
+
+#define MAX_TRACE_FRAMES    1024
+
+struct ProfileEvent {
+    uint64_t                startCycles;
+    uint64_t                endCycles;
+    int32_t                 frameIndex;
+    uint16_t                markerIndex;
+    uint16_t                depth;
+};
+
+struct ProfileThread {
+    char                    name[32];
+    int                     depth;
+    int                     stackMarkers[Profiler::MaxDepth];
+    uint64_t                stackCycles[Profiler::MaxDepth];
+    uint32_t                syncIndex;                      // events before this index are gathered in the frame history
+    volatile atomic_t       writeIndex;                     // number of events written, wraps around the ring buffer
+    ProfileEvent            events[Profiler::MaxEventsPerThread];
+};
+
+struct ProfileMarker {
+    const char *            name;
+    uint64_t                frameCycles;                    // accumulated in the current frame
+    int                     frameCalls;
+    int                     lastCalls;
+    float                   frameMsec[Profiler::MaxFrameHistory];
+};
+
+volatile bool               Profiler::enabled = false;
+int                         Profiler::frameIndex = 0;
+
+// Markers are never unregistered since the marker indexes are cached in static variables
+static ProfileMarker        markers[Profiler::MaxMarkers];
+static int                  numMarkers = 0;
+
+static ProfileThread *      threads[Profiler::MaxThreads];
+static volatile atomic_t    numThreads = 0;
+static int                  generation = 0;
+
+static volatile atomic_t    lock = 0;
+
+static uint64_t             frameStartCycles[MAX_TRACE_FRAMES];
+static float                frameMsec[Profiler::MaxFrameHistory];
+static int                  numHistoryFrames = 0;
+
+static BE_THREAD_LOCAL ProfileThread *threadData = nullptr;
+static BE_THREAD_LOCAL int  threadGeneration = -1;
+
+static void Lock() {
+    while (atomic_cmpxchg(&lock, 1, 0) != 0) {
+        PlatformProcess::Sleep(0);
+    }
+}
+
+static void Unlock() {
+    atomic_cmpxchg(&lock, 0, 1);
+}
+
+void Profiler::Init() {
+    generation++;
+
+    numThreads = 0;
+    frameIndex = 0;
+    numHistoryFrames = 0;
+    frameStartCycles[0] = PlatformTime::Cycles();
+
+    cmdSystem.AddCommand(L"profileStart", Cmd_ProfileStart, L"starts recording the profiler scopes");
+    cmdSystem.AddCommand(L"profileStop", Cmd_ProfileStop, L"stops recording the profiler scopes");
+    cmdSystem.AddCommand(L"profileDump", Cmd_ProfileDump, L"writes the recorded profiler scopes in Chrome trace format");
+}
+
+void Profiler::Shutdown() {
+    cmdSystem.RemoveCommand(L"profileStart");
+    cmdSystem.RemoveCommand(L"profileStop");
+    cmdSystem.RemoveCommand(L"profileDump");
+
+    enabled = false;
+
+    Lock();
+    for (int i = 0; i < numThreads; i++) {
+        Mem_AlignedFree(threads[i]);
+        threads[i] = nullptr;
+    }
+    numThreads = 0;
+    // Invalidates the thread local pointers of all threads
+    generation++;
+    Unlock();
+}
+
+void Profiler::SetEnabled(bool enable) {
+    if (enable && !enabled) {
+        // Recording restarts from the empty ring buffers and scope stacks.
+        // Scopes which are still open are dropped when they are closed, since PopScope ignores an empty stack.
+        for (int i = 0; i < numThreads; i++) {
+            threads[i]->depth = 0;
+            threads[i]->syncIndex = 0;
+            threads[i]->writeIndex = 0;
+        }
+
+        for (int i = 0; i < numMarkers; i++) {
+            markers[i].frameCycles = 0;
+            markers[i].frameCalls = 0;
+            markers[i].lastCalls = 0;
+            memset(markers[i].frameMsec, 0, sizeof(markers[i].frameMsec));
+        }
+
+        numHistoryFrames = 0;
+        frameStartCycles[frameIndex & (MAX_TRACE_FRAMES - 1)] = PlatformTime::Cycles();
+    }
+
+    enabled = enable;
+}
+
+int Profiler::RegisterMarker(const char *name) {
+    Lock();
+
+    for (int i = 0; i < numMarkers; i++) {
+        if (!strcmp(markers[i].name, name)) {
+            Unlock();
+            return i;
+        }
+    }
+
+    // All the markers after the limit are merged into the last one
+    if (numMarkers == MaxMarkers - 1) {
+        markers[numMarkers].name = "Others";
+        Unlock();
+        return numMarkers;
+    }
+
+    ProfileMarker &marker = markers[numMarkers];
+    marker.name = name;
+    marker.frameCycles = 0;
+    marker.frameCalls = 0;
+    marker.lastCalls = 0;
+    memset(marker.frameMsec, 0, sizeof(marker.frameMsec));
+
+    int markerIndex = numMarkers++;
+
+    Unlock();
+    return markerIndex;
+}
+
+static ProfileThread *GetThread() {
+    if (threadGeneration == generation) {
+        return threadData;
+    }
+
+    Lock();
+
+    ProfileThread *thread = nullptr;
+    if (numThreads < Profiler::MaxThreads) {
+        thread = (ProfileThread *)Mem_Alloc16(sizeof(ProfileThread));
+        thread->depth = 0;
+        thread->syncIndex = 0;
+        thread->writeIndex = 0;
+
+        int workerIndex = JobSystem::WorkerIndex();
+        if (workerIndex == 0) {
+            Str::snPrintf(thread->name, sizeof(thread->name), "Main Thread");
+        } else if (workerIndex > 0) {
+            Str::snPrintf(thread->name, sizeof(thread->name), "Worker %i", workerIndex);
+        } else {
+            Str::snPrintf(thread->name, sizeof(thread->name), "Thread %i", (int)numThreads);
+        }
+
+        threads[numThreads++] = thread;
+    }
+
+    threadData = thread;
+    threadGeneration = generation;
+
+    Unlock();
+    return thread;
+}
+
+void Profiler::SetThreadName(const char *name) {
+    ProfileThread *thread = GetThread();
+    if (thread) {
+        Str::snPrintf(thread->name, sizeof(thread->name), "%s", name);
+    }
+}
+
+void Profiler::PushScope(int markerIndex) {
+    ProfileThread *thread = GetThread();
+    if (!thread) {
+        return;
+    }
+
+    if (thread->depth < MaxDepth) {
+        thread->stackMarkers[thread->depth] = markerIndex;
+        thread->stackCycles[thread->depth] = PlatformTime::Cycles();
+    }
+    thread->depth++;
+}
+
+void Profiler::PopScope() {
+    ProfileThread *thread = GetThread();
+    if (!thread || thread->depth <= 0) {
+        return;
+    }
+
+    thread->depth--;
+    if (thread->depth >= MaxDepth) {
+        return;
+    }
+
+    uint64_t endCycles = PlatformTime::Cycles();
+
+    ProfileEvent &event = thread->events[thread->writeIndex & (MaxEventsPerThread - 1)];
+    event.startCycles = thread->stackCycles[thread->depth];
+    event.endCycles = endCycles;
+    event.frameIndex = frameIndex;
+    event.markerIndex = (uint16_t)thread->stackMarkers[thread->depth];
+    event.depth = (uint16_t)thread->depth;
+
+    // Publish the event to SyncFrame/DumpChromeTrace on the main thread
+    atomic_add(&thread->writeIndex, 1);
+}
+
+void Profiler::SyncFrame() {
+    uint64_t cycles = PlatformTime::Cycles();
+
+    if (!enabled) {
+        return;
+    }
+
+    const double msecPerCycle = PlatformTime::SecondsPerCycles() * 1000.0;
+
+    // Gathers the events closed in this frame.
+    // Scopes closed on the other threads are counted in the frame when they are gathered
+    for (int threadIndex = 0; threadIndex < numThreads; threadIndex++) {
+        ProfileThread *thread = threads[threadIndex];
+
+        uint32_t writeIndex = (uint32_t)atomic_add(&thread->writeIndex, 0);
+        uint32_t readIndex = thread->syncIndex;
+        if (writeIndex - readIndex > MaxEventsPerThread) {
+            readIndex = writeIndex - MaxEventsPerThread;
+        }
+
+        for (; readIndex != writeIndex; readIndex++) {
+            const ProfileEvent &event = thread->events[readIndex & (MaxEventsPerThread - 1)];
+            ProfileMarker &marker = markers[event.markerIndex];
+            marker.frameCycles += event.endCycles - event.startCycles;
+            marker.frameCalls++;
+        }
+
+        thread->syncIndex = writeIndex;
+    }
+
+    const int historyIndex = frameIndex & (MaxFrameHistory - 1);
+
+    for (int i = 0; i < numMarkers; i++) {
+        ProfileMarker &marker = markers[i];
+        marker.frameMsec[historyIndex] = (float)(marker.frameCycles * msecPerCycle);
+        marker.lastCalls = marker.frameCalls;
+        marker.frameCycles = 0;
+        marker.frameCalls = 0;
+    }
+
+    frameMsec[historyIndex] = (float)((cycles - frameStartCycles[frameIndex & (MAX_TRACE_FRAMES - 1)]) * msecPerCycle);
+    numHistoryFrames = Min(numHistoryFrames + 1, (int)MaxFrameHistory);
+
+    frameIndex++;
+    frameStartCycles[frameIndex & (MAX_TRACE_FRAMES - 1)] = cycles;
+}
+
+int Profiler::GetMarkerStats(MarkerStats *stats, int maxStats) {
+    if (numHistoryFrames == 0) {
+        return 0;
+    }
+
+    const int lastHistoryIndex = (frameIndex - 1) & (MaxFrameHistory - 1);
+
+    Array<MarkerStats> statsArray;
+    statsArray.SetGranularity(64);
+
+    for (int i = 0; i < numMarkers; i++) {
+        const ProfileMarker &marker = markers[i];
+
+        float sum = 0.0f;
+        float peak = 0.0f;
+        for (int j = 0; j < numHistoryFrames; j++) {
+            sum += marker.frameMsec[j];
+            peak = Max(peak, marker.frameMsec[j]);
+        }
+
+        if (peak <= 0.0f) {
+            continue;
+        }
+
+        MarkerStats &markerStats = statsArray.Alloc();
+        markerStats.name = marker.name;
+        markerStats.lastMsec = marker.frameMsec[lastHistoryIndex];
+        markerStats.avgMsec = sum / numHistoryFrames;
+        markerStats.maxMsec = peak;
+        markerStats.lastCalls = marker.lastCalls;
+    }
+
+    statsArray.Sort([](const MarkerStats &a, const MarkerStats &b) {
+        return a.avgMsec > b.avgMsec;
+    });
+
+    int count = Min(statsArray.Count(), maxStats);
+    for (int i = 0; i < count; i++) {
+        stats[i] = statsArray[i];
+    }
+    return count;
+}
+
+void Profiler::GetFrameTimes(float &avgMsec, float &maxMsec) {
+    avgMsec = 0.0f;
+    maxMsec = 0.0f;
+
+    if (numHistoryFrames == 0) {
+        return;
+    }
+
+    for (int i = 0; i < numHistoryFrames; i++) {
+        avgMsec += frameMsec[i];
+        maxMsec = Max(maxMsec, frameMsec[i]);
+    }
+    avgMsec /= numHistoryFrames;
+}
+
+bool Profiler::DumpChromeTrace(const char *filename) {
+    File *fp = fileSystem.OpenFile(filename, File::WriteMode);
+    if (!fp) {
+        BE_WARNLOG(L"Couldn't open %hs for writing\n", filename);
+        return false;
+    }
+
+    const double usecPerCycle = PlatformTime::SecondsPerCycles() * 1000000.0;
+
+    uint32_t beginIndexes[MaxThreads];
+    uint32_t endIndexes[MaxThreads];
+    uint64_t baseCycles = ~(uint64_t)0;
+
+    // Finds the time stamp of the oldest event to start the trace from zero
+    for (int threadIndex = 0; threadIndex < numThreads; threadIndex++) {
+        const ProfileThread *thread = threads[threadIndex];
+
+        endIndexes[threadIndex] = (uint32_t)thread->writeIndex;
+        beginIndexes[threadIndex] = endIndexes[threadIndex] > MaxEventsPerThread ? endIndexes[threadIndex] - MaxEventsPerThread : 0;
+
+        for (uint32_t i = beginIndexes[threadIndex]; i != endIndexes[threadIndex]; i++) {
+            baseCycles = Min(baseCycles, thread->events[i & (MaxEventsPerThread - 1)].startCycles);
+        }
+    }
+
+    fp->Printf("{\"traceEvents\":[\n");
+
+    int numEvents = 0;
+
+    for (int threadIndex = 0; threadIndex < numThreads; threadIndex++) {
+        const ProfileThread *thread = threads[threadIndex];
+
+        fp->Printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}}",
+            threadIndex > 0 ? ",\n" : "", threadIndex, thread->name);
+        fp->Printf(",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"sort_index\":%i}}", threadIndex, threadIndex);
+
+        for (uint32_t i = beginIndexes[threadIndex]; i != endIndexes[threadIndex]; i++) {
+            const ProfileEvent &event = thread->events[i & (MaxEventsPerThread - 1)];
+
+            fp->Printf(",\n{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%i}}",
+                markers[event.markerIndex].name, threadIndex, 
+                (event.startCycles - baseCycles) * usecPerCycle, (event.endCycles - event.startCycles) * usecPerCycle, event.frameIndex);
+            numEvents++;
+        }
+    }
+
+    // Frame boundaries as global instant events
+    if (numEvents > 0) {
+        const int numFrames = Min(frameIndex + 1, MAX_TRACE_FRAMES);
+        for (int i = frameIndex + 1 - numFrames; i <= frameIndex; i++) {
+            uint64_t cycles = frameStartCycles[i & (MAX_TRACE_FRAMES - 1)];
+            if (cycles < baseCycles) {
+                continue;
+            }
+            fp->Printf(",\n{\"name\":\"Frame %i\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f}", i, (cycles - baseCycles) * usecPerCycle);
+        }
+    }
+
+    fp->Printf("\n],\n\"displayTimeUnit\":\"ms\"\n}\n");
+
+    fileSystem.CloseFile(fp);
+
+    BE_LOG(L"Wrote %i profile events to %hs\n", numEvents, filename);
+    return true;
+}
+
+void Profiler::Cmd_ProfileStart(const CmdArgs &args) {
+    SetEnabled(true);
+}
+
+void Profiler::Cmd_ProfileStop(const CmdArgs &args) {
+    SetEnabled(false);
+}
+
+void Profiler::Cmd_ProfileDump(const CmdArgs &args) {
+    Str filename = args.Argc() > 1 ? WStr::ToStr(args.Argv(1)) : Str("Profile/trace.json");
+    filename.DefaultFileExtension(".json");
+
+    // Stops recording while the ring buffers are being read
+    bool wasEnabled = enabled;
+    enabled = false;
+
+    DumpChromeTrace(filename);
+
+    enabled = wasEnabled;
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,377 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Platform/Intrinsics.h"
+#include "Platform/PlatformProcess.h"
+#include "Core/Heap.h"
+#include "SmallAllocator.h"
+
+#ifndef __WIN32__
+#include <sys/mman.h>
+#endif
+
+BE_NAMESPACE_BEGIN
+
+#define SEGMENT_SHIFT           20
+#define SEGMENT_SIZE            (1 << SEGMENT_SHIFT)
+#define SLAB_PAGE_SHIFT         16
+#define SLAB_PAGE_SIZE          (1 << SLAB_PAGE_SHIFT)
+#define PAGES_PER_SEGMENT       (SEGMENT_SIZE / SLAB_PAGE_SIZE)
+#define PAGE_HEADER_SIZE        64
+#define SEGMENT_TABLE_BITS      12
+#define SEGMENT_TABLE_SIZE      (1 << SEGMENT_TABLE_BITS)
+#define MAX_SEGMENTS            (SEGMENT_TABLE_SIZE * 3 / 4)
+
+// Multiples of 16, and multiples of 32 from 128 bytes
+static const uint16_t sizeClasses[SmallAllocator::NumSizeClasses] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256,
+    320, 384, 448, 512,
+    640, 768, 896, 1024,
+    1280, 1536, 1792, 2048
+};
+
+struct PageHeader {
+    uint32_t                sizeClass;
+    uint32_t                tag;
+};
+
+struct FreeBlock {
+    FreeBlock *             next;
+};
+
+struct FreeList {
+    FreeBlock *             head;
+    int                     count;
+};
+
+struct ThreadCache {
+    FreeList                lists[MemTag::Count][SmallAllocator::NumSizeClasses];
+};
+
+struct CentralList {
+    FreeBlock *             head;
+    byte *                  bumpPtr;        // not yet used blocks of the last page
+    byte *                  bumpEnd;
+};
+
+struct CentralClass {
+    volatile atomic_t       lock;
+    CentralList             lists[MemTag::Count];
+};
+
+static CentralClass         centralClasses[SmallAllocator::NumSizeClasses];
+
+static volatile atomic_t    pageLock = 0;
+static byte *               currentSegment = nullptr;
+static int                  nextPageIndex = PAGES_PER_SEGMENT;
+static int                  numSegments = 0;
+static int                  numPages = 0;
+
+// Open addressing hash table of segment base addresses, used to find out whether a pointer belongs to a segment.
+// Entries are only added, so it can be read without locking.
+static volatile atomic_t    segmentTable[SEGMENT_TABLE_SIZE];
+
+static BE_THREAD_LOCAL ThreadCache *threadCache = nullptr;
+
+static void Lock(volatile atomic_t *lock) {
+    while (atomic_cmpxchg(lock, 1, 0) != 0) {
+        PlatformProcess::Sleep(0);
+    }
+}
+
+static void Unlock(volatile atomic_t *lock) {
+    atomic_cmpxchg(lock, 0, 1);
+}
+
+static BE_FORCE_INLINE int SizeClassIndex(size_t size) {
+    if (size <= 128) {
+        return size > 0 ? (int)((size + 15) >> 4) - 1 : 0;
+    }
+    // 4 classes for each power of two
+    const size_t s = size - 1;
+    int b = 7;
+    while (s >> (b + 1)) {
+        b++;
+    }
+    return 8 + (b - 7) * 4 + (int)(s >> (b - 2)) - 4;
+}
+
+// Number of blocks moved between the thread cache and the central list at once
+static BE_FORCE_INLINE int BatchCount(int sizeClass) {
+    return Clamp(8192 / (int)sizeClasses[sizeClass], 4, 64);
+}
+
+static BE_FORCE_INLINE uint32_t HashSegment(uintptr_t key) {
+    return ((uint32_t)key * 2654435761u) >> (32 - SEGMENT_TABLE_BITS);
+}
+
+static byte *AllocSegment() {
+#ifdef __WIN32__
+    // A reservation can't be partially released, so reserve twice the size to find an aligned address,
+    // release it and reserve again exactly at the aligned address. Another thread may grab the range in between, so retry.
+    for (int retry = 0; retry < 8; retry++) {
+        byte *reserved = (byte *)VirtualAlloc(nullptr, SEGMENT_SIZE * 2, MEM_RESERVE, PAGE_NOACCESS);
+        if (!reserved) {
+            return nullptr;
+        }
+        byte *aligned = (byte *)(((uintptr_t)reserved + SEGMENT_SIZE - 1) & ~(uintptr_t)(SEGMENT_SIZE - 1));
+        VirtualFree(reserved, 0, MEM_RELEASE);
+
+        byte *segment = (byte *)VirtualAlloc(aligned, SEGMENT_SIZE, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (segment) {
+            assert(segment == aligned);
+            return segment;
+        }
+    }
+    return nullptr;
+#else
+    byte *mapped = (byte *)mmap(nullptr, SEGMENT_SIZE * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (mapped == (byte *)MAP_FAILED) {
+        return nullptr;
+    }
+    byte *aligned = (byte *)(((uintptr_t)mapped + SEGMENT_SIZE - 1) & ~(uintptr_t)(SEGMENT_SIZE - 1));
+    // Unmap the unaligned head and tail
+    const size_t headSize = aligned - mapped;
+    if (headSize > 0) {
+        munmap(mapped, headSize);
+    }
+    const size_t tailSize = SEGMENT_SIZE - headSize;
+    if (tailSize > 0) {
+        munmap(aligned + SEGMENT_SIZE, tailSize);
+    }
+    return aligned;
+#endif
+}
+
+static void RegisterSegment(byte *segment) {
+    uint32_t index = HashSegment((uintptr_t)segment >> SEGMENT_SHIFT);
+    while (segmentTable[index]) {
+        index = (index + 1) & (SEGMENT_TABLE_SIZE - 1);
+    }
+    // Full barrier, so other threads see the segment before any block of it
+    atomic_cmpxchg(&segmentTable[index], (atomic_t)(intptr_t)segment, 0);
+}
+
+static byte *AllocPage() {
+    Lock(&pageLock);
+
+    if (nextPageIndex == PAGES_PER_SEGMENT) {
+        byte *segment = numSegments < MAX_SEGMENTS ? AllocSegment() : nullptr;
+        if (!segment) {
+            Unlock(&pageLock);
+            return nullptr;
+        }
+        RegisterSegment(segment);
+
+        currentSegment = segment;
+        nextPageIndex = 0;
+        numSegments++;
+    }
+
+    byte *page = currentSegment + nextPageIndex * SLAB_PAGE_SIZE;
+    nextPageIndex++;
+    numPages++;
+
+    Unlock(&pageLock);
+    return page;
+}
+
+static ThreadCache *GetThreadCache() {
+    if (!threadCache) {
+        // Can't be allocated by Mem_* which calls back here
+        threadCache = (ThreadCache *)calloc(1, sizeof(ThreadCache));
+    }
+    return threadCache;
+}
+
+// Moves a batch of blocks from the central list to the thread list. Returns the number of blocks moved.
+static int Refill(FreeList &list, int sizeClass, int tag) {
+    CentralClass &central = centralClasses[sizeClass];
+    CentralList &centralList = central.lists[tag];
+    const size_t blockSize = sizeClasses[sizeClass];
+    const int batchCount = BatchCount(sizeClass);
+    int count = 0;
+
+    Lock(&central.lock);
+
+    while (count < batchCount && centralList.head) {
+        FreeBlock *block = centralList.head;
+        centralList.head = block->next;
+        block->next = list.head;
+        list.head = block;
+        count++;
+    }
+
+    while (count < batchCount) {
+        if ((size_t)(centralList.bumpEnd - centralList.bumpPtr) < blockSize) {
+            byte *page = AllocPage();
+            if (!page) {
+                break;
+            }
+            PageHeader *header = (PageHeader *)page;
+            header->sizeClass = sizeClass;
+            header->tag = tag;
+
+            centralList.bumpPtr = page + PAGE_HEADER_SIZE;
+            centralList.bumpEnd = page + SLAB_PAGE_SIZE;
+        }
+
+        FreeBlock *block = (FreeBlock *)centralList.bumpPtr;
+        centralList.bumpPtr += blockSize;
+        block->next = list.head;
+        list.head = block;
+        count++;
+    }
+
+    Unlock(&central.lock);
+
+    list.count += count;
+    return count;
+}
+
+// Moves count blocks from the thread list to the central list
+static void Flush(FreeList &list, int count, int sizeClass, int tag) {
+    assert(count > 0 && count <= list.count);
+
+    FreeBlock *first = list.head;
+    FreeBlock *last = first;
+    for (int i = 1; i < count; i++) {
+        last = last->next;
+    }
+    list.head = last->next;
+    list.count -= count;
+
+    CentralClass &central = centralClasses[sizeClass];
+    CentralList &centralList = central.lists[tag];
+
+    Lock(&central.lock);
+    last->next = centralList.head;
+    centralList.head = first;
+    Unlock(&central.lock);
+}
+
+void *SmallAllocator::Alloc(size_t size, size_t alignment, int tag) {
+    if (alignment > 16) {
+        if (alignment > 32) {
+            return nullptr;
+        }
+        size = (Max(size, (size_t)1) + 31) & ~(size_t)31;
+    }
+    if (size > MaxSize) {
+        return nullptr;
+    }
+
+    const int sizeClass = SizeClassIndex(size);
+    assert(sizeClasses[sizeClass] % alignment == 0);
+
+    ThreadCache *cache = GetThreadCache();
+    if (!cache) {
+        return nullptr;
+    }
+
+    FreeList &list = cache->lists[tag][sizeClass];
+    if (!list.head && !Refill(list, sizeClass, tag)) {
+        return nullptr;
+    }
+
+    FreeBlock *block = list.head;
+    list.head = block->next;
+    list.count--;
+    return block;
+}
+
+void SmallAllocator::Free(void *ptr) {
+    const PageHeader *header = (const PageHeader *)((uintptr_t)ptr & ~(uintptr_t)(SLAB_PAGE_SIZE - 1));
+    const int sizeClass = header->sizeClass;
+    const int tag = header->tag;
+
+    FreeBlock *block = (FreeBlock *)ptr;
+
+    ThreadCache *cache = GetThreadCache();
+    if (!cache) {
+        // Give it back to the central list directly
+        CentralClass &central = centralClasses[sizeClass];
+        Lock(&central.lock);
+        block->next = central.lists[tag].head;
+        central.lists[tag].head = block;
+        Unlock(&central.lock);
+        return;
+    }
+
+    // Blocks freed by another thread than the allocating one are cached in this thread
+    FreeList &list = cache->lists[tag][sizeClass];
+    block->next = list.head;
+    list.head = block;
+    list.count++;
+
+    const int batchCount = BatchCount(sizeClass);
+    if (list.count > batchCount * 2) {
+        Flush(list, batchCount, sizeClass, tag);
+    }
+}
+
+bool SmallAllocator::Owns(const void *ptr) {
+    const uintptr_t key = (uintptr_t)ptr >> SEGMENT_SHIFT;
+    uint32_t index = HashSegment(key);
+    while (1) {
+        const atomic_t segment = segmentTable[index];
+        if (!segment) {
+            return false;
+        }
+        if (((uintptr_t)segment >> SEGMENT_SHIFT) == key) {
+            return true;
+        }
+        index = (index + 1) & (SEGMENT_TABLE_SIZE - 1);
+    }
+}
+
+void SmallAllocator::GetBlockInfo(const void *ptr, size_t *blockSize, int *tag) {
+    const PageHeader *header = (const PageHeader *)((uintptr_t)ptr & ~(uintptr_t)(SLAB_PAGE_SIZE - 1));
+    *blockSize = sizeClasses[header->sizeClass];
+    *tag = header->tag;
+}
+
+void SmallAllocator::FlushThreadCache() {
+    if (!threadCache) {
+        return;
+    }
+
+    for (int tag = 0; tag < MemTag::Count; tag++) {
+        for (int sizeClass = 0; sizeClass < NumSizeClasses; sizeClass++) {
+            FreeList &list = threadCache->lists[tag][sizeClass];
+            if (list.count > 0) {
+                Flush(list, list.count, sizeClass, tag);
+            }
+        }
+    }
+
+    free(threadCache);
+    threadCache = nullptr;
+}
+
+int SmallAllocator::NumSegments() {
+    return numSegments;
+}
+
+int SmallAllocator::NumPages() {
+    return numPages;
+}
+
+size_t SmallAllocator::ReservedBytes() {
+    return (size_t)numSegments * SEGMENT_SIZE;
+}
+
+BE_NAMESPACE_END
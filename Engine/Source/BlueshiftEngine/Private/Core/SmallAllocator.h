@@ -0,0 +1,66 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Small object allocator
+
+    Size-class slab allocator used by Mem_* for blocks up to MaxSize bytes.
+
+    Memory is reserved from the OS in segments of 1 MB aligned to their size,
+    and each segment is split into 64 KB pages. A page holds blocks of a single
+    size class and a single allocation tag, which are stored in the page
+    header, so the blocks themselves don't need any header. Every size class
+    is a multiple of 16, and classes from 128 bytes are multiples of 32,
+    so blocks are naturally aligned for Mem_Alloc16/Mem_Alloc32.
+
+    Each thread keeps a free list per (tag, size class), and exchanges batches
+    of blocks with the central lists only when its list runs empty or grows
+    too large. Pages are never given back to the OS.
+
+-------------------------------------------------------------------------------
+*/
+
+BE_NAMESPACE_BEGIN
+
+class SmallAllocator {
+public:
+    enum {
+        MaxSize             = 2048,
+        NumSizeClasses      = 24
+    };
+
+                            /// Returns nullptr if size is bigger than MaxSize, alignment is bigger than 32 or it's out of memory.
+    static void *           Alloc(size_t size, size_t alignment, int tag);
+
+    static void             Free(void *ptr);
+
+                            /// Returns true if ptr is allocated by this allocator.
+    static bool             Owns(const void *ptr);
+
+                            /// Returns the size of the block and the tag of the page it belongs to.
+    static void             GetBlockInfo(const void *ptr, size_t *blockSize, int *tag);
+
+                            /// Gives back the free blocks cached by the calling thread.
+    static void             FlushThreadCache();
+
+    static int              NumSegments();
+    static int              NumPages();
+    static size_t           ReservedBytes();
+};
+
+BE_NAMESPACE_END
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/Heap.h"
 #include "Core/Str.h"
 #include "Containers/StrArray.h"
 
@@ -31,10 +32,12 @@ void Str::ReAllocate(int amount, bool keepOld) {
 
     alloced = newSize;
 
+    MemTagScope tagScope(MemTag::Str);
+
 #ifdef USE_STRING_DATA_ALLOCATOR
     char *newBuffer = stringDataAllocator.Alloc(alloced);
 #else
-    char *newBuffer = new char[alloced];
+    char *newBuffer = (char *)Mem_Alloc(alloced * sizeof(char));
 #endif
     if (keepOld && data && len > 0) {
         data[len] = '\0';
@@ -45,7 +48,7 @@ void Str::ReAllocate(int amount, bool keepOld) {
 #ifdef USE_STRING_DATA_ALLOCATOR
         stringDataAllocator.Free(data);
 #else
-        delete [] data;
+        Mem_Free(data);
 #endif
     }
 
@@ -57,7 +60,7 @@ void Str::FreeData() {
 #ifdef USE_STRING_DATA_ALLOCATOR
         stringDataAllocator.Free(data);
 #else
-        delete [] data;
+        Mem_Free(data);
 #endif
         data = baseBuffer;
     }
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/Heap.h"
 #include "Core/WStr.h"
 #include "Containers/StrArray.h"
 
@@ -31,10 +32,12 @@ void WStr::ReAllocate(int amount, bool keepOld) {
 
     alloced = newSize;
 
+    MemTagScope tagScope(MemTag::Str);
+
 #ifdef USE_STRING_DATA_ALLOCATOR
     wchar_t *newBuffer = stringDataAllocator.Alloc(alloced);
 #else
-    wchar_t *newBuffer = new wchar_t[alloced];
+    wchar_t *newBuffer = (wchar_t *)Mem_Alloc(alloced * sizeof(wchar_t));
 #endif
     if (keepOld && data && len > 0) {
         data[len] = L'\0';
@@ -45,7 +48,7 @@ void WStr::ReAllocate(int amount, bool keepOld) {
 #ifdef USE_STRING_DATA_ALLOCATOR
         stringDataAllocator.Free(data);
 #else
-        delete [] data;
+        Mem_Free(data);
 #endif
     }
 
@@ -57,7 +60,7 @@ void WStr::FreeData() {
 #ifdef USE_STRING_DATA_ALLOCATOR
         stringDataAllocator.Free(data);
 #else
-        delete [] data;
+        Mem_Free(data);
 #endif
         data = baseBuffer;
     }
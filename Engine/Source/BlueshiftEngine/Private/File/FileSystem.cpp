@@ -718,6 +718,8 @@ bool FileSystem::RemoveDirectory(const char *dirname, bool tree) const {
 //-------------------------------------------------------------------------------
 
 size_t FileSystem::LoadFile(const char *path, bool searchDirs, void **buffer) {
+    MemTagScope tagScope(MemTag::Asset);
+
     if (!path || !path[0]) {
         BE_ERRLOG(L"FileSystem::LoadFile: empty filename\n");
         *buffer = nullptr;
@@ -24,15 +24,27 @@
 #include "Components/ComCamera.h"
 #include "Components/ComRigidBody.h"
 #include "Components/ComSensor.h"
+#include "Components/ComSkinnedMeshRenderer.h"
 #include "Game/Entity.h"
 #include "Game/GameWorld.h"
 #include "Game/GameSettings/TagLayerSettings.h"
 #include "Game/GameSettings/PhysicsSettings.h"
 #include "Containers/StaticArray.h"
 #include "File/FileSystem.h"
+#include "Core/Profiler.h"
+#include "Core/JobSystem.h"
 
 BE_NAMESPACE_BEGIN
 
+static CVAR(g_parallelAnimation, L"1", CVar::Bool, L"compute the animations of the skinned meshes in parallel using the job system");
+static CVAR(g_animLod, L"1", CVar::Bool, L"reduce the animation update rate of the distant or small skinned meshes, and skip the joints of the off-screen skinned meshes");
+static CVAR(g_animLodDistance1, L"30", CVar::Float, L"distance in meter to update the animation every 2nd frame");
+static CVAR(g_animLodDistance2, L"60", CVar::Float, L"distance in meter to update the animation every 4th frame");
+static CVAR(g_animLodScreenSize1, L"0.1", CVar::Float, L"projected size ratio to the screen height to update the animation every 2nd frame");
+static CVAR(g_animLodScreenSize2, L"0.05", CVar::Float, L"projected size ratio to the screen height to update the animation every 4th frame");
+static CVAR(g_animPoseCache, L"1", CVar::Bool, L"share the sampled anim poses among the skinned meshes playing the same anim at the same time");
+static CVAR(g_animPoseCacheSteps, L"0", CVar::Integer, L"number of the quantized steps between two anim frames to share the cached anim poses, 0 for the exact time");
+
 const EventDef      EV_RestartGame("restartGame", false, "s");
 
 const SignalDef     SIG_EntityRegistered("entityRegistered", "a");
@@ -88,6 +100,8 @@ void GameWorld::Reset() {
     time = 0;
     prevTime = 0;
 
+    animationViewCount = renderWorld->GetViewCount();
+
     renderWorld->ClearDebugPrimitives(0);
     renderWorld->ClearDebugText(0);
 }
@@ -405,6 +419,8 @@ void GameWorld::BeginMapLoading() {
     isMapLoading = true;
 
     Reset();
+
+    renderWorld->BeginMapLoading();
 }
 
 void GameWorld::FinishMapLoading() {
@@ -620,6 +636,8 @@ void GameWorld::SaveMap(const char *filename) {
 }
 
 void GameWorld::Update(int elapsedTime) {
+    BE_PROFILE_SCOPE("GameWorld::Update");
+
     prevTime = time;
 
     int scaledElapsedTime = elapsedTime * timeScale;
@@ -634,16 +652,154 @@ void GameWorld::Update(int elapsedTime) {
 }
 
 void GameWorld::UpdateEntities() {
+    BE_PROFILE_SCOPE("GameWorld::UpdateEntities");
+
     // depth-first order  
     for (Entity *ent = entityHierarchy.GetChild(); ent; ent = ent->node.GetNext()) {
         ent->Update();
     }
 
+    UpdateAnimations();
+
     for (Entity *ent = entityHierarchy.GetChild(); ent; ent = ent->node.GetNext()) {
         ent->LateUpdate();
     }
 }
 
+void GameWorld::RegisterAnimation(ComSkinnedMeshRenderer *skinnedMeshRenderer) {
+    pendingAnimations.Append(skinnedMeshRenderer);
+}
+
+void GameWorld::UnregisterAnimation(ComSkinnedMeshRenderer *skinnedMeshRenderer) {
+    // Cleared instead of removed, because it may be called while finishing the animations
+    int index = pendingAnimations.FindIndex(skinnedMeshRenderer);
+    if (index >= 0) {
+        pendingAnimations[index] = nullptr;
+    }
+}
+
+void GameWorld::UpdateAnimations() {
+    BE_PROFILE_SCOPE("GameWorld::UpdateAnimations");
+
+    const int count = pendingAnimations.Count();
+    if (!count) {
+        return;
+    }
+
+    animPoseCache.BeginFrame(g_animPoseCache.GetBool(), g_animPoseCacheSteps.GetInteger());
+
+    CollectAnimationLodViews();
+
+    // Each skinned mesh computes only its own animator and joints, so they run in parallel
+    JobSystem::ParallelFor(0, count, g_parallelAnimation.GetBool() ? 1 : count, [this](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            if (pendingAnimations[i]) {
+                pendingAnimations[i]->ComputeAnimationFrame(AnimationUpdateInterval(pendingAnimations[i]));
+            }
+        }
+    });
+
+    // Animation events call the scripts and the render entities are updated, so finish them serially
+    for (int i = 0; i < pendingAnimations.Count(); i++) {
+        if (pendingAnimations[i]) {
+            pendingAnimations[i]->FinishAnimationFrame();
+        }
+    }
+
+    pendingAnimations.SetCount(0, false);
+
+    // Poses may be stale out of the animation stage, for example after the anims are reloaded
+    animPoseCache.EndFrame();
+
+    animationViewCount = renderWorld->GetViewCount();
+}
+
+void GameWorld::CollectAnimationLodViews() {
+    animationLodViews.SetCount(0, false);
+
+    if (!g_animLod.GetBool()) {
+        return;
+    }
+
+    for (Entity *ent = entityHierarchy.GetChild(); ent; ent = ent->node.GetNext()) {
+        const ComCamera *camera = ent->GetComponent<ComCamera>();
+        if (!camera || !camera->IsEnabled()) {
+            continue;
+        }
+
+        const SceneView::Parms &viewParms = camera->viewParms;
+
+        AnimationLodView &lodView = animationLodViews.Alloc();
+        lodView.origin = viewParms.origin;
+        if (viewParms.orthogonal) {
+            lodView.projectionScale = 0.0f;
+            lodView.orthogonalSize = viewParms.sizeY;
+        } else {
+            lodView.projectionScale = 1.0f / Math::Tan(DEG2RAD(viewParms.fovY * 0.5f));
+            lodView.orthogonalSize = 0.0f;
+        }
+    }
+}
+
+// Returns the number of frames to update the animation once, 0 to skip the joints of the off-screen skinned mesh.
+// Visibility comes from the views rendered since the last animation update.
+int GameWorld::AnimationUpdateInterval(const ComSkinnedMeshRenderer *skinnedMeshRenderer) const {
+    if (!g_animLod.GetBool()) {
+        return 1;
+    }
+
+    const SceneEntity *sceneEntity = skinnedMeshRenderer->GetRenderEntity();
+    if (!sceneEntity) {
+        return 1;
+    }
+
+    // Visibility is unknown if no view is rendered
+    if (renderWorld->GetViewCount() == animationViewCount) {
+        return 1;
+    }
+
+    if (sceneEntity->viewCount <= animationViewCount) {
+        return 0;
+    }
+
+    if (!animationLodViews.Count()) {
+        return 1;
+    }
+
+    const OBB &worldOBB = sceneEntity->GetWorldOBB();
+    const float radius = worldOBB.Extents().Length();
+
+    const float distance1 = MeterToUnit(g_animLodDistance1.GetFloat());
+    const float distance2 = MeterToUnit(g_animLodDistance2.GetFloat());
+    const float screenSize1 = g_animLodScreenSize1.GetFloat();
+    const float screenSize2 = g_animLodScreenSize2.GetFloat();
+
+    // Takes the most detailed LOD of all the views
+    int interval = 4;
+    for (int i = 0; i < animationLodViews.Count() && interval > 1; i++) {
+        const AnimationLodView &lodView = animationLodViews[i];
+        const float distance = Max(worldOBB.Center().Distance(lodView.origin), radius);
+
+        float screenSize;
+        if (lodView.orthogonalSize > 0.0f) {
+            screenSize = radius / lodView.orthogonalSize;
+        } else {
+            screenSize = radius * lodView.projectionScale / distance;
+        }
+
+        if (distance > distance2 || screenSize < screenSize2) {
+            continue;
+        }
+        if (distance > distance1 || screenSize < screenSize1) {
+            interval = 2;
+            continue;
+        }
+        interval = 1;
+    }
+
+    return interval;
+}
+
 void GameWorld::ProcessPointerInput() {
     if (!gameStarted) {
         return;
@@ -61,6 +61,8 @@ Prefab *PrefabManager::AllocPrefab(const char *hashName, const Guid guid) {
 }
 
 Prefab *PrefabManager::GetPrefab(const char *filename) {
+    MemTagScope tagScope(MemTag::Asset);
+
     Str normalizedFilename = filename;
     normalizedFilename.BackSlashesToSlashes();
 
@@ -25,6 +25,8 @@
 #include "Core/StrColor.h"
 #include "Core/CVars.h"
 #include "Core/Cmds.h"
+#include "Core/Profiler.h"
+#include "Core/Heap.h"
 #include "File/FileSystem.h"
 
 BE_NAMESPACE_BEGIN
@@ -116,6 +118,7 @@ void Common::Init(const char *baseDir) {
     cmdSystem.AddCommand(L"version", Cmd_Version);
     cmdSystem.AddCommand(L"error", Cmd_Error);
     cmdSystem.AddCommand(L"quit", Cmd_Quit);
+    cmdSystem.AddCommand(L"memstats", Cmd_MemStats);
 
     cmdSystem.BufferCommandText(CmdSystem::ExecuteNow, L"exec \"Config/config.cfg\"\n");
     cvarSystem.ClearModified();
@@ -135,6 +138,7 @@ void Common::Shutdown() {
     cmdSystem.RemoveCommand(L"version");
     cmdSystem.RemoveCommand(L"quit");
     cmdSystem.RemoveCommand(L"error");
+    cmdSystem.RemoveCommand(L"memstats");
 
     keyCmdSystem.Shutdown();
 
@@ -161,6 +165,9 @@ void Common::SaveConfig(const char *filename) {
 }
 
 void Common::RunFrame(int frameMsec) {
+    Profiler::SyncFrame();
+    Mem_SyncFrame();
+
     frameTime = frameMsec;
     frameSec = MS2SEC(frameMsec);
     realTime += frameMsec;
@@ -246,6 +253,19 @@ void Common::Cmd_Error(const CmdArgs &args) {
     }
 }
 
+void Common::Cmd_MemStats(const CmdArgs &args) {
+    Mem_PrintStats();
+
+    if (args.Argc() > 1) {
+        Str filename = WStr::ToStr(args.Argv(1));
+        filename.DefaultFileExtension(".csv");
+
+        if (Mem_WriteStats(filename)) {
+            BE_LOG(L"memory stats written to %hs\n", filename.c_str());
+        }
+    }
+}
+
 void Common::Cmd_Quit(const CmdArgs &args) {
     gameClient.Shutdown();
     common.Shutdown();
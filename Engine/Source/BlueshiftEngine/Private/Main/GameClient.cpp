@@ -16,6 +16,7 @@
 #include "Core/StrColor.h"
 #include "Core/Cmds.h"
 #include "Core/CVars.h"
+#include "Core/Profiler.h"
 #include "Core/Vec4Color.h"
 #include "Render/Render.h"
 #include "Physics/Physics.h"
@@ -47,6 +48,7 @@ static CVAR(cl_conNoPrint, L"1", CVar::Bool, L"");
 static CVAR(cl_conNotifyTime, L"3.0", CVar::Float | CVar::Archive, L"");
 static CVAR(cl_showFps, L"0", CVar::Bool, L"");
 static CVAR(cl_showTimer, L"0", CVar::Bool, L"");
+static CVAR(cl_showProfiler, L"0", CVar::Bool, L"show the profiler scopes of recent frames");
 
 GameClient      gameClient;
 
@@ -468,6 +470,10 @@ void GameClient::DrawConsole() {
         DrawString(0, CONSOLE_FONT_HEIGHT, BE1::wva(L"%02i:%02i:%02i", hours, minutes, seconds), -1, DTF_RIGHT | DTF_DROPSHADOW);
     }
 
+    if (cl_showProfiler.GetBool()) {
+        DrawProfiler();
+    }
+
     if (consoleHeight > 0.0f) {
         DrawConsoleScreen();
     } else {
@@ -477,6 +483,56 @@ void GameClient::DrawConsole() {
     SetFont(oldFont);
 }
 
+void GameClient::DrawProfiler() {
+    static const int MaxProfilerLines = 24;
+    static const int ColumnWidth = 70;
+    static const int NameWidth = 240;
+    
+    const int lineHeight = CONSOLE_FONT_HEIGHT + CONSOLE_FONT_Y_SPACING;
+    int x = CONSOLE_TEXT_BORDER;
+    int y = CONSOLE_FONT_HEIGHT * 2;
+
+    if (!Profiler::IsEnabled()) {
+        SetTextColor(Color4::white);
+        DrawString(x, y, L"Profiler is not running. Type 'profileStart' to start.", -1, DTF_DROPSHADOW);
+        return;
+    }
+
+    Profiler::MarkerStats stats[MaxProfilerLines];
+    int numStats = Profiler::GetMarkerStats(stats, COUNT_OF(stats));
+
+    float avgFrameMsec, maxFrameMsec;
+    Profiler::GetFrameTimes(avgFrameMsec, maxFrameMsec);
+
+    DrawBar(x - 4, y - 2, NameWidth + ColumnWidth * 4 + 8, (numStats + 2) * lineHeight + 4, Color4(0.0f, 0.0f, 0.0f, 0.6f));
+
+    SetTextColor(Color4::orange);
+    DrawString(x, y, wva(L"frame %i  avg %.2fms  max %.2fms", Profiler::FrameIndex(), avgFrameMsec, maxFrameMsec), -1, DTF_DROPSHADOW);
+    y += lineHeight;
+
+    static const wchar_t *columnNames[] = { L"last(ms)", L"avg(ms)", L"max(ms)", L"calls" };
+    SetTextColor(Color4::grey);
+    DrawString(x, y, L"scope", -1, DTF_DROPSHADOW);
+    for (int i = 0; i < COUNT_OF(columnNames); i++) {
+        DrawString(x + NameWidth + ColumnWidth * i, y, columnNames[i], -1, DTF_DROPSHADOW);
+    }
+    y += lineHeight;
+
+    for (int i = 0; i < numStats; i++) {
+        const Profiler::MarkerStats &markerStats = stats[i];
+
+        // Highlights the scopes which have a spike in the frame history
+        SetTextColor(markerStats.maxMsec > markerStats.avgMsec * 2.0f && markerStats.maxMsec > 1.0f ? Color4::yellow : Color4::white);
+
+        DrawString(x, y, wva(L"%hs", markerStats.name), -1, DTF_DROPSHADOW);
+        DrawString(x + NameWidth, y, wva(L"%.3f", markerStats.lastMsec), -1, DTF_DROPSHADOW);
+        DrawString(x + NameWidth + ColumnWidth, y, wva(L"%.3f", markerStats.avgMsec), -1, DTF_DROPSHADOW);
+        DrawString(x + NameWidth + ColumnWidth * 2, y, wva(L"%.3f", markerStats.maxMsec), -1, DTF_DROPSHADOW);
+        DrawString(x + NameWidth + ColumnWidth * 3, y, wva(L"%i", markerStats.lastCalls), -1, DTF_DROPSHADOW);
+        y += lineHeight;
+    }
+}
+
 void GameClient::DrawConsoleScreen() {
     wchar_t	version[64];
     
@@ -140,6 +140,8 @@ Collider *ColliderManager::FindCollider(const char *name, const Vec3 &scale, boo
 }
 
 Collider *ColliderManager::GetCollider(const char *name, const Vec3 &scale, bool convexHull) {
+    MemTagScope tagScope(MemTag::Physics);
+
     if (!name || name[0] == 0) {
         return nullptr;
     }
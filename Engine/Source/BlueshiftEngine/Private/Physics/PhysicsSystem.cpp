@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/Heap.h"
 #include "Physics/Physics.h"
 #include "Physics/Collider.h"
 #include "ColliderInternal.h"
@@ -34,7 +35,21 @@ static bool CustomMaterialCombinerCallback(btManifoldPoint &cp, const btCollisio
     return false;
 }
 
+// Bullet allocations are accounted to MemTag::Physics.
+// btAlignedAlloc does the alignment on top of these, so unaligned allocation is enough.
+static void *PhysicsSystem_Alloc(size_t size) {
+    MemTagScope tagScope(MemTag::Physics);
+    return Mem_Alloc(size);
+}
+
+static void PhysicsSystem_Free(void *ptr) {
+    Mem_Free(ptr);
+}
+
 void PhysicsSystem::Init() {
+    // Should be set before any allocation in Bullet
+    btAlignedAllocSetCustom(PhysicsSystem_Alloc, PhysicsSystem_Free);
+
     gContactAddedCallback = CustomMaterialCombinerCallback;
 
     colliderManager.Init();
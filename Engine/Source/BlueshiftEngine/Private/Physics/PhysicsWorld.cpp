@@ -17,6 +17,7 @@
 #include "Physics/Collider.h"
 #include "ColliderInternal.h"
 #include "PhysicsInternal.h"
+#include "Core/Profiler.h"
 
 BE_NAMESPACE_BEGIN
     
@@ -118,7 +119,8 @@ void PhysicsWorld::ClearScene() {
 }
 
 void PhysicsWorld::StepSimulation(int frameTime) {
-    //startFrameMsec = PlatformTime::Milliseconds();
+    BE_PROFILE_SCOPE("PhysicsWorld::StepSimulation");
+    MemTagScope tagScope(MemTag::Physics);
 
     if (!physics_enable.GetBool()) {
         return;
@@ -150,8 +152,6 @@ void PhysicsWorld::StepSimulation(int frameTime) {
     
     timeDelta = 0.0f;
 #endif
-
-    //fc.frameTime = PlatformTime::Milliseconds() - startFrameMsec;
 }
 
 const Vec3 PhysicsWorld::GetGravity() const {
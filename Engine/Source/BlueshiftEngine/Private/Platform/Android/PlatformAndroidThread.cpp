@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/Heap.h"
 #include "Platform\PlatformThread.h"
 #include <pthread.h>
 #include <sched.h>
@@ -64,6 +65,9 @@ static void *ThreadStartup(ThreadStartupData *parg) {
     SetAffinity(arg.affinity);
     arg.startProc(arg.param);
 
+    // Gives back the memory cached by this thread
+    Mem_ThreadExit();
+
     return NULL;
 }
 
@@ -200,6 +204,10 @@ bool PlatformUnixCondition::TimedWait(const PlatformUnixCondition *posixConditio
 	return true;
 }
 
+void PlatformUnixCondition::Signal(const PlatformUnixCondition *posixCondition) {
+	pthread_cond_signal(posixCondition->cond);
+}
+
 void PlatformUnixCondition::Broadcast(const PlatformUnixCondition *posixCondition) {
 	pthread_cond_broadcast(posixCondition->cond);
 }
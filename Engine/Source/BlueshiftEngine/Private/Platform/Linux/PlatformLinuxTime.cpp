@@ -1,15 +1,13 @@
 #include "Precompiled.h"
 #include "Platform/PlatformTime.h"
-//#include <mach/mach_time.h>
+#include <sys/time.h>
+#include <time.h>
 
 BE_NAMESPACE_BEGIN
 
 void PlatformLinuxTime::Init() {
-	//// Time base is in nano seconds.
-	//mach_timebase_info_data_t info;
-	//mach_timebase_info(&info);
-	//secondsPerCycle = 1e-9 * (double)info.numer / (double)info.denom;
-
+	// Cycles() counts nano seconds of CLOCK_MONOTONIC.
+	secondsPerCycle = 1e-9;
 }
 
 float PlatformLinuxTime::Seconds() {
@@ -22,11 +20,9 @@ float PlatformLinuxTime::Seconds() {
 }
 
 uint64_t PlatformLinuxTime::Cycles() {
-	//uint64_t cycles = mach_absolute_time();
-	//return cycles;
-	struct timeval tv;
-	gettimeofday(&tv, 0);
-	return tv.tv_sec * 1000000L + tv.tv_usec;
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
 BE_NAMESPACE_END
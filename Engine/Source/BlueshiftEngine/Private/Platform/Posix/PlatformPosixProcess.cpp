@@ -54,6 +54,12 @@ void PlatformPosixProcess::CloseLibrary(SharedLib lib) {
     }
 }
 
+// return the number of logical threads of the system
+int PlatformPosixProcess::NumberOfLogicalProcessors() {
+    long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    return numProcessors > 0 ? (int)numProcessors : 1;
+}
+
 void PlatformPosixProcess::Sleep(float seconds) {
     const uint32_t usec = seconds * 1000000.0f;
     if (usec > 0) {
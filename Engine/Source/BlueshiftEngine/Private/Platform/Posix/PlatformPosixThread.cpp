@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/Heap.h"
 #include "Platform/PlatformThread.h"
 #include <pthread.h>
 #include <sched.h>
@@ -63,6 +64,9 @@ static void *ThreadStartup(ThreadStartupData *parg) {
     SetAffinity(arg.affinity);
     arg.startProc(arg.param);
 
+    // Gives back the memory cached by this thread
+    Mem_ThreadExit();
+
     return NULL;
 }
 
@@ -197,6 +201,10 @@ bool PlatformPosixCondition::TimedWait(const PlatformPosixCondition *posixCondit
     return true;
 }
 
+void PlatformPosixCondition::Signal(const PlatformPosixCondition *posixCondition) {
+    pthread_cond_signal(posixCondition->cond);
+}
+
 void PlatformPosixCondition::Broadcast(const PlatformPosixCondition *posixCondition) {
     pthread_cond_broadcast(posixCondition->cond);
 }
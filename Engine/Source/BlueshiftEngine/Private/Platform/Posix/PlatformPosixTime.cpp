@@ -15,12 +15,13 @@
 #include "Precompiled.h"
 #include "Platform/PlatformTime.h"
 #include <sys/time.h>
+#include <time.h>
 
 BE_NAMESPACE_BEGIN
 
 void PlatformPosixTime::Init() {
-    // we use gettimeofday() instead of rdtsc, so it's 1000000 "cycles" per second on this faked CPU.
-    secondsPerCycle = 1.0f / 1000000.0f;
+    // Cycles() counts nano seconds of CLOCK_MONOTONIC instead of rdtsc.
+    secondsPerCycle = 1e-9;
 }
 
 void PlatformPosixTime::Shutdown() {
@@ -56,9 +57,9 @@ uint64_t PlatformPosixTime::Microseconds() {
 }
 
 uint64_t PlatformPosixTime::Cycles() {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (((uint64_t)tv.tv_sec) * 1000000ULL) + (((uint64_t)tv.tv_usec));
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec) * 1000000000ULL + ((uint64_t)ts.tv_nsec);
 }
 
 int PlatformPosixTime::GetTimeOfDay(struct timeval *tv) {
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/Heap.h"
 #include "Platform/PlatformThread.h"
 #include "Platform/Windows/PlatformWinThread.h"
 
@@ -65,10 +66,32 @@ static void SetAffinity(HANDLE thread, int affinity) {
 #endif
 }
 
+struct ThreadStartupData {
+    threadFunc_t startProc;
+    void *param;
+};
+
+static DWORD WINAPI ThreadStartup(LPVOID parg) {
+    ThreadStartupData arg = *(ThreadStartupData *)parg;
+    delete (ThreadStartupData *)parg;
+
+    arg.startProc(arg.param);
+
+    // Gives back the memory cached by this thread
+    Mem_ThreadExit();
+
+    return 0;
+}
+
 // Creates a hardware thread running on specific core
 PlatformWinThread *PlatformWinThread::Create(threadFunc_t startProc, void *param, size_t stackSize, int affinity) {
-    HANDLE threadHandle = CreateThread(nullptr, stackSize, (LPTHREAD_START_ROUTINE)startProc, param, 0, nullptr);
+    ThreadStartupData *startup = new ThreadStartupData;
+    startup->startProc = startProc;
+    startup->param = param;
+
+    HANDLE threadHandle = CreateThread(nullptr, stackSize, ThreadStartup, startup, 0, nullptr);
     if (threadHandle == nullptr) {
+        delete startup;
         BE_FATALERROR(L"cannot create thread");
     }
 
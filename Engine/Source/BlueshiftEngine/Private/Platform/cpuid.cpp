@@ -87,8 +87,6 @@ void DetectCpu() {
         }
     }
 
-    // If Visual Studio 2010 SP1 or later
-#if (_MSC_FULL_VER >= 160040219)
     // Checking for AVX requires 3 things:
     // 1) CPUID indicates that the OS uses XSAVE and XRSTORE
     //     instructions (allowing saving YMM registers on context
@@ -101,15 +99,32 @@ void DetectCpu() {
     // the instruction needs to be conditionally run.
     bool osUsesXSAVE_XRSTORE = info[2] & BIT(27) || false;
     bool cpuAVXSupport = info[2] & BIT(28) || false;
+    bool cpuFMASupport = info[2] & BIT(12) || false;
 
     if (osUsesXSAVE_XRSTORE && cpuAVXSupport) {
-        // Check if the OS will save the YMM registers
+        // Check if the OS will save the XMM and YMM registers
+#if defined(_MSC_VER)
         unsigned long long xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
-        if (xcrFeatureMask & 0x6) {
+#else
+        unsigned long long xcrFeatureMask = __xgetbv(0);
+#endif
+        if ((xcrFeatureMask & 0x6) == 0x6) {
             cpuInfo.cpuid |= CPUID_AVX;
+
+            if (cpuFMASupport) {
+                cpuInfo.cpuid |= CPUID_FMA;
+            }
+
+            // AVX2 is reported in the structured extended feature flags
+            __cpuid(info, 0);
+            if (info[0] >= 7) {
+                __cpuidex(info, 7, 0);
+                if (info[1] & BIT(5)) {
+                    cpuInfo.cpuid |= CPUID_AVX2;
+                }
+            }
         }
     }
-#endif
 
     if (!strncmp(cpuInfo.vendorString, VENDOR_INTEL, 12)) {
         cpuInfo.cpuid |= CPUID_INTEL;
@@ -24,6 +24,8 @@ BE_NAMESPACE_BEGIN
 
 size_t Anim::Allocated() const {
     size_t size = jointInfo.Allocated() + frameComponents.Allocated() + frameToTimeMap.Allocated() + timeToFrameMap.Allocated() + hashName.Allocated();
+    size += compressedTracks.Allocated() + keyFrameNums.Allocated() + keyValues.Allocated();
+    size += sampleGroups.Allocated() + jointSampleLanes.Allocated();
     return size;
 }
 
@@ -36,11 +38,17 @@ void Anim::Purge() {
     rootRotation = false;
     rootTranslationXY = false;
     rootTranslationZ = false;
+    isCompressed = false;
 
     totalDelta.SetFromScalar(0);
     
     jointInfo.Clear();
     frameComponents.Clear();
+    compressedTracks.Clear();
+    keyFrameNums.Clear();
+    keyValues.Clear();
+    sampleGroups.Clear();
+    jointSampleLanes.Clear();
     frameToTimeMap.Clear();
     timeToFrameMap.Clear();
 }
@@ -55,10 +63,16 @@ Anim &Anim::Copy(const Anim &other) {
     rootRotation = other.rootRotation;
     rootTranslationXY = other.rootTranslationXY;
     rootTranslationZ = other.rootTranslationZ;
+    isCompressed = other.isCompressed;
 
     jointInfo = other.jointInfo;
     baseFrame = other.baseFrame;
     frameComponents = other.frameComponents;
+    compressedTracks = other.compressedTracks;
+    keyFrameNums = other.keyFrameNums;
+    keyValues = other.keyValues;
+    sampleGroups = other.sampleGroups;
+    jointSampleLanes = other.jointSampleLanes;
     frameToTimeMap = other.frameToTimeMap;
     timeToFrameMap = other.timeToFrameMap;
     totalDelta = other.totalDelta;
@@ -107,12 +121,19 @@ void Anim::CreateDefaultAnim(const Skeleton *skeleton) {
     ComputeTimeFrames();
 
     ComputeTotalDelta();
+
+    ComputeSamplingPlan();
 }
 
 Anim *Anim::CreateAdditiveAnim(const char *hashName, const JointPose *firstFrame, int numJointIndexes, const int *jointIndexes) {
     Anim *additiveAnim = animManager.AllocAnim(hashName);
     additiveAnim->Copy(*this);
 
+    // additive frames are written to the frame components
+    if (additiveAnim->isCompressed) {
+        additiveAnim->Decompress();
+    }
+
     isAdditiveAnim = true;
 
     JointPose *jointFrame = (JointPose *)_alloca16(numJoints * sizeof(jointFrame[0]));
@@ -181,6 +202,8 @@ Anim *Anim::CreateAdditiveAnim(const char *hashName, const JointPose *firstFrame
         additiveAnim->baseFrame[jointIndex] -= firstFrame[jointIndex];
     }
 
+    additiveAnim->ComputeSamplingPlan();
+
     return additiveAnim;
 }
 
@@ -283,6 +306,12 @@ bool Anim::CheckHierarchy(const Skeleton *skeleton) const {
 void Anim::ComputeTotalDelta() {
     if (!numAnimatedComponents) {
         totalDelta.SetFromScalar(0);
+    } else if (isCompressed) {
+        // not animated components are decompressed to the base frame, so their delta is zero
+        JointPose rootPose = baseFrame[0];
+        int rootIndex = 0;
+        GetCompressedFrame((float)(numFrames - 1), 1, &rootIndex, &rootPose);
+        totalDelta = rootPose.t - baseFrame[0].t;
     } else {
         float *componentPtr = &frameComponents[jointInfo[0].firstComponent];
         if (jointInfo[0].animBits & Tx) {
@@ -328,6 +357,76 @@ void Anim::ComputeTimeFrames() {
     }
 }
 
+static void CopySampleLane(JointSampleGroup &dst, int dstLane, const JointSampleGroup &src, int srcLane) {
+    for (int c = 0; c < JointSampleGroup::NumComponents; c++) {
+        dst.componentOffsets[c][dstLane] = src.componentOffsets[c][srcLane];
+        dst.componentMasks[c][dstLane] = src.componentMasks[c][srcLane];
+    }
+    for (int c = 0; c < JointSampleGroup::NumComponents + 1; c++) {
+        dst.baseComponents[c][dstLane] = src.baseComponents[c][srcLane];
+    }
+    dst.rotationMasks[dstLane] = src.rotationMasks[srcLane];
+    dst.jointIndexes[dstLane] = src.jointIndexes[srcLane];
+}
+
+// Fills the unused lanes of the last group with the last joint, so the kernel can write them without any check.
+static void PadSampleLanes(JointSampleGroup *groups, int numLanes) {
+    const int lastLane = numLanes - 1;
+
+    for (int lane = numLanes; lane & 3; lane++) {
+        CopySampleLane(groups[lane >> 2], lane & 3, groups[lastLane >> 2], lastLane & 3);
+    }
+}
+
+void Anim::ComputeSamplingPlan() {
+    sampleGroups.Clear();
+    jointSampleLanes.SetGranularity(1);
+    jointSampleLanes.SetCount(numJoints);
+
+    int numLanes = 0;
+    for (int i = 0; i < numJoints; i++) {
+        jointSampleLanes[i] = jointInfo[i].animBits ? numLanes++ : -1;
+    }
+
+    if (!numLanes) {
+        return;
+    }
+
+    sampleGroups.SetGranularity(1);
+    sampleGroups.SetCount((numLanes + 3) / 4);
+
+    for (int i = 0; i < numJoints; i++) {
+        const int lane = jointSampleLanes[i];
+        if (lane < 0) {
+            continue;
+        }
+
+        const JointInfo &info = jointInfo[i];
+        const JointPose &base = baseFrame[i];
+        JointSampleGroup &group = sampleGroups[lane >> 2];
+        const int l = lane & 3;
+
+        const float baseComponents[JointSampleGroup::NumComponents + 1] = {
+            base.t.x, base.t.y, base.t.z, base.q.x, base.q.y, base.q.z, base.s.x, base.s.y, base.s.z, base.q.w
+        };
+
+        // components are stored in order of the anim bits
+        int offset = info.firstComponent;
+        for (int c = 0; c < JointSampleGroup::NumComponents; c++) {
+            const bool animated = (info.animBits & BIT(c)) != 0;
+            group.componentOffsets[c][l] = animated ? offset++ : 0;
+            group.componentMasks[c][l] = animated ? ~0 : 0;
+        }
+        for (int c = 0; c < JointSampleGroup::NumComponents + 1; c++) {
+            group.baseComponents[c][l] = baseComponents[c];
+        }
+        group.rotationMasks[l] = (info.animBits & (Qx | Qy | Qz)) ? ~0 : 0;
+        group.jointIndexes[l] = i;
+    }
+
+    PadSampleLanes(sampleGroups.Ptr(), numLanes);
+}
+
 void Anim::ComputeFrameAABBs(const Skeleton *skeleton, const Mesh *mesh, Array<AABB> &frameAABBs) const {
     if (skeleton->NumJoints() == 0) {
         return;
@@ -492,6 +591,18 @@ void Anim::GetTranslation(Vec3 &outTranslation, int time, bool cyclicTranslation
 
     TimeToFrameInterpolation(time, frame);
 
+    if (isCompressed) {
+        JointPose rootPose = baseFrame[0];
+        int rootIndex = 0;
+        GetCompressedFrame(frame.frame1 + (frame.frame2 - frame.frame1) * frame.backlerp, 1, &rootIndex, &rootPose);
+        outTranslation = rootPose.t;
+
+        if (frame.cycleCount && cyclicTranslation) {
+            outTranslation += totalDelta * (float)frame.cycleCount;
+        }
+        return;
+    }
+
     const float *componentPtr1 = &frameComponents[numAnimatedComponents * frame.frame1 + jointInfo[0].firstComponent];
     const float *componentPtr2 = &frameComponents[numAnimatedComponents * frame.frame2 + jointInfo[0].firstComponent];
 
@@ -544,6 +655,14 @@ void Anim::GetRotation(Quat &outRotation, int time) const {
     FrameInterpolation frame;
     TimeToFrameInterpolation(time, frame);
 
+    if (isCompressed) {
+        JointPose rootPose = baseFrame[0];
+        int rootIndex = 0;
+        GetCompressedFrame(frame.frame1 + (frame.frame2 - frame.frame1) * frame.backlerp, 1, &rootIndex, &rootPose);
+        outRotation = rootPose.q;
+        return;
+    }
+
     const float *componentPtr1 = &frameComponents[numAnimatedComponents * frame.frame1 + jointInfo[0].firstComponent];
     const float *componentPtr2 = &frameComponents[numAnimatedComponents * frame.frame2 + jointInfo[0].firstComponent];
 
@@ -652,6 +771,14 @@ void Anim::GetScaling(Vec3 &outScaling, int time) const {
     FrameInterpolation frame;
     TimeToFrameInterpolation(time, frame);
 
+    if (isCompressed) {
+        JointPose rootPose = baseFrame[0];
+        int rootIndex = 0;
+        GetCompressedFrame(frame.frame1 + (frame.frame2 - frame.frame1) * frame.backlerp, 1, &rootIndex, &rootPose);
+        outScaling = rootPose.s;
+        return;
+    }
+
     const float *componentPtr1 = &frameComponents[numAnimatedComponents * frame.frame1 + jointInfo[0].firstComponent];
     const float *componentPtr2 = &frameComponents[numAnimatedComponents * frame.frame2 + jointInfo[0].firstComponent];
 
@@ -743,61 +870,65 @@ void Anim::GetSingleFrame(int frameNum, int numJointIndexes, const int *jointInd
         return;
     }
 
-    const float *frame = &frameComponents[frameNum * numAnimatedComponents];
-
-    for (int i = 0; i < numJointIndexes; i++) {
-        int j = jointIndexes[i];
-        const JointInfo *infoPtr = &jointInfo[j];
-
-        int animBits = infoPtr->animBits;
-        if (animBits == 0) {
-            continue;
-        }
+    if (isCompressed) {
+        GetCompressedFrame((float)frameNum, numJointIndexes, jointIndexes, joints);
+    } else {
+        const float *frame = &frameComponents[frameNum * numAnimatedComponents];
 
-        JointPose *jointPtr = &joints[j];
-        const float *jointframe = frame + infoPtr->firstComponent;
+        for (int i = 0; i < numJointIndexes; i++) {
+            int j = jointIndexes[i];
+            const JointInfo *infoPtr = &jointInfo[j];
 
-        if (animBits & (Tx | Ty | Tz)) {
-            if (animBits & Tx) {
-                jointPtr->t.x = *jointframe++;
+            int animBits = infoPtr->animBits;
+            if (animBits == 0) {
+                continue;
             }
 
-            if (animBits & Ty) {
-                jointPtr->t.y = *jointframe++;
-            }
+            JointPose *jointPtr = &joints[j];
+            const float *jointframe = frame + infoPtr->firstComponent;
 
-            if (animBits & Tz) {
-                jointPtr->t.z = *jointframe++;
-            }
-        }
+            if (animBits & (Tx | Ty | Tz)) {
+                if (animBits & Tx) {
+                    jointPtr->t.x = *jointframe++;
+                }
 
-        if (animBits & (Qx | Qy | Qz)) {
-            if (animBits & Qx) {
-                jointPtr->q.x = *jointframe++;
-            }
+                if (animBits & Ty) {
+                    jointPtr->t.y = *jointframe++;
+                }
 
-            if (animBits & Qy) {
-                jointPtr->q.y = *jointframe++;
+                if (animBits & Tz) {
+                    jointPtr->t.z = *jointframe++;
+                }
             }
 
-            if (animBits & Qz) {
-                jointPtr->q.z = *jointframe++;
-            }
+            if (animBits & (Qx | Qy | Qz)) {
+                if (animBits & Qx) {
+                    jointPtr->q.x = *jointframe++;
+                }
 
-            jointPtr->q.w = jointPtr->q.CalcW();
-        }
+                if (animBits & Qy) {
+                    jointPtr->q.y = *jointframe++;
+                }
 
-        if (animBits & (Sx | Sy | Sz)) {
-            if (animBits & Sx) {
-                jointPtr->s.x = *jointframe++;
-            }
+                if (animBits & Qz) {
+                    jointPtr->q.z = *jointframe++;
+                }
 
-            if (animBits & Sy) {
-                jointPtr->s.y = *jointframe++;
+                jointPtr->q.w = jointPtr->q.CalcW();
             }
 
-            if (animBits & Sz) {
-                jointPtr->s.z = *jointframe++;
+            if (animBits & (Sx | Sy | Sz)) {
+                if (animBits & Sx) {
+                    jointPtr->s.x = *jointframe++;
+                }
+
+                if (animBits & Sy) {
+                    jointPtr->s.y = *jointframe++;
+                }
+
+                if (animBits & Sz) {
+                    jointPtr->s.z = *jointframe++;
+                }
             }
         }
     }
@@ -831,234 +962,36 @@ void Anim::GetInterpolatedFrame(FrameInterpolation &frame, int numJointIndexes,
         return;
     }
 
-    JointPose *blendJoints = (JointPose *)_alloca16(baseFrame.Count() * sizeof(JointPose));
-    int *lerpIndex = (int *)_alloca16(baseFrame.Count() * sizeof(lerpIndex[0]));
-    int numLerpJoints = 0;
-
-    const float *frame1 = &frameComponents[frame.frame1 * numAnimatedComponents];
-    const float *frame2 = &frameComponents[frame.frame2 * numAnimatedComponents];
-
-    for (int i = 0; i < numJointIndexes; i++) {
-        int j = jointIndexes[i];
-        const JointInfo *infoPtr = &jointInfo[j];
-
-        int animBits = infoPtr->animBits;
-        if (animBits == 0) {
-            continue;
-        }
-
-        lerpIndex[numLerpJoints++] = j;
-
-        JointPose *jointPtr = &joints[j];
-        JointPose *blendPtr = &blendJoints[j];
-
-        const float *jointframe1 = frame1 + infoPtr->firstComponent;
-        const float *jointframe2 = frame2 + infoPtr->firstComponent;
+    if (isCompressed) {
+        GetCompressedFrame(frame.frame1 + (frame.frame2 - frame.frame1) * frame.backlerp, numJointIndexes, jointIndexes, joints);
+    } else {
+        const float *frame1 = &frameComponents[frame.frame1 * numAnimatedComponents];
+        const float *frame2 = &frameComponents[frame.frame2 * numAnimatedComponents];
 
-        switch (animBits & (Tx | Ty | Tz)) {
-        case 0:
-            blendPtr->t = jointPtr->t;
-            break;
-        case Tx:
-            jointPtr->t.x = jointframe1[0];
-            blendPtr->t.x = jointframe2[0];
-            blendPtr->t.y = jointPtr->t.y;
-            blendPtr->t.z = jointPtr->t.z;
-            jointframe1++;
-            jointframe2++;
-            break;
-        case Ty:
-            jointPtr->t.y = jointframe1[0];
-            blendPtr->t.y = jointframe2[0];
-            blendPtr->t.x = jointPtr->t.x;
-            blendPtr->t.z = jointPtr->t.z;
-            jointframe1++;
-            jointframe2++;
-            break;
-        case Tz:
-            jointPtr->t.z = jointframe1[0];
-            blendPtr->t.z = jointframe2[0];
-            blendPtr->t.x = jointPtr->t.x;
-            blendPtr->t.y = jointPtr->t.y;
-            jointframe1++;
-            jointframe2++;
-            break;
-        case Tx | Ty:
-            jointPtr->t.x = jointframe1[0];
-            jointPtr->t.y = jointframe1[1];
-            blendPtr->t.x = jointframe2[0];
-            blendPtr->t.y = jointframe2[1];
-            blendPtr->t.z = jointPtr->t.z;
-            jointframe1 += 2;
-            jointframe2 += 2;
-            break;
-        case Tx | Tz:
-            jointPtr->t.x = jointframe1[0];
-            jointPtr->t.z = jointframe1[1];
-            blendPtr->t.x = jointframe2[0];
-            blendPtr->t.z = jointframe2[1];
-            blendPtr->t.y = jointPtr->t.y;
-            jointframe1 += 2;
-            jointframe2 += 2;
-            break;
-        case Ty | Tz:
-            jointPtr->t.y = jointframe1[0];
-            jointPtr->t.z = jointframe1[1];
-            blendPtr->t.y = jointframe2[0];
-            blendPtr->t.z = jointframe2[1];
-            blendPtr->t.x = jointPtr->t.x;
-            jointframe1 += 2;
-            jointframe2 += 2;
-            break;
-        case Tx | Ty | Tz:
-            jointPtr->t.x = jointframe1[0];
-            jointPtr->t.y = jointframe1[1];
-            jointPtr->t.z = jointframe1[2];
-            blendPtr->t.x = jointframe2[0];
-            blendPtr->t.y = jointframe2[1];
-            blendPtr->t.z = jointframe2[2];
-            jointframe1 += 3;
-            jointframe2 += 3;
-            break;
-        }
+        if (numJointIndexes == numJoints) {
+            simdProcessor->SampleJoints(joints, sampleGroups.Ptr(), sampleGroups.Count(), frame1, frame2, frame.backlerp);
+        } else {
+            // gather the lanes of the masked joints
+            JointSampleGroup *groups = (JointSampleGroup *)_alloca16(((numJointIndexes + 3) / 4) * sizeof(JointSampleGroup));
+            int numLanes = 0;
+
+            for (int i = 0; i < numJointIndexes; i++) {
+                const int lane = jointSampleLanes[jointIndexes[i]];
+                if (lane < 0) {
+                    continue;
+                }
+                CopySampleLane(groups[numLanes >> 2], numLanes & 3, sampleGroups[lane >> 2], lane & 3);
+                numLanes++;
+            }
 
-        switch (animBits & (Qx | Qy | Qz)) {
-        case 0:
-            blendPtr->q = jointPtr->q;
-            break;
-        case Qx:
-            jointPtr->q.x = jointframe1[0];
-            blendPtr->q.x = jointframe2[0];
-            blendPtr->q.y = jointPtr->q.y;
-            blendPtr->q.z = jointPtr->q.z;
-            jointPtr->q.w = jointPtr->q.CalcW();
-            blendPtr->q.w = blendPtr->q.CalcW();
-            break;
-        case Qy:
-            jointPtr->q.y = jointframe1[0];
-            blendPtr->q.y = jointframe2[0];
-            blendPtr->q.x = jointPtr->q.x;
-            blendPtr->q.z = jointPtr->q.z;
-            jointPtr->q.w = jointPtr->q.CalcW();
-            blendPtr->q.w = blendPtr->q.CalcW();
-            break;
-        case Qz:
-            jointPtr->q.z = jointframe1[0];
-            blendPtr->q.z = jointframe2[0];
-            blendPtr->q.x = jointPtr->q.x;
-            blendPtr->q.y = jointPtr->q.y;
-            jointPtr->q.w = jointPtr->q.CalcW();
-            blendPtr->q.w = blendPtr->q.CalcW();
-            break;
-        case Qx | Qy:
-            jointPtr->q.x = jointframe1[0];
-            jointPtr->q.y = jointframe1[1];
-            blendPtr->q.x = jointframe2[0];
-            blendPtr->q.y = jointframe2[1];
-            blendPtr->q.z = jointPtr->q.z;
-            jointPtr->q.w = jointPtr->q.CalcW();
-            blendPtr->q.w = blendPtr->q.CalcW();
-            break;
-        case Qx | Qz:
-            jointPtr->q.x = jointframe1[0];
-            jointPtr->q.z = jointframe1[1];
-            blendPtr->q.x = jointframe2[0];
-            blendPtr->q.z = jointframe2[1];
-            blendPtr->q.y = jointPtr->q.y;
-            jointPtr->q.w = jointPtr->q.CalcW();
-            blendPtr->q.w = blendPtr->q.CalcW();
-            break;
-        case Qy | Qz:
-            jointPtr->q.y = jointframe1[0];
-            jointPtr->q.z = jointframe1[1];
-            blendPtr->q.y = jointframe2[0];
-            blendPtr->q.z = jointframe2[1];
-            blendPtr->q.x = jointPtr->q.x;
-            jointPtr->q.w = jointPtr->q.CalcW();
-            blendPtr->q.w = blendPtr->q.CalcW();
-            break;
-        case Qx | Qy | Qz:
-            jointPtr->q.x = jointframe1[0];
-            jointPtr->q.y = jointframe1[1];
-            jointPtr->q.z = jointframe1[2];
-            blendPtr->q.x = jointframe2[0];
-            blendPtr->q.y = jointframe2[1];
-            blendPtr->q.z = jointframe2[2];
-            jointPtr->q.w = jointPtr->q.CalcW();
-            blendPtr->q.w = blendPtr->q.CalcW();
-            break;
-        }
+            if (numLanes > 0) {
+                PadSampleLanes(groups, numLanes);
 
-        switch (animBits & (Sx | Sy | Sz)) {
-        case 0:
-            blendPtr->s = jointPtr->s;
-            break;
-        case Sx:
-            jointPtr->s.x = jointframe1[0];
-            blendPtr->s.x = jointframe2[0];
-            blendPtr->s.y = jointPtr->s.y;
-            blendPtr->s.z = jointPtr->s.z;
-            jointframe1++;
-            jointframe2++;
-            break;
-        case Sy:
-            jointPtr->s.y = jointframe1[0];
-            blendPtr->s.y = jointframe2[0];
-            blendPtr->s.x = jointPtr->s.x;
-            blendPtr->s.z = jointPtr->s.z;
-            jointframe1++;
-            jointframe2++;
-            break;
-        case Sz:
-            jointPtr->s.z = jointframe1[0];
-            blendPtr->s.z = jointframe2[0];
-            blendPtr->s.x = jointPtr->s.x;
-            blendPtr->s.y = jointPtr->s.y;
-            jointframe1++;
-            jointframe2++;
-            break;
-        case Sx | Sy:
-            jointPtr->s.x = jointframe1[0];
-            jointPtr->s.y = jointframe1[1];
-            blendPtr->s.x = jointframe2[0];
-            blendPtr->s.y = jointframe2[1];
-            blendPtr->s.z = jointPtr->s.z;
-            jointframe1 += 2;
-            jointframe2 += 2;
-            break;
-        case Sx | Sz:
-            jointPtr->s.x = jointframe1[0];
-            jointPtr->s.z = jointframe1[1];
-            blendPtr->s.x = jointframe2[0];
-            blendPtr->s.z = jointframe2[1];
-            blendPtr->s.y = jointPtr->s.y;
-            jointframe1 += 2;
-            jointframe2 += 2;
-            break;
-        case Sy | Sz:
-            jointPtr->s.y = jointframe1[0];
-            jointPtr->s.z = jointframe1[1];
-            blendPtr->s.y = jointframe2[0];
-            blendPtr->s.z = jointframe2[1];
-            blendPtr->s.x = jointPtr->s.x;
-            jointframe1 += 2;
-            jointframe2 += 2;
-            break;
-        case Sx | Sy | Sz:
-            jointPtr->s.x = jointframe1[0];
-            jointPtr->s.y = jointframe1[1];
-            jointPtr->s.z = jointframe1[2];
-            blendPtr->s.x = jointframe2[0];
-            blendPtr->s.y = jointframe2[1];
-            blendPtr->s.z = jointframe2[2];
-            jointframe1 += 3;
-            jointframe2 += 3;
-            break;
+                simdProcessor->SampleJoints(joints, groups, (numLanes + 3) / 4, frame1, frame2, frame.backlerp);
+            }
         }
     }
 
-    simdProcessor->BlendJoints(joints, blendJoints, frame.backlerp, lerpIndex, numLerpJoints);
-
 #if CYCLIC_DELTA_MOVEMENT
     if (frame.cycleCount) {
         joints[0].t += totalDelta * (float)frame.cycleCount;
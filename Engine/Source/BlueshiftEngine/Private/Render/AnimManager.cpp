@@ -22,10 +22,12 @@ AnimManager     animManager;
 
 void AnimManager::Init() {
     cmdSystem.AddCommand(L"listAnims", Cmd_ListAnims);
+    cmdSystem.AddCommand(L"compressAnim", Cmd_CompressAnim);
 }
 
 void AnimManager::Shutdown() {
     cmdSystem.RemoveCommand(L"listAnims");
+    cmdSystem.RemoveCommand(L"compressAnim");
         
     animHashMap.DeleteContents(true);
     
@@ -115,6 +117,8 @@ Anim *AnimManager::FindAnim(const char *hashName) const {
 }
 
 Anim *AnimManager::GetAnim(const char *name) {
+    MemTagScope tagScope(MemTag::Anim);
+
     Anim *anim = FindAnim(name);
     if (anim) {
         anim->refCount++;
@@ -184,4 +188,34 @@ void AnimManager::Cmd_ListAnims(const CmdArgs &args) {
     BE_LOG(L"total %hs used in %i joint names\n", Str::FormatBytes((int)namesize).c_str(), animManager.jointNameList.Count());
 }
 
+void AnimManager::Cmd_CompressAnim(const CmdArgs &args) {
+    if (args.Argc() < 2 || args.Argc() > 3) {
+        BE_LOG(L"compressAnim <filename> [maxErrorCentimeters]\n");
+        return;
+    }
+
+    float maxError = CentiToUnit(0.01f);
+    if (args.Argc() == 3) {
+        maxError = CentiToUnit((float)atof(WStr::ToStr(args.Argv(2))));
+    }
+
+    Anim *anim = animManager.GetAnim(WStr::ToStr(args.Argv(1)));
+    if (!anim) {
+        return;
+    }
+
+    if (anim->IsCompressed()) {
+        anim->Decompress();
+    }
+    anim->Compress(maxError);
+
+    Str filename = anim->hashName;
+    filename.SetFileExtension(".banim");
+    anim->Write(filename);
+
+    BE_LOG(L"'%hs' written with compressed frames\n", filename.c_str());
+
+    animManager.ReleaseAnim(anim);
+}
+
 BE_NAMESPACE_END
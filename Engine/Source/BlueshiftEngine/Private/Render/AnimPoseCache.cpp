@@ -0,0 +1,151 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "SIMD/Simd.h"
+
+BE_NAMESPACE_BEGIN
+
+AnimPoseCache   animPoseCache;
+
+// cycleCount is not a part of the key, the frames of the different cycles are the same without CYCLIC_DELTA_MOVEMENT
+static int HashFrameInterpolation(const Anim *anim, const Anim::FrameInterpolation &frameInterpolation, const int *jointIndexes) {
+    return (int)(((uintptr_t)anim >> 4) * 31 + ((uintptr_t)jointIndexes >> 4) * 17 + frameInterpolation.frame1 * 131 + frameInterpolation.frame2 * 7 + (int)(frameInterpolation.backlerp * 1024.0f));
+}
+
+AnimPoseCache::AnimPoseCache() {
+    enabled = false;
+    backlerpSteps = 0;
+    mutex = nullptr;
+    numHits = 0;
+    numMisses = 0;
+}
+
+void AnimPoseCache::Init() {
+    mutex = PlatformMutex::Create();
+
+    entries.SetGranularity(64);
+    poses.SetGranularity(4096);
+}
+
+void AnimPoseCache::Shutdown() {
+    entries.Clear();
+    entryHash.Free();
+    poses.Clear();
+
+    PlatformMutex::Delete(mutex);
+    mutex = nullptr;
+
+    enabled = false;
+}
+
+void AnimPoseCache::BeginFrame(bool enable, int backlerpSteps) {
+    this->enabled = enable && mutex != nullptr;
+    this->backlerpSteps = Max(backlerpSteps, 0);
+
+    entries.SetCount(0, false);
+    entryHash.Clear();
+    poses.SetCount(0, false);
+
+    numHits = 0;
+    numMisses = 0;
+}
+
+void AnimPoseCache::EndFrame() {
+    enabled = false;
+
+    entries.SetCount(0, false);
+    entryHash.Clear();
+    poses.SetCount(0, false);
+}
+
+int AnimPoseCache::FindEntry(const Anim *anim, const Anim::FrameInterpolation &frameInterpolation, const int *jointIndexes, int hash) const {
+    for (int i = entryHash.First(hash); i != -1; i = entryHash.Next(i)) {
+        const Entry &entry = entries[i];
+
+        if (entry.anim == anim && entry.jointIndexes == jointIndexes &&
+            entry.frame1 == frameInterpolation.frame1 && entry.frame2 == frameInterpolation.frame2 && entry.backlerp == frameInterpolation.backlerp) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void AnimPoseCache::GetInterpolatedFrame(const Anim *anim, const Anim::FrameInterpolation &frameInterpolation, int numJointIndexes, const int *jointIndexes, JointPose *joints) {
+    Anim::FrameInterpolation frame = frameInterpolation;
+
+    const int numJoints = anim->NumJoints();
+
+    if (!enabled) {
+        anim->GetInterpolatedFrame(frame, numJointIndexes, jointIndexes, joints);
+        return;
+    }
+
+    if (backlerpSteps > 0) {
+        frame.backlerp = Math::Floor(frame.backlerp * backlerpSteps + 0.5f) / backlerpSteps;
+        if (frame.backlerp >= 1.0f) {
+            frame.frame1 = frame.frame2;
+            frame.backlerp = 0.0f;
+        }
+    }
+
+    // All joints are the same set whatever the index array is
+    const int *maskKey = numJointIndexes == numJoints ? nullptr : jointIndexes;
+
+    const int hash = HashFrameInterpolation(anim, frame, maskKey);
+
+    PlatformMutex::Lock(mutex);
+
+    int entryIndex = FindEntry(anim, frame, maskKey, hash);
+    if (entryIndex >= 0) {
+        simdProcessor->Memcpy(joints, &poses[entries[entryIndex].firstPose], numJoints * sizeof(joints[0]));
+        numHits++;
+
+        PlatformMutex::Unlock(mutex);
+        return;
+    }
+
+    PlatformMutex::Unlock(mutex);
+
+    // Sampled out of the lock. Other jobs may sample the same frame meanwhile, but only the first one is cached
+    anim->GetInterpolatedFrame(frame, numJointIndexes, jointIndexes, joints);
+
+    PlatformMutex::Lock(mutex);
+
+    numMisses++;
+
+    if (FindEntry(anim, frame, maskKey, hash) < 0) {
+        entryIndex = entries.Count();
+
+        Entry &entry = entries.Alloc();
+        entry.anim = anim;
+        entry.frame1 = frame.frame1;
+        entry.frame2 = frame.frame2;
+        entry.backlerp = frame.backlerp;
+        entry.jointIndexes = maskKey;
+        entry.firstPose = poses.Count();
+
+        // Capacity is kept over the frames, so it grows only in the first few frames
+        poses.Reserve(poses.Count() + numJoints);
+        poses.SetCount(poses.Count() + numJoints, false);
+        simdProcessor->Memcpy(&poses[entry.firstPose], joints, numJoints * sizeof(joints[0]));
+
+        entryHash.Add(hash, entryIndex);
+    }
+
+    PlatformMutex::Unlock(mutex);
+}
+
+BE_NAMESPACE_END
@@ -95,10 +95,49 @@ bool Anim::LoadBAnim(const char *filename) {
     }
 
     // --- frames ---
-    frameComponents.SetGranularity(1);
-    frameComponents.SetCount(numAnimatedComponents * numFrames);
-    memcpy(frameComponents.Ptr(), ptr, frameComponents.MemoryUsed());
-    ptr += frameComponents.MemoryUsed();
+    uint32_t frameFormat = RawFrameFormat;
+    if (bAnimHeader->version >= 2) {
+        frameFormat = *(const uint32_t *)ptr;
+        ptr += sizeof(frameFormat);
+    }
+
+    if (frameFormat == CompressedFrameFormat) {
+        int numKeys = *(const int *)ptr;
+        ptr += sizeof(numKeys);
+
+        compressedTracks.SetGranularity(1);
+        compressedTracks.SetCount(numJoints * NumTrackTypes);
+        for (int trackIndex = 0; trackIndex < compressedTracks.Count(); trackIndex++) {
+            BAnimTrack bAnimTrack;
+            memcpy(&bAnimTrack, ptr, sizeof(bAnimTrack));
+            ptr += sizeof(bAnimTrack);
+
+            CompressedTrack *track = &compressedTracks[trackIndex];
+            track->firstKey = bAnimTrack.firstKey;
+            track->numKeys = bAnimTrack.numKeys;
+            track->rangeMin = bAnimTrack.rangeMin;
+            track->rangeScale = bAnimTrack.rangeScale;
+        }
+
+        keyFrameNums.SetGranularity(1);
+        keyFrameNums.SetCount(numKeys);
+        memcpy(keyFrameNums.Ptr(), ptr, keyFrameNums.MemoryUsed());
+        ptr += keyFrameNums.MemoryUsed();
+
+        // padding word for the SIMD loads of the last key
+        keyValues.SetGranularity(1);
+        keyValues.SetCount(numKeys * 3 + 1);
+        memcpy(keyValues.Ptr(), ptr, numKeys * 3 * sizeof(keyValues[0]));
+        ptr += numKeys * 3 * sizeof(keyValues[0]);
+        keyValues[numKeys * 3] = 0;
+
+        isCompressed = true;
+    } else {
+        frameComponents.SetGranularity(1);
+        frameComponents.SetCount(numAnimatedComponents * numFrames);
+        memcpy(frameComponents.Ptr(), ptr, frameComponents.MemoryUsed());
+        ptr += frameComponents.MemoryUsed();
+    }
 
     // --- total delta ---
     memcpy(&totalDelta, ptr, sizeof(totalDelta));
@@ -106,6 +145,8 @@ bool Anim::LoadBAnim(const char *filename) {
 
     fileSystem.FreeFile(data);
 
+    ComputeSamplingPlan();
+
     return true;
 }
 
@@ -161,7 +202,29 @@ void Anim::WriteBAnim(const char *filename) {
     }
 
     // --- frames ---
-    fp->Write(frameComponents.Ptr(), frameComponents.MemoryUsed());
+    if (isCompressed) {
+        fp->WriteUInt32(CompressedFrameFormat);
+
+        int numKeys = keyFrameNums.Count();
+        fp->Write(&numKeys, sizeof(numKeys));
+
+        for (int trackIndex = 0; trackIndex < compressedTracks.Count(); trackIndex++) {
+            const CompressedTrack *track = &compressedTracks[trackIndex];
+
+            BAnimTrack bAnimTrack;
+            bAnimTrack.firstKey = track->firstKey;
+            bAnimTrack.numKeys = track->numKeys;
+            bAnimTrack.rangeMin = track->rangeMin;
+            bAnimTrack.rangeScale = track->rangeScale;
+            fp->Write(&bAnimTrack, sizeof(bAnimTrack));
+        }
+
+        fp->Write(keyFrameNums.Ptr(), keyFrameNums.MemoryUsed());
+        fp->Write(keyValues.Ptr(), numKeys * 3 * sizeof(keyValues[0]));
+    } else {
+        fp->WriteUInt32(RawFrameFormat);
+        fp->Write(frameComponents.Ptr(), frameComponents.MemoryUsed());
+    }
     
     // --- total delta ---
     fp->Write(&totalDelta, sizeof(totalDelta));
@@ -0,0 +1,436 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "Core/JointPose.h"
+#include "SIMD/Simd.h"
+#include <algorithm>
+
+BE_NAMESPACE_BEGIN
+
+static const int animBitsOfTrack[Anim::NumTrackTypes] = {
+    Anim::Tx | Anim::Ty | Anim::Tz,
+    Anim::Qx | Anim::Qy | Anim::Qz,
+    Anim::Sx | Anim::Sy | Anim::Sz
+};
+
+static void WriteFrameComponents(const Anim::JointInfo &info, const JointPose &joint, float *componentPtr) {
+    if (info.animBits & Anim::Tx) {
+        *componentPtr++ = joint.t.x;
+    }
+    if (info.animBits & Anim::Ty) {
+        *componentPtr++ = joint.t.y;
+    }
+    if (info.animBits & Anim::Tz) {
+        *componentPtr++ = joint.t.z;
+    }
+
+    if (info.animBits & (Anim::Qx | Anim::Qy | Anim::Qz)) {
+        // w is recalculated as positive value from x, y, z
+        const float sign = joint.q.w < 0.0f ? -1.0f : 1.0f;
+
+        if (info.animBits & Anim::Qx) {
+            *componentPtr++ = joint.q.x * sign;
+        }
+        if (info.animBits & Anim::Qy) {
+            *componentPtr++ = joint.q.y * sign;
+        }
+        if (info.animBits & Anim::Qz) {
+            *componentPtr++ = joint.q.z * sign;
+        }
+    }
+
+    if (info.animBits & Anim::Sx) {
+        *componentPtr++ = joint.s.x;
+    }
+    if (info.animBits & Anim::Sy) {
+        *componentPtr++ = joint.s.y;
+    }
+    if (info.animBits & Anim::Sz) {
+        *componentPtr++ = joint.s.z;
+    }
+}
+
+// Finds the keys to interpolate at framePos. The first and the last frame are always keys.
+static BE_FORCE_INLINE void FindKeys(const Anim::CompressedTrack &track, const uint16_t *keyFrameNums, float framePos, int &key0, int &key1, float &fraction) {
+    if (track.numKeys == 1) {
+        key0 = track.firstKey;
+        key1 = track.firstKey;
+        fraction = 0.0f;
+        return;
+    }
+
+    const uint16_t *first = keyFrameNums + track.firstKey;
+    const uint16_t *next = std::upper_bound(first + 1, first + track.numKeys - 1, framePos);
+
+    key1 = (int)(next - keyFrameNums);
+    key0 = key1 - 1;
+
+    const float frameNum0 = (float)keyFrameNums[key0];
+    const float frameNum1 = (float)keyFrameNums[key1];
+    fraction = Clamp((framePos - frameNum0) / (frameNum1 - frameNum0), 0.0f, 1.0f);
+}
+
+// Reduces the keys greedily, each segment is extended as long as the frames in between are interpolated within the tolerance.
+// error(key0, key1, frameNum) returns the error of interpolating the quantized keys at key0 and key1 at frameNum.
+template <typename ErrorFunc>
+static void ReduceKeys(int numFrames, float tolerance, ErrorFunc error, Array<int> &keyFrameNums) {
+    keyFrameNums.SetCount(0, false);
+    keyFrameNums.Append(0);
+
+    bool constant = true;
+    for (int frameNum = 1; frameNum < numFrames; frameNum++) {
+        if (error(0, 0, frameNum) > tolerance) {
+            constant = false;
+            break;
+        }
+    }
+
+    if (constant) {
+        return;
+    }
+
+    int key0 = 0;
+    while (key0 < numFrames - 1) {
+        int key1 = key0 + 1;
+
+        while (key1 + 1 < numFrames) {
+            const int candidate = key1 + 1;
+
+            bool fits = true;
+            for (int frameNum = key0 + 1; frameNum < candidate; frameNum++) {
+                if (error(key0, candidate, frameNum) > tolerance) {
+                    fits = false;
+                    break;
+                }
+            }
+
+            if (!fits) {
+                break;
+            }
+            key1 = candidate;
+        }
+
+        keyFrameNums.Append(key1);
+        key0 = key1;
+    }
+}
+
+void Anim::GetRawFrame(int frameNum, JointPose *joints) const {
+    simdProcessor->Memcpy(joints, baseFrame.Ptr(), baseFrame.Count() * sizeof(baseFrame[0]));
+
+    const float *frame = &frameComponents[frameNum * numAnimatedComponents];
+
+    for (int jointIndex = 0; jointIndex < numJoints; jointIndex++) {
+        const JointInfo *infoPtr = &jointInfo[jointIndex];
+        const float *componentPtr = frame + infoPtr->firstComponent;
+        JointPose *jointPtr = &joints[jointIndex];
+
+        if (infoPtr->animBits & Tx) {
+            jointPtr->t.x = *componentPtr++;
+        }
+        if (infoPtr->animBits & Ty) {
+            jointPtr->t.y = *componentPtr++;
+        }
+        if (infoPtr->animBits & Tz) {
+            jointPtr->t.z = *componentPtr++;
+        }
+
+        if (infoPtr->animBits & (Qx | Qy | Qz)) {
+            if (infoPtr->animBits & Qx) {
+                jointPtr->q.x = *componentPtr++;
+            }
+            if (infoPtr->animBits & Qy) {
+                jointPtr->q.y = *componentPtr++;
+            }
+            if (infoPtr->animBits & Qz) {
+                jointPtr->q.z = *componentPtr++;
+            }
+            jointPtr->q.w = jointPtr->q.CalcW();
+        }
+
+        if (infoPtr->animBits & Sx) {
+            jointPtr->s.x = *componentPtr++;
+        }
+        if (infoPtr->animBits & Sy) {
+            jointPtr->s.y = *componentPtr++;
+        }
+        if (infoPtr->animBits & Sz) {
+            jointPtr->s.z = *componentPtr++;
+        }
+    }
+}
+
+void Anim::GetCompressedFrame(float framePos, int numJointIndexes, const int *jointIndexes, JointPose *joints) const {
+    const int maxTracks = numJointIndexes * NumTrackTypes;
+
+    int *keyIndexes0 = (int *)_alloca16(maxTracks * sizeof(keyIndexes0[0]));
+    int *keyIndexes1 = (int *)_alloca16(maxTracks * sizeof(keyIndexes1[0]));
+    float *fractions = (float *)_alloca16(maxTracks * sizeof(fractions[0]));
+    Vec3 *rangeMins = (Vec3 *)_alloca16(maxTracks * sizeof(rangeMins[0]));
+    Vec3 *rangeScales = (Vec3 *)_alloca16(maxTracks * sizeof(rangeScales[0]));
+    Vec3 *vecs = (Vec3 *)_alloca16(maxTracks * sizeof(vecs[0]));
+    Vec3 **vecDsts = (Vec3 **)_alloca16(maxTracks * sizeof(vecDsts[0]));
+    Quat *quats = (Quat *)_alloca16(numJointIndexes * sizeof(quats[0]));
+    Quat **quatDsts = (Quat **)_alloca16(numJointIndexes * sizeof(quatDsts[0]));
+
+    // rotation keys are gathered from the end of the same arrays
+    int *quatKeyIndexes0 = keyIndexes0 + maxTracks - numJointIndexes;
+    int *quatKeyIndexes1 = keyIndexes1 + maxTracks - numJointIndexes;
+    float *quatFractions = fractions + maxTracks - numJointIndexes;
+
+    int numVecs = 0;
+    int numQuats = 0;
+
+    for (int i = 0; i < numJointIndexes; i++) {
+        const int jointIndex = jointIndexes[i];
+        const CompressedTrack *tracks = &compressedTracks[jointIndex * NumTrackTypes];
+        JointPose *jointPtr = &joints[jointIndex];
+
+        if (tracks[TranslationTrack].numKeys > 0) {
+            FindKeys(tracks[TranslationTrack], keyFrameNums.Ptr(), framePos, keyIndexes0[numVecs], keyIndexes1[numVecs], fractions[numVecs]);
+            rangeMins[numVecs] = tracks[TranslationTrack].rangeMin;
+            rangeScales[numVecs] = tracks[TranslationTrack].rangeScale;
+            vecDsts[numVecs++] = &jointPtr->t;
+        }
+
+        if (tracks[ScaleTrack].numKeys > 0) {
+            FindKeys(tracks[ScaleTrack], keyFrameNums.Ptr(), framePos, keyIndexes0[numVecs], keyIndexes1[numVecs], fractions[numVecs]);
+            rangeMins[numVecs] = tracks[ScaleTrack].rangeMin;
+            rangeScales[numVecs] = tracks[ScaleTrack].rangeScale;
+            vecDsts[numVecs++] = &jointPtr->s;
+        }
+
+        if (tracks[RotationTrack].numKeys > 0) {
+            FindKeys(tracks[RotationTrack], keyFrameNums.Ptr(), framePos, quatKeyIndexes0[numQuats], quatKeyIndexes1[numQuats], quatFractions[numQuats]);
+            quatDsts[numQuats++] = &jointPtr->q;
+        }
+    }
+
+    simdProcessor->DecompressVec3Keys(vecs, keyValues.Ptr(), keyIndexes0, keyIndexes1, fractions, rangeMins, rangeScales, numVecs);
+    simdProcessor->DecompressQuatKeys(quats, keyValues.Ptr(), quatKeyIndexes0, quatKeyIndexes1, quatFractions, numQuats);
+
+    for (int i = 0; i < numVecs; i++) {
+        *vecDsts[i] = vecs[i];
+    }
+
+    for (int i = 0; i < numQuats; i++) {
+        *quatDsts[i] = quats[i];
+    }
+}
+
+void Anim::Compress(float maxError, float skinDistance) {
+    if (isCompressed || !numAnimatedComponents) {
+        return;
+    }
+
+    if (numFrames > 65535) {
+        BE_WARNLOG(L"Anim::Compress: '%hs' has too many frames to compress\n", hashName.c_str());
+        return;
+    }
+
+    size_t oldSize = Allocated();
+
+    Array<JointPose> framePoses;
+    framePoses.SetCount(numFrames * numJoints);
+
+    for (int frameNum = 0; frameNum < numFrames; frameNum++) {
+        GetRawFrame(frameNum, &framePoses[frameNum * numJoints]);
+    }
+
+    // Error bound of each track in world space along the joint hierarchy.
+    // Rotation and scale errors of a joint move the descendant joints and the virtual vertices by its reach,
+    // and the errors of all the tracks on the path from the root to a leaf joint are accumulated.
+    Array<float> maxScale;
+    Array<float> worldScale;
+    Array<float> worldReach;
+    Array<int> jointTracks;
+    Array<int> upTracks;
+    Array<int> downTracks;
+    maxScale.SetCount(numJoints);
+    worldScale.SetCount(numJoints);
+    worldReach.SetCount(numJoints);
+    jointTracks.SetCount(numJoints);
+    upTracks.SetCount(numJoints);
+    downTracks.SetCount(numJoints);
+
+    for (int jointIndex = 0; jointIndex < numJoints; jointIndex++) {
+        const int parentIndex = jointInfo[jointIndex].parentNum;
+        assert(parentIndex < jointIndex);
+
+        maxScale[jointIndex] = 0.0f;
+        for (int frameNum = 0; frameNum < numFrames; frameNum++) {
+            const Vec3 &s = framePoses[frameNum * numJoints + jointIndex].s;
+            maxScale[jointIndex] = Max(maxScale[jointIndex], Max3(Math::Fabs(s.x), Math::Fabs(s.y), Math::Fabs(s.z)));
+        }
+        worldScale[jointIndex] = (parentIndex >= 0 ? worldScale[parentIndex] : 1.0f) * maxScale[jointIndex];
+
+        jointTracks[jointIndex] = 0;
+        for (int trackType = 0; trackType < NumTrackTypes; trackType++) {
+            jointTracks[jointIndex] += (jointInfo[jointIndex].animBits & animBitsOfTrack[trackType]) ? 1 : 0;
+        }
+        upTracks[jointIndex] = (parentIndex >= 0 ? upTracks[parentIndex] : 0) + jointTracks[jointIndex];
+        downTracks[jointIndex] = jointTracks[jointIndex];
+        worldReach[jointIndex] = skinDistance;
+    }
+
+    for (int jointIndex = numJoints - 1; jointIndex > 0; jointIndex--) {
+        const int parentIndex = jointInfo[jointIndex].parentNum;
+        if (parentIndex < 0) {
+            continue;
+        }
+
+        float maxLength = 0.0f;
+        for (int frameNum = 0; frameNum < numFrames; frameNum++) {
+            maxLength = Max(maxLength, framePoses[frameNum * numJoints + jointIndex].t.Length());
+        }
+
+        worldReach[parentIndex] = Max(worldReach[parentIndex], maxLength * worldScale[parentIndex] + worldReach[jointIndex]);
+        downTracks[parentIndex] = Max(downTracks[parentIndex], jointTracks[parentIndex] + downTracks[jointIndex]);
+    }
+
+    Array<uint16_t> quantizedKeys;
+    Array<int> reducedKeyFrameNums;
+    Array<float> frameFractions;
+    quantizedKeys.SetCount(numFrames * 3 + 1);
+    quantizedKeys[numFrames * 3] = 0;
+
+    compressedTracks.SetGranularity(1);
+    compressedTracks.SetCount(numJoints * NumTrackTypes);
+    keyFrameNums.Clear();
+    keyValues.Clear();
+
+    for (int jointIndex = 0; jointIndex < numJoints; jointIndex++) {
+        const int parentIndex = jointInfo[jointIndex].parentNum;
+        const int pathTracks = upTracks[jointIndex] + downTracks[jointIndex] - jointTracks[jointIndex];
+        const float tolerance = maxError / Max(pathTracks, 1);
+        const float parentWorldScale = parentIndex >= 0 ? worldScale[parentIndex] : 1.0f;
+
+        for (int trackType = 0; trackType < NumTrackTypes; trackType++) {
+            CompressedTrack &track = compressedTracks[jointIndex * NumTrackTypes + trackType];
+            track.firstKey = keyFrameNums.Count();
+            track.numKeys = 0;
+            track.rangeMin.SetFromScalar(0);
+            track.rangeScale.SetFromScalar(0);
+
+            if (!(jointInfo[jointIndex].animBits & animBitsOfTrack[trackType])) {
+                continue;
+            }
+
+            if (trackType == RotationTrack) {
+                for (int frameNum = 0; frameNum < numFrames; frameNum++) {
+                    QuantizedJointKey::QuantizeQuat(framePoses[frameNum * numJoints + jointIndex].q, &quantizedKeys[frameNum * 3]);
+                }
+
+                // chord length of the rotation angle times reach
+                const float reach = worldReach[jointIndex];
+
+                ReduceKeys(numFrames, tolerance, [&](int key0, int key1, int frameNum) {
+                    const float fraction = key0 != key1 ? (float)(frameNum - key0) / (key1 - key0) : 0.0f;
+                    Quat q;
+                    simdProcessor->DecompressQuatKeys(&q, quantizedKeys.Ptr(), &key0, &key1, &fraction, 1);
+
+                    const Quat &original = framePoses[frameNum * numJoints + jointIndex].q;
+                    const float dot = q.x * original.x + q.y * original.y + q.z * original.z + q.w * original.w;
+                    return 2.0f * Math::Sqrt(Max(1.0f - dot * dot, 0.0f)) * reach;
+                }, reducedKeyFrameNums);
+            } else {
+                Vec3 rangeMax;
+                track.rangeMin = trackType == TranslationTrack ? framePoses[jointIndex].t : framePoses[jointIndex].s;
+                rangeMax = track.rangeMin;
+
+                for (int frameNum = 1; frameNum < numFrames; frameNum++) {
+                    const JointPose &pose = framePoses[frameNum * numJoints + jointIndex];
+                    const Vec3 &v = trackType == TranslationTrack ? pose.t : pose.s;
+                    for (int i = 0; i < 3; i++) {
+                        track.rangeMin[i] = Min(track.rangeMin[i], v[i]);
+                        rangeMax[i] = Max(rangeMax[i], v[i]);
+                    }
+                }
+
+                track.rangeScale = (rangeMax - track.rangeMin) * (1.0f / 65535.0f);
+
+                for (int frameNum = 0; frameNum < numFrames; frameNum++) {
+                    const JointPose &pose = framePoses[frameNum * numJoints + jointIndex];
+                    QuantizedJointKey::QuantizeVec3(trackType == TranslationTrack ? pose.t : pose.s, track.rangeMin, track.rangeScale, &quantizedKeys[frameNum * 3]);
+                }
+
+                // translation error moves the descendants as it is, scale error moves them by reach
+                const float errorScale = trackType == TranslationTrack ? parentWorldScale : worldReach[jointIndex] / Max(maxScale[jointIndex], FLT_EPSILON);
+
+                ReduceKeys(numFrames, tolerance, [&](int key0, int key1, int frameNum) {
+                    const float fraction = key0 != key1 ? (float)(frameNum - key0) / (key1 - key0) : 0.0f;
+                    Vec3 v;
+                    simdProcessor->DecompressVec3Keys(&v, quantizedKeys.Ptr(), &key0, &key1, &fraction, &track.rangeMin, &track.rangeScale, 1);
+
+                    const JointPose &pose = framePoses[frameNum * numJoints + jointIndex];
+                    return v.Distance(trackType == TranslationTrack ? pose.t : pose.s) * errorScale;
+                }, reducedKeyFrameNums);
+            }
+
+            track.numKeys = reducedKeyFrameNums.Count();
+
+            for (int keyIndex = 0; keyIndex < reducedKeyFrameNums.Count(); keyIndex++) {
+                const int frameNum = reducedKeyFrameNums[keyIndex];
+                keyFrameNums.Append((uint16_t)frameNum);
+                keyValues.Append(quantizedKeys[frameNum * 3 + 0]);
+                keyValues.Append(quantizedKeys[frameNum * 3 + 1]);
+                keyValues.Append(quantizedKeys[frameNum * 3 + 2]);
+            }
+        }
+    }
+
+    // padding word for the SIMD loads of the last key
+    keyValues.Append(0);
+
+    frameComponents.Clear();
+    isCompressed = true;
+
+    BE_LOG(L"anim '%hs' compressed (%hs -> %hs, %i keys)\n", hashName.c_str(),
+        Str::FormatBytes((int)oldSize).c_str(), Str::FormatBytes((int)Allocated()).c_str(), keyFrameNums.Count());
+}
+
+void Anim::Decompress() {
+    if (!isCompressed) {
+        return;
+    }
+
+    int *jointIndexes = (int *)_alloca16(numJoints * sizeof(jointIndexes[0]));
+    for (int i = 0; i < numJoints; i++) {
+        jointIndexes[i] = i;
+    }
+
+    JointPose *joints = (JointPose *)_alloca16(numJoints * sizeof(joints[0]));
+
+    frameComponents.SetGranularity(1);
+    frameComponents.SetCount(numAnimatedComponents * numFrames);
+
+    for (int frameNum = 0; frameNum < numFrames; frameNum++) {
+        simdProcessor->Memcpy(joints, baseFrame.Ptr(), baseFrame.Count() * sizeof(baseFrame[0]));
+
+        GetCompressedFrame((float)frameNum, numJoints, jointIndexes, joints);
+
+        for (int jointIndex = 0; jointIndex < numJoints; jointIndex++) {
+            WriteFrameComponents(jointInfo[jointIndex], joints[jointIndex], &frameComponents[frameNum * numAnimatedComponents + jointInfo[jointIndex].firstComponent]);
+        }
+    }
+
+    compressedTracks.Clear();
+    keyFrameNums.Clear();
+    keyValues.Clear();
+    isCompressed = false;
+}
+
+BE_NAMESPACE_END
@@ -20,10 +20,10 @@ BE_NAMESPACE_BEGIN
 #define BSKEL_VERSION   1
 
 #define BMESH_IDENT     MAKE_FOURCC('B', 'E', 'M', '1')
-#define BMESH_VERSION   1
+#define BMESH_VERSION   3  // version 2 adds LOD levels after the surfaces, version 3 adds compact vertices
 
 #define BANIM_IDENT     MAKE_FOURCC('B', 'E', 'A', '1')
-#define BANIM_VERSION   1
+#define BANIM_VERSION   2  // version 2 adds compressed frames
 
 enum BAnimFlag {
     RootTranslationXY        = BIT(0),
@@ -60,6 +60,18 @@ struct BMeshSurf {
     uint32_t        maxWeights;
 };
 
+// Written as uint32_t after BMeshSurf from version 3
+enum BMeshVertexFormat {
+    GenericVertexFormat     = 0,    // followed by numVerts BMeshVert
+    CompactVertexFormat     = 1     // followed by BMeshCompactBounds and numVerts BMeshCompactVert
+};
+
+// Followed by numSurfs surfaces in the same layout as the base surfaces
+struct BMeshLod {
+    float           screenSize;
+    uint32_t        numSurfs;
+};
+
 struct BMeshVert {
     Vec3            position;
     Vec2            texCoord;
@@ -69,6 +81,20 @@ struct BMeshVert {
     byte            color[4];
 };
 
+// Dequantizes positions of the compact vertices (position = xyz / 32767 * positionScale + positionBias)
+struct BMeshCompactBounds {
+    Vec3            positionScale;
+    Vec3            positionBias;
+};
+
+// Same layout as VertexCompact
+struct BMeshCompactVert {
+    int16_t         position[4];
+    uint16_t        texCoord[2];        // half floats
+    byte            normalTangent[4];
+    byte            color[4];
+};
+
 struct BAnimHeader {
     int32_t         ident;
     int32_t         version;
@@ -87,6 +113,20 @@ struct BAnimJoint {
     int32_t         firstComponent;
 };
 
+// Written as uint32_t after the base frame from version 2
+enum BAnimFrameFormat {
+    RawFrameFormat          = 0,    // followed by numFrames * numAnimatedComponents floats
+    CompressedFrameFormat   = 1     // followed by uint32_t numKeys, numJoints * 3 BAnimTrack, numKeys uint16_t frame numbers and numKeys * 3 uint16_t values
+};
+
+// Same layout as Anim::CompressedTrack
+struct BAnimTrack {
+    int32_t         firstKey;
+    int32_t         numKeys;
+    Vec3            rangeMin;
+    Vec3            rangeScale;
+};
+
 #pragma pack()
 
 BE_NAMESPACE_END
@@ -20,7 +20,6 @@
 BE_NAMESPACE_BEGIN
 
 #define PINNED_MEMORY   1
-#define PERSISTENT_MAP  0
 
 BufferCacheManager      bufferCacheManager;
 
@@ -83,12 +82,21 @@ void BufferCacheManager::Init() {
     mostUsedTexelMem = 0;
 
 #if PINNED_MEMORY
-    MapBufferSet(frameData[mappedNum]);
-#if PERSISTENT_MAP
-    for (int i = mappedNum + 1; i < COUNT_OF(frameData); i++) {
-        MapBufferSet(frameData[i]);
+    // Persistently mapped buffer sets work as a ring of frames, the CPU writes directly to the mapped memory
+    // of the frame which the GPU finished reading. Otherwise the buffers are orphaned and mapped every frame.
+    persistentMap = r_usePersistentMappedBuffers.GetBool() && glr.SupportsBufferStorage();
+
+    if (persistentMap) {
+        for (int i = 0; i < COUNT_OF(frameData); i++) {
+            MapBufferSet(frameData[i]);
+        }
+    } else {
+        MapBufferSet(frameData[mappedNum]);
     }
-#endif
+
+    BE_LOG(L"dynamic buffers %hs\n", persistentMap ? "persistently mapped" : "orphaned every frame");
+#else
+    persistentMap = false;
 #endif
 }
 
@@ -120,11 +128,7 @@ void BufferCacheManager::Shutdown() {
 
 void BufferCacheManager::MapBufferSet(FrameDataBufferSet &bufferSet) {
 #if PINNED_MEMORY
-#if PERSISTENT_MAP
-    Renderer::BufferLockMode lockMode = Renderer::WriteOnlyPersistent;
-#else
-    Renderer::BufferLockMode lockMode = Renderer::WriteOnly;
-#endif
+    Renderer::BufferLockMode lockMode = persistentMap ? Renderer::WriteOnlyPersistent : Renderer::WriteOnlyOrphan;
 
     if (!bufferSet.mappedVertexBase) {
         glr.BindBuffer(Renderer::VertexBuffer, bufferSet.vertexBuffer);
@@ -173,15 +177,32 @@ void BufferCacheManager::UnmapBufferSet(FrameDataBufferSet &bufferSet) {
 
 void BufferCacheManager::BeginWrite() {
 #if PINNED_MEMORY
+    // Orphaned buffers get a new data store, only the persistently mapped ones need to wait for the GPU
+    if (!persistentMap) {
+        return;
+    }
+
     // Wait until the gpu is no longer using the buffer
     if (frameData[mappedNum].sync != Renderer::NullSync) {
+        const uint64_t startWait = PlatformTime::Microseconds();
         glr.WaitSync(frameData[mappedNum].sync);
+        const uint64_t endWait = PlatformTime::Microseconds();
+        if (r_showBufferCacheTiming.GetBool() && endWait - startWait > 1000) {
+            BE_DLOG(L"BufferCacheManager::BeginWrite: wait sync took %i msec\n", (int)((endWait - startWait) / 1000));
+        }
+
+        glr.DeleteSync(frameData[mappedNum].sync);
+        frameData[mappedNum].sync = Renderer::NullSync;
     }
 #endif
 }
 
 void BufferCacheManager::EndDrawCommand() {
 #if PINNED_MEMORY
+    if (!persistentMap) {
+        return;
+    }
+
     if (frameData[unmappedNum].sync != Renderer::NullSync) {
         glr.DeleteSync(frameData[unmappedNum].sync);
     }
@@ -206,20 +227,22 @@ void BufferCacheManager::BeginBackEnd() {
             Str::FormatBytes(mostUsedTexelMem).c_str());
     }
 
-#if PINNED_MEMORY && !PERSISTENT_MAP
-    // unmap the current frame so the GPU can read it
-    const uint32_t startUnmap = PlatformTime::Milliseconds();
-    UnmapBufferSet(frameData[mappedNum]);
-    const uint32_t endUnmap = PlatformTime::Milliseconds();
-    if (r_showBufferCacheTiming.GetBool() && endUnmap - startUnmap > 1) {
-        BE_DLOG(L"BufferCacheManager::BeginBackEnd: unmap took %i msec\n", endUnmap - startUnmap);
+#if PINNED_MEMORY
+    if (!persistentMap) {
+        // unmap the current frame so the GPU can read it
+        const uint32_t startUnmap = PlatformTime::Milliseconds();
+        UnmapBufferSet(frameData[mappedNum]);
+        const uint32_t endUnmap = PlatformTime::Milliseconds();
+        if (r_showBufferCacheTiming.GetBool() && endUnmap - startUnmap > 1) {
+            BE_DLOG(L"BufferCacheManager::BeginBackEnd: unmap took %i msec\n", endUnmap - startUnmap);
+        }
     }
 #endif
 
     unmappedNum = mappedNum;
 
     // update buffered texture
-    if (renderGlobal.skinningMethod == Mesh::VtfSkinning) {
+    if (renderGlobal.skinningMethod == Mesh::VtfSkinning || r_instancing.GetBool()) {
         if (renderGlobal.vtUpdateMethod == Mesh::TboUpdate) {
             // The update to the data is not guaranteed to affect the texture until next time it is bound to a texture image unit
             glr.SelectTextureUnit(0);
@@ -234,12 +257,14 @@ void BufferCacheManager::BeginBackEnd() {
     frameCount++;
     mappedNum = frameCount % COUNT_OF(frameData);
     
-#if PINNED_MEMORY && !PERSISTENT_MAP
-    const uint32_t startMap = PlatformTime::Milliseconds();
-    MapBufferSet(frameData[mappedNum]);
-    const uint32_t endMap = PlatformTime::Milliseconds();
-    if (r_showBufferCacheTiming.GetBool() && endMap - startMap > 1) {
-        BE_DLOG(L"BufferCacheManager::BeginBackEnd: map took %i msec\n", endMap - startMap);
+#if PINNED_MEMORY
+    if (!persistentMap) {
+        const uint32_t startMap = PlatformTime::Milliseconds();
+        MapBufferSet(frameData[mappedNum]);
+        const uint32_t endMap = PlatformTime::Milliseconds();
+        if (r_showBufferCacheTiming.GetBool() && endMap - startMap > 1) {
+            BE_DLOG(L"BufferCacheManager::BeginBackEnd: map took %i msec\n", endMap - startMap);
+        }
     }
 #endif
 
@@ -259,6 +284,9 @@ void BufferCacheManager::BeginBackEnd() {
 }
 
 void BufferCacheManager::AllocStaticVertex(int bytes, const void *data, BufferCache *bc) {
+    // Wait for the render thread to release the GL context
+    renderSystem.SyncRenderThread();
+
     bc->buffer = glr.CreateBuffer(Renderer::VertexBuffer, Renderer::Static, bytes, 0, data);
     bc->offset = 0;
     bc->bytes = bytes;
@@ -266,6 +294,8 @@ void BufferCacheManager::AllocStaticVertex(int bytes, const void *data, BufferCa
 }
 
 void BufferCacheManager::AllocStaticIndex(int bytes, const void *data, BufferCache *bc) {
+    renderSystem.SyncRenderThread();
+
     bc->buffer = glr.CreateBuffer(Renderer::IndexBuffer, Renderer::Static, bytes, 0, data);
     bc->offset = 0;
     bc->bytes = bytes;
@@ -273,6 +303,8 @@ void BufferCacheManager::AllocStaticIndex(int bytes, const void *data, BufferCac
 }
 
 void BufferCacheManager::AllocStaticTexel(int bytes, const void *data, BufferCache *bc) {
+    renderSystem.SyncRenderThread();
+
     bc->buffer = glr.CreateBuffer(Renderer::TexelBuffer, Renderer::Static, bytes, 0, data);
     bc->offset = 0;
     bc->bytes = bytes;
@@ -496,6 +528,15 @@ bool BufferCacheManager::IsCached(const BufferCache *bc) const {
     return false;
 }
 
+int BufferCacheManager::GetTexelMemAvailable() const {
+    const FrameDataBufferSet *currentBufferSet = &frameData[mappedNum];
+    if (!currentBufferSet->texelBuffer) {
+        return 0;
+    }
+
+    return Max(TB_BYTES - (int)currentBufferSet->texelMemUsed.GetValue(), 0);
+}
+
 void BufferCacheManager::UpdatePBOTexture() const {
     const FrameDataBufferSet *currentBufferSet = &frameData[unmappedNum];
 
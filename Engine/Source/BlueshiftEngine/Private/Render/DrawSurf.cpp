@@ -0,0 +1,43 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderInternal.h"
+
+BE_NAMESPACE_BEGIN
+
+DrawSurf *DrawSurfBuffer::Append(const DrawSurf &drawSurf) {
+    if (!last || last->count == ChunkSize) {
+        Chunk *chunk = (Chunk *)frameData.Alloc(sizeof(Chunk));
+        chunk->count = 0;
+        chunk->next = nullptr;
+
+        if (last) {
+            last->next = chunk;
+        } else {
+            first = chunk;
+        }
+        last = chunk;
+    }
+
+    const int index = last->count++;
+    last->sortkeys[index] = drawSurf.sortkey;
+    last->surfs[index] = drawSurf;
+    count++;
+
+    return &last->surfs[index];
+}
+
+BE_NAMESPACE_END
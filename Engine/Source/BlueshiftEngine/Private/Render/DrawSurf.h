@@ -19,11 +19,29 @@
 
     DrawSurf
 
-    sort key:
+    64 bit sort key:
 
-    0xF0000000 (0~15)    : material sort
-    0x0FFF0000 (0~4095)  : entityNum
-    0x0000FFFF (0~65535) : materialNum
+    0xF000000000000000 (0~15)      : material sort
+
+    blend sorts:
+    0x0FFFF00000000000 (0~65535)   : depth (back to front)
+    0x00000FFFFF000000 (0~1048575) : entityNum
+    0x0000000000FFFF00 (0~65535)   : materialNum
+    0x00000000000000C0 (0~3)       : vertex format
+
+    other sorts (surfaces with the same material and sub mesh are adjacent to be instanced):
+    0x0FFFF00000000000 (0~65535)   : materialNum
+    0x00000C0000000000 (0~3)       : vertex format
+    0x000003FFFFF00000             : hash of the source sub mesh
+    0x00000000000FFFFF (0~1048575) : entityNum
+
+    Draw Surface Buffer
+
+    Chunked storage of draw surfaces allocated from the frame data.
+    Chunks are linked instead of reallocated, so the buffer grows without copying
+    and pointers to the appended surfaces stay valid until the end of the frame.
+    Sort keys are stored in a separate array of each chunk to be gathered for sorting
+    without touching the surfaces.
 
 -------------------------------------------------------------------------------
 */
@@ -37,19 +55,73 @@ public:
         ShowWires       = BIT(1)
     };
 
-    void                MakeSortKey(int entityNum, const Material *material);
+    enum VertexFormat {
+        StaticVertexFormat,
+        SkinnedVertexFormat,
+        GuiVertexFormat
+    };
+
+                        /// Makes sort key. subMesh and guiSubMesh should be set before calling this.
+                        /// depth can be any value increasing with the distance from the view origin.
+    void                MakeSortKey(int entityNum, const Material *material, float depth);
 
-    uint32_t            sortkey;
+    uint64_t            sortkey;
     uint32_t            flags;
     viewEntity_t *      entity;
     const Material *    material;
     const float *       materialRegisters;
     SubMesh *           subMesh;
     GuiSubMesh *        guiSubMesh;
+    int                 numInstances;       ///< Number of instances drawn by this surface, 0 if merged into the instanced draw of the preceding one
+    const BufferCache * instanceCache;      ///< Entity data of the instances, nullptr if not instanced
 };
 
-BE_INLINE void DrawSurf::MakeSortKey(int entityNum, const Material *material) {
-    sortkey = ((material->GetSort() << 28) | (entityNum << 16) | materialManager.GetIndexByMaterial(material));
+BE_INLINE void DrawSurf::MakeSortKey(int entityNum, const Material *material, float depth) {
+    const uint64_t sort = material->GetSort();
+
+    const uint64_t vertexFormat = subMesh ? (subMesh->IsGpuSkinning() ? SkinnedVertexFormat : StaticVertexFormat) : GuiVertexFormat;
+    const uint64_t materialNum = materialManager.GetIndexByMaterial(material) & 0xFFFF;
+
+    if (sort >= Material::BlendSort) {
+        // Bit pattern of the non-negative float increases with its value, upper 16 bits are enough for sorting
+        union { float f; uint32_t i; } u;
+        u.f = Max(depth, 0.0f);
+        const uint64_t depthBits = 0xFFFF - (u.i >> 16);
+
+        sortkey = (sort << 60) | (depthBits << 44) | ((uint64_t)(entityNum & 0xFFFFF) << 24) | (materialNum << 8) | (vertexFormat << 6);
+    } else {
+        // Hash collisions only break the batches, backend compares the sub meshes
+        const uint64_t subMeshHash = subMesh ? (((uintptr_t)subMesh->GetSourceSubMesh() >> 4) & 0x3FFFFF) : 0;
+
+        sortkey = (sort << 60) | (materialNum << 44) | (vertexFormat << 42) | (subMeshHash << 20) | (uint64_t)(entityNum & 0xFFFFF);
+    }
 }
 
+class DrawSurfBuffer {
+public:
+    enum { ChunkSize = 256 };
+
+    struct Chunk {
+        uint64_t        sortkeys[ChunkSize];
+        DrawSurf        surfs[ChunkSize];
+        int             count;
+        Chunk *         next;
+    };
+
+    void                Clear() { first = nullptr; last = nullptr; count = 0; }
+
+                        /// Returns total number of surfaces in the buffer.
+    int                 Count() const { return count; }
+
+    Chunk *             FirstChunk() const { return first; }
+
+                        /// Copies the surface into the buffer and returns the pointer to the stored one.
+    DrawSurf *          Append(const DrawSurf &drawSurf);
+
+private:
+    Chunk *             first;
+    Chunk *             last;
+    int                 count;
+};
+
 BE_NAMESPACE_END
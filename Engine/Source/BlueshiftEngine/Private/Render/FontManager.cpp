@@ -110,6 +110,8 @@ Font *FontManager::FindFont(const char *hashName, int fontSize) const {
 }
 
 Font *FontManager::GetFont(const char *hashName, int fontSize) {
+    MemTagScope tagScope(MemTag::Asset);
+
     if (!hashName || !hashName[0]) {
         return defaultFont;
     }
@@ -24,47 +24,85 @@ static const int MEMORY_BLOCK_SIZE = 0x100000;
 
 FrameData   frameData;
 
-void FrameData::Init() {
-    Shutdown();
-
-    int size = MEMORY_BLOCK_SIZE;
+FrameData::MemBlock *FrameData::AllocBlock(int size) {
     MemBlock *block = (MemBlock *)Mem_Alloc(sizeof(*block) + 15 + size);
     if (!block) {
-        BE_FATALERROR(L"FrameData::Init: failed to allocate memory");
+        BE_FATALERROR(L"FrameData::AllocBlock: Mem_Alloc() failed");
     }
     block->base = (byte *)AlignUp((intptr_t)block + sizeof(*block), 16);
     block->size = size;
     block->used = 0;
     block->next = nullptr;
-
-    this->mem = block;
-    this->alloc = block;
-    this->commands.used = 0;
+    return block;
 }
 
-void FrameData::Shutdown() {
+void FrameData::FreeBlocks(Region *region) {
     MemBlock *nextBlock;
-    for (MemBlock *block = this->mem; block; block = nextBlock) {
+    for (MemBlock *block = region->mem; block; block = nextBlock) {
         nextBlock = block->next;
         Mem_Free(block);
     }
-    
-    this->mem = nullptr;
+
+    region->mem = nullptr;
+    region->alloc = nullptr;
+}
+
+void FrameData::Init() {
+    Shutdown();
+
+    for (int frameIndex = 0; frameIndex < NumFrames; frameIndex++) {
+        Frame *frame = &frames[frameIndex];
+
+        // Other worker regions are created on their first allocation
+        MemBlock *block = AllocBlock(MEMORY_BLOCK_SIZE);
+        frame->regions[0].mem = block;
+        frame->regions[0].alloc = block;
+        frame->commands.used = 0;
+    }
+
+    activeFrame = 0;
 }
 
+void FrameData::Shutdown() {
+    for (int frameIndex = 0; frameIndex < NumFrames; frameIndex++) {
+        for (int i = 0; i < COUNT_OF(frames[frameIndex].regions); i++) {
+            FreeBlocks(&frames[frameIndex].regions[i]);
+        }
+    }
+}
+
+// The other frame becomes active. Its memory is reused, so the back end must have finished reading it.
 void FrameData::ToggleFrame() {
-    // reset the mem allocation to the first block
-    this->alloc = this->mem;
+    activeFrame = (activeFrame + 1) % NumFrames;
+
+    Frame *frame = &frames[activeFrame];
 
-    // clear all the blocks
-    for (MemBlock *block = this->mem; block; block = block->next) {
-        block->used = 0;
+    frame->commands.used = 0;
+
+    for (int i = 0; i < COUNT_OF(frame->regions); i++) {
+        Region *region = &frame->regions[i];
+
+        // reset the mem allocation to the first block
+        region->alloc = region->mem;
+
+        // clear all the blocks
+        for (MemBlock *block = region->mem; block; block = block->next) {
+            block->used = 0;
+        }
     }
 }
 
 void *FrameData::Alloc(int bytes) {
     bytes = AlignUp(bytes, 16);
-    MemBlock *block = this->alloc;
+
+    // Each worker allocates from its own region, threads not owned by the job system use the first one
+    Region *region = &frames[activeFrame].regions[Max(JobSystem::WorkerIndex(), 0)];
+    if (!region->mem) {
+        region->mem = AllocBlock(MEMORY_BLOCK_SIZE);
+        region->alloc = region->mem;
+    }
+
+    MemBlock *block = region->alloc;
 
     if (block->size - block->used >= bytes) {
         void *buf = block->base + block->used;
@@ -74,25 +112,16 @@ void *FrameData::Alloc(int bytes) {
 
     // advance to the next mem block if available
     block = block->next;
-    // create a new block if we are at the end of the chain
-    if (!block) {
-        int size = MEMORY_BLOCK_SIZE;
-        block = (MemBlock *)Mem_Alloc(sizeof(*block) + 15 + size);
-        if (!block) {
-            BE_FATALERROR(L"FrameData::Alloc: Mem_Alloc() failed");
-        }
-        block->base = (byte *)AlignUp((intptr_t)block + sizeof(*block), 16);
-        block->size = size;
-        block->used = 0;
-        block->next = nullptr;
-        this->alloc->next = block;
-    }
-
-    if (bytes > block->size) {
-        BE_FATALERROR(L"FrameData::Alloc of %i exceeded MEMORY_BLOCK_SIZE", bytes);
+    // create a new block if we are at the end of the chain or the next one is too small.
+    // allocations larger than MEMORY_BLOCK_SIZE get a dedicated block which is reused in the following frames.
+    if (!block || bytes > block->size) {
+        MemBlock *newBlock = AllocBlock(Max(bytes, MEMORY_BLOCK_SIZE));
+        newBlock->next = block;
+        region->alloc->next = newBlock;
+        block = newBlock;
     }
 
-    this->alloc = block;
+    region->alloc = block;
     block->used = bytes;
 
     return block->base;
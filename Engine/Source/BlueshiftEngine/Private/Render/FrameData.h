@@ -14,11 +14,17 @@
 
 #pragma once
 
+#include "Core/JobSystem.h"
+
 BE_NAMESPACE_BEGIN
 
 /// All of the information needed by the back end must be contained in.
+/// Memory is allocated from per-worker regions so that frontend jobs can allocate without locking.
+/// Double buffered so that the front end can fill the next frame while the render thread reads the previous one.
 class FrameData {
 public:
+    enum { NumFrames = 2 };
+
     void                    Init();
     void                    Shutdown();
     void                    ToggleFrame();
@@ -26,7 +32,7 @@ public:
     void *                  Alloc(int bytes);
     void *                  ClearedAlloc(int bytes);
 
-    RenderCommandBuffer *   GetCommands() { return &commands; }
+    RenderCommandBuffer *   GetCommands() { return &frames[activeFrame].commands; }
 
 private:
     struct MemBlock {
@@ -36,9 +42,22 @@ private:
         byte *              base;
     };
 
-    MemBlock *              mem;
-    MemBlock *              alloc;
-    RenderCommandBuffer     commands;
+    struct Region {
+        MemBlock *          mem;
+        MemBlock *          alloc;
+        char                pad[64 - 2 * sizeof(MemBlock *)];
+    };
+
+    struct Frame {
+        Region              regions[JobSystem::MaxWorkers];
+        RenderCommandBuffer commands;
+    };
+
+    static MemBlock *       AllocBlock(int size);
+    static void             FreeBlocks(Region *region);
+
+    Frame                   frames[NumFrames];
+    int                     activeFrame;
 };
 
 extern FrameData            frameData;
@@ -131,6 +131,8 @@ Material *MaterialManager::FindMaterial(const char *hashName) const {
 }
 
 Material *MaterialManager::GetMaterial(const char *hashName) {
+    MemTagScope tagScope(MemTag::Asset);
+
     if (!hashName || !hashName[0]) {
         return defaultMaterial;
     }
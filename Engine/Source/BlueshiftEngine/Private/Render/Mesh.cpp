@@ -32,6 +32,8 @@ void Mesh::Purge() {
         }
         surfaces.Clear();
 
+        FreeLods();
+
         if (skinningJointCache) {
             if (skinningJointCache->skinningJoints) {
                 Mem_AlignedFree(skinningJointCache->skinningJoints);
@@ -45,10 +47,51 @@ void Mesh::Purge() {
         }
         surfaces.Clear();
 
+        FreeLods();
+
         SAFE_DELETE_ARRAY(joints);
     }
 }
 
+void Mesh::FreeLods() {
+    for (int lodIndex = 0; lodIndex < lods.Count(); lodIndex++) {
+        MeshLod *lod = lods[lodIndex];
+
+        for (int i = 0; i < lod->surfaces.Count(); i++) {
+            FreeSurface(lod->surfaces[i]);
+        }
+        delete lod;
+    }
+    lods.Clear();
+}
+
+float Mesh::GetLodScreenSize(int lod) const {
+    assert(lod >= 0 && lod <= lods.Count());
+    if (lod == 0) {
+        return Math::Infinity;
+    }
+    return lods[lod - 1]->screenSize;
+}
+
+MeshSurf *Mesh::GetLodSurface(int lod, int index) const {
+    assert(lod >= 0 && lod <= lods.Count());
+    if (lod == 0) {
+        return GetSurface(index);
+    }
+    assert(index >= 0 && index < lods[lod - 1]->surfaces.Count());
+    return lods[lod - 1]->surfaces[index];
+}
+
+MeshLod *Mesh::AllocLod(float screenSize) {
+    assert(lods.Count() == 0 || screenSize < lods[lods.Count() - 1]->screenSize);
+
+    MeshLod *lod = new MeshLod;
+    lod->screenSize = screenSize;
+    lods.Append(lod);
+
+    return lod;
+}
+
 MeshSurf *Mesh::AllocSurface(int numVerts, int numIndexes) const {
     MeshSurf *surf = new MeshSurf;
     surf->materialIndex = 0;
@@ -154,6 +197,18 @@ void Mesh::Instantiate(int meshType) {
         MeshSurf *surf = AllocInstantiatedSurface(originalMesh->surfaces[i], meshType);
         surfaces.Append(surf);
     }
+
+    FreeLods();
+
+    for (int lodIndex = 0; lodIndex < originalMesh->lods.Count(); lodIndex++) {
+        const MeshLod *refLod = originalMesh->lods[lodIndex];
+        MeshLod *lod = AllocLod(refLod->screenSize);
+
+        for (int i = 0; i < refLod->surfaces.Count(); i++) {
+            MeshSurf *surf = AllocInstantiatedSurface(refLod->surfaces[i], meshType);
+            lod->surfaces.Append(surf);
+        }
+    }
 }
 
 void Mesh::FinishSurfaces(int flags) {
@@ -184,6 +239,18 @@ void Mesh::FinishSurfaces(int flags) {
 
     // TODO: consider to remove this
     ComputeEdges();
+
+    // LOD levels are built from finished surfaces, so only bounds and edges are needed
+    for (int lodIndex = 0; lodIndex < lods.Count(); lodIndex++) {
+        for (int i = 0; i < lods[lodIndex]->surfaces.Count(); i++) {
+            SubMesh *subMesh = lods[lodIndex]->surfaces[i]->subMesh;
+            subMesh->ComputeAABB();
+            if (flags & OptimizeIndicesFlag) {
+                subMesh->OptimizeIndexedTriangles();
+            }
+            subMesh->ComputeEdges();
+        }
+    }
 }
 
 void Mesh::TransformVerts(const Mat3 &rotation, const Vec3 &translation) {
@@ -195,14 +262,73 @@ void Mesh::TransformVerts(const Mat3 &rotation, const Vec3 &translation) {
         }
     }
 
+    for (int lodIndex = 0; lodIndex < lods.Count(); lodIndex++) {
+        for (int i = 0; i < lods[lodIndex]->surfaces.Count(); i++) {
+            SubMesh *subMesh = lods[lodIndex]->surfaces[i]->subMesh;
+
+            for (int j = 0; j < subMesh->numVerts; j++) {
+                subMesh->verts[j].Transform(rotation, translation);
+            }
+            subMesh->ComputeAABB();
+        }
+    }
+
     ComputeAABB();
 }
 
 void Mesh::OptimizeIndexedTriangles() {
+    int numTris = 0;
+    int numVerts = 0;
+    int numMissesBefore = 0;
+    int numMissesAfter = 0;
+
     for (int i = 0; i < surfaces.Count(); i++) {
         SubMesh *subMesh = surfaces[i]->subMesh;
+
+        numTris += subMesh->numIndexes / 3;
+        numVerts += subMesh->numVerts;
+        numMissesBefore += subMesh->CountVertexCacheMisses();
+
         subMesh->OptimizeIndexedTriangles();
+
+        numMissesAfter += subMesh->CountVertexCacheMisses();
+    }
+
+    if (numTris > 0) {
+        // ACMR: average cache miss ratio (transformed vertices per triangle)
+        // ATVR: average transformed vertex ratio (transformed vertices per vertex, 1.0 is optimal)
+        BE_DLOG(L"Mesh::OptimizeIndexedTriangles: '%hs' ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", hashName.c_str(),
+            (float)numMissesBefore / numTris, (float)numMissesAfter / numTris,
+            (float)numMissesBefore / numVerts, (float)numMissesAfter / numVerts);
+    }
+}
+
+void Mesh::SetCompactVertices(bool compact) {
+    if (isInstantiated) {
+        BE_WARNLOG(L"Mesh::SetCompactVertices: can't change vertex format of instantiated mesh '%hs'\n", hashName.c_str());
+        return;
     }
+
+    for (int i = 0; i < surfaces.Count(); i++) {
+        SubMesh *subMesh = surfaces[i]->subMesh;
+        subMesh->useCompactVertex = compact && !subMesh->vertWeights && subMesh->numJointWeights == 0;
+    }
+
+    for (int lodIndex = 0; lodIndex < lods.Count(); lodIndex++) {
+        for (int i = 0; i < lods[lodIndex]->surfaces.Count(); i++) {
+            SubMesh *subMesh = lods[lodIndex]->surfaces[i]->subMesh;
+            subMesh->useCompactVertex = compact && !subMesh->vertWeights && subMesh->numJointWeights == 0;
+        }
+    }
+}
+
+bool Mesh::UseCompactVertices() const {
+    for (int i = 0; i < surfaces.Count(); i++) {
+        if (surfaces[i]->subMesh->useCompactVertex) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void Mesh::Voxelize() {
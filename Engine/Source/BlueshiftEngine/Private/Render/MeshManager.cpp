@@ -31,6 +31,8 @@ MeshManager     meshManager;
 void MeshManager::Init() {
     cmdSystem.AddCommand(L"listMeshes", Cmd_ListMeshes);
     cmdSystem.AddCommand(L"reloadMesh", Cmd_ReloadMesh);
+    cmdSystem.AddCommand(L"generateMeshLods", Cmd_GenerateMeshLods);
+    cmdSystem.AddCommand(L"setMeshVertexFormat", Cmd_SetMeshVertexFormat);
 
     meshHashMap.Init(1024, 64, 64);
     instantiatedMeshList.Resize(64, 64);
@@ -79,6 +81,8 @@ void MeshManager::Init() {
 void MeshManager::Shutdown() {
     cmdSystem.RemoveCommand(L"listMeshes");
     cmdSystem.RemoveCommand(L"reloadMesh");
+    cmdSystem.RemoveCommand(L"generateMeshLods");
+    cmdSystem.RemoveCommand(L"setMeshVertexFormat");
 
     for (int i = 0; i < meshHashMap.Count(); i++) {
         const auto *entry = meshManager.meshHashMap.GetByIndex(i);
@@ -195,6 +199,8 @@ Mesh *MeshManager::FindMesh(const char *hashName) const {
 }
 
 Mesh *MeshManager::GetMesh(const char *hashName) {
+    MemTagScope tagScope(MemTag::Asset);
+
     if (!hashName || !hashName[0]) {
         return defaultMesh;
     }
@@ -291,4 +297,68 @@ void MeshManager::Cmd_ReloadMesh(const CmdArgs &args) {
     }
 }
 
+void MeshManager::Cmd_GenerateMeshLods(const CmdArgs &args) {
+    if (args.Argc() < 2) {
+        BE_LOG(L"generateMeshLods <filename> [ratio1 ratio2 ...]\n");
+        return;
+    }
+
+    float reductionRatios[8] = { 0.5f, 0.25f, 0.125f };
+    int numLevels = 3;
+
+    if (args.Argc() > 2) {
+        numLevels = Min(args.Argc() - 2, (int)COUNT_OF(reductionRatios));
+        for (int i = 0; i < numLevels; i++) {
+            reductionRatios[i] = wcstof(args.Argv(i + 2), nullptr);
+        }
+    }
+
+    Mesh *mesh = meshManager.GetMesh(WStr::ToStr(args.Argv(1)));
+    if (mesh->IsDefaultMesh()) {
+        return;
+    }
+
+    if (mesh->GenerateLODs(numLevels, reductionRatios)) {
+        Str filename = mesh->hashName;
+        filename.SetFileExtension(".bmesh");
+        mesh->Write(filename);
+
+        BE_LOG(L"%i LOD levels written to '%hs'\n", numLevels, filename.c_str());
+    }
+
+    meshManager.ReleaseMesh(mesh);
+}
+
+void MeshManager::Cmd_SetMeshVertexFormat(const CmdArgs &args) {
+    if (args.Argc() != 3) {
+        BE_LOG(L"setMeshVertexFormat <filename> <generic|compact>\n");
+        return;
+    }
+
+    bool compact;
+    if (!WStr::Icmp(args.Argv(2), L"compact")) {
+        compact = true;
+    } else if (!WStr::Icmp(args.Argv(2), L"generic")) {
+        compact = false;
+    } else {
+        BE_WARNLOG(L"Unknown vertex format '%ls'\n", args.Argv(2));
+        return;
+    }
+
+    Mesh *mesh = meshManager.GetMesh(WStr::ToStr(args.Argv(1)));
+    if (mesh->IsDefaultMesh()) {
+        return;
+    }
+
+    mesh->SetCompactVertices(compact);
+
+    Str filename = mesh->hashName;
+    filename.SetFileExtension(".bmesh");
+    mesh->Write(filename);
+
+    BE_LOG(L"'%hs' written with %ls vertices\n", filename.c_str(), args.Argv(2));
+
+    meshManager.ReleaseMesh(mesh);
+}
+
 BE_NAMESPACE_END
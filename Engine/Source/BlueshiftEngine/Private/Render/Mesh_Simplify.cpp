@@ -0,0 +1,611 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderInternal.h"
+#include "Containers/HashIndex.h"
+#include "Core/JobSystem.h"
+#include "Core/Heap.h"
+
+BE_NAMESPACE_BEGIN
+
+// Border edges of open meshes are kept by planes perpendicular to the border triangles, weighted by this
+#define BORDER_QUADRIC_WEIGHT       10.0
+// Minimum cosine between the normals of a triangle before and after a collapse, to prevent folding triangles
+#define MIN_COLLAPSE_NORMAL_DOT     0.2f
+
+// Quadric error metric (Garland & Heckbert) of a set of planes.
+// Evaluates the sum of squared distances from a point to the planes.
+class Quadric {
+public:
+    void                    Clear() { memset(this, 0, sizeof(*this)); }
+
+    void                    AddPlane(const Vec3 &n, float d, double weight);
+    void                    Add(const Quadric &q);
+
+    double                  Evaluate(const Vec3 &p) const;
+
+private:
+    double                  a2, ab, ac, ad;
+    double                  b2, bc, bd;
+    double                  c2, cd;
+    double                  d2;
+};
+
+void Quadric::AddPlane(const Vec3 &n, float d, double weight) {
+    a2 += weight * n.x * n.x;
+    ab += weight * n.x * n.y;
+    ac += weight * n.x * n.z;
+    ad += weight * n.x * d;
+    b2 += weight * n.y * n.y;
+    bc += weight * n.y * n.z;
+    bd += weight * n.y * d;
+    c2 += weight * n.z * n.z;
+    cd += weight * n.z * d;
+    d2 += weight * d * d;
+}
+
+void Quadric::Add(const Quadric &q) {
+    a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+    b2 += q.b2; bc += q.bc; bd += q.bd;
+    c2 += q.c2; cd += q.cd;
+    d2 += q.d2;
+}
+
+double Quadric::Evaluate(const Vec3 &p) const {
+    const double x = p.x, y = p.y, z = p.z;
+    return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+        + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+        + c2 * z * z + 2 * cd * z
+        + d2;
+}
+
+struct CollapseCandidate {
+    double                  cost;
+    int32_t                 from;           // vertex to remove
+    int32_t                 to;             // vertex to keep
+    int32_t                 fromVersion;
+    int32_t                 toVersion;
+};
+
+static bool CollapseCandidateGreater(const CollapseCandidate &a, const CollapseCandidate &b) {
+    return a.cost > b.cost;
+}
+
+// Simplifies a triangle mesh with half-edge collapses, which move a vertex onto one of its neighbors.
+// Remaining vertices are never moved or blended, so texture coordinates, tangents and joint weights stay intact.
+class MeshSimplifier {
+public:
+    enum VertexFlag {
+        BorderVertex        = BIT(0),   // on an open edge, can only slide along the border
+        LockedVertex        = BIT(1)    // shares its position with another vertex (UV seam, normal crease, mirrored tangent)
+    };
+
+    MeshSimplifier(const VertexLightingGeneric *verts, int numVerts, const TriIndex *indexes, int numIndexes, const Edge *edges, int numEdges);
+
+    int                     NumTris() const { return numLiveTris; }
+
+                            // Collapses edges until the number of triangles reaches targetNumTris or no more collapse is possible
+    void                    Simplify(int targetNumTris);
+
+                            // Returns the remaining triangles in the vertex indexes of the source mesh
+    void                    GetIndexes(Array<int> &outIndexes) const;
+
+private:
+    void                    PushCandidates(int v, bool bothDirections);
+    void                    PushCandidate(int from, int to);
+    bool                    CanCollapse(int from, int to);
+    void                    Collapse(int from, int to);
+
+    const VertexLightingGeneric *verts;
+    int                     numVerts;
+    int                     numLiveTris;
+
+    Array<int>              triIndexes;     // 3 vertex indexes per triangle
+    Array<bool>             triRemoved;
+    Array<Array<int>>       vertTris;       // triangles using each vertex
+    Array<Quadric>          quadrics;
+    Array<int>              flags;
+    Array<int>              versions;       // incremented when the quadric of a vertex changes
+    Array<bool>             vertRemoved;
+    Array<int>              marks;          // temporary marks to find shared neighbors
+    int                     markCount;
+
+    Array<CollapseCandidate> heap;
+};
+
+MeshSimplifier::MeshSimplifier(const VertexLightingGeneric *verts, int numVerts, const TriIndex *indexes, int numIndexes, const Edge *edges, int numEdges) {
+    this->verts = verts;
+    this->numVerts = numVerts;
+
+    const int numTris = numIndexes / 3;
+    numLiveTris = numTris;
+
+    triIndexes.SetCount(numIndexes);
+    for (int i = 0; i < numIndexes; i++) {
+        triIndexes[i] = indexes[i];
+    }
+    triRemoved.SetCount(numTris);
+    for (int i = 0; i < numTris; i++) {
+        triRemoved[i] = false;
+    }
+
+    vertTris.SetCount(numVerts);
+    quadrics.SetCount(numVerts);
+    flags.SetCount(numVerts);
+    versions.SetCount(numVerts);
+    vertRemoved.SetCount(numVerts);
+    marks.SetCount(numVerts);
+    markCount = 0;
+
+    for (int i = 0; i < numVerts; i++) {
+        quadrics[i].Clear();
+        flags[i] = 0;
+        versions[i] = 0;
+        vertRemoved[i] = false;
+        marks[i] = 0;
+    }
+
+    // Vertices sharing a position with other vertices are locked, so the seams between them are kept as they are
+    HashIndex positionHash(1024, numVerts);
+    for (int i = 0; i < numVerts; i++) {
+        const Vec3 &p = verts[i].xyz;
+        const int hash = positionHash.GenerateHash(p);
+
+        for (int j = positionHash.First(hash); j != -1; j = positionHash.Next(j)) {
+            if (verts[j].xyz == p) {
+                flags[i] |= LockedVertex;
+                flags[j] |= LockedVertex;
+            }
+        }
+        positionHash.Add(hash, i);
+    }
+
+    // Plane quadrics of the triangles weighted by the area
+    for (int i = 0; i < numTris; i++) {
+        const int *tri = &triIndexes[i * 3];
+        const Vec3 &p0 = verts[tri[0]].xyz;
+        const Vec3 &p1 = verts[tri[1]].xyz;
+        const Vec3 &p2 = verts[tri[2]].xyz;
+
+        Vec3 n = (p1 - p0).Cross(p2 - p0);
+        const float area = n.Normalize() * 0.5f;
+        const float d = -n.Dot(p0);
+
+        for (int k = 0; k < 3; k++) {
+            quadrics[tri[k]].AddPlane(n, d, area);
+            vertTris[tri[k]].Append(i);
+        }
+    }
+
+    // Edges with a single adjacent triangle are borders. The 0'th edge is a dummy.
+    for (int i = 1; i < numEdges; i++) {
+        const Edge &edge = edges[i];
+        if (edge.t[0] >= 0 && edge.t[1] >= 0) {
+            continue;
+        }
+
+        const int triIndex = edge.t[0] >= 0 ? edge.t[0] : edge.t[1];
+        if (triIndex < 0) {
+            continue;
+        }
+
+        const int *tri = &triIndexes[triIndex * 3];
+        const Vec3 &p0 = verts[edge.v[0]].xyz;
+        const Vec3 &p1 = verts[edge.v[1]].xyz;
+
+        Vec3 triNormal = (verts[tri[1]].xyz - verts[tri[0]].xyz).Cross(verts[tri[2]].xyz - verts[tri[0]].xyz);
+        triNormal.Normalize();
+
+        Vec3 edgeDir = p1 - p0;
+        const float edgeLength = edgeDir.Normalize();
+
+        Vec3 n = edgeDir.Cross(triNormal);
+        n.Normalize();
+        const float d = -n.Dot(p0);
+
+        quadrics[edge.v[0]].AddPlane(n, d, BORDER_QUADRIC_WEIGHT * edgeLength * edgeLength);
+        quadrics[edge.v[1]].AddPlane(n, d, BORDER_QUADRIC_WEIGHT * edgeLength * edgeLength);
+
+        flags[edge.v[0]] |= BorderVertex;
+        flags[edge.v[1]] |= BorderVertex;
+    }
+
+    heap.SetGranularity(Max(numIndexes * 2, 16));
+
+    for (int i = 0; i < numVerts; i++) {
+        PushCandidates(i, false);
+    }
+}
+
+void MeshSimplifier::PushCandidate(int from, int to) {
+    if (flags[from] & LockedVertex) {
+        return;
+    }
+    if ((flags[from] & BorderVertex) && !(flags[to] & (BorderVertex | LockedVertex))) {
+        return;
+    }
+
+    Quadric q = quadrics[from];
+    q.Add(quadrics[to]);
+
+    CollapseCandidate &candidate = heap.Alloc();
+    candidate.cost = q.Evaluate(verts[to].xyz);
+    candidate.from = from;
+    candidate.to = to;
+    candidate.fromVersion = versions[from];
+    candidate.toVersion = versions[to];
+
+    std::push_heap(heap.Ptr(), heap.Ptr() + heap.Count(), CollapseCandidateGreater);
+}
+
+// Pushes the collapses from the vertex to its neighbors, and optionally the collapses from the neighbors to the vertex
+void MeshSimplifier::PushCandidates(int v, bool bothDirections) {
+    markCount++;
+
+    for (int i = 0; i < vertTris[v].Count(); i++) {
+        const int *tri = &triIndexes[vertTris[v][i] * 3];
+
+        for (int k = 0; k < 3; k++) {
+            const int w = tri[k];
+            if (w == v || marks[w] == markCount) {
+                continue;
+            }
+            marks[w] = markCount;
+
+            PushCandidate(v, w);
+            if (bothDirections) {
+                PushCandidate(w, v);
+            }
+        }
+    }
+}
+
+bool MeshSimplifier::CanCollapse(int from, int to) {
+    // Count the triangles shared by the edge
+    int numSharedTris = 0;
+    for (int i = 0; i < vertTris[from].Count(); i++) {
+        const int *tri = &triIndexes[vertTris[from][i] * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+            numSharedTris++;
+        }
+    }
+
+    if (numSharedTris == 0) {
+        return false;
+    }
+
+    // Border vertices can only slide along the open edges
+    if ((flags[from] & BorderVertex) && numSharedTris != 1) {
+        return false;
+    }
+
+    // Link condition: shared neighbors should be only the opposite vertices of the shared triangles.
+    // Otherwise the collapse makes a non-manifold fold.
+    markCount++;
+    for (int i = 0; i < vertTris[from].Count(); i++) {
+        const int *tri = &triIndexes[vertTris[from][i] * 3];
+        for (int k = 0; k < 3; k++) {
+            marks[tri[k]] = markCount;
+        }
+    }
+
+    const int sharedMark = ++markCount;
+    int numSharedNeighbors = 0;
+    for (int i = 0; i < vertTris[to].Count(); i++) {
+        const int *tri = &triIndexes[vertTris[to][i] * 3];
+        for (int k = 0; k < 3; k++) {
+            const int w = tri[k];
+            if (w != from && w != to && marks[w] == sharedMark - 1) {
+                marks[w] = sharedMark;
+                numSharedNeighbors++;
+            }
+        }
+    }
+
+    if (numSharedNeighbors != numSharedTris) {
+        return false;
+    }
+
+    // Reject collapses which flip or degenerate the remaining triangles
+    const Vec3 &newPos = verts[to].xyz;
+
+    for (int i = 0; i < vertTris[from].Count(); i++) {
+        const int *tri = &triIndexes[vertTris[from][i] * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+            continue;
+        }
+
+        Vec3 p[3], q[3];
+        for (int k = 0; k < 3; k++) {
+            p[k] = verts[tri[k]].xyz;
+            q[k] = tri[k] == from ? newPos : p[k];
+        }
+
+        Vec3 oldNormal = (p[1] - p[0]).Cross(p[2] - p[0]);
+        Vec3 newNormal = (q[1] - q[0]).Cross(q[2] - q[0]);
+
+        const float oldLength = oldNormal.Normalize();
+        const float newLength = newNormal.Normalize();
+        if (newLength <= oldLength * 1e-4f) {
+            return false;
+        }
+        if (oldNormal.Dot(newNormal) < MIN_COLLAPSE_NORMAL_DOT) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void MeshSimplifier::Collapse(int from, int to) {
+    Array<int> &fromTris = vertTris[from];
+
+    for (int i = 0; i < fromTris.Count(); i++) {
+        const int triIndex = fromTris[i];
+        int *tri = &triIndexes[triIndex * 3];
+
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+            // Degenerated triangle
+            triRemoved[triIndex] = true;
+            numLiveTris--;
+
+            for (int k = 0; k < 3; k++) {
+                if (tri[k] != from) {
+                    vertTris[tri[k]].Remove(triIndex);
+                }
+            }
+        } else {
+            for (int k = 0; k < 3; k++) {
+                if (tri[k] == from) {
+                    tri[k] = to;
+                }
+            }
+            vertTris[to].Append(triIndex);
+        }
+    }
+
+    fromTris.Clear();
+    vertRemoved[from] = true;
+
+    quadrics[to].Add(quadrics[from]);
+    versions[to]++;
+
+    PushCandidates(to, true);
+}
+
+void MeshSimplifier::Simplify(int targetNumTris) {
+    while (numLiveTris > targetNumTris && heap.Count() > 0) {
+        std::pop_heap(heap.Ptr(), heap.Ptr() + heap.Count(), CollapseCandidateGreater);
+        const CollapseCandidate candidate = heap[heap.Count() - 1];
+        heap.SetCount(heap.Count() - 1, false);
+
+        // Skip outdated candidates
+        if (vertRemoved[candidate.from] || vertRemoved[candidate.to]) {
+            continue;
+        }
+        if (versions[candidate.from] != candidate.fromVersion || versions[candidate.to] != candidate.toVersion) {
+            continue;
+        }
+
+        if (!CanCollapse(candidate.from, candidate.to)) {
+            continue;
+        }
+
+        Collapse(candidate.from, candidate.to);
+    }
+}
+
+void MeshSimplifier::GetIndexes(Array<int> &outIndexes) const {
+    outIndexes.SetCount(numLiveTris * 3);
+
+    int count = 0;
+    for (int i = 0; i < triRemoved.Count(); i++) {
+        if (!triRemoved[i]) {
+            outIndexes[count++] = triIndexes[i * 3 + 0];
+            outIndexes[count++] = triIndexes[i * 3 + 1];
+            outIndexes[count++] = triIndexes[i * 3 + 2];
+        }
+    }
+}
+
+void SubMesh::AllocSimplifiedSubMesh(const SubMesh *ref, const int *refIndexes, int numRefIndexes) {
+    const int numOriginalVerts = ref->numVerts - ref->numMirroredVerts;
+
+    // Vertices used by the remaining triangles, and the original vertices of the used mirrored vertices
+    Array<int> vertexMap;
+    vertexMap.SetCount(ref->numVerts);
+    for (int i = 0; i < ref->numVerts; i++) {
+        vertexMap[i] = -1;
+    }
+    for (int i = 0; i < numRefIndexes; i++) {
+        vertexMap[refIndexes[i]] = 0;
+        if (refIndexes[i] >= numOriginalVerts) {
+            vertexMap[ref->mirroredVerts[refIndexes[i] - numOriginalVerts]] = 0;
+        }
+    }
+
+    // Vertices keep the order of the reference, so the mirrored vertices remain at the end
+    int newNumVerts = 0;
+    int newNumMirroredVerts = 0;
+    for (int i = 0; i < ref->numVerts; i++) {
+        if (vertexMap[i] == 0) {
+            vertexMap[i] = newNumVerts++;
+            if (i >= numOriginalVerts) {
+                newNumMirroredVerts++;
+            }
+        } else {
+            vertexMap[i] = -1;
+        }
+    }
+
+    AllocSubMesh(newNumVerts, numRefIndexes);
+
+    normalsCalculated = ref->normalsCalculated;
+    tangentsCalculated = ref->tangentsCalculated;
+    useCompactVertex = ref->useCompactVertex;
+
+    for (int i = 0; i < ref->numVerts; i++) {
+        if (vertexMap[i] >= 0) {
+            verts[vertexMap[i]] = ref->verts[i];
+        }
+    }
+
+    for (int i = 0; i < numRefIndexes; i++) {
+        indexes[i] = vertexMap[refIndexes[i]];
+    }
+
+    if (newNumMirroredVerts > 0) {
+        numMirroredVerts = newNumMirroredVerts;
+        mirroredVerts = (int *)Mem_Alloc16(sizeof(int) * newNumMirroredVerts);
+
+        for (int i = numOriginalVerts; i < ref->numVerts; i++) {
+            if (vertexMap[i] >= 0) {
+                mirroredVerts[vertexMap[i] - (newNumVerts - newNumMirroredVerts)] = vertexMap[ref->mirroredVerts[i - numOriginalVerts]];
+            }
+        }
+    }
+
+    // Vertex weights for GPU skinning
+    if (ref->vertWeights) {
+        const int vertexWeightSize = ref->VertexWeightSize();
+        vertWeights = Mem_Alloc16(vertexWeightSize * newNumVerts);
+        gpuSkinningVersionIndex = ref->gpuSkinningVersionIndex;
+
+        for (int i = 0; i < ref->numVerts; i++) {
+            if (vertexMap[i] >= 0) {
+                memcpy((byte *)vertWeights + vertexMap[i] * vertexWeightSize, (const byte *)ref->vertWeights + i * vertexWeightSize, vertexWeightSize);
+            }
+        }
+    }
+
+    // Joint weights for CPU skinning are stored as a run of weights for each vertex,
+    // the last weight of a vertex has non-zero nextVertOffset
+    if (ref->numJointWeights > 0) {
+        Array<int> firstWeights;
+        firstWeights.SetCount(ref->numVerts + 1);
+        for (int i = 0, j = 0; i < ref->numVerts; i++) {
+            firstWeights[i] = j;
+            while (ref->jointWeights[j].nextVertOffset == 0) {
+                j++;
+            }
+            j++;
+            firstWeights[i + 1] = j;
+        }
+
+        for (int i = 0; i < ref->numVerts; i++) {
+            if (vertexMap[i] >= 0) {
+                numJointWeights += firstWeights[i + 1] - firstWeights[i];
+            }
+        }
+
+        jointWeights = (JointWeight *)Mem_Alloc16(sizeof(JointWeight) * numJointWeights);
+        jointWeightVerts = (Vec4 *)Mem_Alloc16(sizeof(Vec4) * numJointWeights);
+
+        // Output vertices are in the order of the reference vertices
+        int weightIndex = 0;
+        for (int i = 0; i < ref->numVerts; i++) {
+            if (vertexMap[i] >= 0) {
+                for (int j = firstWeights[i]; j < firstWeights[i + 1]; j++) {
+                    jointWeights[weightIndex] = ref->jointWeights[j];
+                    jointWeightVerts[weightIndex] = ref->jointWeightVerts[j];
+                    weightIndex++;
+                }
+            }
+        }
+    }
+}
+
+bool Mesh::GenerateLODs(int numLevels, const float *reductionRatios) {
+    if (isInstantiated) {
+        BE_WARNLOG(L"Mesh::GenerateLODs: can't generate LOD levels of instantiated mesh '%hs'\n", hashName.c_str());
+        return false;
+    }
+
+    for (int level = 0; level < numLevels; level++) {
+        const float prevRatio = level > 0 ? reductionRatios[level - 1] : 1.0f;
+        if (reductionRatios[level] <= 0.0f || reductionRatios[level] >= prevRatio) {
+            BE_WARNLOG(L"Mesh::GenerateLODs: reduction ratios should be decreasing values in (0, 1)\n");
+            return false;
+        }
+    }
+
+    FreeLods();
+
+    if (numLevels <= 0 || surfaces.Count() == 0) {
+        return true;
+    }
+
+    // Border detection uses the adjacency of the edges
+    for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+        SubMesh *subMesh = surfaces[surfaceIndex]->subMesh;
+        if (!subMesh->edgesCalculated) {
+            subMesh->ComputeEdges();
+        }
+    }
+
+    const int numSurfaces = surfaces.Count();
+
+    Array<SubMesh *> lodSubMeshes;
+    lodSubMeshes.SetCount(numSurfaces * numLevels);
+
+    // Surfaces are simplified in parallel. Each level continues collapsing from the previous level.
+    JobSystem::ParallelFor(0, numSurfaces, 1, [this, numLevels, reductionRatios, &lodSubMeshes](int begin, int end) {
+        for (int surfaceIndex = begin; surfaceIndex < end; surfaceIndex++) {
+            const SubMesh *subMesh = surfaces[surfaceIndex]->subMesh;
+            const int numTris = subMesh->numIndexes / 3;
+
+            MeshSimplifier simplifier(subMesh->verts, subMesh->numVerts, subMesh->indexes, subMesh->numIndexes, subMesh->edges, subMesh->numEdges);
+
+            Array<int> lodIndexes;
+
+            for (int level = 0; level < numLevels; level++) {
+                simplifier.Simplify(Max((int)(numTris * reductionRatios[level]), 1));
+                simplifier.GetIndexes(lodIndexes);
+
+                SubMesh *lodSubMesh = new SubMesh;
+                lodSubMesh->AllocSimplifiedSubMesh(subMesh, lodIndexes.Ptr(), lodIndexes.Count());
+                lodSubMesh->ComputeAABB();
+                lodSubMesh->OptimizeIndexedTriangles();
+                lodSubMesh->ComputeEdges();
+
+                lodSubMeshes[surfaceIndex * numLevels + level] = lodSubMesh;
+            }
+        }
+    });
+
+    for (int level = 0; level < numLevels; level++) {
+        // Triangle density on screen is kept by switching when the projected area is reduced by the same ratio
+        MeshLod *lod = AllocLod(Math::Sqrt(reductionRatios[level]));
+
+        for (int surfaceIndex = 0; surfaceIndex < numSurfaces; surfaceIndex++) {
+            MeshSurf *surf = new MeshSurf;
+            surf->materialIndex = surfaces[surfaceIndex]->materialIndex;
+            surf->subMesh       = lodSubMeshes[surfaceIndex * numLevels + level];
+            surf->drawSurf      = nullptr;
+            surf->viewCount     = 0;
+
+            lod->surfaces.Append(surf);
+        }
+    }
+
+    for (int i = 0; i < instantiatedMeshes.Count(); i++) {
+        instantiatedMeshes[i]->Reinstantiate();
+    }
+
+    return true;
+}
+
+BE_NAMESPACE_END
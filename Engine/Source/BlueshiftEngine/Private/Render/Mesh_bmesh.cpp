@@ -53,19 +53,92 @@ bool Mesh::LoadBMesh(const char *filename) {
 
     // --- surfaces ---
     for (int surfaceIndex = 0; surfaceIndex < bMeshHeader->numSurfs; surfaceIndex++) {
-        const BMeshSurf *bMeshSurf = (const BMeshSurf *)ptr;
-        ptr += sizeof(BMeshSurf);
+        surfaces.Append(ReadBMeshSurf(ptr, bMeshHeader->version));
+    }
+
+    // --- LOD levels ---
+    if (bMeshHeader->version >= 2) {
+        uint32_t numLods = *(uint32_t *)ptr;
+        ptr += sizeof(uint32_t);
+
+        for (int lodIndex = 0; lodIndex < numLods; lodIndex++) {
+            BMeshLod bMeshLod;
+            memcpy(&bMeshLod, ptr, sizeof(BMeshLod));
+            ptr += sizeof(BMeshLod);
+
+            MeshLod *lod = AllocLod(bMeshLod.screenSize);
+
+            for (int surfaceIndex = 0; surfaceIndex < bMeshLod.numSurfs; surfaceIndex++) {
+                lod->surfaces.Append(ReadBMeshSurf(ptr, bMeshHeader->version));
+            }
+        }
+
+        // LOD surfaces are swapped with the base surfaces of the same index
+        for (int lodIndex = 0; lodIndex < lods.Count(); lodIndex++) {
+            if (lods[lodIndex]->surfaces.Count() != surfaces.Count()) {
+                BE_WARNLOG(L"Mesh::LoadBMesh: LOD %i has different number of surfaces in %hs\n", lodIndex + 1, filename);
+                FreeLods();
+                break;
+            }
+        }
+    }
+
+    fileSystem.FreeFile(data);
+
+    FinishSurfaces(OptimizeIndicesFlag);
 
-        MeshSurf *meshSurf = AllocSurface(bMeshSurf->numVerts, bMeshSurf->numIndexes);
-        surfaces.Append(meshSurf);
-        SubMesh *subMesh = meshSurf->subMesh;
+    return true;
+}
 
-        meshSurf->materialIndex = bMeshSurf->materialIndex;
+MeshSurf *Mesh::ReadBMeshSurf(byte *&ptr, int version) const {
+    const BMeshSurf *bMeshSurf = (const BMeshSurf *)ptr;
+    ptr += sizeof(BMeshSurf);
+
+    uint32_t vertexFormat = GenericVertexFormat;
+    if (version >= 3) {
+        vertexFormat = *(uint32_t *)ptr;
+        ptr += sizeof(uint32_t);
+    }
+
+    MeshSurf *meshSurf = AllocSurface(bMeshSurf->numVerts, bMeshSurf->numIndexes);
+    SubMesh *subMesh = meshSurf->subMesh;
+
+    meshSurf->materialIndex = bMeshSurf->materialIndex;
+
+    // --- vertexes ---
+    if (vertexFormat == CompactVertexFormat) {
+        BMeshCompactBounds bounds;
+        memcpy(&bounds, ptr, sizeof(BMeshCompactBounds));
+        ptr += sizeof(BMeshCompactBounds);
+
+        const Vec3 scale = bounds.positionScale / 32767.0f;
+
+        for (int i = 0; i < bMeshSurf->numVerts; i++) {
+            VertexLightingGeneric *v = &subMesh->verts[i];
+
+            BMeshCompactVert copy;
+            memcpy(&copy, ptr, sizeof(BMeshCompactVert));
+
+            Vec3 normal, tangent;
+            float bitangentSign;
+            DecodeCompactNormalTangent(copy.normalTangent, normal, tangent, bitangentSign);
+
+            v->SetPosition(copy.position[0] * scale.x + bounds.positionBias.x, copy.position[1] * scale.y + bounds.positionBias.y, copy.position[2] * scale.z + bounds.positionBias.z);
+            v->st[0] = copy.texCoord[0];
+            v->st[1] = copy.texCoord[1];
+            v->SetNormal(normal);
+            v->SetTangent(tangent);
+            v->SetBiTangentSign(bitangentSign);
+            v->SetColor(*reinterpret_cast<const uint32_t *>(copy.color));
+
+            ptr += sizeof(BMeshCompactVert);
+        }
 
-        // --- vertexes ---
+        subMesh->useCompactVertex = true;
+    } else {
         for (int i = 0; i < bMeshSurf->numVerts; i++) {
             VertexLightingGeneric *v = &subMesh->verts[i];
-            
+        
             BMeshVert copy;
             memcpy(&copy, ptr, sizeof(BMeshVert)); // for alignment BUS Error
 
@@ -78,86 +151,82 @@ bool Mesh::LoadBMesh(const char *filename) {
 
             ptr += sizeof(BMeshVert);
         }
+    }
 
-        // --- vertex weights ---
-        if (bMeshSurf->maxWeights > 0) {
-            int vertexWeightSize = 0;
-
-            if (bMeshSurf->maxWeights == 1) {
-                vertexWeightSize = sizeof(VertexWeight1);
-                subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
-                subMesh->gpuSkinningVersionIndex = 0;
-
-                VertexWeight1 *dstPtr = (VertexWeight1 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
-                    dstPtr->index = *ptr++;
-                }
-            } else if (bMeshSurf->maxWeights <= 4) {
-                vertexWeightSize = sizeof(VertexWeight4);
-                subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
-                subMesh->gpuSkinningVersionIndex = 1;
-
-                VertexWeight4 *dstPtr = (VertexWeight4 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
-                    dstPtr->index[0] = *ptr++;
-                    dstPtr->index[1] = *ptr++;
-                    dstPtr->index[2] = *ptr++;
-                    dstPtr->index[3] = *ptr++;
-
-                    dstPtr->weight[0] = *ptr++;
-                    dstPtr->weight[1] = *ptr++;
-                    dstPtr->weight[2] = *ptr++;
-                    dstPtr->weight[3] = *ptr++;
-                }
-            } else if (bMeshSurf->maxWeights <= 8) {
-                vertexWeightSize = sizeof(VertexWeight8);
-                subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
-                subMesh->gpuSkinningVersionIndex = 2;
-
-                VertexWeight8 *dstPtr = (VertexWeight8 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
-                    dstPtr->index[0] = *ptr++;
-                    dstPtr->index[1] = *ptr++;
-                    dstPtr->index[2] = *ptr++;
-                    dstPtr->index[3] = *ptr++;
-                    dstPtr->index[4] = *ptr++;
-                    dstPtr->index[5] = *ptr++;
-                    dstPtr->index[6] = *ptr++;
-                    dstPtr->index[7] = *ptr++;
-
-                    dstPtr->weight[0] = *ptr++;
-                    dstPtr->weight[1] = *ptr++;
-                    dstPtr->weight[2] = *ptr++;
-                    dstPtr->weight[3] = *ptr++;
-                    dstPtr->weight[4] = *ptr++;
-                    dstPtr->weight[5] = *ptr++;
-                    dstPtr->weight[6] = *ptr++;
-                    dstPtr->weight[7] = *ptr++;
-                }
-            } else {
-                assert(0);
-            }
-        }
+    // --- vertex weights ---
+    if (bMeshSurf->maxWeights > 0) {
+        int vertexWeightSize = 0;
+
+        if (bMeshSurf->maxWeights == 1) {
+            vertexWeightSize = sizeof(VertexWeight1);
+            subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
+            subMesh->gpuSkinningVersionIndex = 0;
 
-        // --- indexes ---
-        if (bMeshSurf->indexSize == 4) {
-            for (int i = 0; i < bMeshSurf->numIndexes; i++) {
-                subMesh->indexes[i] = *(uint32_t *)ptr;
-                ptr += sizeof(uint32_t);
+            VertexWeight1 *dstPtr = (VertexWeight1 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
+                dstPtr->index = *ptr++;
             }
-        } else if (bMeshSurf->indexSize == 2) {
-            for (int i = 0; i < bMeshSurf->numIndexes; i++) {
-                subMesh->indexes[i] = *(uint16_t *)ptr;
-                ptr += sizeof(uint16_t);
+        } else if (bMeshSurf->maxWeights <= 4) {
+            vertexWeightSize = sizeof(VertexWeight4);
+            subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
+            subMesh->gpuSkinningVersionIndex = 1;
+
+            VertexWeight4 *dstPtr = (VertexWeight4 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
+                dstPtr->index[0] = *ptr++;
+                dstPtr->index[1] = *ptr++;
+                dstPtr->index[2] = *ptr++;
+                dstPtr->index[3] = *ptr++;
+
+                dstPtr->weight[0] = *ptr++;
+                dstPtr->weight[1] = *ptr++;
+                dstPtr->weight[2] = *ptr++;
+                dstPtr->weight[3] = *ptr++;
             }
+        } else if (bMeshSurf->maxWeights <= 8) {
+            vertexWeightSize = sizeof(VertexWeight8);
+            subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
+            subMesh->gpuSkinningVersionIndex = 2;
+
+            VertexWeight8 *dstPtr = (VertexWeight8 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
+                dstPtr->index[0] = *ptr++;
+                dstPtr->index[1] = *ptr++;
+                dstPtr->index[2] = *ptr++;
+                dstPtr->index[3] = *ptr++;
+                dstPtr->index[4] = *ptr++;
+                dstPtr->index[5] = *ptr++;
+                dstPtr->index[6] = *ptr++;
+                dstPtr->index[7] = *ptr++;
+
+                dstPtr->weight[0] = *ptr++;
+                dstPtr->weight[1] = *ptr++;
+                dstPtr->weight[2] = *ptr++;
+                dstPtr->weight[3] = *ptr++;
+                dstPtr->weight[4] = *ptr++;
+                dstPtr->weight[5] = *ptr++;
+                dstPtr->weight[6] = *ptr++;
+                dstPtr->weight[7] = *ptr++;
+            }
+        } else {
+            assert(0);
         }
     }
 
-    fileSystem.FreeFile(data);
-
-    FinishSurfaces(0);
+    // --- indexes ---
+    if (bMeshSurf->indexSize == 4) {
+        for (int i = 0; i < bMeshSurf->numIndexes; i++) {
+            subMesh->indexes[i] = *(uint32_t *)ptr;
+            ptr += sizeof(uint32_t);
+        }
+    } else if (bMeshSurf->indexSize == 2) {
+        for (int i = 0; i < bMeshSurf->numIndexes; i++) {
+            subMesh->indexes[i] = *(uint16_t *)ptr;
+            ptr += sizeof(uint16_t);
+        }
+    }
 
-    return true;
+    return meshSurf;
 }
 
 void Mesh::WriteBMesh(const char *filename) {
@@ -188,18 +257,54 @@ void Mesh::WriteBMesh(const char *filename) {
 
     // --- surfaces ---
     for (int surfaceIndex = 0; surfaceIndex < bMeshHeader.numSurfs; surfaceIndex++) {
-        const MeshSurf *meshSurf = GetSurface(surfaceIndex);
-        const SubMesh *subMesh = meshSurf->subMesh;
-
-        BMeshSurf bMeshSurf;
-        bMeshSurf.materialIndex     = meshSurf->materialIndex;
-        bMeshSurf.numVerts          = subMesh->numVerts;
-        bMeshSurf.numIndexes        = subMesh->numIndexes;
-        bMeshSurf.indexSize         = subMesh->numIndexes < BIT(16) ? sizeof(uint16_t) : sizeof(uint32_t);
-        bMeshSurf.maxWeights        = subMesh->MaxVertexWeights();
-        fp->Write(&bMeshSurf, sizeof(bMeshSurf));
-
-        // --- vertexes ---
+        WriteBMeshSurf(fp, GetSurface(surfaceIndex));
+    }
+
+    // --- LOD levels ---
+    fp->WriteUInt32(lods.Count());
+
+    for (int lodIndex = 0; lodIndex < lods.Count(); lodIndex++) {
+        const MeshLod *lod = lods[lodIndex];
+
+        BMeshLod bMeshLod;
+        bMeshLod.screenSize         = lod->screenSize;
+        bMeshLod.numSurfs           = lod->surfaces.Count();
+        fp->Write(&bMeshLod, sizeof(bMeshLod));
+
+        for (int surfaceIndex = 0; surfaceIndex < lod->surfaces.Count(); surfaceIndex++) {
+            WriteBMeshSurf(fp, lod->surfaces[surfaceIndex]);
+        }
+    }
+
+    fileSystem.CloseFile(fp);
+}
+
+void Mesh::WriteBMeshSurf(File *fp, const MeshSurf *meshSurf) const {
+    const SubMesh *subMesh = meshSurf->subMesh;
+
+    BMeshSurf bMeshSurf;
+    bMeshSurf.materialIndex     = meshSurf->materialIndex;
+    bMeshSurf.numVerts          = subMesh->numVerts;
+    bMeshSurf.numIndexes        = subMesh->numIndexes;
+    bMeshSurf.indexSize         = subMesh->numIndexes < BIT(16) ? sizeof(uint16_t) : sizeof(uint32_t);
+    bMeshSurf.maxWeights        = subMesh->MaxVertexWeights();
+    fp->Write(&bMeshSurf, sizeof(bMeshSurf));
+
+    fp->WriteUInt32(subMesh->useCompactVertex ? CompactVertexFormat : GenericVertexFormat);
+
+    // --- vertexes ---
+    if (subMesh->useCompactVertex) {
+        BMeshCompactBounds bounds;
+        bounds.positionScale    = subMesh->CompactPositionScale();
+        bounds.positionBias     = subMesh->CompactPositionBias();
+        fp->Write(&bounds, sizeof(bounds));
+
+        // Same quantization as the vertex buffer
+        VertexCompact *compactVerts = (VertexCompact *)Mem_Alloc16(sizeof(VertexCompact) * subMesh->numVerts);
+        subMesh->WriteCompactVerts(compactVerts);
+        fp->Write(compactVerts, sizeof(VertexCompact) * subMesh->numVerts);
+        Mem_AlignedFree(compactVerts);
+    } else {
         for (int i = 0; i < subMesh->numVerts; i++) {
             const VertexLightingGeneric *v  = &subMesh->verts[i];
             const Vec3 position     = v->GetPosition();
@@ -207,7 +312,7 @@ void Mesh::WriteBMesh(const char *filename) {
             const Vec3 normal       = v->GetNormal();
             const Vec3 tangent      = v->GetTangent();
             const Vec3 biTangent    = v->GetBiTangent();
-            
+        
             fp->Write(&position, sizeof(Vec3));
             fp->Write(&texCoord, sizeof(Vec2));
             fp->Write(&normal, sizeof(Vec3));
@@ -215,64 +320,62 @@ void Mesh::WriteBMesh(const char *filename) {
             fp->Write(&biTangent, sizeof(Vec3));
             fp->WriteUInt32(subMesh->verts[i].GetColor());
         }
+    }
 
-        // --- vertex weights ---
-        if (bMeshSurf.maxWeights > 0) {
-            if (bMeshSurf.maxWeights == 1) {
-                VertexWeight1 *vw = (VertexWeight1 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
-                    fp->WriteUChar(vw->index);
-                }
-            } else if (bMeshSurf.maxWeights <= 4) {
-                VertexWeight4 *vw = (VertexWeight4 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
-                    fp->WriteUChar(vw->index[0]);
-                    fp->WriteUChar(vw->index[1]);
-                    fp->WriteUChar(vw->index[2]);
-                    fp->WriteUChar(vw->index[3]);
-
-                    fp->WriteUChar(vw->weight[0]);
-                    fp->WriteUChar(vw->weight[1]);
-                    fp->WriteUChar(vw->weight[2]);
-                    fp->WriteUChar(vw->weight[3]);
-                }
-            } else if (bMeshSurf.maxWeights <= 8) {
-                VertexWeight8 *vw = (VertexWeight8 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
-                    fp->WriteUChar(vw->index[0]);
-                    fp->WriteUChar(vw->index[1]);
-                    fp->WriteUChar(vw->index[2]);
-                    fp->WriteUChar(vw->index[3]);
-                    fp->WriteUChar(vw->index[4]);
-                    fp->WriteUChar(vw->index[5]);
-                    fp->WriteUChar(vw->index[6]);
-                    fp->WriteUChar(vw->index[7]);
-
-                    fp->WriteUChar(vw->weight[0]);
-                    fp->WriteUChar(vw->weight[1]);
-                    fp->WriteUChar(vw->weight[2]);
-                    fp->WriteUChar(vw->weight[3]);
-                    fp->WriteUChar(vw->weight[4]);
-                    fp->WriteUChar(vw->weight[5]);
-                    fp->WriteUChar(vw->weight[6]);
-                    fp->WriteUChar(vw->weight[7]);
-                }
+    // --- vertex weights ---
+    if (bMeshSurf.maxWeights > 0) {
+        if (bMeshSurf.maxWeights == 1) {
+            VertexWeight1 *vw = (VertexWeight1 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
+                fp->WriteUChar(vw->index);
             }
-        }
-
-        // --- indexes ---
-        if (subMesh->numIndexes < BIT(16)) {
-            for (int i = 0; i < subMesh->numIndexes; i++) {
-                fp->WriteUInt16(subMesh->indexes[i]);
+        } else if (bMeshSurf.maxWeights <= 4) {
+            VertexWeight4 *vw = (VertexWeight4 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
+                fp->WriteUChar(vw->index[0]);
+                fp->WriteUChar(vw->index[1]);
+                fp->WriteUChar(vw->index[2]);
+                fp->WriteUChar(vw->index[3]);
+
+                fp->WriteUChar(vw->weight[0]);
+                fp->WriteUChar(vw->weight[1]);
+                fp->WriteUChar(vw->weight[2]);
+                fp->WriteUChar(vw->weight[3]);
             }
-        } else {
-            for (int i = 0; i < subMesh->numIndexes; i++) {
-                fp->WriteUInt32(subMesh->indexes[i]);
+        } else if (bMeshSurf.maxWeights <= 8) {
+            VertexWeight8 *vw = (VertexWeight8 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
+                fp->WriteUChar(vw->index[0]);
+                fp->WriteUChar(vw->index[1]);
+                fp->WriteUChar(vw->index[2]);
+                fp->WriteUChar(vw->index[3]);
+                fp->WriteUChar(vw->index[4]);
+                fp->WriteUChar(vw->index[5]);
+                fp->WriteUChar(vw->index[6]);
+                fp->WriteUChar(vw->index[7]);
+
+                fp->WriteUChar(vw->weight[0]);
+                fp->WriteUChar(vw->weight[1]);
+                fp->WriteUChar(vw->weight[2]);
+                fp->WriteUChar(vw->weight[3]);
+                fp->WriteUChar(vw->weight[4]);
+                fp->WriteUChar(vw->weight[5]);
+                fp->WriteUChar(vw->weight[6]);
+                fp->WriteUChar(vw->weight[7]);
             }
         }
     }
 
-    fileSystem.CloseFile(fp);
+    // --- indexes ---
+    if (subMesh->numIndexes < BIT(16)) {
+        for (int i = 0; i < subMesh->numIndexes; i++) {
+            fp->WriteUInt16(subMesh->indexes[i]);
+        }
+    } else {
+        for (int i = 0; i < subMesh->numIndexes; i++) {
+            fp->WriteUInt32(subMesh->indexes[i]);
+        }
+    }
 }
     
 BE_NAMESPACE_END
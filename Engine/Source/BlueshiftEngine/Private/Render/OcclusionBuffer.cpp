@@ -0,0 +1,252 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderInternal.h"
+#include "Core/JobSystem.h"
+#include "Core/Heap.h"
+#include "SIMD/Simd.h"
+#include "Core/Profiler.h"
+
+BE_NAMESPACE_BEGIN
+
+// Triangles are clipped by the plane w = OCCLUSION_NEAR_W, bounds crossing it are never occluded
+#define OCCLUSION_NEAR_W    0.001f
+
+OcclusionBuffer::OcclusionBuffer() {
+    depthBuffer = (float *)Mem_Alloc16(sizeof(float) * Width * Height);
+    hiZBuffer = (float *)Mem_Alloc16(sizeof(float) * HiZWidth * HiZHeight);
+
+    triVerts.SetGranularity(1024);
+    for (int i = 0; i < NumTiles; i++) {
+        tileTris[i].SetGranularity(256);
+    }
+
+    numTris = 0;
+}
+
+OcclusionBuffer::~OcclusionBuffer() {
+    Mem_AlignedFree(depthBuffer);
+    Mem_AlignedFree(hiZBuffer);
+}
+
+void OcclusionBuffer::Begin(const view_t *view) {
+    viewProjMatrix = view->def->viewProjMatrix;
+
+    triVerts.SetCount(0, false);
+    for (int i = 0; i < NumTiles; i++) {
+        tileTris[i].SetCount(0, false);
+    }
+
+    numTris = 0;
+}
+
+void OcclusionBuffer::AddOccluder(const Mat4 &modelViewProjMatrix, const SubMesh *subMesh) {
+    const VertexLightingGeneric *verts = subMesh->Verts();
+    const TriIndex *indexes = subMesh->Indexes();
+
+    clipVerts.SetCount(subMesh->NumVerts(), false);
+    for (int i = 0; i < subMesh->NumVerts(); i++) {
+        clipVerts[i] = modelViewProjMatrix * Vec4(verts[i].xyz, 1.0f);
+    }
+
+    for (int i = 0; i < subMesh->NumIndexes(); i += 3) {
+        const Vec4 &clip0 = clipVerts[indexes[i + 0]];
+        const Vec4 &clip1 = clipVerts[indexes[i + 1]];
+        const Vec4 &clip2 = clipVerts[indexes[i + 2]];
+
+        // Trivially reject the triangle outside of the one of the side planes
+        if ((clip0.x > clip0.w && clip1.x > clip1.w && clip2.x > clip2.w) ||
+            (clip0.x < -clip0.w && clip1.x < -clip1.w && clip2.x < -clip2.w) ||
+            (clip0.y > clip0.w && clip1.y > clip1.w && clip2.y > clip2.w) ||
+            (clip0.y < -clip0.w && clip1.y < -clip1.w && clip2.y < -clip2.w)) {
+            continue;
+        }
+
+        const int clipBits = (clip0.w < OCCLUSION_NEAR_W ? 1 : 0) | (clip1.w < OCCLUSION_NEAR_W ? 2 : 0) | (clip2.w < OCCLUSION_NEAR_W ? 4 : 0);
+        if (clipBits == 7) {
+            continue;
+        }
+
+        if (!clipBits) {
+            AddTriangle(clip0, clip1, clip2);
+            continue;
+        }
+
+        // Clip the triangle by the near plane, results in a triangle or a quad
+        const Vec4 *in[3] = { &clip0, &clip1, &clip2 };
+        Vec4 out[4];
+        int numOut = 0;
+
+        for (int j = 0; j < 3; j++) {
+            const Vec4 &a = *in[j];
+            const Vec4 &b = *in[(j + 1) % 3];
+            const bool aInside = a.w >= OCCLUSION_NEAR_W;
+            const bool bInside = b.w >= OCCLUSION_NEAR_W;
+
+            if (aInside) {
+                out[numOut++] = a;
+            }
+            if (aInside != bInside) {
+                const float t = (OCCLUSION_NEAR_W - a.w) / (b.w - a.w);
+                out[numOut++] = a + (b - a) * t;
+            }
+        }
+
+        for (int j = 2; j < numOut; j++) {
+            AddTriangle(out[0], out[j - 1], out[j]);
+        }
+    }
+}
+
+void OcclusionBuffer::AddTriangle(const Vec4 &clip0, const Vec4 &clip1, const Vec4 &clip2) {
+    const Vec4 *clip[3] = { &clip0, &clip1, &clip2 };
+    Vec3 screen[3];
+
+    for (int i = 0; i < 3; i++) {
+        const float invW = 1.0f / clip[i]->w;
+        screen[i].x = (clip[i]->x * invW * 0.5f + 0.5f) * Width;
+        screen[i].y = (clip[i]->y * invW * 0.5f + 0.5f) * Height;
+        screen[i].z = invW;
+    }
+
+    const float minX = Min(Min(screen[0].x, screen[1].x), screen[2].x);
+    const float minY = Min(Min(screen[0].y, screen[1].y), screen[2].y);
+    const float maxX = Max(Max(screen[0].x, screen[1].x), screen[2].x);
+    const float maxY = Max(Max(screen[0].y, screen[1].y), screen[2].y);
+
+    if (maxX <= 0.0f || maxY <= 0.0f || minX >= Width || minY >= Height) {
+        return;
+    }
+
+    const int tileX0 = Max((int)minX, 0) / TileWidth;
+    const int tileY0 = Max((int)minY, 0) / TileHeight;
+    const int tileX1 = (int)Min(maxX, (float)(Width - 1)) / TileWidth;
+    const int tileY1 = (int)Min(maxY, (float)(Height - 1)) / TileHeight;
+
+    const int triNum = numTris++;
+
+    triVerts.Append(screen[0]);
+    triVerts.Append(screen[1]);
+    triVerts.Append(screen[2]);
+
+    for (int tileY = tileY0; tileY <= tileY1; tileY++) {
+        for (int tileX = tileX0; tileX <= tileX1; tileX++) {
+            tileTris[tileY * NumTilesX + tileX].Append(triNum);
+        }
+    }
+}
+
+void OcclusionBuffer::Rasterize(bool parallel) {
+    BE_PROFILE_SCOPE("OcclusionBuffer::Rasterize");
+
+    JobSystem::ParallelFor(0, NumTiles, parallel ? 1 : NumTiles, [this](int begin, int end) {
+        for (int tileIndex = begin; tileIndex < end; tileIndex++) {
+            RasterizeTile(tileIndex);
+        }
+    });
+}
+
+void OcclusionBuffer::RasterizeTile(int tileIndex) {
+    const int minX = (tileIndex % NumTilesX) * TileWidth;
+    const int minY = (tileIndex / NumTilesX) * TileHeight;
+
+    for (int y = minY; y < minY + TileHeight; y++) {
+        memset(depthBuffer + y * Width + minX, 0, sizeof(float) * TileWidth);
+    }
+
+    simdProcessor->RasterizeOccluderTriangles(depthBuffer, Width, triVerts.Ptr(), tileTris[tileIndex].Ptr(), tileTris[tileIndex].Count(), minX, minY, minX + TileWidth, minY + TileHeight);
+
+    // Tiles are multiples of the blocks, so each tile writes its own blocks only
+    for (int blockY = minY / HiZBlockSize; blockY < (minY + TileHeight) / HiZBlockSize; blockY++) {
+        for (int blockX = minX / HiZBlockSize; blockX < (minX + TileWidth) / HiZBlockSize; blockX++) {
+            float farthest = FLT_MAX;
+
+            for (int y = blockY * HiZBlockSize; y < (blockY + 1) * HiZBlockSize; y++) {
+                const float *src = depthBuffer + y * Width + blockX * HiZBlockSize;
+                for (int x = 0; x < HiZBlockSize; x++) {
+                    farthest = Min(farthest, src[x]);
+                }
+            }
+
+            hiZBuffer[blockY * HiZWidth + blockX] = farthest;
+        }
+    }
+}
+
+bool OcclusionBuffer::IsOccluded(const AABB &aabb) const {
+    if (!numTris) {
+        return false;
+    }
+
+    Vec3 points[8];
+    aabb.ToPoints(points);
+
+    float minX = FLT_MAX, minY = FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX;
+    float nearest = 0.0f;
+
+    for (int i = 0; i < 8; i++) {
+        const Vec4 clip = viewProjMatrix * Vec4(points[i], 1.0f);
+        if (clip.w < OCCLUSION_NEAR_W) {
+            return false;
+        }
+
+        const float invW = 1.0f / clip.w;
+        const float x = (clip.x * invW * 0.5f + 0.5f) * Width;
+        const float y = (clip.y * invW * 0.5f + 0.5f) * Height;
+
+        minX = Min(minX, x);
+        minY = Min(minY, y);
+        maxX = Max(maxX, x);
+        maxY = Max(maxY, y);
+        nearest = Max(nearest, invW);
+    }
+
+    const int x0 = (int)Max(minX, 0.0f);
+    const int y0 = (int)Max(minY, 0.0f);
+    const int x1 = (int)Math::Ceil(Min(maxX, (float)Width));
+    const int y1 = (int)Math::Ceil(Min(maxY, (float)Height));
+    if (x0 >= x1 || y0 >= y1) {
+        return false;
+    }
+
+    for (int blockY = y0 / HiZBlockSize; blockY <= (y1 - 1) / HiZBlockSize; blockY++) {
+        for (int blockX = x0 / HiZBlockSize; blockX <= (x1 - 1) / HiZBlockSize; blockX++) {
+            // Whole block is nearer than the bounds
+            if (hiZBuffer[blockY * HiZWidth + blockX] > nearest) {
+                continue;
+            }
+
+            const int bx0 = Max(blockX * HiZBlockSize, x0);
+            const int by0 = Max(blockY * HiZBlockSize, y0);
+            const int bx1 = Min((blockX + 1) * HiZBlockSize, x1);
+            const int by1 = Min((blockY + 1) * HiZBlockSize, y1);
+
+            for (int y = by0; y < by1; y++) {
+                const float *src = depthBuffer + y * Width;
+                for (int x = bx0; x < bx1; x++) {
+                    if (src[x] <= nearest) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+BE_NAMESPACE_END
@@ -0,0 +1,79 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    OcclusionBuffer
+
+    Small CPU depth buffer for the occlusion culling in the front end.
+    Occluder triangles are binned to the screen tiles and the tiles are rasterized in parallel.
+    Depth is stored as 1/w, so the larger value is nearer and the cleared value 0 is infinitely far.
+    Each tile builds the hierarchical depth (farthest depth of each block) to test the bounds quickly.
+
+-------------------------------------------------------------------------------
+*/
+
+BE_NAMESPACE_BEGIN
+
+class OcclusionBuffer {
+public:
+    enum {
+        Width           = 256,
+        Height          = 128,
+        TileWidth       = 64,
+        TileHeight      = 32,
+        NumTilesX       = Width / TileWidth,
+        NumTilesY       = Height / TileHeight,
+        NumTiles        = NumTilesX * NumTilesY,
+        HiZBlockSize    = 8,
+        HiZWidth        = Width / HiZBlockSize,
+        HiZHeight       = Height / HiZBlockSize
+    };
+
+    OcclusionBuffer();
+    ~OcclusionBuffer();
+
+                        /// Clears the occluders and starts the occlusion culling for the view.
+    void                Begin(const view_t *view);
+
+                        /// Transforms, clips and bins the triangles of the occluder sub mesh.
+    void                AddOccluder(const Mat4 &modelViewProjMatrix, const SubMesh *subMesh);
+
+                        /// Rasterizes the binned triangles and builds the hierarchical depth.
+    void                Rasterize(bool parallel);
+
+                        /// Returns number of the occluder triangles added since Begin().
+    int                 NumTris() const { return numTris; }
+
+                        /// Returns true if the world space bounds are hidden by the occluders completely.
+    bool                IsOccluded(const AABB &aabb) const;
+
+private:
+    void                AddTriangle(const Vec4 &clip0, const Vec4 &clip1, const Vec4 &clip2);
+    void                RasterizeTile(int tileIndex);
+
+    float *             depthBuffer;
+    float *             hiZBuffer;
+    Mat4                viewProjMatrix;
+
+    Array<Vec4>         clipVerts;                  // temporary clip space vertices of the occluder
+    Array<Vec3>         triVerts;                   // screen space (x, y, 1/w), three per triangle
+    Array<int>          tileTris[NumTiles];         // triangle numbers binned to each tile
+    int                 numTris;
+};
+
+BE_NAMESPACE_END
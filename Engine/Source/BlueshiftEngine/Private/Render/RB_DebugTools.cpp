@@ -16,6 +16,7 @@
 #include "Render/Render.h"
 #include "RenderInternal.h"
 #include "Simplex.h"
+#include "Core/Profiler.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -64,6 +65,9 @@ static int          rb_numDebugText = 0;
 static int          rb_debugTextTime = 0;
 
 void RB_ClearDebugPrimitives(int time) {
+    // Debug primitives are read by the render thread
+    renderSystem.SyncRenderThread();
+
     rb_debugPrimsTime = time;
 
     if (!time) {
@@ -95,6 +99,8 @@ void RB_ClearDebugPrimitives(int time) {
 }
 
 Vec3 *RB_ReserveDebugPrimsVerts(int prims, int numVerts, const Color4 &color, const float lineWidth, const bool twoSided, const bool depthTest, const int lifeTime) {
+    renderSystem.SyncRenderThread();
+
     DebugPrims *debugPrims;
     byte rgba[4];
 
@@ -259,6 +265,8 @@ static void RB_DrawDebugPrims() {
 }
 
 void RB_ClearDebugText(int time) {
+    renderSystem.SyncRenderThread();
+
     rb_debugTextTime = time;
 
     if (!time) {
@@ -286,6 +294,8 @@ void RB_ClearDebugText(int time) {
 }
 
 void RB_AddDebugText(const char *text, const Vec3 &origin, const Mat3 &viewAxis, float scale, float lineWidth, const Color4 &color, const int align, const int lifeTime, const bool depthTest) {
+    renderSystem.SyncRenderThread();
+
     DebugText *debugText;
     byte rgba[4];
 
@@ -546,7 +556,7 @@ static void RB_DrawDebugText() {
 }
 
 void RB_DrawTris(int numDrawSurfs, DrawSurf **drawSurfs, bool forceToDraw) {
-    int					prevSortkey = -1;
+    uint64_t				prevSortkey = UINT64_MAX;
     const Material *	prevMaterial = nullptr;
     viewEntity_t *		prevEntity = nullptr;
     bool				depthhack = false;
@@ -674,6 +684,8 @@ static void RB_DrawDebugLightScissorRects() {
 }
 
 void RB_DebugPass(int numDrawSurfs, DrawSurf **drawSurfs) {
+    BE_PROFILE_SCOPE("RB_DebugPass");
+
     /*if (r_showTangentSpace.GetBool()) {
         DrawDebugTangentSpace(r_showTangentSpace.GetInteger() - 1);
     }
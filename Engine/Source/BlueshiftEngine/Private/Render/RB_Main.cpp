@@ -16,6 +16,7 @@
 #include "Render/Render.h"
 #include "RenderInternal.h"
 #include "Platform/PlatformTime.h"
+#include "Core/Profiler.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -479,6 +480,8 @@ static void RB_ClearView() {
 
 // FIXME: subview 일 경우를 생각
 static void RB_DrawView() {
+    BE_PROFILE_SCOPE("RB_DrawView");
+
     if (backEnd.ctx->flags & RenderContext::UseSelectionBuffer) {
         backEnd.ctx->screenSelectionRT->Begin();
 
@@ -612,6 +615,8 @@ static void RB_DrawView() {
 }
 
 static void RB_Draw2DView() {
+    BE_PROFILE_SCOPE("RB_Draw2DView");
+
     if (!backEnd.numDrawSurfs) {
         return;
     }
@@ -995,6 +1000,8 @@ static const void *RB_ExecuteSwapBuffers(const void *data) {
 }
 
 void RB_Execute(const void *data) {
+    BE_PROFILE_SCOPE("RB_Execute");
+
     int t1, t2;
 
     t1 = PlatformTime::Milliseconds();
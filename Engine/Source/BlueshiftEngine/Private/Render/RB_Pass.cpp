@@ -15,11 +15,14 @@
 #include "Precompiled.h"
 #include "Render/Render.h"
 #include "RenderInternal.h"
+#include "Core/Profiler.h"
 
 BE_NAMESPACE_BEGIN
 
 void RB_SelectionPass(int numDrawSurfs, DrawSurf **drawSurfs) {
-    int                 prevSortkey = -1;
+    BE_PROFILE_SCOPE("RB_SelectionPass");
+
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     const Material *    prevMaterial = nullptr;
     bool                prevDepthHack = false;
@@ -92,7 +95,9 @@ void RB_SelectionPass(int numDrawSurfs, DrawSurf **drawSurfs) {
 }
 
 void RB_OccluderPass(int numDrawSurfs, DrawSurf **drawSurfs) {
-    int                 prevSortkey = -1;
+    BE_PROFILE_SCOPE("RB_OccluderPass");
+
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     const Material *    prevMaterial = nullptr;
     bool                prevDepthHack = false;
@@ -168,7 +173,9 @@ void RB_OccluderPass(int numDrawSurfs, DrawSurf **drawSurfs) {
 }
 
 void RB_DepthPrePass(int numDrawSurfs, DrawSurf **drawSurfs) {
-    int                 prevSortkey = -1;
+    BE_PROFILE_SCOPE("RB_DepthPrePass");
+
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     const Material *    prevMaterial = nullptr;
     bool                prevDepthHack = false;
@@ -179,6 +186,11 @@ void RB_DepthPrePass(int numDrawSurfs, DrawSurf **drawSurfs) {
             continue;
         }
 
+        if (!surf->numInstances) {
+            // drawn by the instanced draw of the preceding surface
+            continue;
+        }
+
         if (surf->sortkey != prevSortkey) {
             if (!(surf->material->GetCoverage() & (Material::OpaqueCoverage | Material::PerforatedCoverage))) {
                 continue;
@@ -229,7 +241,11 @@ void RB_DepthPrePass(int numDrawSurfs, DrawSurf **drawSurfs) {
             prevSortkey = surf->sortkey;
         }
 
-        backEnd.rbsurf.DrawSubMesh(surf->subMesh, surf->guiSubMesh);
+        if (surf->instanceCache) {
+            backEnd.rbsurf.DrawInstancedSubMesh(surf->subMesh, surf->instanceCache, surf->numInstances);
+        } else {
+            backEnd.rbsurf.DrawSubMesh(surf->subMesh, surf->guiSubMesh);
+        }
     }
 
     if (prevMaterial) {
@@ -243,7 +259,9 @@ void RB_DepthPrePass(int numDrawSurfs, DrawSurf **drawSurfs) {
 }
 
 void RB_AmbientPass(int numDrawSurfs, DrawSurf **drawSurfs) {
-    int                 prevSortkey = -1;
+    BE_PROFILE_SCOPE("RB_AmbientPass");
+
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     const Material *    prevMaterial = nullptr;
     bool                prevDepthHack = false;
@@ -254,6 +272,11 @@ void RB_AmbientPass(int numDrawSurfs, DrawSurf **drawSurfs) {
             continue;
         }
 
+        if (!surf->numInstances) {
+            // drawn by the instanced draw of the preceding surface
+            continue;
+        }
+
         if (surf->sortkey != prevSortkey) {
             if (!(surf->material->GetCoverage() & (Material::OpaqueCoverage | Material::PerforatedCoverage))) {
                 continue;
@@ -298,7 +321,11 @@ void RB_AmbientPass(int numDrawSurfs, DrawSurf **drawSurfs) {
             prevSortkey = surf->sortkey;
         }
         
-        backEnd.rbsurf.DrawSubMesh(surf->subMesh, surf->guiSubMesh);
+        if (surf->instanceCache) {
+            backEnd.rbsurf.DrawInstancedSubMesh(surf->subMesh, surf->instanceCache, surf->numInstances);
+        } else {
+            backEnd.rbsurf.DrawSubMesh(surf->subMesh, surf->guiSubMesh);
+        }
     }
 
     if (prevMaterial) {
@@ -312,7 +339,9 @@ void RB_AmbientPass(int numDrawSurfs, DrawSurf **drawSurfs) {
 }
 
 void RB_BlendPass(int numDrawSurfs, DrawSurf **drawSurfs) {
-    int                 prevSortkey = -1;
+    BE_PROFILE_SCOPE("RB_BlendPass");
+
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     const Material *    prevMaterial = nullptr;
     bool                prevDepthHack = false;
@@ -377,7 +406,9 @@ void RB_BlendPass(int numDrawSurfs, DrawSurf **drawSurfs) {
 }
 
 void RB_VelocityMapPass(int numDrawSurfs, DrawSurf **drawSurfs) {
-    int                 prevSortkey = -1;
+    BE_PROFILE_SCOPE("RB_VelocityMapPass");
+
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     viewEntity_t *      skipEntity = nullptr;
     const Material *    prevMaterial = nullptr;
@@ -471,7 +502,9 @@ void RB_VelocityMapPass(int numDrawSurfs, DrawSurf **drawSurfs) {
 }
 
 void RB_FinalPass(int numDrawSurfs, DrawSurf **drawSurfs) {
-    int                 prevSortkey = -1;
+    BE_PROFILE_SCOPE("RB_FinalPass");
+
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     const Material *    prevMaterial = nullptr;
     bool                prevDepthHack = false;
@@ -545,7 +578,9 @@ void RB_FinalPass(int numDrawSurfs, DrawSurf **drawSurfs) {
 }
 
 void RB_GuiPass(int numDrawSurfs, DrawSurf **drawSurfs) {
-    int                 prevSortkey = -1;
+    BE_PROFILE_SCOPE("RB_GuiPass");
+
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     const Material *    prevMaterial = nullptr;
     bool                prevDepthHack = false;
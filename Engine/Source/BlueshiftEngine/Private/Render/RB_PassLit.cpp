@@ -15,6 +15,7 @@
 #include "Precompiled.h"
 #include "Render/Render.h"
 #include "RenderInternal.h"
+#include "Core/Profiler.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -182,7 +183,7 @@ static bool RB_ComputeShadowCropMatrix(const Frustum &lightFrustum, const Frustu
 }
 
 static void RB_LitPass(const viewLight_t *viewLight, bool skipSelfShadow, bool skipNoSelfShadow) {
-    int                 prevSortkey = -1;
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     const Material *    prevMaterial = nullptr;
     bool                prevDepthHack = false;
@@ -247,7 +248,7 @@ static void RB_LitPass(const viewLight_t *viewLight, bool skipSelfShadow, bool s
 }
 
 static bool RB_ShadowCubeMapFacePass(const viewLight_t *viewLight, const Mat4 &lightViewMatrix, const Frustum &lightFrustum, const Frustum &viewFrustum, bool forceClear, int cubeMapFace) {
-    int                 prevSortkey = -1;
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     viewEntity_t *      skipEntity = nullptr;
     viewEntity_t *      entity2 = nullptr;
@@ -463,7 +464,7 @@ static void RB_ShadowCubeMapAndLitPass(const viewLight_t *viewLight) {
 
 // TODO: cascade 별로 컬링해야함
 static bool RB_ShadowMapPass(const viewLight_t *viewLight, const Frustum &viewFrustum, int cascadeIndex, bool forceClear) {
-    int                 prevSortkey = -1;
+    uint64_t            prevSortkey = UINT64_MAX;
     viewEntity_t *      prevEntity = nullptr;
     viewEntity_t *      skipEntity = nullptr;
     viewEntity_t *      entity2 = nullptr;
@@ -867,6 +868,8 @@ static void RB_ShadowMapAndLitPass(const viewLight_t *viewLight) {
 }
 
 void RB_AllShadowAndLitPass(viewLight_t *viewLights) {
+    BE_PROFILE_SCOPE("RB_AllShadowAndLitPass");
+
     Rect prevScissorRect;
 
     backEnd.mainLight = nullptr;
@@ -29,6 +29,7 @@ void RBSurf::Init() {
     numVerts = 0;
     numIndexes = 0;
     numInstances = 0;
+    instanceCache = nullptr;
 
     material = nullptr;
     subMesh = nullptr;
@@ -83,6 +84,26 @@ void RBSurf::DrawStaticSubMesh(SubMesh *subMesh) {
     Flush();
 }
 
+void RBSurf::DrawInstancedSubMesh(SubMesh *subMesh, const BufferCache *instanceCache, int numInstances) {
+    if (this->numIndexes) {
+        Flush();
+    }
+
+    this->startIndex = 0;
+
+    this->vbHandle = subMesh->ambientCache->buffer;
+    this->ibHandle = subMesh->indexCache->buffer;
+
+    this->numVerts = subMesh->numVerts;
+    this->numIndexes = subMesh->numIndexes;
+    this->numInstances = numInstances;
+    this->instanceCache = instanceCache;
+
+    this->subMesh = subMesh;
+
+    Flush();
+}
+
 void RBSurf::DrawDynamicSubMesh(SubMesh *subMesh) {
     if (startIndex < 0) {
         // startIndex 는 Flush 후에 -1 로 세팅된다
@@ -129,6 +150,9 @@ void RBSurf::SetSubMeshVertexFormat(const SubMesh *subMesh, int vertexFormatInde
             glr.SetVertexFormat(vertexFormats[vertexFormatIndex + subMesh->gpuSkinningVersionIndex + 1].vertexFormatHandle);
             glr.SetStreamSource(0, vbHandle, 0, sizeof(VertexLightingGeneric));
             glr.SetStreamSource(1, vbHandle, sizeof(VertexLightingGeneric) * numVerts, subMesh->VertexWeightSize());
+        } else if (subMesh->useCompactVertex) {
+            glr.SetVertexFormat(vertexFormats[VertexFormat::ToCompactVertexFormat(vertexFormatIndex)].vertexFormatHandle);
+            glr.SetStreamSource(0, vbHandle, 0, sizeof(VertexCompact));
         } else {
             glr.SetVertexFormat(vertexFormats[vertexFormatIndex].vertexFormatHandle);
             glr.SetStreamSource(0, vbHandle, 0, sizeof(VertexLightingGeneric));
@@ -198,6 +222,7 @@ void RBSurf::Flush() {
     numVerts = 0;
     numIndexes = 0;
     numInstances = 0;
+    instanceCache = nullptr;
 }
 
 void RBSurf::Flush_SelectionPass() {
@@ -28,14 +28,16 @@ void RBSurf::DrawPrimitives() const {
         glr.DrawElements(Renderer::TrianglesPrim, startIndex, numIndexes, sizeof(TriIndex), 0);
     }
 
+    const int instanceCount = Max(numInstances, 1);
+
     if (flushType == ShadowFlush) {
         backEnd.ctx->renderCounter.shadowDrawCalls++;
-        backEnd.ctx->renderCounter.shadowDrawIndexes += numIndexes;
-        backEnd.ctx->renderCounter.shadowDrawVerts += numVerts;
+        backEnd.ctx->renderCounter.shadowDrawIndexes += numIndexes * instanceCount;
+        backEnd.ctx->renderCounter.shadowDrawVerts += numVerts * instanceCount;
     } else {
         backEnd.ctx->renderCounter.drawCalls++;
-        backEnd.ctx->renderCounter.drawIndexes += numIndexes;
-        backEnd.ctx->renderCounter.drawVerts += numVerts;
+        backEnd.ctx->renderCounter.drawIndexes += numIndexes * instanceCount;
+        backEnd.ctx->renderCounter.drawVerts += numVerts * instanceCount;
     }
 }
 
@@ -132,6 +134,45 @@ void RBSurf::SetMatrixConstants(const Shader *shader) const {
     if (shader->builtInConstantLocations[Shader::ModelViewProjectionMatrixTransposeConst] >= 0) {
         shader->SetConstant4x4f(shader->builtInConstantLocations[Shader::ModelViewProjectionMatrixTransposeConst], false, backEnd.modelViewProjMatrix);
     }
+
+    SetCompactVertexConstants(shader);
+
+    if (instanceCache) {
+        SetInstancingConstants(shader);
+    }
+}
+
+// Dequantization parameters of the compact vertices, the identity for the generic vertices
+void RBSurf::SetCompactVertexConstants(const Shader *shader) const {
+    const bool compact = subMesh && subMesh->useCompactVertex;
+
+    if (shader->builtInConstantLocations[Shader::PositionScaleConst] >= 0) {
+        shader->SetConstant3f(shader->builtInConstantLocations[Shader::PositionScaleConst], compact ? subMesh->CompactPositionScale() : Vec3::one);
+    }
+
+    if (shader->builtInConstantLocations[Shader::PositionBiasConst] >= 0) {
+        shader->SetConstant3f(shader->builtInConstantLocations[Shader::PositionBiasConst], compact ? subMesh->CompactPositionBias() : Vec3::zero);
+    }
+
+    if (shader->builtInConstantLocations[Shader::CompactVertexConst] >= 0) {
+        shader->SetConstant1f(shader->builtInConstantLocations[Shader::CompactVertexConst], compact ? 1.0f : 0.0f);
+    }
+}
+
+// Entity data of the instances are fetched from the instance buffer written in the front end
+void RBSurf::SetInstancingConstants(const Shader *shader) const {
+    const Texture *instanceDataTexture = instanceCache->texture;
+    shader->SetTexture("instanceDataMap", instanceDataTexture);
+
+    if (shader->builtInConstantLocations[Shader::InstanceIndexBaseConst] >= 0) {
+        // tcBase[1] is always 0 for the texture buffer object
+        int indexBase = instanceCache->tcBase[1] * instanceDataTexture->GetWidth() + instanceCache->tcBase[0];
+        shader->SetConstant1i(shader->builtInConstantLocations[Shader::InstanceIndexBaseConst], indexBase);
+    }
+
+    if (shader->builtInConstantLocations[Shader::ViewProjectionMatrixConst] >= 0) {
+        shader->SetConstant4x4f(shader->builtInConstantLocations[Shader::ViewProjectionMatrixConst], true, backEnd.view->def->viewProjMatrix);
+    }
 }
 
 void RBSurf::SetVertexColorConstants(const Shader *shader, const Material::VertexColorMode &vertexColor) const {
@@ -253,6 +294,11 @@ void RBSurf::RenderDepth(const Material::Pass *mtrlPass) const {
         shader = shader->perforatedVersion;
     }
 
+    if (instanceCache) {
+        assert(shader->instancedVersion);
+        shader = shader->instancedVersion;
+    }
+
     if (subMesh && subMesh->useGpuSkinning) {
         if (shader->gpuSkinningVersion[subMesh->gpuSkinningVersionIndex]) {
             shader = shader->gpuSkinningVersion[subMesh->gpuSkinningVersionIndex];
@@ -352,6 +398,11 @@ void RBSurf::RenderAmbient(const Material::Pass *mtrlPass, float ambientScale) c
             }
         }
 
+        if (instanceCache) {
+            assert(shader->instancedVersion);
+            shader = shader->instancedVersion;
+        }
+
         if (subMesh && subMesh->useGpuSkinning) {
             if (shader->gpuSkinningVersion[subMesh->gpuSkinningVersionIndex]) {
                 shader = shader->gpuSkinningVersion[subMesh->gpuSkinningVersionIndex];
@@ -401,6 +452,11 @@ void RBSurf::RenderAmbient(const Material::Pass *mtrlPass, float ambientScale) c
                 shader = shader->perforatedVersion;
             }
         }
+
+        if (instanceCache) {
+            assert(shader->instancedVersion);
+            shader = shader->instancedVersion;
+        }
         
         if (subMesh && subMesh->useGpuSkinning) {
             if (shader->gpuSkinningVersion[subMesh->gpuSkinningVersionIndex]) {
@@ -700,6 +756,8 @@ void RBSurf::RenderFogLightInteraction(const Material::Pass *mtrlPass) const {
 
     shader->Bind();
 
+    SetCompactVertexConstants(shader);
+
     // light texture transform matrix
     Mat4 viewProjScaleBiasMat = surfLight->def->GetViewProjScaleBiasMatrix() * surfEntity->def->GetModelMatrix();	
     shader->SetConstant4x4f("lightTextureMatrix", true, viewProjScaleBiasMat);
@@ -739,6 +797,8 @@ void RBSurf::RenderBlendLightInteraction(const Material::Pass *mtrlPass) const {
 
     shader->Bind();
 
+    SetCompactVertexConstants(shader);
+
     // light texture transform matrix
     Mat4 viewProjScaleBiasMat = surfLight->def->GetViewProjScaleBiasMatrix() * surfEntity->def->GetModelMatrix();
     shader->SetConstant4x4f("lightTextureMatrix", true, viewProjScaleBiasMat);
@@ -49,6 +49,8 @@ public:
 
     void                Begin(int flushType, const Material *material, const float *materialRegisters, const viewEntity_t *surfEntity, const viewLight_t *surfLight);
     void                DrawSubMesh(SubMesh *subMesh, GuiSubMesh *guiSubMesh);
+                        // Draws numInstances of the static sub mesh with the entity data in instanceCache
+    void                DrawInstancedSubMesh(SubMesh *subMesh, const BufferCache *instanceCache, int numInstances);
     void                Flush();
 
     void                EndFrame();
@@ -76,6 +78,8 @@ private:
     void                SetShaderProperties(const Shader *shader, const StrHashMap<Shader::Property> &shaderProperties) const;
     const Texture *     TextureFromShaderProperties(const Material::Pass *mtrlPass, const Str &textureName) const;
     void                SetMatrixConstants(const Shader *shader) const;
+    void                SetCompactVertexConstants(const Shader *shader) const;
+    void                SetInstancingConstants(const Shader *shader) const;
     void                SetVertexColorConstants(const Shader *shader, const Material::VertexColorMode &vertexColor) const;
     void                SetSkinningConstants(const Shader *shader, const SkinningJointCache *cache) const;
 
@@ -106,6 +110,7 @@ private:
     int                 numVerts;
     int                 numIndexes;
     int                 numInstances;
+    const BufferCache * instanceCache;
 };
 
 /*
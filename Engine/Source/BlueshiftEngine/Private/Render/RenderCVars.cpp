@@ -26,6 +26,8 @@ CVAR(r_gamma, L"1.0", CVar::Float | CVar::Archive, L"changes gamma tables");
 CVAR(r_swapInterval, L"0", CVar::Integer | CVar::Archive, L"");
 CVAR(r_dynamicCacheVertexBytes, L"0x200000", CVar::Integer | CVar::Archive, L"size of dynamic vertex buffer");
 CVAR(r_dynamicCacheIndexBytes, L"0x200000", CVar::Integer | CVar::Archive, L"size of dynamic index buffer");
+CVAR(r_useRenderThread, L"0", CVar::Bool | CVar::Archive, L"execute the render back end on a dedicated render thread overlapping the game update of the next frame");
+CVAR(r_usePersistentMappedBuffers, L"1", CVar::Bool | CVar::Archive, L"keep dynamic buffers persistently mapped if GL_ARB_buffer_storage is supported");
 
 CVAR(r_fastSkinning, L"3", CVar::Integer | CVar::Archive, L"matrix skinning calculation, 0 = CPU skinning, 1 = VS skinning, 2 = VTF skinning, 3 = VTF skinning with instancing");
 CVAR(r_vertexTextureUpdate, L"2", CVar::Integer | CVar::Archive, L"texel fetch buffer, 0 = direct copy, 1 = PBO, 2 = TBO");
@@ -59,6 +61,9 @@ CVAR(r_optimizedShadowProjection, L"1", CVar::Integer, L"");
 
 CVAR(r_HOM, L"0", CVar::Bool, L"use hierarchical occlusion map culling");
 CVAR(r_HOM_debug, L"0", CVar::Bool, L"");
+CVAR(r_SWOcclusion, L"0", CVar::Bool, L"use software occlusion culling in the front end");
+CVAR(r_SWOcclusion_maxOccluderTris, L"2000", CVar::Integer, L"occluder sub meshes with more triangles are skipped");
+CVAR(r_dbvtRebuildAreaRatio, L"1.5", CVar::Float, L"rebuild the bounding volume trees when the area ratio grows more than this times since the last build, 0 to disable");
 
 CVAR(r_ambientLit, L"1", CVar::Bool | CVar::Archive, L"use ambient lighting");
 CVAR(r_ambientScale, L"1.0", CVar::Float | CVar::Archive, L"ambient light intensities are mutipled by this");
@@ -110,6 +115,9 @@ CVAR(r_useUnsmoothedTangents, L"1", CVar::Bool, L"");
 CVAR(r_useLightScissors, L"1", CVar::Bool, L"use custom scissor rectangle for each light");
 CVAR(r_useLightOcclusionQuery, L"0", CVar::Bool, L"");
 CVAR(r_usePostProcessing, L"1", CVar::Bool | CVar::Archive, L"");
+CVAR(r_useParallelFrontEnd, L"1", CVar::Bool, L"run the view frontend stages in parallel using the job system");
+CVAR(r_instancing, L"1", CVar::Bool | CVar::Archive, L"merge static surfaces sharing the sub mesh and material into instanced draws");
+CVAR(r_lodBias, L"0", CVar::Float | CVar::Archive, L"mesh LOD selection bias, positive values select lower detail levels earlier as if each step doubled the distance");
 
 CVAR(r_skipBackEnd, L"0", CVar::Bool, L"don't draw anything");
 CVAR(r_skipAmbientPass, L"0", CVar::Bool, L"skip ambient draw pass");
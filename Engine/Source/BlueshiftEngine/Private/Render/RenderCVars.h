@@ -35,6 +35,8 @@ extern CVar     r_gamma;
 extern CVar     r_swapInterval;
 extern CVar     r_dynamicCacheVertexBytes;
 extern CVar     r_dynamicCacheIndexBytes;
+extern CVar     r_useRenderThread;
+extern CVar     r_usePersistentMappedBuffers;
 
 extern CVar     r_fastSkinning;
 extern CVar     r_vertexTextureUpdate;
@@ -68,6 +70,9 @@ extern CVar     r_optimizedShadowProjection;
 
 extern CVar     r_HOM;
 extern CVar     r_HOM_debug;
+extern CVar     r_SWOcclusion;
+extern CVar     r_SWOcclusion_maxOccluderTris;
+extern CVar     r_dbvtRebuildAreaRatio;
 
 extern CVar     r_ambientLit;
 extern CVar     r_ambientScale;
@@ -119,6 +124,9 @@ extern CVar     r_useUnsmoothedTangents;
 extern CVar     r_useLightScissors;
 extern CVar     r_useLightOcclusionQuery;
 extern CVar     r_usePostProcessing;
+extern CVar     r_useParallelFrontEnd;
+extern CVar     r_instancing;
+extern CVar     r_lodBias;
 
 extern CVar     r_skipBackEnd;
 extern CVar     r_skipAmbientPass;
@@ -17,6 +17,7 @@
 #include "RenderInternal.h"
 #include "Core/Heap.h"
 #include "Platform/PlatformTime.h"
+#include "Core/Profiler.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -499,6 +500,12 @@ void RenderContext::Display() {
 }
 
 void RenderContext::BeginFrame() {
+    BE_PROFILE_SCOPE("RenderContext::BeginFrame");
+    MemTagScope tagScope(MemTag::Render);
+
+    // The render thread may be still executing the previous frame
+    renderSystem.SyncRenderThread();
+
     renderSystem.currentContext = this;
 
     startFrameMsec = PlatformTime::Milliseconds();
@@ -527,6 +534,9 @@ void RenderContext::BeginFrame() {
 }
 
 void RenderContext::EndFrame() {
+    BE_PROFILE_SCOPE("RenderContext::EndFrame");
+    MemTagScope tagScope(MemTag::Render);
+
     frameCount++;
 
     // Adds GUI commands
@@ -540,8 +550,6 @@ void RenderContext::EndFrame() {
     
     renderSystem.IssueCommands();
 
-    bufferCacheManager.EndDrawCommand();
-
     guiMesh.Clear();
 
     frameData.ToggleFrame();
@@ -549,6 +557,9 @@ void RenderContext::EndFrame() {
     renderCounter.frameMsec = PlatformTime::Milliseconds() - startFrameMsec;
 
     if (r_showStats.GetInteger() > 0) {
+        // Counters are written by the back end
+        renderSystem.SyncRenderThread();
+
         switch (r_showStats.GetInteger()) {
         case 1:
             BE_LOG(L"draw:%i verts:%i tris:%i sdraw:%i sverts:%i stris:%i\n", 
@@ -563,6 +574,12 @@ void RenderContext::EndFrame() {
             BE_LOG(L"shadowmap:%i skinning:%i\n",
                 renderCounter.numShadowMapDraw, renderCounter.numSkinningEntities);
             break;
+        case 4:
+            BE_LOG(L"views:%i surfs:%i (usec) entities:%i meshes:%i lights:%i flush:%i optimize:%i\n",
+                renderCounter.numViews, renderCounter.numDrawSurfs,
+                renderCounter.viewLightsAndEntitiesUsec, renderCounter.addMeshesUsec, renderCounter.addMeshesForLightsUsec,
+                renderCounter.flushDrawSurfsUsec, renderCounter.optimizeLightsUsec);
+            break;
         }
     }
 
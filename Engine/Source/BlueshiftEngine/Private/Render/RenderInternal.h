@@ -16,6 +16,8 @@
 
 BE_NAMESPACE_BEGIN
 
+class OcclusionBuffer;
+
 struct viewEntity_t {
     const SceneEntity *     def;
 
@@ -34,6 +36,16 @@ struct drawSurfNode_t {
     drawSurfNode_t *        next;
 };
 
+// Shadow caster surface found in a light job which is not yet visible in the view.
+// drawSurf 생성은 main thread 에서 한번에 처리한다.
+struct pendingShadowCaster_t {
+    SceneEntity *           sceneEntity;
+    MeshSurf *              meshSurf;
+    const Material *        material;
+
+    pendingShadowCaster_t * next;
+};
+
 struct viewLight_t {
     const SceneLight *      def;
 
@@ -56,6 +68,9 @@ struct viewLight_t {
                             // light bounding volume 에 포함되고, shadow caster 가 view frustum 에 보이는 surfaces (litSurfs 를 포함한다)
     drawSurfNode_t *        shadowCasterSurfs;
     AABB                    shadowCasterAABB;
+
+                            // view 에 보이지 않는 shadow caster surfaces (ResolveShadowCasters 에서 shadowCasterSurfs 로 옮겨진다)
+    pendingShadowCaster_t * pendingShadowCasters;
 };
 
 struct view_t {
@@ -70,10 +85,12 @@ struct view_t {
                             // view 에 보이는 모든 surfaces 와 shadow surfaces
     DrawSurf **             drawSurfs;
     int                     numDrawSurfs;
-    int                     maxDrawSurfs;
 
     viewEntity_t *          viewEntities;
     viewLight_t *           viewLights;
+
+                            // occluders 가 rasterize 된 occlusion buffer (occlusion culling 을 하지 않으면 nullptr)
+    const OcclusionBuffer * occlusionBuffer;
 };
 
 struct renderGlobal_t {
@@ -93,4 +110,5 @@ BE_NAMESPACE_END
 #include "RenderCVars.h"
 #include "RenderUtils.h"
 #include "FrameData.h"
+#include "OcclusionBuffer.h"
 #include "RBackEnd.h"
@@ -16,15 +16,30 @@
 #include "Render/Render.h"
 #include "RenderInternal.h"
 #include "Render/Font.h"
+#include "Core/Profiler.h"
 #include "Core/Cmds.h"
 #include "File/FileSystem.h"
+#include "Platform/PlatformThread.h"
 
 BE_NAMESPACE_BEGIN
 
 renderGlobal_t      renderGlobal;
 RenderSystem        renderSystem;
 
+// Render thread executes the back end of frame N while the game thread updates frame N+1.
+// GL context is owned by only one thread at a time, it is handed over in IssueCommands() and SyncRenderThread().
+static PlatformThread *     renderThread;
+static PlatformMutex *      renderThreadMutex;
+static PlatformCondition *  renderThreadCondition;
+static const void *         renderThreadCommands;       // commands being executed, nullptr if the render thread is idle
+static Renderer::Handle     renderThreadContextHandle;
+static bool                 renderThreadTerminate;
+static bool                 mainThreadOwnsContext = true;
+static BE_THREAD_LOCAL bool isRenderThread = false;
+
 void RenderSystem::Init(const Renderer::Settings *settings) {
+    MemTagScope tagScope(MemTag::Render);
+
     cmdSystem.AddCommand(L"screenshot", Cmd_ScreenShot);
 
     // Initialize OpenGL renderer
@@ -69,6 +84,8 @@ void RenderSystem::Init(const Renderer::Settings *settings) {
 
     animManager.Init();
 
+    animPoseCache.Init();
+
     RB_Init();
     
     frameData.Init();
@@ -85,6 +102,8 @@ void RenderSystem::Init(const Renderer::Settings *settings) {
 }
 
 void RenderSystem::Shutdown() {
+    StopRenderThread();
+
     cmdSystem.RemoveCommand(L"screenshot");
 
     frameData.Shutdown();
@@ -93,6 +112,8 @@ void RenderSystem::Shutdown() {
 
     RB_Shutdown();
 
+    animPoseCache.Shutdown();
+
     animManager.Shutdown();
 
     meshManager.Shutdown();
@@ -206,6 +227,8 @@ void RenderSystem::CmdScreenshot(int x, int y, int width, int height, const char
     }
 
     cmd->commandId		= ScreenShotCommand;
+    // The caller may read the saved file right after EndFrame()
+    syncAfterIssue = true;
     cmd->x				= x;
     cmd->y				= y;
     cmd->width			= width;
@@ -213,6 +236,100 @@ void RenderSystem::CmdScreenshot(int x, int y, int width, int height, const char
     Str::Copynz(cmd->filename, filename, COUNT_OF(cmd->filename));
 }
 
+static void ExecuteCommands(const void *data) {
+    if (!r_skipBackEnd.GetBool()) {
+        RB_Execute(data);
+    }
+
+    bufferCacheManager.EndDrawCommand();
+}
+
+static void RenderThreadProc(void *param) {
+    isRenderThread = true;
+
+    PlatformMutex::Lock(renderThreadMutex);
+
+    while (1) {
+        while (!renderThreadCommands && !renderThreadTerminate) {
+            PlatformCondition::Wait(renderThreadCondition, renderThreadMutex);
+        }
+
+        if (renderThreadTerminate) {
+            break;
+        }
+
+        const void *data = renderThreadCommands;
+        PlatformMutex::Unlock(renderThreadMutex);
+
+        glr.SetContext(renderThreadContextHandle);
+
+        ExecuteCommands(data);
+
+        glr.ReleaseContext();
+
+        PlatformMutex::Lock(renderThreadMutex);
+        renderThreadCommands = nullptr;
+        PlatformCondition::Broadcast(renderThreadCondition);
+    }
+
+    PlatformMutex::Unlock(renderThreadMutex);
+}
+
+void RenderSystem::StartRenderThread() {
+    if (renderThread) {
+        return;
+    }
+
+    renderThreadMutex = PlatformMutex::Create();
+    renderThreadCondition = PlatformCondition::Create();
+    renderThreadCommands = nullptr;
+    renderThreadTerminate = false;
+
+    renderThread = PlatformThread::Create(RenderThreadProc, nullptr, 0);
+
+    BE_LOG(L"render thread started\n");
+}
+
+void RenderSystem::StopRenderThread() {
+    if (!renderThread) {
+        return;
+    }
+
+    SyncRenderThread();
+
+    PlatformMutex::Lock(renderThreadMutex);
+    renderThreadTerminate = true;
+    PlatformCondition::Broadcast(renderThreadCondition);
+    PlatformMutex::Unlock(renderThreadMutex);
+
+    PlatformThread::Wait(renderThread);
+    renderThread = nullptr;
+
+    PlatformCondition::Delete(renderThreadCondition);
+    PlatformMutex::Delete(renderThreadMutex);
+
+    BE_LOG(L"render thread stopped\n");
+}
+
+void RenderSystem::SyncRenderThread() {
+    if (!renderThread || isRenderThread) {
+        return;
+    }
+
+    BE_PROFILE_SCOPE("RenderSystem::SyncRenderThread");
+
+    PlatformMutex::Lock(renderThreadMutex);
+    while (renderThreadCommands) {
+        PlatformCondition::Wait(renderThreadCondition, renderThreadMutex);
+    }
+    PlatformMutex::Unlock(renderThreadMutex);
+
+    if (!mainThreadOwnsContext) {
+        glr.SetContext(renderThreadContextHandle);
+        mainThreadOwnsContext = true;
+    }
+}
+
 void RenderSystem::IssueCommands() {
     RenderCommandBuffer *cmds = frameData.GetCommands();
     // add an end-of-list command
@@ -221,9 +338,32 @@ void RenderSystem::IssueCommands() {
     // clear it out, in case this is a sync and not a buffer flip
     cmds->used = 0;
 
-    if (!r_skipBackEnd.GetBool()) {
-        RB_Execute(cmds->data);
+    if (!r_useRenderThread.GetBool()) {
+        StopRenderThread();
+
+        ExecuteCommands(cmds->data);
+    } else {
+        StartRenderThread();
+
+        // Render thread should be idle here, it is synchronized at the beginning of the frame
+        SyncRenderThread();
+
+        renderThreadContextHandle = currentContext ? currentContext->GetContextHandle() : Renderer::NullContext;
+
+        glr.ReleaseContext();
+        mainThreadOwnsContext = false;
+
+        PlatformMutex::Lock(renderThreadMutex);
+        renderThreadCommands = cmds->data;
+        PlatformCondition::Broadcast(renderThreadCondition);
+        PlatformMutex::Unlock(renderThreadMutex);
+
+        if (syncAfterIssue) {
+            SyncRenderThread();
+        }
     }
+
+    syncAfterIssue = false;
 }
 
 void RenderSystem::RecreateScreenMapRT() {
@@ -87,6 +87,9 @@ RenderTarget *RenderTarget::Create(const Texture *colorTexture, const Texture *d
 }
 
 RenderTarget *RenderTarget::Create(int numColorTextures, const Texture **colorTextures, const Texture *depthStencilTexture, int flags) {
+    // Wait for the render thread to release the GL context
+    renderSystem.SyncRenderThread();
+
     Renderer::Handle            colorTextureHandles[MaxMultipleColorTextures] = { Renderer::NullTexture, };
     Renderer::Handle            depthStencilTextureHandle = Renderer::NullTexture;
     Renderer::TextureType       textureType;
@@ -158,6 +161,8 @@ RenderTarget *RenderTarget::Create(int numColorTextures, const Texture **colorTe
 }
 
 void RenderTarget::Delete(RenderTarget *renderTarget) {
+    renderSystem.SyncRenderThread();
+
     glr.DeleteRenderTarget(renderTarget->rtHandle);
     rts.RemoveIndex(rts.FindIndex(renderTarget));
     delete renderTarget;
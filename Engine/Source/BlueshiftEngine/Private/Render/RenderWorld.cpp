@@ -21,11 +21,16 @@
 
 BE_NAMESPACE_BEGIN
 
-static const int MaxViewDrawSurfs = 0x4000;
-
 RenderWorld::RenderWorld() {
     viewCount = 0;
 
+    drawSurfBuffers = new DrawSurfBuffer[JobSystem::MaxWorkers];
+    for (int i = 0; i < JobSystem::MaxWorkers; i++) {
+        drawSurfBuffers[i].Clear();
+    }
+
+    occlusionBuffer = nullptr;
+
     textMesh.SetCoordFrame(GuiMesh::CoordFrame3D);
 
     debugLineColor.Set(0, 0, 0, 0);
@@ -34,6 +39,10 @@ RenderWorld::RenderWorld() {
 
 RenderWorld::~RenderWorld() {
     ClearScene();
+
+    delete [] drawSurfBuffers;
+
+    SAFE_DELETE(occlusionBuffer);
 }
 
 void RenderWorld::ClearScene() {
@@ -64,6 +73,8 @@ const SceneEntity *RenderWorld::GetEntity(int entityHandle) const {
 }
 
 int RenderWorld::AddEntity(const SceneEntity::Parms *parms) {
+    MemTagScope tagScope(MemTag::Render);
+
     int entityHandle = sceneEntities.FindNull();
     if (entityHandle == -1) {
         entityHandle = sceneEntities.Append(nullptr);
@@ -75,6 +86,8 @@ int RenderWorld::AddEntity(const SceneEntity::Parms *parms) {
 }
 
 void RenderWorld::UpdateEntity(int entityHandle, const SceneEntity::Parms *parms) {
+    MemTagScope tagScope(MemTag::Render);
+
     while (entityHandle >= sceneEntities.Count()) {
         sceneEntities.Append(nullptr);
     }
@@ -105,6 +118,7 @@ void RenderWorld::UpdateEntity(int entityHandle, const SceneEntity::Parms *parms
                 meshSurfProxy->sceneEntity = sceneEntity;
                 meshSurfProxy->mesh = parms->mesh;
                 meshSurfProxy->meshSurfIndex = surfaceIndex;
+                meshSurfProxy->lodGroup = parms->mesh->NumLods() > 1 ? &sceneEntity->lodGroup : nullptr;
                 meshSurfProxy->aabb.SetFromTransformedAABB(meshSurf->subMesh->GetAABB() * parms->scale, parms->origin, parms->axis);
                 meshSurfProxy->id = staticDbvt.CreateProxy(sceneEntity->meshSurfProxies[surfaceIndex].aabb, MeterToUnit(0.0f), &sceneEntity->meshSurfProxies[surfaceIndex]);
             }
@@ -125,6 +139,12 @@ void RenderWorld::UpdateEntity(int entityHandle, const SceneEntity::Parms *parms
 
             // If this entity is a static mesh
             if (sceneEntity->parms.mesh && !sceneEntity->parms.joints) {
+                if (!meshMatch) {
+                    // Level of the previous mesh is meaningless for the new one
+                    sceneEntity->lodGroup.viewCount = -1;
+                    sceneEntity->lodGroup.lodLevel = 0;
+                }
+
                 // mesh surface count changed so we recreate static proxy
                 if (parms->mesh->NumSurfaces() != sceneEntity->numMeshSurfProxies) {
                     Mem_Free(sceneEntity->meshSurfProxies);
@@ -141,11 +161,14 @@ void RenderWorld::UpdateEntity(int entityHandle, const SceneEntity::Parms *parms
                         meshSurfProxy->sceneEntity = sceneEntity;
                         meshSurfProxy->mesh = parms->mesh;
                         meshSurfProxy->meshSurfIndex = surfaceIndex;
+                        meshSurfProxy->lodGroup = parms->mesh->NumLods() > 1 ? &sceneEntity->lodGroup : nullptr;
                         meshSurfProxy->aabb.SetFromTransformedAABB(meshSurf->subMesh->GetAABB() * parms->scale, parms->origin, parms->axis);
                         meshSurfProxy->id = staticDbvt.CreateProxy(sceneEntity->meshSurfProxies[surfaceIndex].aabb, MeterToUnit(0.0f), &sceneEntity->meshSurfProxies[surfaceIndex]);
                     }
                 } else {
                     for (int surfaceIndex = 0; surfaceIndex < parms->mesh->NumSurfaces(); surfaceIndex++) {
+                        sceneEntity->meshSurfProxies[surfaceIndex].mesh = parms->mesh;
+                        sceneEntity->meshSurfProxies[surfaceIndex].lodGroup = parms->mesh->NumLods() > 1 ? &sceneEntity->lodGroup : nullptr;
                         sceneEntity->meshSurfProxies[surfaceIndex].aabb.SetFromTransformedAABB(parms->mesh->GetSurface(surfaceIndex)->subMesh->GetAABB() * parms->scale, parms->origin, parms->axis);
                         staticDbvt.MoveProxy(sceneEntity->meshSurfProxies[surfaceIndex].id, sceneEntity->meshSurfProxies[surfaceIndex].aabb, MeterToUnit(0.5f), parms->origin - sceneEntity->parms.origin);
                     }
@@ -194,6 +217,8 @@ const SceneLight *RenderWorld::GetLight(int lightHandle) const {
 }
 
 int RenderWorld::AddLight(const SceneLight::Parms *parms) {
+    MemTagScope tagScope(MemTag::Render);
+
     int lightHandle = sceneLights.FindNull();
     if (lightHandle == -1) {
         lightHandle = sceneLights.Append(nullptr);
@@ -205,6 +230,8 @@ int RenderWorld::AddLight(const SceneLight::Parms *parms) {
 }
 
 void RenderWorld::UpdateLight(int lightHandle, const SceneLight::Parms *parms) {
+    MemTagScope tagScope(MemTag::Render);
+
     while (lightHandle >= sceneLights.Count()) {
         sceneLights.Append(nullptr);
     }
@@ -253,19 +280,23 @@ void RenderWorld::RemoveLight(int lightHandle) {
     sceneLights[lightHandle] = nullptr;
 }
 
+void RenderWorld::BeginMapLoading() {
+    // Static mesh proxies are built at once in FinishMapLoading()
+    staticDbvt.BeginBulkInsert();
+}
+
 void RenderWorld::FinishMapLoading() {
-//#ifndef _DEBUG
-//    int startTime = PlatformTime::Milliseconds();
-//
-//    dynamicDbvt.RebuildBottomUp();
-//    staticDbvt.RebuildBottomUp();
-//
-//    int elapsedTime = PlatformTime::Milliseconds() - startTime;
-//    BE_LOG(L"%i msec to build dynamic AABB tree\n", elapsedTime);
-//#endif
+    int startTime = PlatformTime::Milliseconds();
+
+    staticDbvt.EndBulkInsert();
+
+    int elapsedTime = PlatformTime::Milliseconds() - startTime;
+    BE_LOG(L"%i msec to build static AABB tree (%i proxies, area ratio %.2f)\n", elapsedTime, staticDbvt.GetProxyCount(), staticDbvt.GetAreaRatio());
 }
 
 void RenderWorld::RenderScene(const SceneView *view) {
+    MemTagScope tagScope(MemTag::Render);
+
     if (view->parms.renderRect.w <= 0.0f || view->parms.renderRect.h <= 0.0f) {
         return;
     }
@@ -274,12 +305,15 @@ void RenderWorld::RenderScene(const SceneView *view) {
         return;
     }
 
+    // Rebuild the trees degraded by the incremental updates before culling
+    if (r_dbvtRebuildAreaRatio.GetFloat() > 0.0f) {
+        dynamicDbvt.RebuildIfDegraded(r_dbvtRebuildAreaRatio.GetFloat());
+        staticDbvt.RebuildIfDegraded(r_dbvtRebuildAreaRatio.GetFloat());
+    }
+
     // Set current render view
     currentView = (view_t *)frameData.ClearedAlloc(sizeof(*currentView));
     currentView->def = view;
-    currentView->maxDrawSurfs = MaxViewDrawSurfs;
-    currentView->numDrawSurfs = 0;
-    currentView->drawSurfs = (DrawSurf **)frameData.Alloc(currentView->maxDrawSurfs * sizeof(DrawSurf *));
 
     RenderView(currentView);
 }
@@ -322,8 +356,6 @@ void RenderWorld::EmitGuiFullScreen(GuiMesh &guiMesh) {
     view_t *guiView         = (view_t *)frameData.ClearedAlloc(sizeof(*guiView));
     guiView->def            = &sceneView;
     guiView->is2D           = true;
-    guiView->maxDrawSurfs   = guiMesh.surfaces.Count();
-    guiView->drawSurfs      = (DrawSurf **)frameData.Alloc(guiView->maxDrawSurfs * sizeof(DrawSurf *));
 
     // GUI view entity
     Mat4 projMatrix;
@@ -356,6 +388,9 @@ void RenderWorld::EmitGuiFullScreen(GuiMesh &guiMesh) {
         AddDrawSurf(guiView, viewEntity, guiSurf->material, nullptr, guiSubMesh, 0);
     }
 
+    // GUI surfaces are drawn in the order they are added
+    FlushDrawSurfs(guiView, false);
+
     renderSystem.CmdDrawView(guiView);
 }
 
@@ -15,6 +15,10 @@
 #include "Precompiled.h"
 #include "Render/Render.h"
 #include "RenderInternal.h"
+#include "Platform/PlatformTime.h"
+#include "Core/Heap.h"
+#include "Containers/RadixSort.h"
+#include "Core/Profiler.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -60,11 +64,14 @@ viewLight_t *RenderWorld::AddViewLight(view_t *view, SceneLight *sceneLight) {
 
 // viewLight 와 viewEntity 들을 등록한다.
 void RenderWorld::AddViewLightsAndEntities(view_t *view) {
+    BE_PROFILE_SCOPE("RenderWorld::AddViewLightsAndEntities");
+
     viewCount++;
 
     view->aabb.Clear();
     view->viewLights = nullptr;
     view->viewEntities = nullptr;
+    view->occlusionBuffer = nullptr;
 
     // Called for each entities and lights intersecting with view frustum 
     auto addViewLightsAndEntities = [this, view](int32_t proxyId) -> bool {
@@ -161,12 +168,77 @@ void RenderWorld::AddViewLightsAndEntities(view_t *view) {
     if (view->def->parms.orthogonal) {
         dynamicDbvt.Query(view->def->box, addViewLightsAndEntities);
     } else {
-        dynamicDbvt.Query(view->def->frustum, addViewLightsAndEntities);
+        dynamicDbvt.QueryBatch(view->def->frustum, addViewLightsAndEntities);
+
+        if (r_SWOcclusion.GetBool()) {
+            CullOccludedEntities(view);
+        }
+    }
+}
+
+// Occluders themselves and depth hacked entities are never culled by the occlusion buffer
+static bool CanBeOccluded(const SceneEntity *sceneEntity) {
+    return !sceneEntity->parms.occluder && !sceneEntity->parms.depthHack;
+}
+
+// occluder entity 들의 mesh 를 occlusion buffer 에 rasterize 하고, 완전히 가려진 viewEntity 들은 ambient visible 에서 제외한다.
+// 가려진 entity 도 viewEntity 로 남아있으므로 그림자는 그대로 그려진다.
+void RenderWorld::CullOccludedEntities(view_t *view) {
+    BE_PROFILE_SCOPE("RenderWorld::CullOccludedEntities");
+
+    if (!occlusionBuffer) {
+        occlusionBuffer = new OcclusionBuffer;
+    }
+
+    occlusionBuffer->Begin(view);
+
+    const int maxOccluderTris = r_SWOcclusion_maxOccluderTris.GetInteger();
+
+    for (viewEntity_t *viewEntity = view->viewEntities; viewEntity; viewEntity = viewEntity->next) {
+        const SceneEntity::Parms &entityParms = viewEntity->def->parms;
+
+        if (!entityParms.occluder || !entityParms.mesh || entityParms.joints) {
+            continue;
+        }
+
+        // Lowest LOD level is the cheapest occluder
+        const Mesh *mesh = entityParms.mesh;
+        const int lod = mesh->NumLods() - 1;
+
+        for (int surfaceIndex = 0; surfaceIndex < mesh->NumSurfaces(); surfaceIndex++) {
+            const SubMesh *subMesh = mesh->GetLodSurface(lod, surfaceIndex)->subMesh;
+
+            if (subMesh->NumIndexes() / 3 > maxOccluderTris) {
+                continue;
+            }
+
+            occlusionBuffer->AddOccluder(viewEntity->modelViewProjMatrix, subMesh);
+        }
+    }
+
+    if (!occlusionBuffer->NumTris()) {
+        return;
+    }
+
+    occlusionBuffer->Rasterize(r_useParallelFrontEnd.GetBool());
+
+    view->occlusionBuffer = occlusionBuffer;
+
+    for (viewEntity_t *viewEntity = view->viewEntities; viewEntity; viewEntity = viewEntity->next) {
+        if (!CanBeOccluded(viewEntity->def)) {
+            continue;
+        }
+
+        if (occlusionBuffer->IsOccluded(viewEntity->def->proxy->aabb)) {
+            viewEntity->ambientVisible = false;
+        }
     }
 }
 
 // skinned mesh 들을 ambient drawSurfs 에 담는다. 
 void RenderWorld::AddSkinnedMeshes(view_t *view) {
+    BE_PROFILE_SCOPE("RenderWorld::AddSkinnedMeshes");
+
     for (viewEntity_t *viewEntity = view->viewEntities; viewEntity; viewEntity = viewEntity->next) {
         if (!viewEntity->ambientVisible) {
             continue;
@@ -191,24 +263,21 @@ void RenderWorld::AddSkinnedMeshes(view_t *view) {
             flags |= DrawSurf::ShowWires;
         }
 
-        if (entityParms.skeleton && entityParms.joints) {
-            // Update skinning joint cache for GPU skinning
-            entityParms.mesh->UpdateSkinningJointCache(entityParms.skeleton, entityParms.joints);
-        }
-
         for (int surfaceIndex = 0; surfaceIndex < entityParms.mesh->NumSurfaces(); surfaceIndex++) {
             MeshSurf *surf = entityParms.mesh->GetSurface(surfaceIndex);
 
-            AddDrawSurf(view, viewEntity, entityParms.customMaterials[surf->materialIndex], surf->subMesh, nullptr, flags);
-
             surf->viewCount = viewCount;
-            surf->drawSurf = view->drawSurfs[view->numDrawSurfs - 1];
+            surf->drawSurf = AddDrawSurf(view, viewEntity, entityParms.customMaterials[surf->materialIndex], surf->subMesh, nullptr, flags);
         }
     }
 }
 
 void RenderWorld::AddTextMeshes(view_t *view) {
     for (viewEntity_t *viewEntity = view->viewEntities; viewEntity; viewEntity = viewEntity->next) {
+        if (!viewEntity->ambientVisible) {
+            continue;
+        }
+
         const SceneEntity::Parms &entityParms = viewEntity->def->parms;
 
         if (entityParms.text.IsEmpty()) {
@@ -246,8 +315,57 @@ void RenderWorld::AddTextMeshes(view_t *view) {
     }
 }
 
+// Projected size must pass the threshold by this ratio to change the level, so the level doesn't flicker around the threshold
+#define LOD_HYSTERESIS      0.1f
+
+// Selects the LOD level of the static mesh entity using the projected size of the bounding sphere
+// as a fraction of the screen height.
+static int SelectLod(const view_t *view, const SceneEntity *sceneEntity, const Mesh *mesh, int currentLod) {
+    const SceneView *viewDef = view->def;
+    const OBB &worldOBB = sceneEntity->GetWorldOBB();
+    const float radius = worldOBB.Extents().Length();
+
+    float screenSize;
+    if (viewDef->parms.orthogonal) {
+        screenSize = radius / viewDef->parms.sizeY;
+    } else {
+        const float distance = Max(worldOBB.Center().Distance(viewDef->parms.origin), radius);
+        screenSize = radius * viewDef->projMatrix[1][1] / distance;
+    }
+
+    if (r_lodBias.GetFloat() != 0.0f) {
+        screenSize *= Math::Pow(2.0f, -r_lodBias.GetFloat());
+    }
+
+    const int numLods = mesh->NumLods();
+
+    int lod = 0;
+    while (lod + 1 < numLods && screenSize < mesh->GetLodScreenSize(lod + 1)) {
+        lod++;
+    }
+
+    if (currentLod < numLods) {
+        if (lod > currentLod) {
+            if (screenSize > mesh->GetLodScreenSize(currentLod + 1) * (1.0f - LOD_HYSTERESIS)) {
+                lod = currentLod;
+            }
+        } else if (lod < currentLod) {
+            if (screenSize < mesh->GetLodScreenSize(currentLod) * (1.0f + LOD_HYSTERESIS)) {
+                lod = currentLod;
+            }
+        }
+    }
+
+    return lod;
+}
+
+// Static mesh trees with fewer proxies are culled in serial
+#define PARALLEL_CULLING_MIN_PROXIES    4096
+
 // static mesh 들을 ambient drawSurfs 에 담는다. 
 void RenderWorld::AddStaticMeshes(view_t *view) {
+    BE_PROFILE_SCOPE("RenderWorld::AddStaticMeshes");
+
     // Called for each static mesh surfaces intersecting with view frustum 
     auto addStaticMeshSurfs = [this, view](int32_t proxyId) -> bool {
         DbvtProxy *proxy = (DbvtProxy *)staticDbvt.GetUserData(proxyId);
@@ -262,14 +380,26 @@ void RenderWorld::AddStaticMeshes(view_t *view) {
             return true;
         }
 
-        /*if (proxy->lodGroup >= 0) {
-            // Compute LOD value [0, 1]
-            AABB aabb = meshSurf->subMesh->GetAABB() * proxy->sceneEntity->parms.scale;
-            Vec3 size = aabb[1] - aabb[0];
-            float area = view->def->parms.axis[0].Abs().Dot(Vec3(size.y * size.z, size.z * size.x, size.x * size.y));
-            float d = view->def->parms.origin.DistanceSqr(proxy->sceneEntity->parms.origin);
-            float lodValue = area / d;
-        }*/
+        if (!proxy->sceneEntity->viewEntity->ambientVisible) {
+            return true;
+        }
+
+        // Surfaces of the visible entity can still be occluded, single surface entity is already tested
+        if (view->occlusionBuffer && proxy->mesh->NumSurfaces() > 1 && CanBeOccluded(proxy->sceneEntity)) {
+            if (view->occlusionBuffer->IsOccluded(proxy->aabb)) {
+                return true;
+            }
+        }
+
+        // The level is selected once per view, so that all the surfaces of the entity use the same level
+        if (proxy->lodGroup) {
+            LodGroup *lodGroup = proxy->lodGroup;
+            if (lodGroup->viewCount != this->viewCount) {
+                lodGroup->viewCount = this->viewCount;
+                lodGroup->lodLevel = SelectLod(view, proxy->sceneEntity, proxy->mesh, lodGroup->lodLevel);
+            }
+            meshSurf = proxy->mesh->GetLodSurface(lodGroup->lodLevel, proxy->meshSurfIndex);
+        }
 
 #if 0
         // More accurate OBB culling
@@ -285,10 +415,9 @@ void RenderWorld::AddStaticMeshes(view_t *view) {
         }
 
         viewEntity_t *viewEntity = proxy->sceneEntity->viewEntity;
-        this->AddDrawSurf(view, viewEntity, viewEntity->def->parms.customMaterials[meshSurf->materialIndex], meshSurf->subMesh, nullptr, flags);
 
         meshSurf->viewCount = this->viewCount;
-        meshSurf->drawSurf = view->drawSurfs[view->numDrawSurfs - 1];
+        meshSurf->drawSurf = this->AddDrawSurf(view, viewEntity, viewEntity->def->parms.customMaterials[meshSurf->materialIndex], meshSurf->subMesh, nullptr, flags);
         //bool has = meshSurf->drawSurf->material->IsLitSurface();
 
         if (r_showAABB.GetInteger() > 0) {
@@ -301,16 +430,58 @@ void RenderWorld::AddStaticMeshes(view_t *view) {
 
     if (view->def->parms.orthogonal) {
         staticDbvt.Query(view->def->box, addStaticMeshSurfs);
+    } else if (r_useParallelFrontEnd.GetBool() && staticDbvt.GetProxyCount() >= PARALLEL_CULLING_MIN_PROXIES) {
+        // Callbacks are called on this thread after the sub trees are culled in parallel
+        staticDbvt.QueryParallel(view->def->frustum, addStaticMeshSurfs);
     } else {
-        staticDbvt.Query(view->def->frustum, addStaticMeshSurfs);
+        staticDbvt.QueryBatch(view->def->frustum, addStaticMeshSurfs);
     }
 }
 
-// static mesh 들을 viewLight 의 litSurfs/shadowCasterSurfs 리스트에 담는다.
-void RenderWorld::AddStaticMeshesForLights(view_t *view) {
-    viewLight_t *viewLight = view->viewLights;
+// viewLight 별로 static/skinned mesh 들을 litSurfs/shadowCasterSurfs 리스트에 담는다.
+// 각 light 는 자신의 리스트에만 쓰므로 병렬로 처리할 수 있다.
+void RenderWorld::AddMeshesForLights(view_t *view, bool parallel) {
+    BE_PROFILE_SCOPE("RenderWorld::AddMeshesForLights");
 
-    auto addStaticMeshSurfsForLights = [this, view, &viewLight](int32_t proxyId) -> bool {
+    int numViewLights = 0;
+    for (viewLight_t *viewLight = view->viewLights; viewLight; viewLight = viewLight->next) {
+        numViewLights++;
+    }
+
+    if (!numViewLights) {
+        return;
+    }
+
+    viewLight_t **viewLights = (viewLight_t **)frameData.Alloc(numViewLights * sizeof(viewLight_t *));
+    numViewLights = 0;
+    for (viewLight_t *viewLight = view->viewLights; viewLight; viewLight = viewLight->next) {
+        viewLights[numViewLights++] = viewLight;
+    }
+
+    JobSystem::ParallelFor(0, numViewLights, parallel ? 1 : numViewLights, [this, view, viewLights](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            AddStaticMeshesForLight(view, viewLights[i]);
+            AddSkinnedMeshesForLight(view, viewLights[i]);
+        }
+    });
+
+    // Shadow caster surfaces that are not visible in the view are added here in serial
+    ResolveShadowCasters(view);
+}
+
+static void AddPendingShadowCaster(viewLight_t *viewLight, SceneEntity *sceneEntity, MeshSurf *meshSurf, const Material *material) {
+    pendingShadowCaster_t *shadowCaster = (pendingShadowCaster_t *)frameData.Alloc(sizeof(pendingShadowCaster_t));
+    shadowCaster->sceneEntity = sceneEntity;
+    shadowCaster->meshSurf = meshSurf;
+    shadowCaster->material = material;
+    shadowCaster->next = viewLight->pendingShadowCasters;
+
+    viewLight->pendingShadowCasters = shadowCaster;
+}
+
+// static mesh 들을 viewLight 의 litSurfs/shadowCasterSurfs 리스트에 담는다.
+void RenderWorld::AddStaticMeshesForLight(view_t *view, viewLight_t *viewLight) {
+    auto addStaticMeshSurfsForLight = [this, view, viewLight](int32_t proxyId) -> bool {
         DbvtProxy *proxy = (DbvtProxy *)this->staticDbvt.GetUserData(proxyId);
         MeshSurf *meshSurf = proxy->mesh->GetSurface(proxy->meshSurfIndex);
 
@@ -333,6 +504,13 @@ void RenderWorld::AddStaticMeshesForLights(view_t *view) {
             return true;
         }
 
+        if (proxy->lodGroup) {
+            const LodGroup *lodGroup = proxy->lodGroup;
+            // Entities not visible in the view only cast shadows. Lights run in parallel, so the level is selected without updating the group.
+            const int lodLevel = lodGroup->viewCount == this->viewCount ? lodGroup->lodLevel : SelectLod(view, proxy->sceneEntity, proxy->mesh, lodGroup->lodLevel);
+            meshSurf = proxy->mesh->GetLodSurface(lodLevel, proxy->meshSurfIndex);
+        }
+
         const Material *material = proxy->sceneEntity->parms.customMaterials[meshSurf->materialIndex];
 
         if (meshSurf->viewCount == this->viewCount) {
@@ -352,57 +530,38 @@ void RenderWorld::AddStaticMeshesForLights(view_t *view) {
                 return true;
             }
 
-            if (meshSurf->viewCount != this->viewCount) {
-                viewEntity_t *shadowViewEntity = this->AddViewEntity(view, proxy->sceneEntity);
-                shadowViewEntity->shadowVisible = true;
-
-                this->AddDrawSurf(view, shadowViewEntity, material, meshSurf->subMesh, nullptr, 0);
-
-                meshSurf->viewCount = this->viewCount;
-                meshSurf->drawSurf = view->drawSurfs[view->numDrawSurfs - 1];
-            }
+            AddPendingShadowCaster(viewLight, proxy->sceneEntity, meshSurf, material);
 
-            drawSurfNode_t *drawSurfNode = (drawSurfNode_t *)frameData.Alloc(sizeof(drawSurfNode_t));
-            drawSurfNode->drawSurf = meshSurf->drawSurf;
-            drawSurfNode->next = viewLight->shadowCasterSurfs;
-
-            viewLight->shadowCasterSurfs = drawSurfNode;
             viewLight->shadowCasterAABB.AddAABB(proxy->aabb);
         }
 
         return true;
     };
 
-    while (viewLight) {
-        const SceneLight *sceneLight = viewLight->def;
-
-        switch (sceneLight->parms.type) {
-        case SceneLight::DirectionalLight:
-            staticDbvt.Query(sceneLight->obb, addStaticMeshSurfsForLights);
-            break;
-        case SceneLight::PointLight:
-            if (sceneLight->IsRadiusUniform()) {
-                staticDbvt.Query(Sphere(sceneLight->GetOrigin(), sceneLight->GetRadius()[0]), addStaticMeshSurfsForLights);
-            } else {
-                staticDbvt.Query(sceneLight->obb, addStaticMeshSurfsForLights);
-            }
-            break;
-        case SceneLight::SpotLight:
-            staticDbvt.Query(sceneLight->frustum, addStaticMeshSurfsForLights);
-            break;
-        default:
-            break;
-       }
+    const SceneLight *sceneLight = viewLight->def;
 
-       viewLight = viewLight->next;
+    switch (sceneLight->parms.type) {
+    case SceneLight::DirectionalLight:
+        staticDbvt.Query(sceneLight->obb, addStaticMeshSurfsForLight);
+        break;
+    case SceneLight::PointLight:
+        if (sceneLight->IsRadiusUniform()) {
+            staticDbvt.Query(Sphere(sceneLight->GetOrigin(), sceneLight->GetRadius()[0]), addStaticMeshSurfsForLight);
+        } else {
+            staticDbvt.Query(sceneLight->obb, addStaticMeshSurfsForLight);
+        }
+        break;
+    case SceneLight::SpotLight:
+        staticDbvt.QueryBatch(sceneLight->frustum, addStaticMeshSurfsForLight);
+        break;
+    default:
+        break;
     }
 }
 
 // skinned mesh 들을 viewLight 의 litSurfs/shadowCasterSurfs 리스트에 담는다.
-void RenderWorld::AddSkinnedMeshesForLights(view_t *view) {
-    viewLight_t *viewLight = view->viewLights;
-
-    auto addShadowCasterEntities = [this, view, &viewLight](int32_t proxyId) -> bool {
+void RenderWorld::AddSkinnedMeshesForLight(view_t *view, viewLight_t *viewLight) {
+    auto addShadowCasterEntities = [this, view, viewLight](int32_t proxyId) -> bool {
         DbvtProxy *proxy = (DbvtProxy *)this->dynamicDbvt.GetUserData(proxyId);
         SceneEntity *sceneEntity = proxy->sceneEntity;
             
@@ -452,37 +611,13 @@ void RenderWorld::AddSkinnedMeshesForLights(view_t *view) {
             return true;
         }
 
-        viewEntity_t *shadowViewEntity = nullptr;
-            
         for (int surfaceIndex = 0; surfaceIndex < sceneEntity->parms.mesh->NumSurfaces(); surfaceIndex++) {
             MeshSurf *surf = sceneEntity->parms.mesh->GetSurface(surfaceIndex);
 
             const Material *material = sceneEntity->parms.customMaterials[surf->materialIndex];
 
             if (material->IsShadowCaster()) {
-                if (surf->viewCount != this->viewCount) {
-                    // ambient visible 하지 않으므로 shadow 용 viewEntity 를 등록해준다.
-                    if (!shadowViewEntity) {
-                        shadowViewEntity = this->AddViewEntity(view, sceneEntity);
-                        shadowViewEntity->shadowVisible = true;
-                    }
-
-                    if (shadowViewEntity->def->parms.skeleton && shadowViewEntity->def->parms.joints) {
-                        shadowViewEntity->def->parms.mesh->UpdateSkinningJointCache(shadowViewEntity->def->parms.skeleton, shadowViewEntity->def->parms.joints);
-                    }
-
-                    // drawSurf for shadow
-                    this->AddDrawSurf(view, shadowViewEntity, material, surf->subMesh, nullptr, 0);
-
-                    surf->viewCount = this->viewCount;
-                    surf->drawSurf = view->drawSurfs[view->numDrawSurfs - 1];
-                }
-
-                drawSurfNode_t *drawSurfNode = (drawSurfNode_t *)frameData.Alloc(sizeof(drawSurfNode_t));
-                drawSurfNode->drawSurf = surf->drawSurf;
-                drawSurfNode->next = viewLight->shadowCasterSurfs;
-                
-                viewLight->shadowCasterSurfs = drawSurfNode;
+                AddPendingShadowCaster(viewLight, sceneEntity, surf, material);
             }
         }
 
@@ -490,33 +625,58 @@ void RenderWorld::AddSkinnedMeshesForLights(view_t *view) {
 
         return true;
     };
-    
-    while (viewLight) {
-        const SceneLight *sceneLight = viewLight->def;
 
-        switch (sceneLight->parms.type) {
-        case SceneLight::DirectionalLight:
+    const SceneLight *sceneLight = viewLight->def;
+
+    switch (sceneLight->parms.type) {
+    case SceneLight::DirectionalLight:
+        dynamicDbvt.Query(sceneLight->obb, addShadowCasterEntities);
+        break;
+    case SceneLight::PointLight:
+        if (sceneLight->IsRadiusUniform()) {
+            dynamicDbvt.Query(Sphere(sceneLight->GetOrigin(), sceneLight->GetRadius()[0]), addShadowCasterEntities);
+        } else {
             dynamicDbvt.Query(sceneLight->obb, addShadowCasterEntities);
-            break;
-        case SceneLight::PointLight:
-            if (sceneLight->IsRadiusUniform()) {
-                dynamicDbvt.Query(Sphere(sceneLight->GetOrigin(), sceneLight->GetRadius()[0]), addShadowCasterEntities);
-            } else {
-                dynamicDbvt.Query(sceneLight->obb, addShadowCasterEntities);
+        }
+        break;
+    case SceneLight::SpotLight:
+        dynamicDbvt.QueryBatch(sceneLight->frustum, addShadowCasterEntities);
+        break;
+    default:
+        break;
+    }
+}
+
+// light job 들이 찾은 shadow caster 들을 shadowCasterSurfs 리스트에 담는다.
+// ambient visible 하지 않은 surf 는 여기서 shadow 용 viewEntity 와 drawSurf 를 생성한다.
+void RenderWorld::ResolveShadowCasters(view_t *view) {
+    for (viewLight_t *viewLight = view->viewLights; viewLight; viewLight = viewLight->next) {
+        for (pendingShadowCaster_t *shadowCaster = viewLight->pendingShadowCasters; shadowCaster; shadowCaster = shadowCaster->next) {
+            MeshSurf *surf = shadowCaster->meshSurf;
+
+            if (surf->viewCount != this->viewCount) {
+                viewEntity_t *shadowViewEntity = AddViewEntity(view, shadowCaster->sceneEntity);
+                shadowViewEntity->shadowVisible = true;
+
+                // drawSurf for shadow
+                surf->viewCount = this->viewCount;
+                surf->drawSurf = AddDrawSurf(view, shadowViewEntity, shadowCaster->material, surf->subMesh, nullptr, 0);
             }
-            break;
-        case SceneLight::SpotLight:
-            dynamicDbvt.Query(sceneLight->frustum, addShadowCasterEntities);
-            break;
-        default:
-            break;
+
+            drawSurfNode_t *drawSurfNode = (drawSurfNode_t *)frameData.Alloc(sizeof(drawSurfNode_t));
+            drawSurfNode->drawSurf = surf->drawSurf;
+            drawSurfNode->next = viewLight->shadowCasterSurfs;
+
+            viewLight->shadowCasterSurfs = drawSurfNode;
         }
 
-        viewLight = viewLight->next;
+        viewLight->pendingShadowCasters = nullptr;
     }
 }
 
 void RenderWorld::OptimizeLights(view_t *view) {
+    BE_PROFILE_SCOPE("RenderWorld::OptimizeLights");
+
     Rect screenClipRect;
     viewLight_t *prevViewLight = nullptr;
 
@@ -545,39 +705,52 @@ void RenderWorld::OptimizeLights(view_t *view) {
     }
 }
 
-static int BE_CDECL _CompareDrawSurf(const void *elem1, const void *elem2) {
-    const uint32_t sortkey1 = (*(DrawSurf **)elem1)->sortkey;
-    const uint32_t sortkey2 = (*(DrawSurf **)elem2)->sortkey;
+void RenderWorld::RenderView(view_t *view) {
+    BE_PROFILE_SCOPE("RenderWorld::RenderView");
 
-    if (sortkey1 < sortkey2) {
-        return -1;
-    }
-    if (sortkey1 > sortkey2) {
-        return 1;
-    }
-    return 0;
-}
+    // Debug primitives are not thread-safe, so run the frontend in serial when they are requested
+    const bool parallel = r_useParallelFrontEnd.GetBool() && r_showAABB.GetInteger() == 0;
 
-void RenderWorld::SortDrawSurfs(view_t *view) {
-    qsort(view->drawSurfs, view->numDrawSurfs, sizeof(DrawSurf *), _CompareDrawSurf);
-}
+    uint64_t stageTime[6];
+    stageTime[0] = PlatformTime::Microseconds();
 
-void RenderWorld::RenderView(view_t *view) {
     // view frustum 을 entity dynamic bounding volume tree 에 query 해서 빠르게 sceneLight, sceneEntity 를 찾는다.
     // 찾은 def 들은 각각 viewLights, viewEntities 를 생성하며 view 에 등록
     // sceneEntity 와 sceneLight 의 pointer 에도 연결 (아래 단계에서 다시 한번 dbvt 를 seaching 할때 이미 등록된 viewLights/viewEntities 를 한번에 찾기위해)
     AddViewLightsAndEntities(view);
 
-    // viewEntities 를 iteration 하며 skinned mesh surface 를 drawSurf 에 등록
-    AddSkinnedMeshes(view);
+    stageTime[1] = PlatformTime::Microseconds();
+
+    // staticDBVT 를 query 해서 찾은 static mesh surface 와
+    // viewEntities 를 iteration 하며 찾은 skinned mesh surface 를 병렬로 drawSurf 에 등록
+    JobSystem::ParallelFor(0, 2, parallel ? 1 : 2, [this, view](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            if (i == 0) {
+                AddStaticMeshes(view);
+            } else {
+                AddSkinnedMeshes(view);
+            }
+        }
+    });
 
+    // text mesh 는 공유된 textMesh 를 사용하므로 main thread 에서 처리
     AddTextMeshes(view);
 
-    // staticDBVT 를 query 해서 찾은 static mesh surface 를 drawSurf 에 등록
-    AddStaticMeshes(view);
+    stageTime[2] = PlatformTime::Microseconds();
+
+    // light 의 bounding volume 으로 staticDBVT 와 dynamicDBVT 를 query 하여,
+    // ambient visible 여부, shadow bounding volume 의 visible 여부
+    // ambient visible 이라면 viewLight 의 litSurf 에 등록
+    // shadow visible 이라면 shadowCasterSurf 에 등록
+    // skinned mesh 는 entity 단위로 컬링하고 surf 를 한꺼번에 등록
+    AddMeshesForLights(view, parallel);
+
+    stageTime[3] = PlatformTime::Microseconds();
+
+    // 등록된 모든 drawSurfs 들을 view 에 모아서 sorting
+    FlushDrawSurfs(view, true);
 
-    // 등록된 모든 ambient visible 한 drawSurfs 들을 sorting
-    SortDrawSurfs(view);
+    stageTime[4] = PlatformTime::Microseconds();
     
     /*if (!(view->def->parms.flags & NoSubViews)) {
         for (int i = 0; i < view->numDrawSurfs; i++) {
@@ -603,29 +776,54 @@ void RenderWorld::RenderView(view_t *view) {
         }
     }*/
     
-    // light 의 bounding volume 으로 staticDBVT 를 query 하여,
-    // ambient visible 여부, shadow bounding volume 의 visible 여부
-    // ambient visible 이라면 viewLight 의 litSurf 에 등록
-    // shadow visible 이라면 shadowCasterSurf 에 등록
-    AddStaticMeshesForLights(view);
+    OptimizeLights(view);
 
-    // 바로 윗 단계와 비슷하나 entity 단위로 컬링하고 skinned mesh 의 surf 를 한꺼번에 등록
-    AddSkinnedMeshesForLights(view);
+    stageTime[5] = PlatformTime::Microseconds();
+
+    RenderContext *ctx = renderSystem.GetCurrentRenderContext();
+    if (ctx) {
+        ctx->renderCounter.numViews++;
+        ctx->renderCounter.numDrawSurfs += view->numDrawSurfs;
+        ctx->renderCounter.viewLightsAndEntitiesUsec += (unsigned int)(stageTime[1] - stageTime[0]);
+        ctx->renderCounter.addMeshesUsec += (unsigned int)(stageTime[2] - stageTime[1]);
+        ctx->renderCounter.addMeshesForLightsUsec += (unsigned int)(stageTime[3] - stageTime[2]);
+        ctx->renderCounter.flushDrawSurfsUsec += (unsigned int)(stageTime[4] - stageTime[3]);
+        ctx->renderCounter.optimizeLightsUsec += (unsigned int)(stageTime[5] - stageTime[4]);
+    }
 
-    OptimizeLights(view);
+    if (r_useRenderThread.GetBool()) {
+        CopyDefsToFrameData(view);
+    }
 
     renderSystem.CmdDrawView(view);
 }
 
-void RenderWorld::RenderSubView(viewEntity_t *viewEntity, const DrawSurf *drawSurf, const Material *material) {
-}
+// Render thread 가 back end 를 실행하는 동안 game thread 는 다음 프레임의 scene 을 갱신하므로,
+// back end 에서 읽는 def 들을 frame data 에 복사해서 연결한다. 복사본은 읽기 전용이며 소멸자는 호출되지 않는다.
+void RenderWorld::CopyDefsToFrameData(view_t *view) {
+    SceneView *viewDef = (SceneView *)frameData.Alloc(sizeof(SceneView));
+    memcpy((void *)viewDef, view->def, sizeof(SceneView));
+    view->def = viewDef;
 
-void RenderWorld::AddDrawSurf(view_t *view, viewEntity_t *viewEntity, const Material *material, SubMesh *subMesh, GuiSubMesh *guiSubMesh, int flags) {
-    if (view->numDrawSurfs + 1 > view->maxDrawSurfs) {
-        BE_WARNLOG(L"RenderWorld::AddDrawSurf: not enough renderable surfaces\n");
-        return;
+    for (viewEntity_t *viewEntity = view->viewEntities; viewEntity; viewEntity = viewEntity->next) {
+        SceneEntity *entityDef = (SceneEntity *)frameData.Alloc(sizeof(SceneEntity));
+        memcpy((void *)entityDef, viewEntity->def, sizeof(SceneEntity));
+        viewEntity->def = entityDef;
+    }
+
+    for (viewLight_t *viewLight = view->viewLights; viewLight; viewLight = viewLight->next) {
+        SceneLight *lightDef = (SceneLight *)frameData.Alloc(sizeof(SceneLight));
+        memcpy((void *)lightDef, viewLight->def, sizeof(SceneLight));
+        viewLight->def = lightDef;
     }
+}
+
+void RenderWorld::RenderSubView(viewEntity_t *viewEntity, const DrawSurf *drawSurf, const Material *material) {
+}
 
+// drawSurf 를 생성해서 calling worker 의 buffer 에 담는다. 여러 worker 에서 동시에 호출될 수 있다.
+// GPU 버퍼 캐싱은 FlushDrawSurfs 에서 main thread 가 처리한다.
+DrawSurf *RenderWorld::AddDrawSurf(view_t *view, viewEntity_t *viewEntity, const Material *material, SubMesh *subMesh, GuiSubMesh *guiSubMesh, int flags) {
     const Material *realMaterial = material;
     if (!realMaterial) {
         realMaterial = materialManager.defaultMaterial;
@@ -642,25 +840,208 @@ void RenderWorld::AddDrawSurf(view_t *view, viewEntity_t *viewEntity, const Mate
 
     realMaterial->GetExprChunk()->Evaluate(localParms, outputValues);*/
 
-    if (subMesh) {
-        if (viewEntity->def->parms.skeleton && viewEntity->def->parms.joints && !subMesh->IsGpuSkinning()) {
-            subMesh->CacheDynamicDataToGpu(viewEntity->def->parms.joints, realMaterial);
-        } else {
-            subMesh->CacheStaticDataToGpu();
+    DrawSurf drawSurf;
+    drawSurf.entity             = viewEntity;
+    drawSurf.material           = realMaterial;
+    drawSurf.materialRegisters  = nullptr;//outputValues;
+    drawSurf.subMesh            = subMesh;
+    drawSurf.guiSubMesh         = guiSubMesh;
+    drawSurf.flags              = flags;
+    drawSurf.numInstances       = 1;
+    drawSurf.instanceCache      = nullptr;
+
+    drawSurf.MakeSortKey(viewEntity->def->index, realMaterial, view->def->parms.origin.DistanceSqr(viewEntity->def->parms.origin));
+
+    return drawSurfBuffers[Max(JobSystem::WorkerIndex(), 0)].Append(drawSurf);
+}
+
+// worker 들이 생성한 drawSurfs 의 GPU 버퍼를 캐싱하고 view 의 drawSurfs 배열에 모은다. main thread 에서만 호출해야 한다.
+// sort 가 true 라면 chunk 에 따로 저장된 sort key 들로 radix sort 한다.
+void RenderWorld::FlushDrawSurfs(view_t *view, bool sort) {
+    BE_PROFILE_SCOPE("RenderWorld::FlushDrawSurfs");
+
+    int numDrawSurfs = 0;
+    for (int workerIndex = 0; workerIndex < JobSystem::MaxWorkers; workerIndex++) {
+        numDrawSurfs += drawSurfBuffers[workerIndex].Count();
+    }
+
+    view->numDrawSurfs = 0;
+    view->drawSurfs = (DrawSurf **)frameData.Alloc(numDrawSurfs * sizeof(DrawSurf *));
+
+    RadixSortPair *pairs = nullptr;
+    if (sort && numDrawSurfs > 1) {
+        pairs = (RadixSortPair *)Mem_Alloc16(numDrawSurfs * 2 * sizeof(RadixSortPair));
+    }
+
+    for (int workerIndex = 0; workerIndex < JobSystem::MaxWorkers; workerIndex++) {
+        DrawSurfBuffer &drawSurfBuffer = drawSurfBuffers[workerIndex];
+
+        for (DrawSurfBuffer::Chunk *chunk = drawSurfBuffer.FirstChunk(); chunk; chunk = chunk->next) {
+            for (int i = 0; i < chunk->count; i++) {
+                DrawSurf *drawSurf = &chunk->surfs[i];
+                SubMesh *subMesh = drawSurf->subMesh;
+
+                if (subMesh) {
+                    const SceneEntity::Parms &entityParms = drawSurf->entity->def->parms;
+
+                    if (entityParms.skeleton && entityParms.joints) {
+                        // Update skinning joint cache for GPU skinning
+                        entityParms.mesh->UpdateSkinningJointCache(entityParms.skeleton, entityParms.joints);
+                    }
+
+                    if (entityParms.skeleton && entityParms.joints && !subMesh->IsGpuSkinning()) {
+                        subMesh->CacheDynamicDataToGpu(entityParms.joints, drawSurf->material);
+                    } else {
+                        subMesh->CacheStaticDataToGpu();
+                    }
+                }
+
+                if (pairs) {
+                    pairs[view->numDrawSurfs].key = chunk->sortkeys[i];
+                    pairs[view->numDrawSurfs].index = view->numDrawSurfs;
+                }
+
+                view->drawSurfs[view->numDrawSurfs++] = drawSurf;
+            }
         }
+
+        drawSurfBuffer.Clear();
     }
 
-    DrawSurf *drawSurf = (DrawSurf *)frameData.ClearedAlloc(sizeof(DrawSurf));
-    drawSurf->entity            = viewEntity;
-    drawSurf->material          = realMaterial;
-    drawSurf->materialRegisters = nullptr;//outputValues;
-    drawSurf->subMesh           = subMesh;
-    drawSurf->guiSubMesh        = guiSubMesh;
-    drawSurf->flags             = flags;
+    if (!pairs) {
+        return;
+    }
 
-    drawSurf->MakeSortKey(viewEntity->def->index, realMaterial);
-    
-    view->drawSurfs[view->numDrawSurfs++] = drawSurf;
+    RadixSortPair *temp = pairs + numDrawSurfs;
+
+    if (r_useParallelFrontEnd.GetBool()) {
+        ParallelRadixSort(pairs, temp, numDrawSurfs);
+    } else {
+        RadixSort(pairs, temp, numDrawSurfs);
+    }
+
+    // Permute drawSurfs using temp buffer which is no longer needed
+    DrawSurf **sortedDrawSurfs = (DrawSurf **)temp;
+    for (int i = 0; i < numDrawSurfs; i++) {
+        sortedDrawSurfs[i] = view->drawSurfs[pairs[i].index];
+    }
+    memcpy(view->drawSurfs, sortedDrawSurfs, numDrawSurfs * sizeof(DrawSurf *));
+
+    Mem_AlignedFree(pairs);
+
+    if (r_instancing.GetBool()) {
+        InstanceDrawSurfs(view);
+    }
+}
+
+// Ambient 또는 depth pass 에서 instanced draw 로 그릴 수 있는 surface 인지 검사한다.
+// backend 의 shader 선택과 같은 순서로 instanced version 이 있는지 확인해야 한다.
+static bool IsInstanceableDrawSurf(const DrawSurf *drawSurf) {
+    if (!drawSurf->subMesh || !(drawSurf->flags & DrawSurf::AmbientVisible)) {
+        return false;
+    }
+
+    if (!(drawSurf->material->GetCoverage() & (Material::OpaqueCoverage | Material::PerforatedCoverage))) {
+        return false;
+    }
+
+    const SceneEntity::Parms &entityParms = drawSurf->entity->def->parms;
+    if (entityParms.joints || entityParms.billboard || entityParms.depthHack) {
+        return false;
+    }
+
+    const Material::Pass *mtrlPass = drawSurf->material->GetPass();
+    const Shader *shader;
+
+    if (r_ambientLit.GetBool()) {
+        shader = mtrlPass->shader && mtrlPass->shader->GetAmbientLitVersion() ? mtrlPass->shader->GetAmbientLitVersion() : ShaderManager::amblitNoBumpShader;
+    } else {
+        shader = ShaderManager::amblitNoAmbientCubeMapShader;
+    }
+
+    if (!r_useDepthPrePass.GetBool() && mtrlPass->stateBits & Renderer::MaskAF && shader->GetPerforatedVersion()) {
+        shader = shader->GetPerforatedVersion();
+    }
+
+    return shader->GetInstancedVersion() != nullptr;
+}
+
+// Sort 된 drawSurfs 에서 같은 material 과 sub mesh 를 공유하는 연속된 surface 들을 하나의 instanced draw 로 합친다.
+// 합쳐진 surface 들의 entity data 는 texel buffer 에 담고, 첫번째 surface 가 모든 instance 를 그린다.
+void RenderWorld::InstanceDrawSurfs(view_t *view) {
+    BE_PROFILE_SCOPE("RenderWorld::InstanceDrawSurfs");
+
+    const Vec3 &viewOrigin = view->def->parms.origin;
+
+    int i = 0;
+    while (i < view->numDrawSurfs) {
+        DrawSurf *leadSurf = view->drawSurfs[i];
+        if (!IsInstanceableDrawSurf(leadSurf)) {
+            i++;
+            continue;
+        }
+
+        const SubMesh *sourceSubMesh = leadSurf->subMesh->GetSourceSubMesh();
+        const Material::Pass *mtrlPass = leadSurf->material->GetPass();
+        const float *leadParms = leadSurf->entity->def->parms.materialParms;
+
+        int count = 1;
+        while (i + count < view->numDrawSurfs) {
+            const DrawSurf *surf = view->drawSurfs[i + count];
+            if (surf->material != leadSurf->material || !surf->subMesh || surf->subMesh->GetSourceSubMesh() != sourceSubMesh) {
+                break;
+            }
+            if (!IsInstanceableDrawSurf(surf)) {
+                break;
+            }
+            // Owner color is a per-entity constant which can't be varied in an instanced draw
+            if (mtrlPass->useOwnerColor && memcmp(surf->entity->def->parms.materialParms, leadParms, sizeof(float) * (SceneEntity::AlphaParm + 1))) {
+                break;
+            }
+            count++;
+        }
+
+        if (count < 2) {
+            i++;
+            continue;
+        }
+
+        const int bytes = count * 4 * sizeof(Vec4);
+        if (bytes > bufferCacheManager.GetTexelMemAvailable()) {
+            break;
+        }
+
+        BufferCache *instanceCache = (BufferCache *)frameData.Alloc(sizeof(BufferCache));
+        if (!bufferCacheManager.AllocTexel(bytes, nullptr, instanceCache)) {
+            break;
+        }
+
+        Vec4 *instanceData = (Vec4 *)bufferCacheManager.MapTexelBuffer(instanceCache);
+
+        for (int instanceIndex = 0; instanceIndex < count; instanceIndex++) {
+            DrawSurf *surf = view->drawSurfs[i + instanceIndex];
+            const SceneEntity *def = surf->entity->def;
+            const Mat4 &modelMatrix = def->GetModelMatrix();
+
+            // view vector: world -> to mesh coordinates
+            Vec3 localViewOrigin = def->parms.axis.TransposedMulVec(viewOrigin - def->parms.origin) / def->parms.scale;
+
+            instanceData[0] = modelMatrix[0];
+            instanceData[1] = modelMatrix[1];
+            instanceData[2] = modelMatrix[2];
+            instanceData[3] = Vec4(localViewOrigin, 1.0f);
+            instanceData += 4;
+
+            surf->numInstances = 0;
+        }
+
+        bufferCacheManager.UnmapTexelBuffer(instanceCache);
+
+        leadSurf->numInstances = count;
+        leadSurf->instanceCache = instanceCache;
+
+        i += count;
+    }
 }
 
 BE_NAMESPACE_END
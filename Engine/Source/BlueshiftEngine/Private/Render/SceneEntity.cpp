@@ -32,6 +32,8 @@ SceneEntity::SceneEntity() {
     proxy = nullptr;
     meshSurfProxies = nullptr;
     numMeshSurfProxies = 0;
+    lodGroup.viewCount = -1;
+    lodGroup.lodLevel = 0;
 }
 
 SceneEntity::~SceneEntity() {
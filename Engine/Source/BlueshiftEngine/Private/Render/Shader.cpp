@@ -41,7 +41,12 @@ static const char *builtInConstantNames[] = {
     "vertexColorAdd",
     "localViewOrigin",
     "localLightOrigin",
-    "localLightAxis"
+    "localLightAxis",
+    "positionScale",
+    "positionBias",
+    "compactVertex",
+    "viewProjectionMatrix",
+    "instanceIndexBase"
 };
 
 // NOTE: BuiltInSampler enum 과 반드시 순서가 같아야 함
@@ -59,6 +64,9 @@ const StrHashMap<PropertySpec> &Shader::GetSpecHashMap() const {
 }
 
 void Shader::Purge() {
+    // Wait for the render thread to release the GL context
+    renderSystem.SyncRenderThread();
+
     if (shaderHandle != Renderer::NullShader) {
         glr.DeleteShader(shaderHandle);
         shaderHandle = Renderer::NullShader;
@@ -96,6 +104,11 @@ void Shader::Purge() {
         }
     }
 
+    if (instancedVersion) {
+        shaderManager.ReleaseShader(instancedVersion);
+        instancedVersion = nullptr;
+    }
+
     defineArray.Clear();
     specHashMap.Clear();
 }
@@ -103,6 +116,7 @@ void Shader::Purge() {
 bool Shader::Create(const char *text, const char *baseDir) {
     bool generatePerforatedVersion = false;
     bool generateGpuSkinningVersion = false;
+    bool generateInstancedVersion = false;
     bool generateParallelShadowVersion = false;
     bool generatePointShadowVersion = false;
     bool generateSpotShadowVersion = false;
@@ -206,6 +220,8 @@ bool Shader::Create(const char *text, const char *baseDir) {
             generatePerforatedVersion = true;
         } else if (!token.Icmp("generateGpuSkinningVersion")) {
             generateGpuSkinningVersion = true;
+        } else if (!token.Icmp("generateInstancedVersion")) {
+            generateInstancedVersion = true;
         } else if (!token.Icmp("generateParallelShadowVersion")) {
             generateParallelShadowVersion = true;
         } else if (!token.Icmp("generatePointShadowVersion")) {
@@ -221,7 +237,7 @@ bool Shader::Create(const char *text, const char *baseDir) {
         }
     }
 
-    return Finish(generatePerforatedVersion, generateGpuSkinningVersion, generateParallelShadowVersion, generateSpotShadowVersion, generatePointShadowVersion, baseDir);
+    return Finish(generatePerforatedVersion, generateGpuSkinningVersion, generateInstancedVersion, generateParallelShadowVersion, generateSpotShadowVersion, generatePointShadowVersion, baseDir);
 }
 
 bool Shader::ParseProperties(Lexer &lexer) {
@@ -328,7 +344,19 @@ bool Shader::GenerateGpuSkinningVersion(Shader *shader, const Str &shaderNamePos
 }
 
 
-bool Shader::GeneratePerforatedVersion(Shader *shader, const Str &shaderNamePostfix, const Str &vsHeaderText, const Str &fsHeaderText, bool genereateGpuSkinningVersion) {
+bool Shader::GenerateInstancedVersion(Shader *shader, const Str &shaderNamePostfix, const Str &vsHeaderText, const Str &fsHeaderText) {
+    if (!shader->instancedVersion) {
+        shader->instancedVersion = GenerateSubShader(shaderNamePostfix + "-instanced",
+            vsHeaderText + "#define INSTANCED_DRAW\n$include \"instancing.glsl\"\n", fsHeaderText + "#define INSTANCED_DRAW\n", 0);
+        if (!shader->instancedVersion) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Shader::GeneratePerforatedVersion(Shader *shader, const Str &shaderNamePostfix, const Str &vsHeaderText, const Str &fsHeaderText, bool genereateGpuSkinningVersion, bool generateInstancedVersion) {
     if (!shader->perforatedVersion) {
         shader->perforatedVersion = GenerateSubShader(shaderNamePostfix + "-perforated",
             vsHeaderText + "#define PERFORATED\n", fsHeaderText + "#define PERFORATED\n", 0);
@@ -344,18 +372,32 @@ bool Shader::GeneratePerforatedVersion(Shader *shader, const Str &shaderNamePost
         }
     }
 
+    if (generateInstancedVersion) {
+        if (!GenerateInstancedVersion(shader->perforatedVersion,
+            shaderNamePostfix + "-perforated", vsHeaderText + "#define PERFORATED\n", fsHeaderText + "#define PERFORATED\n")) {
+            return false;
+        }
+    }
+
     return true;
 }
 
-bool Shader::Finish(bool generatePerforatedVersion, bool genereateGpuSkinningVersion, bool generateParallelShadowVersion, bool generateSpotShadowVersion, bool generatePointShadowVersion, const char *baseDir) {
+bool Shader::Finish(bool generatePerforatedVersion, bool genereateGpuSkinningVersion, bool generateInstancedVersion, bool generateParallelShadowVersion, bool generateSpotShadowVersion, bool generatePointShadowVersion, const char *baseDir) {
     if (genereateGpuSkinningVersion) {
         if (!GenerateGpuSkinningVersion(this, "", "", "")) {
             return false;
         }
     }
 
+    // Instanced draws are only batched in the ambient and depth passes, so shadow versions don't need it
+    if (generateInstancedVersion) {
+        if (!GenerateInstancedVersion(this, "", "", "")) {
+            return false;
+        }
+    }
+
     if (generatePerforatedVersion) {
-        if (!GeneratePerforatedVersion(this, "", "", "", genereateGpuSkinningVersion)) {
+        if (!GeneratePerforatedVersion(this, "", "", "", genereateGpuSkinningVersion, generateInstancedVersion)) {
             return false;
         }
     }
@@ -379,7 +421,7 @@ bool Shader::Finish(bool generatePerforatedVersion, bool genereateGpuSkinningVer
         }
 
         if (generatePerforatedVersion) {
-            if (!GeneratePerforatedVersion(parallelShadowVersion, shaderNamePostfix, vsHeaderText, fsHeaderText, genereateGpuSkinningVersion)) {
+            if (!GeneratePerforatedVersion(parallelShadowVersion, shaderNamePostfix, vsHeaderText, fsHeaderText, genereateGpuSkinningVersion, false)) {
                 return false;
             }
         }
@@ -404,7 +446,7 @@ bool Shader::Finish(bool generatePerforatedVersion, bool genereateGpuSkinningVer
         }
 
         if (generatePerforatedVersion) {
-            if (!GeneratePerforatedVersion(spotShadowVersion, shaderNamePostfix, vsHeaderText, fsHeaderText, genereateGpuSkinningVersion)) {
+            if (!GeneratePerforatedVersion(spotShadowVersion, shaderNamePostfix, vsHeaderText, fsHeaderText, genereateGpuSkinningVersion, false)) {
                 return false;
             }
         }
@@ -429,7 +471,7 @@ bool Shader::Finish(bool generatePerforatedVersion, bool genereateGpuSkinningVer
         }
 
         if (generatePerforatedVersion) {
-            if (!GeneratePerforatedVersion(pointShadowVersion, shaderNamePostfix, vsHeaderText, fsHeaderText, genereateGpuSkinningVersion)) {
+            if (!GeneratePerforatedVersion(pointShadowVersion, shaderNamePostfix, vsHeaderText, fsHeaderText, genereateGpuSkinningVersion, false)) {
                 return false;
             }
         }
@@ -505,6 +547,10 @@ Shader *Shader::InstantiateShader(const Array<Define> &defineArray) {
         }
     }
 
+    if (instancedVersion) {
+        shader->instancedVersion = instancedVersion->InstantiateShader(defineArray);
+    }
+
     return shader;
 }
 
@@ -597,10 +643,26 @@ void Shader::Reinstantiate() {
             }
         }
     }
+
+    if (originalShader->instancedVersion) {
+        if (instancedVersion) {
+            instancedVersion->originalShader = originalShader->instancedVersion;
+            instancedVersion->Reinstantiate();
+        } else {
+            instancedVersion = originalShader->instancedVersion->InstantiateShader(defineArray);
+        }
+    } else {
+        if (instancedVersion) {
+            shaderManager.ReleaseShader(instancedVersion);
+            instancedVersion = nullptr;
+        }
+    }
 }
 
 
 bool Shader::Instantiate(const Array<Define> &defineArray) {
+    renderSystem.SyncRenderThread();
+
     
 #if defined __ANDROID__ && ! defined __XAMARIN__
     static int progress = 0;
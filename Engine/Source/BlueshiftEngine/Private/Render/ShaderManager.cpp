@@ -400,6 +400,8 @@ Shader *ShaderManager::FindShader(const char *hashName) const {
 }
 
 Shader *ShaderManager::GetShader(const char *hashName) {
+    MemTagScope tagScope(MemTag::Asset);
+
     if (!hashName || !hashName[0]) {
         return nullptr;
     }
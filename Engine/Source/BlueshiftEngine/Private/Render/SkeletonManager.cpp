@@ -107,6 +107,8 @@ Skeleton *SkeletonManager::FindSkeleton(const char *hashName) const {
 }
 
 Skeleton *SkeletonManager::GetSkeleton(const char *hashName) {
+    MemTagScope tagScope(MemTag::Asset);
+
     if (!hashName || !hashName[0]) {
         return defaultSkeleton;
     }
@@ -18,7 +18,6 @@
 #include "SIMD/Simd.h"
 #include "SIMD/SIMD.h"
 #include "Core/Heap.h"
-#include "NvTriStrip.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -77,6 +76,8 @@ void SubMesh::AllocSubMesh(int numVerts, int numIndexes) {
     this->useGpuSkinning            = false;
     this->gpuSkinningVersionIndex   = 0;
 
+    this->useCompactVertex          = false;
+
     this->ambientCache              = (BufferCache *)Mem_ClearedAlloc(sizeof(BufferCache));
     this->indexCache                = (BufferCache *)Mem_ClearedAlloc(sizeof(BufferCache));
 }
@@ -112,6 +113,9 @@ void SubMesh::AllocInstantiatedSubMesh(const SubMesh *ref, int meshType) {
     this->useGpuSkinning            = (ref->vertWeights && meshType == Mesh::SkinnedMesh) ? true : false;
     this->gpuSkinningVersionIndex   = ref->gpuSkinningVersionIndex;
 
+    // Compact vertex buffer is shared with the reference, dynamic meshes upload generic vertices every frame
+    this->useCompactVertex          = ref->useCompactVertex && this->type == Mesh::StaticMesh;
+
     this->aabb                      = ref->aabb;
 
     if (this->type == Mesh::StaticMesh || this->useGpuSkinning) {
@@ -130,6 +134,9 @@ void SubMesh::AllocInstantiatedSubMesh(const SubMesh *ref, int meshType) {
 }
 
 void SubMesh::FreeSubMesh() {
+    // Wait for the render thread to release the GL context
+    renderSystem.SyncRenderThread();
+
     if (!alloced) {
         return;
     }
@@ -182,6 +189,17 @@ void SubMesh::CacheStaticDataToGpu() {
             simdProcessor->Memcpy(ptr, verts, sizeof(VertexLightingGeneric) * numVerts);
             simdProcessor->Memcpy(ptr + sizeof(VertexLightingGeneric) * numVerts, vertWeights, sizeofVertWeight * numVerts);
 
+            glr.UnmapBuffer(ambientCache->buffer);
+        } else if (useCompactVertex) {
+            int size = sizeof(VertexCompact) * numVerts;
+
+            bufferCacheManager.AllocStaticVertex(size, nullptr, ambientCache);
+
+            glr.BindBuffer(Renderer::VertexBuffer, ambientCache->buffer);
+            VertexCompact *ptr = (VertexCompact *)glr.MapBufferRange(ambientCache->buffer, Renderer::WriteOnly, 0, size);
+
+            WriteCompactVerts(ptr);
+
             glr.UnmapBuffer(ambientCache->buffer);
         } else {
             bufferCacheManager.AllocStaticVertex(numVerts * sizeof(VertexLightingGeneric), verts, ambientCache);
@@ -194,6 +212,37 @@ void SubMesh::CacheStaticDataToGpu() {
     }
 }
 
+void SubMesh::WriteCompactVerts(VertexCompact *dst) const {
+    const Vec3 scale = CompactPositionScale();
+    const Vec3 bias = CompactPositionBias();
+    Vec3 invScale;
+    for (int i = 0; i < 3; i++) {
+        invScale[i] = scale[i] > FLT_EPSILON ? 1.0f / scale[i] : 0.0f;
+    }
+
+    for (int i = 0; i < numVerts; i++) {
+        const VertexLightingGeneric &src = verts[i];
+        VertexCompact &v = dst[i];
+
+        for (int j = 0; j < 3; j++) {
+            const float q = Clamp((src.xyz[j] - bias[j]) * invScale[j], -1.0f, 1.0f);
+            v.xyz[j] = (int16_t)Math::Ftoi(q * 32767.0f + (q >= 0.0f ? 0.5f : -0.5f));
+        }
+        v.xyz[3] = 32767;
+
+        v.st[0] = src.st[0];
+        v.st[1] = src.st[1];
+
+        const Vec3 normal = src.GetNormal();
+        // Tangent is orthogonalized to the normal for the angle encoding
+        Vec3 tangent = src.GetTangent() - normal * normal.Dot(src.GetTangent());
+        tangent.Normalize();
+        EncodeCompactNormalTangent(normal, tangent, src.GetBiTangentSign(), v.normalTangent);
+
+        *reinterpret_cast<uint32_t *>(v.color) = src.GetColor();
+    }
+}
+
 void SubMesh::CacheDynamicDataToGpu(const Mat3x4 *joints, const Material *material) {
     if (!bufferCacheManager.IsCached(ambientCache)) {
         if (joints) {
@@ -1182,40 +1231,422 @@ const Mat3 SubMesh::ComputeInertiaTensor(const Vec3 &centroid, float mass) const
     return inertia;
 }
 
-void SubMesh::OptimizeIndexedTriangles() {
-#if 0
-    // NOTE: consider if size of the index is greater than 16 bit number or not
-    PrimitiveGroup *srcPrimGroup = new PrimitiveGroup;
-    srcPrimGroup->type = PrimType::PT_LIST;
-    srcPrimGroup->numIndices = numIndexes;
-    srcPrimGroup->indices = new unsigned short [numIndexes];
+// Forsyth's vertex cache optimization parameters (Linear-Speed Vertex Cache Optimisation, Tom Forsyth)
+#define VERTEX_CACHE_SIZE           32
+#define CACHE_DECAY_POWER           1.5f
+#define LAST_TRI_SCORE              0.75f
+#define VALENCE_BOOST_SCALE         2.0f
+#define VALENCE_BOOST_POWER         0.5f
+#define MAX_VALENCE_SCORES          64
+
+// FIFO cache size used to measure ACMR/ATVR, which is the typical size of the mobile GPUs
+#define MEASURE_VERTEX_CACHE_SIZE   16
+
+int SubMesh::CountVertexCacheMisses(int cacheSize) const {
+    // Time stamp of the vertex when it entered the FIFO cache
+    int *cacheTimes = (int *)Mem_Alloc16(sizeof(int) * numVerts);
+    memset(cacheTimes, -1, sizeof(int) * numVerts);
+
+    int time = cacheSize;
+    int numMisses = 0;
 
     for (int i = 0; i < numIndexes; i++) {
-        srcPrimGroup->indices[i] = indexes[i];
+        const int v = indexes[i];
+        if (cacheTimes[v] < 0 || time - cacheTimes[v] > cacheSize) {
+            cacheTimes[v] = ++time;
+            numMisses++;
+        }
+    }
+
+    Mem_AlignedFree(cacheTimes);
+
+    return numMisses;
+}
+
+struct VertexScoreTables {
+    VertexScoreTables();
+
+    float                   cacheScores[VERTEX_CACHE_SIZE];
+    float                   valenceScores[MAX_VALENCE_SCORES];
+};
+
+VertexScoreTables::VertexScoreTables() {
+    for (int i = 0; i < VERTEX_CACHE_SIZE; i++) {
+        if (i < 3) {
+            // The vertices used by the last triangle get a fixed score, so the next triangle doesn't depend on the order of them
+            cacheScores[i] = LAST_TRI_SCORE;
+        } else {
+            const float scaler = 1.0f / (VERTEX_CACHE_SIZE - 3);
+            cacheScores[i] = Math::Pow(1.0f - (i - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+
+    for (int i = 0; i < MAX_VALENCE_SCORES; i++) {
+        // Boosts the vertices with few remaining triangles, to get rid of the lone vertices quickly
+        valenceScores[i] = i > 0 ? VALENCE_BOOST_SCALE * Math::Pow((float)i, -VALENCE_BOOST_POWER) : 0.0f;
+    }
+}
+
+// Sub meshes are optimized by parallel jobs, so the tables are built by a function-local static which is initialized once thread-safely
+static const VertexScoreTables &GetVertexScoreTables() {
+    static const VertexScoreTables tables;
+    return tables;
+}
+
+static BE_FORCE_INLINE float VertexScore(const VertexScoreTables &tables, int cachePosition, int numActiveTris) {
+    if (numActiveTris == 0) {
+        // No triangle needs this vertex
+        return -1.0f;
     }
 
-    PrimitiveGroup *dstPrimGroup;
+    float score = cachePosition >= 0 ? tables.cacheScores[cachePosition] : 0.0f;
+    score += tables.valenceScores[Min(numActiveTris, MAX_VALENCE_SCORES - 1)];
+    return score;
+}
+
+// Reorders triangles to maximize post-transform vertex cache hits
+static void OptimizeVertexCache(TriIndex *indexes, int numIndexes, int numVerts) {
+    const VertexScoreTables &scoreTables = GetVertexScoreTables();
+
+    const int numTris = numIndexes / 3;
+
+    // Triangles using each vertex, active triangles first
+    int *numActiveTris = (int *)Mem_ClearedAlloc(sizeof(int) * numVerts);
+    int *firstVertTri = (int *)Mem_Alloc(sizeof(int) * (numVerts + 1));
+    int *vertTris = (int *)Mem_Alloc(sizeof(int) * numIndexes);
+    int *cachePositions = (int *)Mem_Alloc(sizeof(int) * numVerts);
+    float *vertScores = (float *)Mem_Alloc(sizeof(float) * numVerts);
+    bool *triAdded = (bool *)Mem_ClearedAlloc(sizeof(bool) * numTris);
+    TriIndex *newIndexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * numIndexes);
 
-    // remap indices
-    RemapIndices(srcPrimGroup, 1, numVerts, &dstPrimGroup);
+    for (int i = 0; i < numIndexes; i++) {
+        numActiveTris[indexes[i]]++;
+    }
+
+    firstVertTri[0] = 0;
+    for (int i = 0; i < numVerts; i++) {
+        firstVertTri[i + 1] = firstVertTri[i] + numActiveTris[i];
+        numActiveTris[i] = 0;
+    }
 
     for (int i = 0; i < numIndexes; i++) {
-        indexes[i] = dstPrimGroup->indices[i];
+        const int v = indexes[i];
+        vertTris[firstVertTri[v] + numActiveTris[v]++] = i / 3;
+    }
+
+    for (int i = 0; i < numVerts; i++) {
+        cachePositions[i] = -1;
+        vertScores[i] = VertexScore(scoreTables, -1, numActiveTris[i]);
+    }
+
+    int cache[VERTEX_CACHE_SIZE + 3];
+    int newCache[VERTEX_CACHE_SIZE + 3];
+    int cacheCount = 0;
+
+    int bestTri = -1;
+    int nextTri = 0; // cursor to find the next triangle when no triangle in the cache is usable
+
+    for (int triCount = 0; triCount < numTris; triCount++) {
+        if (bestTri < 0) {
+            // No triangle in the cache is usable, so takes the next one in the original order.
+            // Scanning every triangle for the best score would be quadratic.
+            while (triAdded[nextTri]) {
+                nextTri++;
+            }
+            bestTri = nextTri;
+        }
+
+        const TriIndex *tri = &indexes[bestTri * 3];
+        newIndexes[triCount * 3 + 0] = tri[0];
+        newIndexes[triCount * 3 + 1] = tri[1];
+        newIndexes[triCount * 3 + 2] = tri[2];
+        triAdded[bestTri] = true;
+
+        // Removes the triangle from the active triangles of the vertices
+        for (int k = 0; k < 3; k++) {
+            const int v = tri[k];
+            int *activeTris = &vertTris[firstVertTri[v]];
+            for (int j = 0; j < numActiveTris[v]; j++) {
+                if (activeTris[j] == bestTri) {
+                    Swap(activeTris[j], activeTris[numActiveTris[v] - 1]);
+                    break;
+                }
+            }
+            numActiveTris[v]--;
+        }
+
+        // Puts the vertices of the triangle in front of the cache
+        int newCacheCount = 0;
+        newCache[newCacheCount++] = tri[0];
+        newCache[newCacheCount++] = tri[1];
+        newCache[newCacheCount++] = tri[2];
+
+        for (int i = 0; i < cacheCount; i++) {
+            const int v = cache[i];
+            if (v != tri[0] && v != tri[1] && v != tri[2]) {
+                newCache[newCacheCount++] = v;
+            }
+        }
+
+        // Updates the scores of the vertices in the cache including the evicted ones
+        for (int i = 0; i < newCacheCount; i++) {
+            const int v = newCache[i];
+            cachePositions[v] = i < VERTEX_CACHE_SIZE ? i : -1;
+            vertScores[v] = VertexScore(scoreTables, cachePositions[v], numActiveTris[v]);
+        }
+
+        // Scores the triangles using them, and finds the best one
+        bestTri = -1;
+        float bestScore = -1.0f;
+
+        for (int i = 0; i < newCacheCount; i++) {
+            const int v = newCache[i];
+            const int *activeTris = &vertTris[firstVertTri[v]];
+
+            for (int j = 0; j < numActiveTris[v]; j++) {
+                const int t = activeTris[j];
+                const float score = vertScores[indexes[t * 3]] + vertScores[indexes[t * 3 + 1]] + vertScores[indexes[t * 3 + 2]];
+
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestTri = t;
+                }
+            }
+        }
+
+        cacheCount = Min(newCacheCount, VERTEX_CACHE_SIZE);
+        memcpy(cache, newCache, sizeof(cache[0]) * cacheCount);
     }
 
-    // remap vertices
-    VertexLightingGeneric *remappedVerts = (VertexLightingGeneric *)Mem_Alloc16(sizeof(verts[0]) * numVerts);
+    memcpy(indexes, newIndexes, sizeof(TriIndex) * numIndexes);
+
+    Mem_Free(numActiveTris);
+    Mem_Free(firstVertTri);
+    Mem_Free(vertTris);
+    Mem_Free(cachePositions);
+    Mem_Free(vertScores);
+    Mem_Free(triAdded);
+    Mem_AlignedFree(newIndexes);
+}
+
+struct TriCluster {
+    int                     firstTri;
+    int                     numTris;
+    float                   sortKey;
+};
+
+// Reorders clusters of triangles to draw outward facing clusters first, which tend to occlude the others (Sander et al. 2007).
+// Clusters are split where a triangle misses every vertex in the cache, so the vertex cache efficiency is mostly kept.
+static void OptimizeOverdraw(TriIndex *indexes, int numIndexes, const VertexLightingGeneric *verts, int numVerts) {
+    const int numTris = numIndexes / 3;
+
+    Array<TriCluster> clusters;
+    clusters.SetGranularity(Max(numTris / 16, 16));
+
+    int *cacheTimes = (int *)Mem_Alloc16(sizeof(int) * numVerts);
+    memset(cacheTimes, -1, sizeof(int) * numVerts);
+    int time = MEASURE_VERTEX_CACHE_SIZE;
+
+    for (int i = 0; i < numTris; i++) {
+        int numMisses = 0;
+        for (int k = 0; k < 3; k++) {
+            const int v = indexes[i * 3 + k];
+            if (cacheTimes[v] < 0 || time - cacheTimes[v] > MEASURE_VERTEX_CACHE_SIZE) {
+                cacheTimes[v] = ++time;
+                numMisses++;
+            }
+        }
+
+        if (i == 0 || numMisses == 3) {
+            TriCluster &cluster = clusters.Alloc();
+            cluster.firstTri = i;
+            cluster.numTris = 0;
+        }
+        clusters[clusters.Count() - 1].numTris++;
+    }
+
+    Mem_AlignedFree(cacheTimes);
+
+    if (clusters.Count() < 2) {
+        return;
+    }
+
+    // Area weighted centroids and normals of the clusters
+    Array<Vec3> clusterCentroids;
+    Array<Vec3> clusterNormals;
+    clusterCentroids.SetCount(clusters.Count());
+    clusterNormals.SetCount(clusters.Count());
+
+    Vec3 meshCentroid = Vec3::zero;
+    float meshArea = 0.0f;
+
+    for (int i = 0; i < clusters.Count(); i++) {
+        const TriCluster &cluster = clusters[i];
+        Vec3 centroid = Vec3::zero;
+        Vec3 normal = Vec3::zero;
+        float area = 0.0f;
+
+        for (int t = cluster.firstTri; t < cluster.firstTri + cluster.numTris; t++) {
+            const Vec3 &p0 = verts[indexes[t * 3 + 0]].xyz;
+            const Vec3 &p1 = verts[indexes[t * 3 + 1]].xyz;
+            const Vec3 &p2 = verts[indexes[t * 3 + 2]].xyz;
+
+            // Length of the cross product is twice the area, so the sum is an area weighted normal
+            const Vec3 n = (p1 - p0).Cross(p2 - p0);
+            const float triArea = n.Length() * 0.5f;
+
+            centroid += (p0 + p1 + p2) * (triArea / 3.0f);
+            normal += n;
+            area += triArea;
+        }
+
+        if (area > 0.0f) {
+            meshCentroid += centroid;
+            meshArea += area;
+            centroid /= area;
+        }
+        normal.Normalize();
+
+        clusterCentroids[i] = centroid;
+        clusterNormals[i] = normal;
+    }
+
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea;
+    }
+
+    for (int i = 0; i < clusters.Count(); i++) {
+        clusters[i].sortKey = (clusterCentroids[i] - meshCentroid).Dot(clusterNormals[i]);
+    }
+
+    // Stable sort keeps the order of the clusters with the same key
+    std::stable_sort(clusters.Ptr(), clusters.Ptr() + clusters.Count(), [](const TriCluster &a, const TriCluster &b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    TriIndex *newIndexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * numIndexes);
+    TriIndex *dst = newIndexes;
+
+    for (int i = 0; i < clusters.Count(); i++) {
+        const TriCluster &cluster = clusters[i];
+        memcpy(dst, &indexes[cluster.firstTri * 3], sizeof(TriIndex) * cluster.numTris * 3);
+        dst += cluster.numTris * 3;
+    }
+
+    memcpy(indexes, newIndexes, sizeof(TriIndex) * numIndexes);
+
+    Mem_AlignedFree(newIndexes);
+}
+
+// Reorders vertices in the order of the first use by the triangles, so vertex fetching is mostly sequential.
+// Unreferenced vertices are moved to the end.
+void SubMesh::OptimizeVertexFetch() {
+    int *vertexMap = (int *)Mem_Alloc16(sizeof(int) * numVerts);
+    for (int i = 0; i < numVerts; i++) {
+        vertexMap[i] = -1;
+    }
+
+    int newVertIndex = 0;
+    for (int i = 0; i < numIndexes; i++) {
+        const int v = indexes[i];
+        if (vertexMap[v] < 0) {
+            vertexMap[v] = newVertIndex++;
+        }
+    }
+    for (int i = 0; i < numVerts; i++) {
+        if (vertexMap[i] < 0) {
+            vertexMap[i] = newVertIndex++;
+        }
+    }
 
     for (int i = 0; i < numIndexes; i++) {
-        remappedVerts[dstPrimGroup->indices[i]] = verts[srcPrimGroup->indices[i]];
+        indexes[i] = vertexMap[indexes[i]];
     }
 
+    VertexLightingGeneric *newVerts = (VertexLightingGeneric *)Mem_Alloc16(sizeof(VertexLightingGeneric) * numVerts);
+    for (int i = 0; i < numVerts; i++) {
+        newVerts[vertexMap[i]] = verts[i];
+    }
     Mem_AlignedFree(verts);
-    verts = remappedVerts;
-    
-    delete srcPrimGroup;
-    delete [] dstPrimGroup;
-#endif
+    verts = newVerts;
+
+    // Vertex weights for GPU skinning
+    if (vertWeights) {
+        const int vertexWeightSize = VertexWeightSize();
+        void *newVertWeights = Mem_Alloc16(vertexWeightSize * numVerts);
+        for (int i = 0; i < numVerts; i++) {
+            memcpy((byte *)newVertWeights + vertexMap[i] * vertexWeightSize, (const byte *)vertWeights + i * vertexWeightSize, vertexWeightSize);
+        }
+        Mem_AlignedFree(vertWeights);
+        vertWeights = newVertWeights;
+    }
+
+    // Joint weights for CPU skinning are stored as a run of weights for each vertex,
+    // the last weight of a vertex has non-zero nextVertOffset
+    if (numJointWeights > 0) {
+        int *firstWeights = (int *)Mem_Alloc16(sizeof(int) * (numVerts + 1));
+        for (int i = 0, j = 0; i < numVerts; i++) {
+            firstWeights[i] = j;
+            while (jointWeights[j].nextVertOffset == 0) {
+                j++;
+            }
+            j++;
+            firstWeights[i + 1] = j;
+        }
+
+        int *inverseMap = (int *)Mem_Alloc16(sizeof(int) * numVerts);
+        for (int i = 0; i < numVerts; i++) {
+            inverseMap[vertexMap[i]] = i;
+        }
+
+        JointWeight *newJointWeights = (JointWeight *)Mem_Alloc16(sizeof(JointWeight) * numJointWeights);
+        Vec4 *newJointWeightVerts = (Vec4 *)Mem_Alloc16(sizeof(Vec4) * numJointWeights);
+
+        int weightIndex = 0;
+        for (int i = 0; i < numVerts; i++) {
+            const int oldVertIndex = inverseMap[i];
+            for (int j = firstWeights[oldVertIndex]; j < firstWeights[oldVertIndex + 1]; j++) {
+                newJointWeights[weightIndex] = jointWeights[j];
+                newJointWeightVerts[weightIndex] = jointWeightVerts[j];
+                weightIndex++;
+            }
+        }
+
+        Mem_AlignedFree(jointWeights);
+        Mem_AlignedFree(jointWeightVerts);
+        jointWeights = newJointWeights;
+        jointWeightVerts = newJointWeightVerts;
+
+        Mem_AlignedFree(inverseMap);
+        Mem_AlignedFree(firstWeights);
+    }
+
+    Mem_AlignedFree(vertexMap);
+}
+
+void SubMesh::OptimizeIndexedTriangles() {
+    if (numIndexes < 3 || refSubMesh) {
+        return;
+    }
+
+    OptimizeVertexCache(indexes, numIndexes, numVerts);
+
+    OptimizeOverdraw(indexes, numIndexes, verts, numVerts);
+
+    // Mirrored vertices should be kept at the end of the vertex array
+    if (numMirroredVerts == 0) {
+        OptimizeVertexFetch();
+
+        if (dominantTris) {
+            ComputeDominantTris();
+        }
+    }
+
+    if (edgesCalculated) {
+        Mem_AlignedFree(edges);
+        Mem_AlignedFree(edgeIndexes);
+        ComputeEdges();
+    }
 }
 
 BE_NAMESPACE_END
@@ -28,6 +28,9 @@ int Texture::MemRequired(bool includingMipmaps) const {
 }
 
 void Texture::Create(Renderer::TextureType type, const Image &srcImage, int flags) {
+    // Wait for the render thread to release the GL context
+    renderSystem.SyncRenderThread();
+
     Purge();
 
     this->type = type;
@@ -44,6 +47,8 @@ void Texture::Create(Renderer::TextureType type, const Image &srcImage, int flag
 }
 
 void Texture::CreateEmpty(Renderer::TextureType type, int width, int height, int depth, int numSlices, Image::Format format, int flags) {
+    renderSystem.SyncRenderThread();
+
     Purge();
 
     this->type = type;
@@ -56,6 +61,8 @@ void Texture::CreateEmpty(Renderer::TextureType type, int width, int height, int
 }
 
 void Texture::CreateFromBuffer(Image::Format format, Renderer::Handle bufferHandle) {
+    renderSystem.SyncRenderThread();
+
     Purge();
 
     this->type = Renderer::TextureBuffer;
@@ -509,6 +516,8 @@ static Renderer::AddressMode TextureFlagsToAddressMode(int flags) {
 }
 
 void Texture::Upload(const Image *srcImage) {
+    renderSystem.SyncRenderThread();
+
     Image::Format srcFormat = srcImage->GetFormat();
     Image::Format forceFormat = Image::Format::UnknownFormat;
     Image tmpImage;
@@ -600,18 +609,26 @@ void Texture::Upload(const Image *srcImage) {
 }
 
 void Texture::Update2D(int xoffset, int yoffset, int width, int height, Image::Format format, const byte *data) {
+    renderSystem.SyncRenderThread();
+
     glr.SetTextureSubImage2D(0, xoffset, yoffset, width, height, format, data);	
 }
 
 void Texture::Update3D(int xoffset, int yoffset, int zoffset, int width, int height, int depth, Image::Format format, const byte *data) {
+    renderSystem.SyncRenderThread();
+
     glr.SetTextureSubImage3D(0, xoffset, yoffset, zoffset, width, height, depth, format, data);
 }
 
 void Texture::UpdateCubemap(int face, int xoffset, int yoffset, int width, int height, Image::Format format, const byte *data) {
+    renderSystem.SyncRenderThread();
+
     glr.SetTextureSubImageCube((Renderer::CubeMapFace)face, 0, xoffset, yoffset, width, height, format, data);
 }
 
 void Texture::UpdateRect(int xoffset, int yoffset, int width, int height, Image::Format format, const byte *data) {
+    renderSystem.SyncRenderThread();
+
     glr.SetTextureSubImageRect(xoffset, yoffset, width, height, format, data);
 }
 
@@ -632,6 +649,8 @@ void Texture::GetTexelsRect(Image::Format format, void *pixels) const {
 }
 
 void Texture::Purge() {
+    renderSystem.SyncRenderThread();
+
     if (textureHandle != Renderer::NullTexture) {
         glr.DeleteTexture(textureHandle);
     }
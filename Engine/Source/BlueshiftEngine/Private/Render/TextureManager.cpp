@@ -247,6 +247,8 @@ Texture *TextureManager::FindTexture(const char *hashName) const {
 }
 
 Texture *TextureManager::GetTexture(const char *hashName, int creationFlags) {
+    MemTagScope tagScope(MemTag::Asset);
+
     if (!hashName || !hashName[0]) {
         return defaultTexture;
     }
@@ -110,6 +110,39 @@ void VertexFormat::Init() {
 
     CreateSkinningVertexFormats(GenericLitColor, GenericLitColorSkinning1, GenericLitColorSkinning4, GenericLitColorSkinning8);	
 
+    // CompactXyz
+    vertexFormats[CompactXyz].Append(0, OFFSET_OF(VertexCompact, xyz), Renderer::VertexElement::Position, 4, Renderer::VertexElement::ShortType, true);
+    vertexFormats[CompactXyz].Create();
+
+    // CompactXyzSt
+    vertexFormats[CompactXyzSt].Append(0, OFFSET_OF(VertexCompact, xyz), Renderer::VertexElement::Position, 4, Renderer::VertexElement::ShortType, true);
+    vertexFormats[CompactXyzSt].Append(0, OFFSET_OF(VertexCompact, st), Renderer::VertexElement::TexCoord0, 2, Renderer::VertexElement::HalfType, false);
+    vertexFormats[CompactXyzSt].Create();
+
+    // CompactXyzStColor
+    vertexFormats[CompactXyzStColor].Append(0, OFFSET_OF(VertexCompact, xyz), Renderer::VertexElement::Position, 4, Renderer::VertexElement::ShortType, true);
+    vertexFormats[CompactXyzStColor].Append(0, OFFSET_OF(VertexCompact, st), Renderer::VertexElement::TexCoord0, 2, Renderer::VertexElement::HalfType, false);
+    vertexFormats[CompactXyzStColor].Append(0, OFFSET_OF(VertexCompact, color), Renderer::VertexElement::Color, 4, Renderer::VertexElement::UByteType, true);
+    vertexFormats[CompactXyzStColor].Create();
+
+    // CompactXyzNormal
+    vertexFormats[CompactXyzNormal].Append(0, OFFSET_OF(VertexCompact, xyz), Renderer::VertexElement::Position, 4, Renderer::VertexElement::ShortType, true);
+    vertexFormats[CompactXyzNormal].Append(0, OFFSET_OF(VertexCompact, normalTangent), Renderer::VertexElement::Normal, 4, Renderer::VertexElement::UByteType, true);
+    vertexFormats[CompactXyzNormal].Create();
+
+    // CompactLit : packed normal and tangent are bound to the normal, tangent attribute is not used
+    vertexFormats[CompactLit].Append(0, OFFSET_OF(VertexCompact, xyz), Renderer::VertexElement::Position, 4, Renderer::VertexElement::ShortType, true);
+    vertexFormats[CompactLit].Append(0, OFFSET_OF(VertexCompact, st), Renderer::VertexElement::TexCoord, 2, Renderer::VertexElement::HalfType, false);
+    vertexFormats[CompactLit].Append(0, OFFSET_OF(VertexCompact, normalTangent), Renderer::VertexElement::Normal, 4, Renderer::VertexElement::UByteType, true);
+    vertexFormats[CompactLit].Create();
+
+    // CompactLitColor
+    vertexFormats[CompactLitColor].Append(0, OFFSET_OF(VertexCompact, xyz), Renderer::VertexElement::Position, 4, Renderer::VertexElement::ShortType, true);
+    vertexFormats[CompactLitColor].Append(0, OFFSET_OF(VertexCompact, st), Renderer::VertexElement::TexCoord0, 2, Renderer::VertexElement::HalfType, false);
+    vertexFormats[CompactLitColor].Append(0, OFFSET_OF(VertexCompact, color), Renderer::VertexElement::Color, 4, Renderer::VertexElement::UByteType, true);
+    vertexFormats[CompactLitColor].Append(0, OFFSET_OF(VertexCompact, normalTangent), Renderer::VertexElement::Normal, 4, Renderer::VertexElement::UByteType, true);
+    vertexFormats[CompactLitColor].Create();
+
     // Occludee
     vertexFormats[Occludee].Append(0, 0, Renderer::VertexElement::Position, 2, Renderer::VertexElement::FloatType, false);
     vertexFormats[Occludee].Append(0, 8, Renderer::VertexElement::TexCoord0, 3, Renderer::VertexElement::FloatType, false);
@@ -146,6 +179,18 @@ void VertexFormat::CreateSkinningVertexFormats(int originalIndex, int skinning1I
     vf->Create();
 }
 
+int VertexFormat::ToCompactVertexFormat(int genericIndex) {
+    switch (genericIndex) {
+    case GenericXyz: return CompactXyz;
+    case GenericXyzSt: return CompactXyzSt;
+    case GenericXyzStColor: return CompactXyzStColor;
+    case GenericXyzNormal: return CompactXyzNormal;
+    case GenericLit: return CompactLit;
+    case GenericLitColor: return CompactLitColor;
+    default: assert(0); return genericIndex;
+    }
+}
+
 void VertexFormat::Free() {
     for (int i = 0; i < COUNT_OF(vertexFormats); i++) {
         vertexFormats[i].Delete();
@@ -173,6 +218,7 @@ void VertexFormat::Append(int stream, int offset, Renderer::VertexElement::Usage
     case Renderer::VertexElement::UIntType: typeSize = 4; break;
     case Renderer::VertexElement::FloatType: typeSize = 4; break;
     case Renderer::VertexElement::HalfType: typeSize = 2; break;
+    case Renderer::VertexElement::ShortType: typeSize = 2; break;
     default: assert(0); break;
     }
 }
@@ -58,6 +58,12 @@ public:
         GenericLitColorSkinning1,
         GenericLitColorSkinning4,
         GenericLitColorSkinning8,
+        CompactXyz,
+        CompactXyzSt,
+        CompactXyzStColor,
+        CompactXyzNormal,
+        CompactLit,
+        CompactLitColor,
         Occludee,
         MaxVertexFormats
     };
@@ -73,6 +79,9 @@ public:
     static void             Free();
     static void             CreateSkinningVertexFormats(int originalIndex, int skinning1Index, int skinning4Index, int skinning8Index);
 
+                            // Returns the compact vertex format corresponding to the generic vertex format
+    static int              ToCompactVertexFormat(int genericIndex);
+
     Array<Renderer::VertexElement> elements;
     Renderer::Handle        vertexFormatHandle;
 };
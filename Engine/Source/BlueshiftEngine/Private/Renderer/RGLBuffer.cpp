@@ -67,6 +67,7 @@ Renderer::Handle RendererGL::CreateBuffer(BufferType type, BufferUsage usage, in
     buffer->size        = size;
     buffer->pitch       = pitch;
     buffer->writeOffset = 0;
+    buffer->immutableStorage = false;
 
     gglGenBuffers(1, &buffer->object);
 
@@ -140,12 +141,28 @@ void *RendererGL::MapBufferRange(Handle bufferHandle, BufferLockMode lockMode, i
         access |= GL_MAP_WRITE_BIT;
 #ifdef GL_ARB_buffer_storage
         if (OpenGL::SupportsBufferStorage()) {
-            access |= (GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
-
-            gglBufferStorage(buffer->target, size, 0, access);
+            const GLbitfield storageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+            if (!buffer->immutableStorage) {
+                // Persistent mapping requires the immutable data store.
+                // Synchronization is up to the caller with fences, so the mapping is kept during the draws.
+                gglBufferStorage(buffer->target, buffer->size, nullptr, storageFlags);
+                buffer->immutableStorage = true;
+            }
+
+            void *ptr = gglMapBufferRange(buffer->target, offset, size, storageFlags);
+            assert(ptr);
+            return ptr;
         }
 #endif
         break;
+    case WriteOnlyOrphan:
+        access |= GL_MAP_WRITE_BIT;
+        if (!buffer->immutableStorage) {
+            // The driver allocates a new data store while the GPU keeps reading the old one
+            gglBufferData(buffer->target, buffer->size, nullptr, buffer->usage);
+        }
+        break;
     }
     
     void *ptr = nullptr;
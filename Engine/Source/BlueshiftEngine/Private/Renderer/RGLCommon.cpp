@@ -345,6 +345,10 @@ bool RendererGL::SupportsDebugLabel() const {
     return OpenGL::SupportsDebugLabel();
 }
 
+bool RendererGL::SupportsBufferStorage() const {
+    return OpenGL::SupportsBufferStorage();
+}
+
 void RendererGL::Clear(int clearBits, const Color4 &color, float depth, unsigned int stencil) {
 #if 1
     if (clearBits & ColorBit) {
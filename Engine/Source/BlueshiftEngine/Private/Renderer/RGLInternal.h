@@ -155,6 +155,7 @@ struct GLBuffer {
     int                 size;
     int                 pitch;
     int                 writeOffset;
+    bool                immutableStorage;
 };
 
 struct GLSync {
@@ -0,0 +1,1095 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Renderer/RendererGL.h"
+#include "Renderer/RendererNull.h"
+#include "Core/Heap.h"
+#include "Containers/HashMap.h"
+#include "SIMD/Simd.h"
+
+// RendererGL implementation for the WITH_NULL_RENDERER build.
+// This file replaces all the RGL*.cpp files, so nothing in here touches OpenGL.
+
+BE_NAMESPACE_BEGIN
+
+struct GLState {
+    int                 tmu;
+    Renderer::Handle    textureHandles[Renderer::MaxTMU];
+    Renderer::Handle    shaderHandle;
+    Renderer::Handle    bufferHandles[Renderer::MaxBufferTypes];
+    Renderer::Handle    vertexFormatHandle;
+    Renderer::Handle    renderTargetHandle;
+    Renderer::Handle    renderTargetHandleStack[16];
+    int                 renderTargetHandleStackDepth;
+    Renderer::Handle    stencilStateHandle;
+
+    unsigned int        renderState;
+    float               alphaRef;
+    int                 cull;
+    float               lineWidth;
+    Rect                viewportRect;
+    Rect                scissorRect;
+};
+
+struct GLContext {
+    Renderer::Handle    handle;
+    Renderer::WindowHandle windowHandle;
+    Renderer::DisplayContextFunc displayFunc;
+    void *              displayFuncDataPtr;
+    bool                onDemandDrawing;
+    int                 width;
+    int                 height;
+    GLState *           state;
+};
+
+struct GLStencilState {
+    int                 readMask;
+    int                 writeMask;
+};
+
+struct GLTexture {
+    int                 type;
+};
+
+struct GLBuffer {
+    int                 type;
+    int                 usage;
+    int                 size;
+    int                 pitch;
+    int                 writeOffset;
+    byte *              storage;        // CPU side storage to be mapped
+};
+
+struct GLSync {
+    int                 dummy;
+};
+
+struct GLShader {
+    char                name[64];
+    StrHashMap<int>     samplerUnits;
+    StrHashMap<int>     uniformLocations;
+};
+
+struct GLVertexFormat {
+    int                 numElements;
+};
+
+struct GLRenderTarget {
+    int                 type;
+    int                 flags;
+    int                 numColorTextures;
+    bool                sRGB;
+};
+
+struct GLQuery {
+    int                 dummy;
+};
+
+RendererGL              glr;
+
+static NullRendererStats nullStats;
+static int              nullContextWidth = 1280;
+static int              nullContextHeight = 720;
+
+void NullRenderer::SetContextSize(int width, int height) {
+    nullContextWidth = width;
+    nullContextHeight = height;
+}
+
+const NullRendererStats &NullRenderer::GetStats() {
+    return nullStats;
+}
+
+void NullRenderer::ResetStats() {
+    memset(&nullStats, 0, sizeof(nullStats));
+}
+
+template <typename T>
+static int AllocHandle(Array<T *> &list, T *object) {
+    int handle = list.FindNull();
+    if (handle == -1) {
+        handle = list.Append(object);
+    } else {
+        list[handle] = object;
+    }
+    return handle;
+}
+
+// Collects uniform declarations from the shader source like the GL driver does at link time.
+// Samplers get sequential texture units, other uniforms get sequential locations.
+static void ParseUniforms(const char *text, GLShader *shader) {
+    static const char *qualifiers[] = { "lowp", "mediump", "highp" };
+
+    for (const char *p = strstr(text, "uniform"); p; p = strstr(p, "uniform")) {
+        const bool wordStart = (p == text) || !(isalnum((unsigned char)p[-1]) || p[-1] == '_');
+        p += 7;
+        if (!wordStart || !isspace((unsigned char)*p)) {
+            continue;
+        }
+
+        char tokens[2][128];
+        int numTokens = 0;
+
+        while (numTokens < 2) {
+            while (isspace((unsigned char)*p)) {
+                p++;
+            }
+            int len = 0;
+            while ((isalnum((unsigned char)*p) || *p == '_') && len < COUNT_OF(tokens[0]) - 1) {
+                tokens[numTokens][len++] = *p++;
+            }
+            tokens[numTokens][len] = '\0';
+            if (!len) {
+                break;
+            }
+
+            bool isQualifier = false;
+            for (int i = 0; i < COUNT_OF(qualifiers); i++) {
+                if (!Str::Cmp(tokens[numTokens], qualifiers[i])) {
+                    isQualifier = true;
+                    break;
+                }
+            }
+            if (!isQualifier) {
+                numTokens++;
+            }
+        }
+
+        // Skip uniform blocks
+        if (numTokens < 2) {
+            continue;
+        }
+
+        if (!Str::Cmpn(tokens[0], "sampler", 7)) {
+            if (!shader->samplerUnits.Get(tokens[1])) {
+                shader->samplerUnits.Set(tokens[1], Min(shader->samplerUnits.Count(), (int)Renderer::MaxTMU - 1));
+            }
+        } else {
+            if (!shader->uniformLocations.Get(tokens[1])) {
+                shader->uniformLocations.Set(tokens[1], shader->uniformLocations.Count());
+            }
+        }
+    }
+}
+
+RendererGL::RendererGL() {
+    initialized = false;
+    currentContext = nullptr;
+    mainContext = nullptr;
+}
+
+void RendererGL::Init(const Settings *settings) {
+    BE_LOG(L"Initializing Null Renderer...\n");
+
+    InitHandles();
+
+    InitMainContext(settings);
+
+    currentContext = mainContext;
+
+    InitGL();
+
+    SetDefaultState();
+
+    NullRenderer::ResetStats();
+
+    initialized = true;
+}
+
+void RendererGL::Shutdown() {
+    BE_LOG(L"Shutting down Null Renderer...\n");
+
+    initialized = false;
+
+    FreeMainContext();
+
+    currentContext = nullptr;
+
+    FreeHandles();
+}
+
+void RendererGL::InitMainContext(const Settings *settings) {
+    mainContext = new GLContext;
+    memset(mainContext, 0, sizeof(*mainContext));
+    mainContext->state = new GLState;
+    mainContext->width = nullContextWidth;
+    mainContext->height = nullContextHeight;
+
+    colorBits = settings->colorBits;
+    depthBits = settings->depthBits;
+    stencilBits = settings->stencilBits;
+    multiSamples = settings->multiSamples;
+}
+
+void RendererGL::FreeMainContext() {
+    SAFE_DELETE(mainContext->state);
+    SAFE_DELETE(mainContext);
+}
+
+void RendererGL::InitHandles() {
+    contextList.SetGranularity(16);
+    contextList.Append(new GLContext());
+
+    stencilStateList.SetGranularity(32);
+    stencilStateList.Append(new GLStencilState());
+
+    bufferList.SetGranularity(1024);
+    bufferList.Append(new GLBuffer());
+
+    syncList.SetGranularity(8);
+    syncList.Append(new GLSync());
+
+    textureList.SetGranularity(1024);
+    textureList.Append(new GLTexture());
+
+    shaderList.SetGranularity(1024);
+    shaderList.Append(new GLShader());
+
+    vertexFormatList.SetGranularity(64);
+    vertexFormatList.Append(new GLVertexFormat());
+
+    renderTargetList.SetGranularity(64);
+    renderTargetList.Append(new GLRenderTarget());
+
+    queryList.SetGranularity(32);
+    queryList.Append(new GLQuery());
+}
+
+void RendererGL::FreeHandles() {
+    for (int i = 0; i < bufferList.Count(); i++) {
+        if (bufferList[i]) {
+            Mem_AlignedFree(bufferList[i]->storage);
+        }
+    }
+
+    contextList.DeleteContents(true);
+    stencilStateList.DeleteContents(true);
+    bufferList.DeleteContents(true);
+    syncList.DeleteContents(true);
+    textureList.DeleteContents(true);
+    shaderList.DeleteContents(true);
+    vertexFormatList.DeleteContents(true);
+    renderTargetList.DeleteContents(true);
+    queryList.DeleteContents(true);
+}
+
+void RendererGL::InitGL() {
+    vendorString = "Blueshift";
+    rendererString = "Null Renderer";
+    versionString = "3.3";
+    version = 3.3f;
+    extensionsString = "";
+    glslVersionString = "3.30";
+    glslVersion = 3.3f;
+
+    // Typical desktop GL 3.3 limits
+    memset(&hwLimit, 0, sizeof(hwLimit));
+    hwLimit.maxTextureSize = 16384;
+    hwLimit.max3dTextureSize = 2048;
+    hwLimit.maxCubeMapTextureSize = 16384;
+    hwLimit.maxRectangleTextureSize = 16384;
+    hwLimit.maxTextureBufferSize = 134217728;
+    hwLimit.maxTextureAnisotropy = 16;
+    hwLimit.maxTextureImageUnits = MaxTMU;
+    hwLimit.maxVertexAttribs = 16;
+    hwLimit.maxVertexUniformComponents = 4096;
+    hwLimit.maxVertexTextureImageUnits = MaxTMU;
+    hwLimit.maxFragmentUniformComponents = 4096;
+    hwLimit.maxFragmentInputComponents = 128;
+    hwLimit.maxGeometryTextureImageUnits = MaxTMU;
+    hwLimit.maxGeometryOutputVertices = 256;
+    hwLimit.maxRenderBufferSize = 16384;
+    hwLimit.maxColorAttachments = 8;
+    hwLimit.maxDrawBuffers = 8;
+}
+
+bool RendererGL::SupportsPolygonMode() const { return true; }
+bool RendererGL::SupportsPackedFloat() const { return true; }
+bool RendererGL::SupportsDepthBufferFloat() const { return true; }
+bool RendererGL::SupportsPixelBufferObject() const { return true; }
+bool RendererGL::SupportsTextureRectangle() const { return true; }
+bool RendererGL::SupportsTextureArray() const { return true; }
+bool RendererGL::SupportsTextureBufferObject() const { return true; }
+bool RendererGL::SupportsTextureCompressionS3TC() const { return false; }
+bool RendererGL::SupportsTextureCompressionLATC() const { return false; }
+bool RendererGL::SupportsTextureCompressionETC2() const { return false; }
+bool RendererGL::SupportsDebugLabel() const { return false; }
+bool RendererGL::SupportsBufferStorage() const { return false; }
+
+//-------------------------------------------------------------------------------------------------
+// Contexts
+//-------------------------------------------------------------------------------------------------
+
+Renderer::Handle RendererGL::CreateContext(WindowHandle windowHandle, bool useSharedContext) {
+    GLContext *ctx = new GLContext;
+    memset(ctx, 0, sizeof(*ctx));
+
+    int handle = AllocHandle(contextList, ctx);
+
+    ctx->handle = (Handle)handle;
+    ctx->windowHandle = windowHandle;
+    ctx->width = nullContextWidth;
+    ctx->height = nullContextHeight;
+
+    if (!useSharedContext) {
+        ctx->state = mainContext->state;
+    } else {
+        ctx->state = new GLState;
+        memset(ctx->state, 0, sizeof(*ctx->state));
+    }
+
+    return (Handle)handle;
+}
+
+void RendererGL::DestroyContext(Handle ctxHandle) {
+    GLContext *ctx = contextList[ctxHandle];
+
+    if (ctx->state != mainContext->state) {
+        delete ctx->state;
+    }
+
+    if (currentContext == ctx) {
+        currentContext = mainContext;
+    }
+
+    delete ctx;
+    contextList[ctxHandle] = nullptr;
+}
+
+void RendererGL::SetContext(Handle ctxHandle) {
+    currentContext = ctxHandle == NullContext ? mainContext : contextList[ctxHandle];
+}
+
+void RendererGL::ReleaseContext() {
+}
+
+void RendererGL::SetContextDisplayFunc(Handle ctxHandle, DisplayContextFunc displayFunc, void *dataPtr, bool onDemandDrawing) {
+    GLContext *ctx = ctxHandle == NullContext ? mainContext : contextList[ctxHandle];
+
+    ctx->displayFunc = displayFunc;
+    ctx->displayFuncDataPtr = dataPtr;
+    ctx->onDemandDrawing = onDemandDrawing;
+}
+
+void RendererGL::DisplayContext(Handle ctxHandle) {
+    GLContext *ctx = ctxHandle == NullContext ? mainContext : contextList[ctxHandle];
+
+    if (ctx->displayFunc) {
+        ctx->displayFunc(ctxHandle, ctx->displayFuncDataPtr);
+    }
+}
+
+Renderer::WindowHandle RendererGL::GetWindowHandleFromContext(Handle ctxHandle) {
+    const GLContext *ctx = ctxHandle == NullContext ? mainContext : contextList[ctxHandle];
+    return ctx->windowHandle;
+}
+
+void RendererGL::GetContextSize(Handle ctxHandle, int *windowWidth, int *windowHeight, int *backingWidth, int *backingHeight) {
+    const GLContext *ctx = ctxHandle == NullContext ? mainContext : contextList[ctxHandle];
+
+    if (windowWidth) *windowWidth = ctx->width;
+    if (windowHeight) *windowHeight = ctx->height;
+    if (backingWidth) *backingWidth = ctx->width;
+    if (backingHeight) *backingHeight = ctx->height;
+}
+
+bool RendererGL::IsFullscreen() const {
+    return false;
+}
+
+bool RendererGL::SetFullscreen(Handle windowHandle, int width, int height) {
+    return false;
+}
+
+void RendererGL::ResetFullscreen(Handle windowHandle) {
+}
+
+void RendererGL::GetGammaRamp(unsigned short ramp[768]) const {
+    for (int i = 0; i < 256; i++) {
+        ramp[i] = ramp[i + 256] = ramp[i + 512] = (unsigned short)(i * 257);
+    }
+}
+
+void RendererGL::SetGammaRamp(unsigned short ramp[768]) const {
+}
+
+void RendererGL::SwapBuffers() const {
+}
+
+void RendererGL::SwapInterval(int interval) const {
+}
+
+void RendererGL::Clear(int clearBits, const Color4 &color, float depth, unsigned int stencil) {
+    nullStats.clears++;
+}
+
+void RendererGL::ReadPixels(int x, int y, int width, int height, Image::Format imageFormat, byte *data) {
+    memset(data, 0, Image::MemRequired(width, height, 1, 1, imageFormat));
+}
+
+//-------------------------------------------------------------------------------------------------
+// States
+//-------------------------------------------------------------------------------------------------
+
+unsigned int RendererGL::GetStateBits() const {
+    return currentContext->state->renderState;
+}
+
+const Rect &RendererGL::GetViewport() const {
+    return currentContext->state->viewportRect;
+}
+
+int RendererGL::GetCullFace() const {
+    return currentContext->state->cull;
+}
+
+const Rect &RendererGL::GetScissor() const {
+    return currentContext->state->scissorRect;
+}
+
+void RendererGL::SetDefaultState() {
+    memset(currentContext->state, 0, sizeof(GLState));
+
+    SetStateBits(ColorWrite | AlphaWrite | DepthWrite | DF_LEqual);
+    SetCullFace(BackCull);
+    currentContext->state->lineWidth = 1.0f;
+    currentContext->state->viewportRect = Rect(0, 0, currentContext->width, currentContext->height);
+}
+
+void RendererGL::SetStateBits(unsigned int state) {
+    if (currentContext->state->renderState != state) {
+        currentContext->state->renderState = state;
+        nullStats.stateChanges++;
+    }
+}
+
+void RendererGL::SetAlphaRef(float alphaRef) {
+    currentContext->state->alphaRef = alphaRef;
+}
+
+void RendererGL::SetCullFace(int cull) {
+    if (currentContext->state->cull != cull) {
+        currentContext->state->cull = cull;
+        nullStats.stateChanges++;
+    }
+}
+
+void RendererGL::SetDepthBias(float slopeScaleBias, float constantBias) {
+}
+
+void RendererGL::SetDepthRange(float znear, float zfar) {
+}
+
+void RendererGL::SetDepthClamp(bool enable) {
+}
+
+void RendererGL::SetDepthBounds(float zmin, float zmax) {
+}
+
+void RendererGL::SetViewport(const Rect &viewportRect) {
+    currentContext->state->viewportRect = viewportRect;
+}
+
+void RendererGL::SetScissor(const Rect &scissorRect) {
+    currentContext->state->scissorRect = scissorRect;
+}
+
+void RendererGL::SetSRGBWrite(bool enable) {
+}
+
+void RendererGL::EnableLineSmooth(bool enable) {
+}
+
+float RendererGL::GetLineWidth() const {
+    return currentContext->state->lineWidth;
+}
+
+void RendererGL::SetLineWidth(float width) {
+    currentContext->state->lineWidth = width;
+}
+
+Renderer::Handle RendererGL::CreateStencilState(int readMask, int writeMask, StencilFunc funcBack, int failBack, int zfailBack, int zpassBack, StencilFunc funcFront, int failFront, int zfailFront, int zpassFront) {
+    GLStencilState *stencilState = new GLStencilState;
+    stencilState->readMask = readMask;
+    stencilState->writeMask = writeMask;
+
+    return (Handle)AllocHandle(stencilStateList, stencilState);
+}
+
+void RendererGL::DeleteStencilState(Handle stencilStateHandle) {
+    delete stencilStateList[stencilStateHandle];
+    stencilStateList[stencilStateHandle] = nullptr;
+}
+
+void RendererGL::SetStencilState(Handle stencilStateHandle, int ref) {
+    if (currentContext->state->stencilStateHandle != stencilStateHandle) {
+        currentContext->state->stencilStateHandle = stencilStateHandle;
+        nullStats.stateChanges++;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Textures
+//-------------------------------------------------------------------------------------------------
+
+Renderer::Handle RendererGL::CreateTexture(TextureType type) {
+    GLTexture *texture = new GLTexture;
+    texture->type = type;
+
+    int handle = AllocHandle(textureList, texture);
+
+    BindTexture((Handle)handle);
+
+    return (Handle)handle;
+}
+
+void RendererGL::DeleteTexture(Handle textureHandle) {
+    for (int i = 0; i < MaxTMU; i++) {
+        if (currentContext->state->textureHandles[i] == textureHandle) {
+            currentContext->state->textureHandles[i] = NullTexture;
+        }
+    }
+
+    delete textureList[textureHandle];
+    textureList[textureHandle] = nullptr;
+}
+
+void RendererGL::SelectTextureUnit(unsigned int unit) {
+    currentContext->state->tmu = unit;
+}
+
+void RendererGL::BindTexture(Handle textureHandle) {
+    Handle *textureHandlePtr = &currentContext->state->textureHandles[currentContext->state->tmu];
+    if (*textureHandlePtr != textureHandle) {
+        *textureHandlePtr = textureHandle;
+        nullStats.textureBinds++;
+    }
+}
+
+void RendererGL::AdjustTextureSize(TextureType type, bool useNPOT, int inWidth, int inHeight, int inDepth, int *outWidth, int *outHeight, int *outDepth) {
+    int w = useNPOT || type == TextureRectangle ? inWidth : Math::CeilPowerOfTwo(inWidth);
+    int h = useNPOT || type == TextureRectangle ? inHeight : Math::CeilPowerOfTwo(inHeight);
+    int d = useNPOT || type == TextureRectangle ? inDepth : Math::CeilPowerOfTwo(inDepth);
+
+    if (type == TextureCubeMap) {
+        w = h = Min(w, h);
+    }
+
+    if (outWidth) *outWidth = w;
+    if (outHeight) *outHeight = h;
+    if (outDepth) *outDepth = d;
+}
+
+void RendererGL::AdjustTextureFormat(TextureType type, bool useCompression, bool useNormalMap, Image::Format inFormat, Image::Format *outFormat) {
+    // Never converts format to skip the image compression cost
+    *outFormat = inFormat;
+}
+
+void RendererGL::SetTextureFilter(TextureFilter filter) {
+}
+
+void RendererGL::SetTextureAddressMode(AddressMode addressMode) {
+}
+
+void RendererGL::SetTextureAnisotropy(int aniso) {
+}
+
+void RendererGL::SetTextureBorderColor(const Color4 &rgba) {
+}
+
+void RendererGL::SetTextureShadowFunc(bool set) {
+}
+
+void RendererGL::SetTextureLODBias(float bias) {
+}
+
+void RendererGL::SetTextureLevel(int baseLevel, int maxLevel) {
+}
+
+void RendererGL::GenerateMipmap() {
+}
+
+void RendererGL::SetTextureImage(TextureType textureType, const Image *srcImage, Image::Format dstFormat, bool useMipmaps, bool useSRGB) {
+    if (srcImage->GetPixels()) {
+        nullStats.textureUploadBytes += srcImage->GetSize(0, srcImage->NumMipmaps());
+    }
+}
+
+void RendererGL::SetTextureImageBuffer(Image::Format dstFormat, bool sRGB, int bufferHandle) {
+}
+
+void RendererGL::SetTextureSubImage2D(int level, int xoffset, int yoffset, int width, int height, Image::Format srcFormat, const void *pixels) {
+    nullStats.textureUploadBytes += Image::MemRequired(width, height, 1, 1, srcFormat);
+}
+
+void RendererGL::SetTextureSubImage3D(int level, int xoffset, int yoffset, int zoffset, int width, int height, int depth, Image::Format srcFormat, const void *pixels) {
+    nullStats.textureUploadBytes += Image::MemRequired(width, height, depth, 1, srcFormat);
+}
+
+void RendererGL::SetTextureSubImage2DArray(int level, int xoffset, int yoffset, int zoffset, int width, int height, int arrays, Image::Format srcFormat, const void *pixels) {
+    nullStats.textureUploadBytes += Image::MemRequired(width, height, 1, 1, srcFormat) * arrays;
+}
+
+void RendererGL::SetTextureSubImageCube(CubeMapFace face, int level, int xoffset, int yoffset, int width, int height, Image::Format srcFormat, const void *pixels) {
+    nullStats.textureUploadBytes += Image::MemRequired(width, height, 1, 1, srcFormat);
+}
+
+void RendererGL::SetTextureSubImageRect(int xoffset, int yoffset, int width, int height, Image::Format srcFormat, const void *pixels) {
+    nullStats.textureUploadBytes += Image::MemRequired(width, height, 1, 1, srcFormat);
+}
+
+void RendererGL::CopyTextureSubImage2D(int xoffset, int yoffset, int x, int y, int width, int height) {
+}
+
+void RendererGL::GetTextureImage2D(int level, Image::Format format, void *pixels) {
+}
+
+void RendererGL::GetTextureImage3D(int level, Image::Format format, void *pixels) {
+}
+
+void RendererGL::GetTextureImageCube(CubeMapFace face, int level, Image::Format format, void *pixels) {
+}
+
+void RendererGL::GetTextureImageRect(Image::Format format, void *pixels) {
+}
+
+//-------------------------------------------------------------------------------------------------
+// Render targets
+//-------------------------------------------------------------------------------------------------
+
+Renderer::Handle RendererGL::CreateRenderTarget(RenderTargetType type, int width, int height, int numColorTextures, Handle *colorTextureHandles, Handle depthTextureHandle, bool sRGB, int flags) {
+    GLRenderTarget *renderTarget = new GLRenderTarget;
+    renderTarget->type = type;
+    renderTarget->flags = flags;
+    renderTarget->numColorTextures = numColorTextures;
+    renderTarget->sRGB = sRGB;
+
+    return (Handle)AllocHandle(renderTargetList, renderTarget);
+}
+
+void RendererGL::DeleteRenderTarget(Handle renderTargetHandle) {
+    delete renderTargetList[renderTargetHandle];
+    renderTargetList[renderTargetHandle] = nullptr;
+}
+
+void RendererGL::BeginRenderTarget(Handle renderTargetHandle, int level, int sliceIndex, unsigned int mrtBitMask) {
+    GLState *state = currentContext->state;
+
+    if (state->renderTargetHandleStackDepth >= COUNT_OF(state->renderTargetHandleStack)) {
+        BE_WARNLOG(L"RendererGL::BeginRenderTarget: render target stack overflow\n");
+        return;
+    }
+
+    state->renderTargetHandleStack[state->renderTargetHandleStackDepth++] = state->renderTargetHandle;
+    state->renderTargetHandle = renderTargetHandle;
+
+    nullStats.renderTargetBinds++;
+}
+
+void RendererGL::EndRenderTarget() {
+    GLState *state = currentContext->state;
+
+    if (state->renderTargetHandleStackDepth == 0) {
+        BE_WARNLOG(L"unmatched BeginRenderTarget() / EndRenderTarget()\n");
+        return;
+    }
+
+    state->renderTargetHandle = state->renderTargetHandleStack[--state->renderTargetHandleStackDepth];
+
+    nullStats.renderTargetBinds++;
+}
+
+void RendererGL::BlitRenderTarget(Handle srcRenderTargetHandle, const Rect &srcRect, Handle dstRenderTargetHandle, const Rect &dstRect, int mask, int filter) const {
+}
+
+//-------------------------------------------------------------------------------------------------
+// Shaders
+//-------------------------------------------------------------------------------------------------
+
+Renderer::Handle RendererGL::CreateShader(const char *name, const char *vsText, const char *fsText) {
+    GLShader *shader = new GLShader;
+    Str::Copynz(shader->name, name, COUNT_OF(shader->name));
+
+    if (vsText) {
+        ParseUniforms(vsText, shader);
+    }
+    if (fsText) {
+        ParseUniforms(fsText, shader);
+    }
+
+    return (Handle)AllocHandle(shaderList, shader);
+}
+
+void RendererGL::DeleteShader(Handle shaderHandle) {
+    if (currentContext->state->shaderHandle == shaderHandle) {
+        currentContext->state->shaderHandle = NullShader;
+    }
+
+    delete shaderList[shaderHandle];
+    shaderList[shaderHandle] = nullptr;
+}
+
+void RendererGL::BindShader(Handle shaderHandle) {
+    if (currentContext->state->shaderHandle != shaderHandle) {
+        currentContext->state->shaderHandle = shaderHandle;
+        nullStats.shaderBinds++;
+    }
+}
+
+int RendererGL::GetSamplerUnit(Handle shaderHandle, const char *name) const {
+    const auto *entry = shaderList[shaderHandle]->samplerUnits.Get(name);
+    return entry ? entry->second : -1;
+}
+
+void RendererGL::SetTexture(int unit, Handle textureHandle) {
+    if (unit < 0) {
+        return;
+    }
+
+    SelectTextureUnit(unit);
+    BindTexture(textureHandle);
+}
+
+int RendererGL::GetShaderConstantLocation(int shaderHandle, const char *name) const {
+    const auto *entry = shaderList[shaderHandle]->uniformLocations.Get(name);
+    return entry ? entry->second : -1;
+}
+
+void RendererGL::SetShaderConstantGeneric(int index, bool rowmajor, int count, const void *data) const {
+    if (index < 0) {
+        return;
+    }
+
+    nullStats.constantUpdates++;
+}
+
+void RendererGL::SetShaderConstant1i(int index, const int constant) const { SetShaderConstantGeneric(index, false, 1, &constant); }
+void RendererGL::SetShaderConstant2i(int index, const int *constant) const { SetShaderConstantGeneric(index, false, 1, constant); }
+void RendererGL::SetShaderConstant3i(int index, const int *constant) const { SetShaderConstantGeneric(index, false, 1, constant); }
+void RendererGL::SetShaderConstant4i(int index, const int *constant) const { SetShaderConstantGeneric(index, false, 1, constant); }
+void RendererGL::SetShaderConstant1f(int index, const float constant) const { SetShaderConstantGeneric(index, false, 1, &constant); }
+void RendererGL::SetShaderConstant2f(int index, const float *constant) const { SetShaderConstantGeneric(index, false, 1, constant); }
+void RendererGL::SetShaderConstant3f(int index, const float *constant) const { SetShaderConstantGeneric(index, false, 1, constant); }
+void RendererGL::SetShaderConstant4f(int index, const float *constant) const { SetShaderConstantGeneric(index, false, 1, constant); }
+void RendererGL::SetShaderConstant2f(int index, const Vec2 &constant) const { SetShaderConstantGeneric(index, false, 1, &constant); }
+void RendererGL::SetShaderConstant3f(int index, const Vec3 &constant) const { SetShaderConstantGeneric(index, false, 1, &constant); }
+void RendererGL::SetShaderConstant4f(int index, const Vec4 &constant) const { SetShaderConstantGeneric(index, false, 1, &constant); }
+void RendererGL::SetShaderConstant2x2f(int index, bool rowmajor, const Mat2 &constant) const { SetShaderConstantGeneric(index, rowmajor, 1, &constant); }
+void RendererGL::SetShaderConstant3x3f(int index, bool rowmajor, const Mat3 &constant) const { SetShaderConstantGeneric(index, rowmajor, 1, &constant); }
+void RendererGL::SetShaderConstant4x4f(int index, bool rowmajor, const Mat4 &constant) const { SetShaderConstantGeneric(index, rowmajor, 1, &constant); }
+void RendererGL::SetShaderConstantArray1i(int index, int count, const int *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray2i(int index, int count, const int *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray3i(int index, int count, const int *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray4i(int index, int count, const int *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray1f(int index, int count, const float *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray2f(int index, int count, const float *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray3f(int index, int count, const float *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray4f(int index, int count, const float *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray2f(int index, int count, const Vec2 *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray3f(int index, int count, const Vec3 *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray4f(int index, int count, const Vec4 *constant) const { SetShaderConstantGeneric(index, false, count, constant); }
+void RendererGL::SetShaderConstantArray2x2f(int index, bool rowmajor, int count, const Mat2 *constant) const { SetShaderConstantGeneric(index, rowmajor, count, constant); }
+void RendererGL::SetShaderConstantArray3x3f(int index, bool rowmajor, int count, const Mat3 *constant) const { SetShaderConstantGeneric(index, rowmajor, count, constant); }
+void RendererGL::SetShaderConstantArray4x4f(int index, bool rowmajor, int count, const Mat4 *constant) const { SetShaderConstantGeneric(index, rowmajor, count, constant); }
+
+//-------------------------------------------------------------------------------------------------
+// Buffers
+//-------------------------------------------------------------------------------------------------
+
+Renderer::Handle RendererGL::CreateBuffer(BufferType type, BufferUsage usage, int size, int pitch, const void *data) {
+    GLBuffer *buffer    = new GLBuffer;
+    buffer->type        = type;
+    buffer->usage       = usage;
+    buffer->size        = size;
+    buffer->pitch       = pitch;
+    buffer->writeOffset = 0;
+    buffer->storage     = nullptr;
+
+    if (size > 0) {
+        buffer->storage = (byte *)Mem_Alloc16(size);
+        if (data) {
+            simdProcessor->Memcpy(buffer->storage, data, size);
+            nullStats.bufferUploadBytes += size;
+        }
+    }
+
+    return (Handle)AllocHandle(bufferList, buffer);
+}
+
+void RendererGL::DeleteBuffer(Handle bufferHandle) {
+    GLBuffer *buffer = bufferList[bufferHandle];
+
+    for (int i = 0; i < COUNT_OF(currentContext->state->bufferHandles); i++) {
+        if (bufferHandle == currentContext->state->bufferHandles[i]) {
+            currentContext->state->bufferHandles[i] = NullBuffer;
+            break;
+        }
+    }
+
+    Mem_AlignedFree(buffer->storage);
+
+    delete bufferList[bufferHandle];
+    bufferList[bufferHandle] = nullptr;
+}
+
+void RendererGL::BindBuffer(BufferType type, Handle bufferHandle) {
+    Handle *bufferHandlePtr = &currentContext->state->bufferHandles[type];
+    if (*bufferHandlePtr != bufferHandle) {
+        *bufferHandlePtr = bufferHandle;
+        nullStats.bufferBinds++;
+    }
+}
+
+void *RendererGL::MapBufferRange(Handle bufferHandle, BufferLockMode lockMode, int offset, int size) {
+    GLBuffer *buffer = bufferList[bufferHandle];
+
+    if (size < 0) {
+        size = buffer->size;
+    }
+
+    assert(offset + size <= buffer->size);
+
+    return buffer->storage + offset;
+}
+
+bool RendererGL::UnmapBuffer(Handle bufferHandle) {
+    return true;
+}
+
+void RendererGL::FlushMappedBufferRange(Handle bufferHandle, int offset, int size) {
+    GLBuffer *buffer = bufferList[bufferHandle];
+
+    if (size < 0) {
+        size = buffer->size;
+    }
+
+    assert(offset + size <= buffer->size);
+
+    nullStats.bufferUploadBytes += size;
+}
+
+int RendererGL::BufferDiscardWrite(Handle bufferHandle, int size, const void *data) {
+    GLBuffer *buffer = bufferList[bufferHandle];
+
+    if (size > buffer->size) {
+        Mem_AlignedFree(buffer->storage);
+        buffer->storage = (byte *)Mem_Alloc16(size);
+    }
+
+    simdProcessor->Memcpy(buffer->storage, data, size);
+    nullStats.bufferUploadBytes += size;
+
+    buffer->size = size;
+    buffer->writeOffset = 0;
+
+    return 0;
+}
+
+// Returns aligned write offset which doesn't cross the pitch boundary, or -1 if it overflows
+static int AllocBufferRange(GLBuffer *writeBuffer, int alignSize, int size) {
+    if (writeBuffer->pitch > 0 && size > writeBuffer->pitch) {
+        return -1;
+    }
+
+    int base = writeBuffer->writeOffset + alignSize - 1;
+    base -= base % alignSize;
+
+    if (writeBuffer->pitch > 0) {
+        int startRow = base / writeBuffer->pitch;
+        int endRow = (base + size) / writeBuffer->pitch;
+
+        if (endRow > startRow) {
+            base -= base % writeBuffer->pitch;
+            base += writeBuffer->pitch;
+        }
+    }
+
+    int endPos = base + size;
+
+    if (endPos > writeBuffer->size) {
+        return -1;
+    }
+
+    writeBuffer->writeOffset = endPos;
+
+    return base;
+}
+
+int RendererGL::BufferWrite(Handle bufferHandle, int alignSize, int size, const void *data) {
+    GLBuffer *writeBuffer = bufferList[bufferHandle];
+
+    int base = AllocBufferRange(writeBuffer, alignSize, size);
+    if (base < 0) {
+        return -1;
+    }
+
+    // If date == nullptr, buffer memory is reserved
+    if (data) {
+        simdProcessor->Memcpy(writeBuffer->storage + base, data, size);
+        nullStats.bufferUploadBytes += size;
+    }
+
+    return base;
+}
+
+int RendererGL::BufferCopy(Handle readBufferHandle, Handle writeBufferHandle, int alignSize, int size) {
+    GLBuffer *writeBuffer = bufferList[writeBufferHandle];
+    const GLBuffer *readBuffer = bufferList[readBufferHandle];
+
+    int base = AllocBufferRange(writeBuffer, alignSize, size);
+    if (base < 0) {
+        return -1;
+    }
+
+    simdProcessor->Memcpy(writeBuffer->storage + base, readBuffer->storage, Min(size, readBuffer->size));
+
+    return base;
+}
+
+void RendererGL::BufferRewind(Handle bufferHandle) {
+    GLBuffer *buffer = bufferList[bufferHandle];
+
+    buffer->writeOffset = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Sync
+//-------------------------------------------------------------------------------------------------
+
+Renderer::Handle RendererGL::FenceSync() {
+    return (Handle)AllocHandle(syncList, new GLSync());
+}
+
+void RendererGL::DeleteSync(Handle syncHandle) {
+    delete syncList[syncHandle];
+    syncList[syncHandle] = nullptr;
+}
+
+void RendererGL::WaitSync(Handle syncHandle) {
+}
+
+//-------------------------------------------------------------------------------------------------
+// Vertex formats
+//-------------------------------------------------------------------------------------------------
+
+Renderer::Handle RendererGL::CreateVertexFormat(int numElements, const VertexElement *elements) {
+    GLVertexFormat *vertexFormat = new GLVertexFormat;
+    vertexFormat->numElements = numElements;
+
+    return (Handle)AllocHandle(vertexFormatList, vertexFormat);
+}
+
+void RendererGL::DeleteVertexFormat(Handle vertexFormatHandle) {
+    if (currentContext->state->vertexFormatHandle == vertexFormatHandle) {
+        currentContext->state->vertexFormatHandle = NullVertexFormat;
+    }
+
+    delete vertexFormatList[vertexFormatHandle];
+    vertexFormatList[vertexFormatHandle] = nullptr;
+}
+
+void RendererGL::SetVertexFormat(Handle vertexFormatHandle) {
+    if (currentContext->state->vertexFormatHandle != vertexFormatHandle) {
+        currentContext->state->vertexFormatHandle = vertexFormatHandle;
+        nullStats.vertexFormatBinds++;
+    }
+}
+
+void RendererGL::SetStreamSource(int stream, Handle vertexBufferHandle, int base, int stride) {
+    BindBuffer(VertexBuffer, vertexBufferHandle);
+}
+
+int RendererGL::GetTypeSize(const VertexElement::Type type) const {
+    switch (type) {
+    case VertexElement::UByteType:
+        return sizeof(byte);
+    case VertexElement::UIntType:
+        return sizeof(uint32_t);
+    case VertexElement::FloatType:
+        return sizeof(float);
+    case VertexElement::HalfType:
+        return sizeof(uint16_t);
+    case VertexElement::ShortType:
+        return sizeof(int16_t);
+    default:
+        assert(0);
+        return 0;
+    }
+}
+
+void RendererGL::BeginUnpackAlignment(int pitch) {
+}
+
+void RendererGL::EndUnpackAlignment() {
+}
+
+//-------------------------------------------------------------------------------------------------
+// Draw calls
+//-------------------------------------------------------------------------------------------------
+
+void RendererGL::DrawArrays(Primitive primitives, const int startVertex, const int numVerts) const {
+    nullStats.drawCalls++;
+    nullStats.drawVerts += numVerts;
+}
+
+void RendererGL::DrawArraysInstanced(Primitive primitives, const int startVertex, const int numVerts, const int primCount) const {
+    nullStats.drawCalls++;
+    nullStats.instancedDrawCalls++;
+    nullStats.drawVerts += numVerts * primCount;
+}
+
+void RendererGL::DrawElements(Primitive primitives, const int startIndex, const int numIndices, int indexSize, const void *ptr) const {
+    nullStats.drawCalls++;
+    nullStats.drawIndexes += numIndices;
+}
+
+void RendererGL::DrawElementsInstanced(Primitive primitives, const int startIndex, const int numIndices, const int indexSize, const void *ptr, const int primCount) const {
+    nullStats.drawCalls++;
+    nullStats.instancedDrawCalls++;
+    nullStats.drawIndexes += numIndices * primCount;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Queries
+//-------------------------------------------------------------------------------------------------
+
+Renderer::Handle RendererGL::CreateQuery() {
+    return (Handle)AllocHandle(queryList, new GLQuery());
+}
+
+void RendererGL::DeleteQuery(Handle queryHandle) {
+    delete queryList[queryHandle];
+    queryList[queryHandle] = nullptr;
+}
+
+void RendererGL::BeginQuery(Handle queryHandle) {
+}
+
+void RendererGL::EndQuery() {
+}
+
+bool RendererGL::QueryResultAvailable(Handle queryHandle) const {
+    return true;
+}
+
+unsigned int RendererGL::QueryResult(Handle queryHandle) const {
+    // Every query passes so nothing gets culled by occlusion queries
+    return 1;
+}
+
+void RendererGL::CheckError(const char *fmt, ...) const {
+}
+
+BE_NAMESPACE_END
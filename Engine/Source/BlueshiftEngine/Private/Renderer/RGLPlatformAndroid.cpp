@@ -366,6 +366,10 @@ void RendererGL::SetContext(Handle ctxHandle) {
 	this->currentContext = ctx;
 }
 
+void RendererGL::ReleaseContext() {
+	glFlush();
+}
+
 
 
 
@@ -357,6 +357,14 @@ void RendererGL::SetContext(Handle ctxHandle) {
 	this->currentContext = ctx;
 }
 
+void RendererGL::ReleaseContext() {
+    if ([EAGLContext currentContext]) {
+        // Commands issued in this thread should be delivered before the other thread continues
+        glFlush();
+        [EAGLContext setCurrentContext:nil];
+    }
+}
+
 void RendererGL::SetContextDisplayFunc(Handle ctxHandle, DisplayContextFunc displayFunc, void *dataPtr, bool onDemandDrawing) {
     GLContext *ctx = ctxHandle == NullContext ? mainContext : contextList[ctxHandle];
     
@@ -723,6 +723,14 @@ void RendererGL::SetContext(Handle ctxHandle) {
 	this->currentContext = ctx;
 }
 
+void RendererGL::ReleaseContext() {
+    if ([NSOpenGLContext currentContext]) {
+        // Commands issued in this thread should be delivered before the other thread continues
+        glFlush();
+        [NSOpenGLContext clearCurrentContext];
+    }
+}
+
 void RendererGL::SetContextDisplayFunc(Handle ctxHandle, DisplayContextFunc displayFunc, void *dataPtr, bool onDemandDrawing) {
     GLContext *ctx = ctxHandle == NullContext ? mainContext : contextList[ctxHandle];
     
@@ -633,6 +633,14 @@ void RendererGL::SetContext(Handle ctxHandle) {
     this->currentContext = ctx;
 }
 
+void RendererGL::ReleaseContext() {
+    if (wglGetCurrentContext()) {
+        // Commands issued in this thread should be delivered before the other thread continues
+        gglFlush();
+        wglMakeCurrent(nullptr, nullptr);
+    }
+}
+
 void RendererGL::SetContextDisplayFunc(Handle ctxHandle, DisplayContextFunc displayFunc, void *displayFuncDataPtr, bool onDemandDrawing) {
     GLContext *ctx = ctxHandle == NullContext ? mainContext : contextList[ctxHandle];
     
@@ -23,6 +23,7 @@ const GLenum toGLType[] = {
     GL_UNSIGNED_INT,
     GL_FLOAT,
     GL_HALF_FLOAT,
+    GL_SHORT,
 };
 
 Renderer::Handle RendererGL::CreateVertexFormat(int numElements, const VertexElement *elements) {
@@ -66,7 +67,7 @@ void RendererGL::DeleteVertexFormat(Handle vertexFormatHandle) {
 }
 
 int RendererGL::GetTypeSize(const VertexElement::Type type) const {
-    static int typeSize[] = { sizeof(byte), sizeof(float), sizeof(float16_t) };
+    static int typeSize[] = { sizeof(byte), sizeof(uint32_t), sizeof(float), sizeof(float16_t), sizeof(int16_t) };
     return typeSize[type];
 }
 
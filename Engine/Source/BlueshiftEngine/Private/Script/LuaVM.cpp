@@ -18,16 +18,49 @@
 #include "File/FileSystem.h"
 #include "File/File.h"
 #include "Core/CVars.h"
+#include "Core/Heap.h"
 
 extern int luaopen_file(lua_State *L);
 
 BE_NAMESPACE_BEGIN
 
 LuaCpp::State *     LuaVM::state = nullptr;
+lua_State *         LuaVM::luaState = nullptr;
 const GameWorld *   LuaVM::gameWorld = nullptr;
 
+// Lua allocator which accounts the memory of the Lua VM to MemTag::Script.
+static void *LuaVM_Alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
+    // When ptr is nullptr, osize is the type of the object being allocated, not a size
+    if (nsize == 0) {
+        if (ptr) {
+            Mem_TrackFree(MemTag::Script, osize);
+            free(ptr);
+        }
+        return nullptr;
+    }
+
+    void *newPtr = realloc(ptr, nsize);
+    if (newPtr) {
+        if (ptr) {
+            Mem_TrackFree(MemTag::Script, osize);
+        }
+        Mem_TrackAlloc(MemTag::Script, nsize);
+    }
+    return newPtr;
+}
+
+static int LuaVM_Panic(lua_State *L) {
+    BE_ERRLOG(L"PANIC: unprotected error in call to Lua API (%hs)\n", lua_tostring(L, -1));
+    return 0;
+}
+
 void LuaVM::Init() {
-    state = new LuaCpp::State(true);
+    luaState = lua_newstate(LuaVM_Alloc, nullptr);
+    lua_atpanic(luaState, LuaVM_Panic);
+    luaL_openlibs(luaState);
+
+    // Non-owning state, luaState is closed in Shutdown()
+    state = new LuaCpp::State(luaState);
 
     BE_LOG(L"Lua version %.1f\n", state->Version());
 
@@ -190,6 +223,11 @@ void LuaVM::InitEngineModule(const GameWorld *gameWorld) {
 
 void LuaVM::Shutdown() {
     SAFE_DELETE(state);
+
+    if (luaState) {
+        lua_close(luaState);
+        luaState = nullptr;
+    }
 }
 
 BE_NAMESPACE_END
@@ -28,36 +28,62 @@ BE_NAMESPACE_BEGIN
 SIMDProcessor *     simdGeneric = nullptr;     // pointer to generic SIMD implementation
 SIMDProcessor *     simdProcessor = nullptr;
 
+static bool HasSSE4(int cpuid) {
+    return (cpuid & CPUID_MMX) && 
+        (cpuid & CPUID_SSE) && 
+        (cpuid & CPUID_SSE2) && 
+        (cpuid & CPUID_SSE3) && 
+        (cpuid & CPUID_SSE4);
+}
+
+static bool HasAVX2(int cpuid) {
+    return HasSSE4(cpuid) && 
+        (cpuid & CPUID_AVX) && 
+        (cpuid & CPUID_AVX2) && 
+        (cpuid & CPUID_FMA);
+}
+
+SIMDProcessor *SIMD::CreateProcessor(CpuId instructionSet) {
+    int cpuid = GetCpuInfo()->cpuid;
+
+    switch (instructionSet) {
+    case CPUID_GENERIC:
+        return new SIMD_Generic;
+#if defined(__X86__)
+    case CPUID_SSE4:
+        if (HasSSE4(cpuid)) {
+            return new SIMD_SSE4;
+        }
+        break;
+    case CPUID_AVX2:
+        if (HasAVX2(cpuid)) {
+            return new SIMD_AVX;
+        }
+        break;
+#endif
+    default:
+        break;
+    }
+    return nullptr;
+}
+
 void SIMD::Init(bool forceGeneric) {
     simdGeneric = new SIMD_Generic;
         
     int cpuid = GetCpuInfo()->cpuid;
 
-    if (forceGeneric) {
-        simdProcessor = simdGeneric;
-    } else {
-#if defined(__X86__)
-        if ((cpuid & CPUID_MMX) && 
-            (cpuid & CPUID_SSE) && 
-            (cpuid & CPUID_SSE2) && 
-            (cpuid & CPUID_SSE3) && 
-            (cpuid & CPUID_SSE4) && 
-            (cpuid & CPUID_AVX)) {
-            simdProcessor = new SIMD_AVX;
-        } else if ((cpuid & CPUID_MMX) && 
-            (cpuid & CPUID_SSE) && 
-            (cpuid & CPUID_SSE2) && 
-            (cpuid & CPUID_SSE3) && 
-            (cpuid & CPUID_SSE4)) {
-            simdProcessor = new SIMD_SSE4;
-        } else {
-            simdProcessor = simdGeneric;
+    simdProcessor = nullptr;
+
+    if (!forceGeneric) {
+        // Try the best instruction set first
+        simdProcessor = CreateProcessor(CPUID_AVX2);
+        if (!simdProcessor) {
+            simdProcessor = CreateProcessor(CPUID_SSE4);
         }
-#elif defined(__ARM__)
-        simdProcessor = simdGeneric;
-#else
+    }
+
+    if (!simdProcessor) {
         simdProcessor = simdGeneric;
-#endif
     }
 
     BE_LOG(L"using %hs for SIMD processing\n", simdProcessor->GetName());
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/Vertex.h"
+#include "Core/JointPose.h"
 #include "SIMD/Simd.h"
 #include "SIMD/Simd_generic.h"
 
@@ -20,9 +22,585 @@
 
 #include "SIMD/Simd_SSE4.h"
 #include "SIMD/Simd_AVX.h"
+#include <immintrin.h>
+
+// This file is compiled with AVX2 and FMA code generation enabled.
+// Do not call any inline function of the math classes here (Vec3, Quat, Mat3x4, ...).
+// The compiler may emit an out-of-line copy of them with AVX instructions, 
+// and the linker is free to pick that copy for the other translation units 
+// that run on CPUs without AVX. Only intrinsics and raw float pointers are used.
 
 BE_NAMESPACE_BEGIN
 
+static BE_FORCE_INLINE __m256 Load2x4(const float *lo, const float *hi) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+}
+
+static BE_FORCE_INLINE void Store2x4(float *lo, float *hi, const __m256 &v) {
+    _mm_storeu_ps(lo, _mm256_castps256_ps128(v));
+    _mm_storeu_ps(hi, _mm256_extractf128_ps(v, 1));
+}
+
+// Transposes 4x4 matrix in each 128 bits lane.
+// Rows (r[k] of lane 0, r[k] of lane 1) become columns, so 4 component vectors of 8 elements 
+// can be converted from/to AoS layout with Load2x4/Store2x4.
+static BE_FORCE_INLINE void Transpose4x4x2(__m256 &r0, __m256 &r1, __m256 &r2, __m256 &r3) {
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+// Loads 4 floats at the offset of 8 structures and returns them as 4 component vectors.
+static BE_FORCE_INLINE void Gather4x8(const float *const ptrs[8], int offset, __m256 &c0, __m256 &c1, __m256 &c2, __m256 &c3) {
+    c0 = Load2x4(ptrs[0] + offset, ptrs[4] + offset);
+    c1 = Load2x4(ptrs[1] + offset, ptrs[5] + offset);
+    c2 = Load2x4(ptrs[2] + offset, ptrs[6] + offset);
+    c3 = Load2x4(ptrs[3] + offset, ptrs[7] + offset);
+    Transpose4x4x2(c0, c1, c2, c3);
+}
+
+// Inverse of Gather4x8. Destroys the input vectors.
+static BE_FORCE_INLINE void Scatter4x8(float *const ptrs[8], int offset, __m256 &c0, __m256 &c1, __m256 &c2, __m256 &c3) {
+    Transpose4x4x2(c0, c1, c2, c3);
+    Store2x4(ptrs[0] + offset, ptrs[4] + offset, c0);
+    Store2x4(ptrs[1] + offset, ptrs[5] + offset, c1);
+    Store2x4(ptrs[2] + offset, ptrs[6] + offset, c2);
+    Store2x4(ptrs[3] + offset, ptrs[7] + offset, c3);
+}
+
+// Reciprocal square root with one Newton-Raphson iteration
+static BE_FORCE_INLINE __m256 RSqrt(const __m256 &x) {
+    const __m256 r = _mm256_rsqrt_ps(x);
+    const __m256 hx = _mm256_mul_ps(x, _mm256_set1_ps(0.5f));
+    return _mm256_mul_ps(r, _mm256_fnmadd_ps(_mm256_mul_ps(hx, r), r, _mm256_set1_ps(1.5f)));
+}
+
+// Same polynomial with Math::Sin16 but without range reduction, a must be in [-pi/2, pi/2]
+static BE_FORCE_INLINE __m256 Sin16(const __m256 &a) {
+    const __m256 s = _mm256_mul_ps(a, a);
+    __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(-2.39e-08f), s, _mm256_set1_ps(2.7526e-06f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-1.98409e-04f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(8.3333315e-03f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-1.666666664e-01f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(1.0f));
+    return _mm256_mul_ps(a, p);
+}
+
+// Same polynomial with Math::ATan16(y, x), y and x must be non-negative
+static BE_FORCE_INLINE __m256 ATan16(const __m256 &y, const __m256 &x) {
+    const __m256 swap = _mm256_cmp_ps(y, x, _CMP_GT_OQ);
+    const __m256 a = _mm256_div_ps(_mm256_min_ps(y, x), _mm256_max_ps(y, x));
+    const __m256 s = _mm256_mul_ps(a, a);
+    __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(0.0028662257f), s, _mm256_set1_ps(-0.0161657367f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(0.0429096138f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-0.0752896400f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(0.1065626393f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-0.1420889944f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(0.1999355085f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(-0.3333314528f));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(1.0f));
+    p = _mm256_mul_ps(p, a);
+    return _mm256_blendv_ps(p, _mm256_sub_ps(_mm256_set1_ps(Math::HalfPi), p), swap);
+}
+
+static BE_FORCE_INLINE float HorizontalSum(const __m256 &v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+void BE_FASTCALL SIMD_AVX::Add(float *dst, const float constant, const float *src, const int count) {
+    const __m256 c = _mm256_set1_ps(constant);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(c, _mm256_loadu_ps(src + i)));
+    }
+    for (; i < count; i++) {
+        dst[i] = constant + src[i];
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::Add(float *dst, const float *src0, const float *src1, const int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(src0 + i), _mm256_loadu_ps(src1 + i)));
+    }
+    for (; i < count; i++) {
+        dst[i] = src0[i] + src1[i];
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::Sub(float *dst, const float constant, const float *src, const int count) {
+    const __m256 c = _mm256_set1_ps(constant);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_sub_ps(c, _mm256_loadu_ps(src + i)));
+    }
+    for (; i < count; i++) {
+        dst[i] = constant - src[i];
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::Sub(float *dst, const float *src0, const float *src1, const int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_sub_ps(_mm256_loadu_ps(src0 + i), _mm256_loadu_ps(src1 + i)));
+    }
+    for (; i < count; i++) {
+        dst[i] = src0[i] - src1[i];
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::Mul(float *dst, const float constant, const float *src, const int count) {
+    const __m256 c = _mm256_set1_ps(constant);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(c, _mm256_loadu_ps(src + i)));
+    }
+    for (; i < count; i++) {
+        dst[i] = constant * src[i];
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::Mul(float *dst, const float *src0, const float *src1, const int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src0 + i), _mm256_loadu_ps(src1 + i)));
+    }
+    for (; i < count; i++) {
+        dst[i] = src0[i] * src1[i];
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::Div(float *dst, const float constant, const float *src, const int count) {
+    const __m256 c = _mm256_set1_ps(constant);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_div_ps(c, _mm256_loadu_ps(src + i)));
+    }
+    for (; i < count; i++) {
+        dst[i] = constant / src[i];
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::Div(float *dst, const float *src0, const float *src1, const int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_div_ps(_mm256_loadu_ps(src0 + i), _mm256_loadu_ps(src1 + i)));
+    }
+    for (; i < count; i++) {
+        dst[i] = src0[i] / src1[i];
+    }
+}
+
+float BE_FASTCALL SIMD_AVX::Sum(const float *src, const int count) {
+    // Two accumulators to hide the latency of add
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        sum0 = _mm256_add_ps(sum0, _mm256_loadu_ps(src + i));
+        sum1 = _mm256_add_ps(sum1, _mm256_loadu_ps(src + i + 8));
+    }
+    if (i + 8 <= count) {
+        sum0 = _mm256_add_ps(sum0, _mm256_loadu_ps(src + i));
+        i += 8;
+    }
+    float ret = HorizontalSum(_mm256_add_ps(sum0, sum1));
+    for (; i < count; i++) {
+        ret += src[i];
+    }
+    return ret;
+}
+
+// Blends 8 joints at a time. Joint indices of the last batch are padded with the last index, 
+// so the same rotation is computed and written several times with the same result.
+template <bool fast>
+static void BlendJoints8(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    static_assert(sizeof(JointPose) == sizeof(float) * 10, "JointPose must be 10 floats (q, t, s)");
+
+    if (fraction <= 0.0f) {
+        return;
+    }
+
+    if (fraction >= 1.0f) {
+        for (int i = 0; i < numJoints; i++) {
+            const int j = index[i];
+            memcpy(&joints[j], &blendJoints[j], sizeof(JointPose));
+        }
+        return;
+    }
+
+    const __m256 vt = _mm256_set1_ps(fraction);
+    const __m256 vone = _mm256_set1_ps(1.0f);
+    const __m256 vsignBit = _mm256_set1_ps(-0.0f);
+    const __m256 vomt = _mm256_set1_ps(1.0f - fraction);
+    // Mask to load/store 6 floats of translation and scale
+    const __m256i tsMask = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+
+    float *dstPtrs[8];
+    const float *srcPtrs[8];
+
+    for (int i = 0; i < numJoints; i += 8) {
+        const int count = numJoints - i < 8 ? numJoints - i : 8;
+
+        for (int k = 0; k < 8; k++) {
+            const int j = index[i + (k < count ? k : count - 1)];
+            dstPtrs[k] = reinterpret_cast<float *>(&joints[j]);
+            srcPtrs[k] = reinterpret_cast<const float *>(&blendJoints[j]);
+        }
+
+        __m256 x0, y0, z0, w0;
+        __m256 x1, y1, z1, w1;
+        Gather4x8(dstPtrs, 0, x0, y0, z0, w0);
+        Gather4x8(srcPtrs, 0, x1, y1, z1, w1);
+
+        __m256 cosom = _mm256_mul_ps(x0, x1);
+        cosom = _mm256_fmadd_ps(y0, y1, cosom);
+        cosom = _mm256_fmadd_ps(z0, z1, cosom);
+        cosom = _mm256_fmadd_ps(w0, w1, cosom);
+
+        const __m256 sign = _mm256_and_ps(cosom, vsignBit);
+
+        __m256 scale0, scale1;
+
+        if (fast) {
+            // Normalized lerp (same as Quat::SetFromSlerpFast)
+            scale0 = vomt;
+            scale1 = _mm256_xor_ps(vt, sign);
+        } else {
+            // Same as Quat::SetFromSlerp (adjusts signs to take the shortest path)
+            x1 = _mm256_xor_ps(x1, sign);
+            y1 = _mm256_xor_ps(y1, sign);
+            z1 = _mm256_xor_ps(z1, sign);
+            w1 = _mm256_xor_ps(w1, sign);
+            cosom = _mm256_xor_ps(cosom, sign);
+
+            const __m256 sinSqr = _mm256_fnmadd_ps(cosom, cosom, vone);
+            const __m256 sinom = RSqrt(sinSqr);
+            const __m256 omega = ATan16(_mm256_mul_ps(sinSqr, sinom), cosom);
+            scale0 = _mm256_mul_ps(Sin16(_mm256_mul_ps(vomt, omega)), sinom);
+            scale1 = _mm256_mul_ps(Sin16(_mm256_mul_ps(vt, omega)), sinom);
+
+            // "from" and "to" quaternions are very close, so we can do a linear interpolation
+            const __m256 linear = _mm256_cmp_ps(_mm256_sub_ps(vone, cosom), _mm256_set1_ps(1e-6f), _CMP_NGT_UQ);
+            scale0 = _mm256_blendv_ps(scale0, vomt, linear);
+            scale1 = _mm256_blendv_ps(scale1, vt, linear);
+        }
+
+        __m256 qx = _mm256_fmadd_ps(scale1, x1, _mm256_mul_ps(scale0, x0));
+        __m256 qy = _mm256_fmadd_ps(scale1, y1, _mm256_mul_ps(scale0, y0));
+        __m256 qz = _mm256_fmadd_ps(scale1, z1, _mm256_mul_ps(scale0, z0));
+        __m256 qw = _mm256_fmadd_ps(scale1, w1, _mm256_mul_ps(scale0, w0));
+
+        if (fast) {
+            __m256 lengthSqr = _mm256_mul_ps(qx, qx);
+            lengthSqr = _mm256_fmadd_ps(qy, qy, lengthSqr);
+            lengthSqr = _mm256_fmadd_ps(qz, qz, lengthSqr);
+            lengthSqr = _mm256_fmadd_ps(qw, qw, lengthSqr);
+            const __m256 invLength = RSqrt(lengthSqr);
+            qx = _mm256_mul_ps(qx, invLength);
+            qy = _mm256_mul_ps(qy, invLength);
+            qz = _mm256_mul_ps(qz, invLength);
+            qw = _mm256_mul_ps(qw, invLength);
+        }
+
+        // Lerp translation and scale of each joint (padded lanes are skipped, lerp is not idempotent)
+        for (int k = 0; k < count; k++) {
+            const __m256 ts0 = _mm256_maskload_ps(dstPtrs[k] + 4, tsMask);
+            const __m256 ts1 = _mm256_maskload_ps(srcPtrs[k] + 4, tsMask);
+            _mm256_maskstore_ps(dstPtrs[k] + 4, tsMask, _mm256_fmadd_ps(_mm256_sub_ps(ts1, ts0), vt, ts0));
+        }
+
+        Scatter4x8(dstPtrs, 0, qx, qy, qz, qw);
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::BlendJoints(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    BlendJoints8<false>(joints, blendJoints, fraction, index, numJoints);
+}
+
+void BE_FASTCALL SIMD_AVX::BlendJointsFast(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    BlendJoints8<true>(joints, blendJoints, fraction, index, numJoints);
+}
+
+void BE_FASTCALL SIMD_AVX::ConvertJointPosesToJointMats(Mat3x4 *jointMats, const JointPose *jointPoses, const int numJoints) {
+    static_assert(sizeof(Mat3x4) == sizeof(float) * 12, "Mat3x4 must be 12 floats");
+
+    const __m256 vone = _mm256_set1_ps(1.0f);
+
+    const float *srcPtrs[8];
+    float *dstPtrs[8];
+    float tailMats[8][12];
+
+    for (int i = 0; i < numJoints; i += 8) {
+        const int count = numJoints - i < 8 ? numJoints - i : 8;
+
+        for (int k = 0; k < 8; k++) {
+            const int j = i + (k < count ? k : count - 1);
+            srcPtrs[k] = reinterpret_cast<const float *>(&jointPoses[j]);
+            // Write the last batch to the temporary matrices, not to overrun jointMats
+            dstPtrs[k] = count == 8 ? reinterpret_cast<float *>(&jointMats[j]) : tailMats[k];
+        }
+
+        __m256 x, y, z, w;
+        __m256 tx, ty, tz, sx;
+        __m256 sy, sz, dummy0, dummy1;
+        Gather4x8(srcPtrs, 0, x, y, z, w);
+        Gather4x8(srcPtrs, 4, tx, ty, tz, sx);
+        // Loads from float 6 (t.z) to not read past the end of the JointPose
+        Gather4x8(srcPtrs, 6, dummy0, dummy1, sy, sz);
+
+        const __m256 x2 = _mm256_add_ps(x, x);
+        const __m256 y2 = _mm256_add_ps(y, y);
+        const __m256 z2 = _mm256_add_ps(z, z);
+
+        const __m256 xx2 = _mm256_mul_ps(x, x2);
+        const __m256 xy2 = _mm256_mul_ps(x, y2);
+        const __m256 xz2 = _mm256_mul_ps(x, z2);
+        const __m256 yy2 = _mm256_mul_ps(y, y2);
+        const __m256 yz2 = _mm256_mul_ps(y, z2);
+        const __m256 zz2 = _mm256_mul_ps(z, z2);
+        const __m256 wx2 = _mm256_mul_ps(w, x2);
+        const __m256 wy2 = _mm256_mul_ps(w, y2);
+        const __m256 wz2 = _mm256_mul_ps(w, z2);
+
+        // Same as Mat3x4::SetScaleRotation(s, q.ToMat3()) and SetTranslation(t)
+        __m256 m00 = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(vone, yy2), zz2), sx);
+        __m256 m01 = _mm256_mul_ps(_mm256_sub_ps(xy2, wz2), sy);
+        __m256 m02 = _mm256_mul_ps(_mm256_add_ps(xz2, wy2), sz);
+
+        __m256 m10 = _mm256_mul_ps(_mm256_add_ps(xy2, wz2), sx);
+        __m256 m11 = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(vone, xx2), zz2), sy);
+        __m256 m12 = _mm256_mul_ps(_mm256_sub_ps(yz2, wx2), sz);
+
+        __m256 m20 = _mm256_mul_ps(_mm256_sub_ps(xz2, wy2), sx);
+        __m256 m21 = _mm256_mul_ps(_mm256_add_ps(yz2, wx2), sy);
+        __m256 m22 = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(vone, xx2), yy2), sz);
+
+        Scatter4x8(dstPtrs, 0, m00, m01, m02, tx);
+        Scatter4x8(dstPtrs, 4, m10, m11, m12, ty);
+        Scatter4x8(dstPtrs, 8, m20, m21, m22, tz);
+
+        if (count < 8) {
+            memcpy(&jointMats[i], tailMats, count * sizeof(Mat3x4));
+        }
+    }
+}
+
+// dst = a * b (affine 3x4 matrix multiplication). dst can be the same as b.
+static BE_FORCE_INLINE void MultiplyMat3x4(float *dst, const float *a, const float *b) {
+    // w mask to add the translation of a
+    const __m256 wMask = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1));
+
+    const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 0));
+    const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 4));
+    const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 8));
+
+    // Row 0 and 1 of a in a 256 bits register, row 2 in a 128 bits register
+    const __m256 a01 = _mm256_loadu_ps(a);
+    const __m128 a2 = _mm_loadu_ps(a + 8);
+
+    __m256 r01 = _mm256_and_ps(a01, wMask);
+    r01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(0, 0, 0, 0)), b0, r01);
+    r01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(1, 1, 1, 1)), b1, r01);
+    r01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(2, 2, 2, 2)), b2, r01);
+
+    __m128 r2 = _mm_and_ps(a2, _mm256_castps256_ps128(wMask));
+    r2 = _mm_fmadd_ps(_mm_permute_ps(a2, _MM_SHUFFLE(0, 0, 0, 0)), _mm256_castps256_ps128(b0), r2);
+    r2 = _mm_fmadd_ps(_mm_permute_ps(a2, _MM_SHUFFLE(1, 1, 1, 1)), _mm256_castps256_ps128(b1), r2);
+    r2 = _mm_fmadd_ps(_mm_permute_ps(a2, _MM_SHUFFLE(2, 2, 2, 2)), _mm256_castps256_ps128(b2), r2);
+
+    _mm256_storeu_ps(dst, r01);
+    _mm_storeu_ps(dst + 8, r2);
+}
+
+void BE_FASTCALL SIMD_AVX::TransformJoints(Mat3x4 *jointMats, const int *parents, const int firstJoint, const int lastJoint) {
+    float *mats = reinterpret_cast<float *>(jointMats);
+
+    for (int i = firstJoint; i <= lastJoint; i++) {
+        assert(parents[i] < i);
+        if (parents[i] >= 0) {
+            // Same as jointMats[i].TransformSelf(jointMats[parents[i]])
+            MultiplyMat3x4(mats + i * 12, mats + parents[i] * 12, mats + i * 12);
+        }
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::MultiplyJoints(Mat3x4 *result, const Mat3x4 *joints1, const Mat3x4 *joints2, const int numJoints) {
+    float *dst = reinterpret_cast<float *>(result);
+    const float *src1 = reinterpret_cast<const float *>(joints1);
+    const float *src2 = reinterpret_cast<const float *>(joints2);
+
+    for (int i = 0; i < numJoints; i++) {
+        MultiplyMat3x4(dst + i * 12, src1 + i * 12, src2 + i * 12);
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::TransformVerts(VertexLightingGeneric *verts, const int numVerts, const Mat3x4 *joints, const Vec4 *base, const int *index, const int numWeights) {
+    const byte *jointsPtr = reinterpret_cast<const byte *>(joints);
+    const float *basePtr = reinterpret_cast<const float *>(base);
+
+    for (int j = 0, i = 0; i < numVerts; i++) {
+        // Accumulates row 0 and 1 of the weighted joint matrices in a 256 bits register, row 2 in a 128 bits register
+        __m256 acc01 = _mm256_setzero_ps();
+        __m128 acc2 = _mm_setzero_ps();
+
+        for (;;) {
+            const float *m = reinterpret_cast<const float *>(jointsPtr + index[j * 2 + 0]);
+            const __m128 b = _mm_loadu_ps(basePtr + j * 4);
+
+            acc01 = _mm256_fmadd_ps(_mm256_loadu_ps(m), _mm256_insertf128_ps(_mm256_castps128_ps256(b), b, 1), acc01);
+            acc2 = _mm_fmadd_ps(_mm_loadu_ps(m + 8), b, acc2);
+
+            if (index[j * 2 + 1] != 0) {
+                break;
+            }
+            j++;
+        }
+
+        j++;
+
+        // Horizontal sums of each row to get x, y, z
+        const __m128 h01 = _mm_hadd_ps(_mm256_castps256_ps128(acc01), _mm256_extractf128_ps(acc01, 1));
+        const __m128 h2 = _mm_hadd_ps(acc2, acc2);
+        const __m128 xyz = _mm_hadd_ps(h01, h2);
+
+        float *dst = reinterpret_cast<float *>(&verts[i]);
+        _mm_storel_pi(reinterpret_cast<__m64 *>(dst), xyz);
+        _mm_store_ss(dst + 2, _mm_movehl_ps(xyz, xyz));
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::DeriveTriPlanes(Plane *planes, const VertexLightingGeneric *verts, const int numVerts, const int *indexes, const int numIndexes) {
+    static_assert(sizeof(Plane) == sizeof(float) * 4, "Plane must be 4 floats");
+
+    const byte *vertsPtr = reinterpret_cast<const byte *>(verts);
+    const int numTris = numIndexes / 3;
+
+    // Offsets of the first index of 8 triangles
+    const __m256i triOffsets = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    const __m256i vertexSize = _mm256_set1_epi32((int)sizeof(VertexLightingGeneric));
+
+    float *dstPtrs[8];
+    float tailPlanes[8][4];
+
+    for (int i = 0; i < numTris; i += 8) {
+        const int count = numTris - i < 8 ? numTris - i : 8;
+
+        __m256i triIndexes = triOffsets;
+        if (count < 8) {
+            // Clamp to the last triangle so that gathers don't read past the end of indexes
+            triIndexes = _mm256_min_epi32(triIndexes, _mm256_set1_epi32((count - 1) * 3));
+        }
+
+        const int *triPtr = indexes + i * 3;
+        // Byte offsets of the vertices a, b, c of 8 triangles
+        const __m256i ia = _mm256_mullo_epi32(_mm256_i32gather_epi32(triPtr + 0, triIndexes, 4), vertexSize);
+        const __m256i ib = _mm256_mullo_epi32(_mm256_i32gather_epi32(triPtr + 1, triIndexes, 4), vertexSize);
+        const __m256i ic = _mm256_mullo_epi32(_mm256_i32gather_epi32(triPtr + 2, triIndexes, 4), vertexSize);
+
+        const float *xPtr = reinterpret_cast<const float *>(vertsPtr);
+        const float *yPtr = xPtr + 1;
+        const float *zPtr = xPtr + 2;
+
+        const __m256 ax = _mm256_i32gather_ps(xPtr, ia, 1);
+        const __m256 ay = _mm256_i32gather_ps(yPtr, ia, 1);
+        const __m256 az = _mm256_i32gather_ps(zPtr, ia, 1);
+
+        const __m256 d0x = _mm256_sub_ps(_mm256_i32gather_ps(xPtr, ib, 1), ax);
+        const __m256 d0y = _mm256_sub_ps(_mm256_i32gather_ps(yPtr, ib, 1), ay);
+        const __m256 d0z = _mm256_sub_ps(_mm256_i32gather_ps(zPtr, ib, 1), az);
+
+        const __m256 d1x = _mm256_sub_ps(_mm256_i32gather_ps(xPtr, ic, 1), ax);
+        const __m256 d1y = _mm256_sub_ps(_mm256_i32gather_ps(yPtr, ic, 1), ay);
+        const __m256 d1z = _mm256_sub_ps(_mm256_i32gather_ps(zPtr, ic, 1), az);
+
+        // n = d1 x d0
+        __m256 nx = _mm256_fmsub_ps(d1y, d0z, _mm256_mul_ps(d1z, d0y));
+        __m256 ny = _mm256_fmsub_ps(d1z, d0x, _mm256_mul_ps(d1x, d0z));
+        __m256 nz = _mm256_fmsub_ps(d1x, d0y, _mm256_mul_ps(d1y, d0x));
+
+        __m256 lengthSqr = _mm256_mul_ps(nx, nx);
+        lengthSqr = _mm256_fmadd_ps(ny, ny, lengthSqr);
+        lengthSqr = _mm256_fmadd_ps(nz, nz, lengthSqr);
+        const __m256 invLength = RSqrt(lengthSqr);
+
+        nx = _mm256_mul_ps(nx, invLength);
+        ny = _mm256_mul_ps(ny, invLength);
+        nz = _mm256_mul_ps(nz, invLength);
+
+        // d = -(n . a)
+        __m256 d = _mm256_mul_ps(nx, ax);
+        d = _mm256_fmadd_ps(ny, ay, d);
+        d = _mm256_fmadd_ps(nz, az, d);
+        d = _mm256_xor_ps(d, _mm256_set1_ps(-0.0f));
+
+        for (int k = 0; k < 8; k++) {
+            dstPtrs[k] = count == 8 ? reinterpret_cast<float *>(&planes[i + k]) : tailPlanes[k];
+        }
+
+        Scatter4x8(dstPtrs, 0, nx, ny, nz, d);
+
+        if (count < 8) {
+            memcpy(&planes[i], tailPlanes, count * sizeof(Plane));
+        }
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::CullAABBsByPlanes(byte *cullBits, const Vec4 *planes, const int numPlanes, const float *bounds, const int stride, const int count) {
+    const float *centerX = bounds;
+    const float *centerY = bounds + stride;
+    const float *centerZ = bounds + stride * 2;
+    const float *extentX = bounds + stride * 3;
+    const float *extentY = bounds + stride * 4;
+    const float *extentZ = bounds + stride * 5;
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(centerX + i);
+        const __m256 cy = _mm256_loadu_ps(centerY + i);
+        const __m256 cz = _mm256_loadu_ps(centerZ + i);
+        const __m256 ex = _mm256_loadu_ps(extentX + i);
+        const __m256 ey = _mm256_loadu_ps(extentY + i);
+        const __m256 ez = _mm256_loadu_ps(extentZ + i);
+
+        __m256 culled = zero;
+
+        for (int j = 0; j < numPlanes; j++) {
+            const Vec4 &plane = planes[j];
+            const __m256 px = _mm256_set1_ps(plane.x);
+            const __m256 py = _mm256_set1_ps(plane.y);
+            const __m256 pz = _mm256_set1_ps(plane.z);
+            __m256 d = _mm256_fmadd_ps(px, cx, _mm256_set1_ps(plane.w));
+            d = _mm256_fmadd_ps(py, cy, d);
+            d = _mm256_fmadd_ps(pz, cz, d);
+            // |plane normal| by clearing the sign bits
+            d = _mm256_fnmadd_ps(_mm256_andnot_ps(signMask, px), ex, d);
+            d = _mm256_fnmadd_ps(_mm256_andnot_ps(signMask, py), ey, d);
+            d = _mm256_fnmadd_ps(_mm256_andnot_ps(signMask, pz), ez, d);
+            culled = _mm256_or_ps(culled, _mm256_cmp_ps(d, zero, _CMP_GT_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(culled);
+        for (int k = 0; k < 8; k++) {
+            cullBits[i + k] = (mask >> k) & 1;
+        }
+    }
+
+    if (i < count) {
+        SIMD_SSE4::CullAABBsByPlanes(cullBits + i, planes, numPlanes, bounds + i, stride, count - i);
+    }
+}
+
 BE_NAMESPACE_END
 
 #endif // defined(__X86__)
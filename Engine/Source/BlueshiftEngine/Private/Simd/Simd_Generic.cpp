@@ -279,4 +279,153 @@ void BE_FASTCALL SIMD_Generic::DeriveTriPlanes(Plane *planes, const VertexLighti
     }
 }
 
+void BE_FASTCALL SIMD_Generic::DecompressVec3Keys(Vec3 *dst, const uint16_t *keys, const int *keyIndexes0, const int *keyIndexes1, const float *fractions, const Vec3 *rangeMins, const Vec3 *rangeScales, const int count) {
+    for (int i = 0; i < count; i++) {
+        const uint16_t *key0 = &keys[keyIndexes0[i] * 3];
+        const uint16_t *key1 = &keys[keyIndexes1[i] * 3];
+        const float f = fractions[i];
+
+        for (int j = 0; j < 3; j++) {
+            const float k0 = (float)key0[j];
+            const float k1 = (float)key1[j];
+            dst[i][j] = rangeMins[i][j] + rangeScales[i][j] * (k0 + (k1 - k0) * f);
+        }
+    }
+}
+
+void BE_FASTCALL SIMD_Generic::DecompressQuatKeys(Quat *dst, const uint16_t *keys, const int *keyIndexes0, const int *keyIndexes1, const float *fractions, const int count) {
+    for (int i = 0; i < count; i++) {
+        const Quat q0 = QuantizedJointKey::DequantizeQuat(&keys[keyIndexes0[i] * 3]);
+        const Quat q1 = QuantizedJointKey::DequantizeQuat(&keys[keyIndexes1[i] * 3]);
+        const float f = fractions[i];
+
+        // interpolate through the shortest path
+        const float dot = q0.x * q1.x + q0.y * q1.y + q0.z * q1.z + q0.w * q1.w;
+        const float f0 = 1.0f - f;
+        const float f1 = dot < 0.0f ? -f : f;
+
+        Quat q(q0.x * f0 + q1.x * f1, q0.y * f0 + q1.y * f1, q0.z * f0 + q1.z * f1, q0.w * f0 + q1.w * f1);
+        const float invLength = 1.0f / Math::Sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        dst[i].x = q.x * invLength;
+        dst[i].y = q.y * invLength;
+        dst[i].z = q.z * invLength;
+        dst[i].w = q.w * invLength;
+    }
+}
+
+void BE_FASTCALL SIMD_Generic::SampleJoints(JointPose *joints, const JointSampleGroup *groups, const int numGroups, const float *frame1, const float *frame2, const float fraction) {
+    for (int i = 0; i < numGroups; i++) {
+        const JointSampleGroup &group = groups[i];
+
+        for (int lane = 0; lane < 4; lane++) {
+            float c1[JointSampleGroup::NumComponents];
+            float c2[JointSampleGroup::NumComponents];
+
+            for (int c = 0; c < JointSampleGroup::NumComponents; c++) {
+                const int offset = group.componentOffsets[c][lane];
+                const bool animated = group.componentMasks[c][lane] != 0;
+                c1[c] = animated ? frame1[offset] : group.baseComponents[c][lane];
+                c2[c] = animated ? frame2[offset] : group.baseComponents[c][lane];
+            }
+
+            Quat q1(c1[JointSampleGroup::Qx], c1[JointSampleGroup::Qy], c1[JointSampleGroup::Qz], group.baseComponents[JointSampleGroup::NumComponents][lane]);
+            Quat q2(c2[JointSampleGroup::Qx], c2[JointSampleGroup::Qy], c2[JointSampleGroup::Qz], group.baseComponents[JointSampleGroup::NumComponents][lane]);
+            if (group.rotationMasks[lane]) {
+                q1.w = q1.CalcW();
+                q2.w = q2.CalcW();
+            }
+
+            JointPose &joint = joints[group.jointIndexes[lane]];
+            joint.q.SetFromSlerp(q1, q2, fraction);
+            joint.t.SetFromLerp(Vec3(&c1[JointSampleGroup::Tx]), Vec3(&c2[JointSampleGroup::Tx]), fraction);
+            joint.s.SetFromLerp(Vec3(&c1[JointSampleGroup::Sx]), Vec3(&c2[JointSampleGroup::Sx]), fraction);
+        }
+    }
+}
+
+void BE_FASTCALL SIMD_Generic::RasterizeOccluderTriangles(float *depthBuffer, const int stride, const Vec3 *triVerts, const int *triIndexes, const int numTris, const int minX, const int minY, const int maxX, const int maxY) {
+    for (int i = 0; i < numTris; i++) {
+        const Vec3 *v0 = &triVerts[triIndexes[i] * 3 + 0];
+        const Vec3 *v1 = &triVerts[triIndexes[i] * 3 + 1];
+        const Vec3 *v2 = &triVerts[triIndexes[i] * 3 + 2];
+
+        float area = (v1->x - v0->x) * (v2->y - v0->y) - (v1->y - v0->y) * (v2->x - v0->x);
+        if (area == 0.0f) {
+            continue;
+        }
+        // Both windings are rasterized
+        if (area < 0.0f) {
+            Swap(v1, v2);
+            area = -area;
+        }
+
+        // Clamp the bounds in float first to avoid overflow of the far away vertices
+        const int x0 = (int)Max(Min(Min(v0->x, v1->x), v2->x), (float)minX);
+        const int y0 = (int)Max(Min(Min(v0->y, v1->y), v2->y), (float)minY);
+        const int x1 = (int)Math::Ceil(Min(Max(Max(v0->x, v1->x), v2->x), (float)maxX));
+        const int y1 = (int)Math::Ceil(Min(Max(Max(v0->y, v1->y), v2->y), (float)maxY));
+        if (x0 >= x1 || y0 >= y1) {
+            continue;
+        }
+
+        // Edge functions e = a * x + b * y + c, non-negative inside of the triangle
+        const float a0 = v1->y - v2->y, b0 = v2->x - v1->x, c0 = v1->x * v2->y - v2->x * v1->y;
+        const float a1 = v2->y - v0->y, b1 = v0->x - v2->x, c1 = v2->x * v0->y - v0->x * v2->y;
+        const float a2 = v0->y - v1->y, b2 = v1->x - v0->x, c2 = v0->x * v1->y - v1->x * v0->y;
+
+        // Depth plane from the barycentric coordinates
+        const float invArea = 1.0f / area;
+        const float za = (a0 * v0->z + a1 * v1->z + a2 * v2->z) * invArea;
+        const float zb = (b0 * v0->z + b1 * v1->z + b2 * v2->z) * invArea;
+        const float zc = (c0 * v0->z + c1 * v1->z + c2 * v2->z) * invArea;
+
+        for (int y = y0; y < y1; y++) {
+            const float py = y + 0.5f;
+            const float px = x0 + 0.5f;
+
+            float e0 = a0 * px + b0 * py + c0;
+            float e1 = a1 * px + b1 * py + c1;
+            float e2 = a2 * px + b2 * py + c2;
+            float z = za * px + zb * py + zc;
+
+            float *dst = depthBuffer + y * stride;
+
+            for (int x = x0; x < x1; x++) {
+                if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f && z > dst[x]) {
+                    dst[x] = z;
+                }
+                e0 += a0;
+                e1 += a1;
+                e2 += a2;
+                z += za;
+            }
+        }
+    }
+}
+
+void BE_FASTCALL SIMD_Generic::CullAABBsByPlanes(byte *cullBits, const Vec4 *planes, const int numPlanes, const float *bounds, const int stride, const int count) {
+    const float *centerX = bounds;
+    const float *centerY = bounds + stride;
+    const float *centerZ = bounds + stride * 2;
+    const float *extentX = bounds + stride * 3;
+    const float *extentY = bounds + stride * 4;
+    const float *extentZ = bounds + stride * 5;
+
+    for (int i = 0; i < count; i++) {
+        byte culled = 0;
+
+        for (int j = 0; j < numPlanes; j++) {
+            const Vec4 &plane = planes[j];
+            const float d = plane.x * centerX[i] + plane.y * centerY[i] + plane.z * centerZ[i] + plane.w;
+            const float r = Math::Fabs(plane.x) * extentX[i] + Math::Fabs(plane.y) * extentY[i] + Math::Fabs(plane.z) * extentZ[i];
+            if (d - r > 0.0f) {
+                culled = 1;
+                break;
+            }
+        }
+
+        cullBits[i] = culled;
+    }
+}
+
 BE_NAMESPACE_END
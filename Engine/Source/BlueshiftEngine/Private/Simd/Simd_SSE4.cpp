@@ -444,6 +444,320 @@ void BE_FASTCALL SIMD_SSE4::MatrixMultiply(float *dst, const float *src0, const
     _mm_store_ps(dst + 12, a0);
 }
 
+void BE_FASTCALL SIMD_SSE4::RasterizeOccluderTriangles(float *depthBuffer, const int stride, const Vec3 *triVerts, const int *triIndexes, const int numTris, const int minX, const int minY, const int maxX, const int maxY) {
+    const ssef pixelOffset(0.5f, 1.5f, 2.5f, 3.5f);
+    const ssef zero(0.0f);
+
+    for (int i = 0; i < numTris; i++) {
+        const Vec3 *v0 = &triVerts[triIndexes[i] * 3 + 0];
+        const Vec3 *v1 = &triVerts[triIndexes[i] * 3 + 1];
+        const Vec3 *v2 = &triVerts[triIndexes[i] * 3 + 2];
+
+        float area = (v1->x - v0->x) * (v2->y - v0->y) - (v1->y - v0->y) * (v2->x - v0->x);
+        if (area == 0.0f) {
+            continue;
+        }
+        if (area < 0.0f) {
+            Swap(v1, v2);
+            area = -area;
+        }
+
+        // Spans start at the 4 pixel aligned x
+        const int x0 = (int)Max(Min(Min(v0->x, v1->x), v2->x), (float)minX) & ~3;
+        const int y0 = (int)Max(Min(Min(v0->y, v1->y), v2->y), (float)minY);
+        const int x1 = (int)Math::Ceil(Min(Max(Max(v0->x, v1->x), v2->x), (float)maxX));
+        const int y1 = (int)Math::Ceil(Min(Max(Max(v0->y, v1->y), v2->y), (float)maxY));
+        if (x0 >= x1 || y0 >= y1) {
+            continue;
+        }
+
+        const float a0 = v1->y - v2->y, b0 = v2->x - v1->x, c0 = v1->x * v2->y - v2->x * v1->y;
+        const float a1 = v2->y - v0->y, b1 = v0->x - v2->x, c1 = v2->x * v0->y - v0->x * v2->y;
+        const float a2 = v0->y - v1->y, b2 = v1->x - v0->x, c2 = v0->x * v1->y - v1->x * v0->y;
+
+        const float invArea = 1.0f / area;
+        const float za = (a0 * v0->z + a1 * v1->z + a2 * v2->z) * invArea;
+        const float zb = (b0 * v0->z + b1 * v1->z + b2 * v2->z) * invArea;
+        const float zc = (c0 * v0->z + c1 * v1->z + c2 * v2->z) * invArea;
+
+        const ssef e0Step(a0 * 4.0f);
+        const ssef e1Step(a1 * 4.0f);
+        const ssef e2Step(a2 * 4.0f);
+        const ssef zStep(za * 4.0f);
+
+        const ssef px = ssef((float)x0) + pixelOffset;
+        const ssef e0Start = ssef(a0) * px;
+        const ssef e1Start = ssef(a1) * px;
+        const ssef e2Start = ssef(a2) * px;
+        const ssef zStart = ssef(za) * px;
+
+        for (int y = y0; y < y1; y++) {
+            const float py = y + 0.5f;
+
+            ssef e0 = e0Start + ssef(b0 * py + c0);
+            ssef e1 = e1Start + ssef(b1 * py + c1);
+            ssef e2 = e2Start + ssef(b2 * py + c2);
+            ssef z = zStart + ssef(zb * py + zc);
+
+            float *dst = depthBuffer + y * stride;
+
+            for (int x = x0; x < x1; x += 4) {
+                const sseb inside = (e0 >= zero) & (e1 >= zero) & (e2 >= zero);
+                if (any(inside)) {
+                    const ssef depth = _mm_load_ps(dst + x);
+                    _mm_store_ps(dst + x, select(inside, vmax(depth, z), depth));
+                }
+                e0 += e0Step;
+                e1 += e1Step;
+                e2 += e2Step;
+                z += zStep;
+            }
+        }
+    }
+}
+
+void BE_FASTCALL SIMD_SSE4::CullAABBsByPlanes(byte *cullBits, const Vec4 *planes, const int numPlanes, const float *bounds, const int stride, const int count) {
+    const float *centerX = bounds;
+    const float *centerY = bounds + stride;
+    const float *centerZ = bounds + stride * 2;
+    const float *extentX = bounds + stride * 3;
+    const float *extentY = bounds + stride * 4;
+    const float *extentZ = bounds + stride * 5;
+    const ssef zero(0.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const ssef cx(centerX + i);
+        const ssef cy(centerY + i);
+        const ssef cz(centerZ + i);
+        const ssef ex(extentX + i);
+        const ssef ey(extentY + i);
+        const ssef ez(extentZ + i);
+
+        sseb culled(false);
+
+        for (int j = 0; j < numPlanes; j++) {
+            const Vec4 &plane = planes[j];
+            const ssef d = ssef(plane.x) * cx + ssef(plane.y) * cy + ssef(plane.z) * cz + ssef(plane.w);
+            const ssef r = ssef(Math::Fabs(plane.x)) * ex + ssef(Math::Fabs(plane.y)) * ey + ssef(Math::Fabs(plane.z)) * ez;
+            culled |= (d - r) > zero;
+        }
+
+        const int mask = (int)movemask(culled);
+        cullBits[i + 0] = mask & 1;
+        cullBits[i + 1] = (mask >> 1) & 1;
+        cullBits[i + 2] = (mask >> 2) & 1;
+        cullBits[i + 3] = (mask >> 3) & 1;
+    }
+
+    if (i < count) {
+        SIMD_Generic::CullAABBsByPlanes(cullBits + i, planes, numPlanes, bounds + i, stride, count - i);
+    }
+}
+
+// Loads x, y, z without reading past the end of Vec3
+static BE_FORCE_INLINE __m128 LoadVec3(const Vec3 &v) {
+    return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)&v.x), _mm_load_ss(&v.z));
+}
+
+static BE_FORCE_INLINE void StoreVec3(Vec3 &v, const __m128 a) {
+    _mm_storel_pi((__m64 *)&v.x, a);
+    _mm_store_ss(&v.z, _mm_movehl_ps(a, a));
+}
+
+// Zero extends the three 16-bit words of the key, the fourth lane is undefined
+static BE_FORCE_INLINE __m128i LoadKeyWords(const uint16_t *key) {
+    return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)key), _mm_setzero_si128());
+}
+
+static BE_FORCE_INLINE __m128 Dot4(const __m128 a, const __m128 b) {
+    __m128 m = _mm_mul_ps(a, b);
+    m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+// Byte shuffles moving the reconstructed component in the last lane to the index of the largest component
+ALIGN16(static const int8_t largestQuatComponentShuffles[4][16]) = {
+    { 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 },
+    { 0, 1, 2, 3, 12, 13, 14, 15, 4, 5, 6, 7, 8, 9, 10, 11 },
+    { 0, 1, 2, 3, 4, 5, 6, 7, 12, 13, 14, 15, 8, 9, 10, 11 },
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 }
+};
+
+static BE_FORCE_INLINE __m128 DecodeQuatKey(const uint16_t *key) {
+    const __m128 scale = _mm_set1_ps(1.41421356f / 32767.0f);
+    const __m128 bias = _mm_set1_ps(0.70710678f);
+
+    const __m128 c = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(LoadKeyWords(key), 1)), scale), bias);
+
+    // w = sqrt(max(1 - (x * x + y * y + z * z), 0))
+    const __m128 sq = _mm_mul_ps(c, c);
+    __m128 w = _mm_add_ss(_mm_add_ss(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1))), _mm_movehl_ps(sq, sq));
+    w = _mm_sqrt_ss(_mm_max_ss(_mm_sub_ss(_mm_set_ss(1.0f), w), _mm_setzero_ps()));
+
+    const __m128 v = _mm_blend_ps(c, _mm_shuffle_ps(w, w, _MM_SHUFFLE(0, 0, 0, 0)), 8);
+
+    const int largest = (key[0] & 1) | ((key[1] & 1) << 1);
+    return _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(v), _mm_load_si128((const __m128i *)largestQuatComponentShuffles[largest])));
+}
+
+void BE_FASTCALL SIMD_SSE4::DecompressVec3Keys(Vec3 *dst, const uint16_t *keys, const int *keyIndexes0, const int *keyIndexes1, const float *fractions, const Vec3 *rangeMins, const Vec3 *rangeScales, const int count) {
+    for (int i = 0; i < count; i++) {
+        const __m128 k0 = _mm_cvtepi32_ps(LoadKeyWords(&keys[keyIndexes0[i] * 3]));
+        const __m128 k1 = _mm_cvtepi32_ps(LoadKeyWords(&keys[keyIndexes1[i] * 3]));
+        const __m128 k = _mm_add_ps(k0, _mm_mul_ps(_mm_sub_ps(k1, k0), _mm_set1_ps(fractions[i])));
+
+        StoreVec3(dst[i], _mm_add_ps(LoadVec3(rangeMins[i]), _mm_mul_ps(LoadVec3(rangeScales[i]), k)));
+    }
+}
+
+void BE_FASTCALL SIMD_SSE4::DecompressQuatKeys(Quat *dst, const uint16_t *keys, const int *keyIndexes0, const int *keyIndexes1, const float *fractions, const int count) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for (int i = 0; i < count; i++) {
+        const __m128 q0 = DecodeQuatKey(&keys[keyIndexes0[i] * 3]);
+        const __m128 q1 = DecodeQuatKey(&keys[keyIndexes1[i] * 3]);
+        const __m128 f = _mm_set1_ps(fractions[i]);
+
+        // interpolate through the shortest path
+        const __m128 f0 = _mm_sub_ps(one, f);
+        const __m128 f1 = _mm_xor_ps(f, _mm_and_ps(Dot4(q0, q1), signMask));
+
+        const __m128 q = _mm_add_ps(_mm_mul_ps(q0, f0), _mm_mul_ps(q1, f1));
+        _mm_storeu_ps(&dst[i].x, _mm_mul_ps(q, _mm_div_ps(one, _mm_sqrt_ps(Dot4(q, q)))));
+    }
+}
+
+static BE_FORCE_INLINE __m128 Select(const __m128 mask, const __m128 a, const __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Gathers the components of four joints, the base components are used for the lanes not animated.
+static BE_FORCE_INLINE __m128 GatherComponents(const float *frame, const int32_t *offsets, const __m128 mask, const __m128 base) {
+    return Select(mask, _mm_setr_ps(frame[offsets[0]], frame[offsets[1]], frame[offsets[2]], frame[offsets[3]]), base);
+}
+
+// Same polynomial as Math::Sin16 without the range reduction, a should be in range [0, pi/2].
+static BE_FORCE_INLINE __m128 Sin16(const __m128 a) {
+    const __m128 s = _mm_mul_ps(a, a);
+    __m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-2.39e-08f), s), _mm_set1_ps(2.7526e-06f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-1.98409e-04f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(8.3333315e-03f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-1.666666664e-01f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(1.0f));
+    return _mm_mul_ps(a, r);
+}
+
+// Same polynomial as Math::ATan16(y, x) for the non-negative y and x.
+static BE_FORCE_INLINE __m128 ATan16(const __m128 y, const __m128 x) {
+    const __m128 swapMask = _mm_cmpgt_ps(y, x);
+    const __m128 a = _mm_div_ps(_mm_min_ps(y, x), _mm_max_ps(y, x));
+    const __m128 s = _mm_mul_ps(a, a);
+    __m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.0028662257f), s), _mm_set1_ps(-0.0161657367f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.0429096138f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.0752896400f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.1065626393f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.1420889944f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(0.1999355085f));
+    r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(-0.3333314528f));
+    r = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(1.0f)), a);
+    return Select(swapMask, _mm_sub_ps(_mm_set1_ps(Math::HalfPi), r), r);
+}
+
+void BE_FASTCALL SIMD_SSE4::SampleJoints(JointPose *joints, const JointSampleGroup *groups, const int numGroups, const float *frame1, const float *frame2, const float fraction) {
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 threeHalves = _mm_set1_ps(1.5f);
+    const __m128 slerpEpsilon = _mm_set1_ps(1e-6f);
+
+    // fraction is same for all the joints, so the end points are selected by the masks same as Quat::SetFromSlerp
+    const __m128 t = _mm_set1_ps(Clamp(fraction, 0.0f, 1.0f));
+    const __m128 oneMinusT = _mm_sub_ps(one, t);
+    const __m128 fromMask = _mm_castsi128_ps(_mm_set1_epi32(fraction <= 0.0f ? -1 : 0));
+    const __m128 toMask = _mm_castsi128_ps(_mm_set1_epi32(fraction >= 1.0f ? -1 : 0));
+
+    __m128 c1[JointSampleGroup::NumComponents];
+    __m128 c2[JointSampleGroup::NumComponents];
+
+    for (int i = 0; i < numGroups; i++) {
+        const JointSampleGroup &group = groups[i];
+
+        for (int c = 0; c < JointSampleGroup::NumComponents; c++) {
+            const __m128 mask = _mm_loadu_ps((const float *)group.componentMasks[c]);
+            const __m128 base = _mm_loadu_ps(group.baseComponents[c]);
+            c1[c] = GatherComponents(frame1, group.componentOffsets[c], mask, base);
+            c2[c] = GatherComponents(frame2, group.componentOffsets[c], mask, base);
+        }
+
+        // w of the animated rotations
+        const __m128 rotationMask = _mm_loadu_ps((const float *)group.rotationMasks);
+        const __m128 baseW = _mm_loadu_ps(group.baseComponents[JointSampleGroup::NumComponents]);
+        __m128 x1 = c1[JointSampleGroup::Qx], y1 = c1[JointSampleGroup::Qy], z1 = c1[JointSampleGroup::Qz];
+        __m128 x2 = c2[JointSampleGroup::Qx], y2 = c2[JointSampleGroup::Qy], z2 = c2[JointSampleGroup::Qz];
+        __m128 w1 = _mm_sub_ps(one, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x1, x1), _mm_mul_ps(y1, y1)), _mm_mul_ps(z1, z1)));
+        __m128 w2 = _mm_sub_ps(one, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x2, x2), _mm_mul_ps(y2, y2)), _mm_mul_ps(z2, z2)));
+        w1 = Select(rotationMask, _mm_sqrt_ps(_mm_andnot_ps(signMask, w1)), baseW);
+        w2 = Select(rotationMask, _mm_sqrt_ps(_mm_andnot_ps(signMask, w2)), baseW);
+
+        // slerp through the shortest path
+        __m128 cosom = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x1, x2), _mm_mul_ps(y1, y2)), _mm_add_ps(_mm_mul_ps(z1, z2), _mm_mul_ps(w1, w2)));
+        const __m128 sign = _mm_and_ps(cosom, signMask);
+        cosom = _mm_xor_ps(cosom, sign);
+
+        const __m128 sinSqr = _mm_sub_ps(one, _mm_mul_ps(cosom, cosom));
+        __m128 invSinom = _mm_rsqrt_ps(sinSqr);
+        invSinom = _mm_mul_ps(invSinom, _mm_sub_ps(threeHalves, _mm_mul_ps(_mm_mul_ps(half, sinSqr), _mm_mul_ps(invSinom, invSinom))));
+        const __m128 omega = ATan16(_mm_mul_ps(sinSqr, invSinom), cosom);
+
+        const __m128 slerpMask = _mm_cmpgt_ps(_mm_sub_ps(one, cosom), slerpEpsilon);
+        __m128 scale0 = Select(slerpMask, _mm_mul_ps(Sin16(_mm_mul_ps(oneMinusT, omega)), invSinom), oneMinusT);
+        __m128 scale1 = Select(slerpMask, _mm_mul_ps(Sin16(_mm_mul_ps(t, omega)), invSinom), t);
+        scale1 = _mm_xor_ps(scale1, sign);
+
+        scale0 = Select(fromMask, one, Select(toMask, _mm_setzero_ps(), scale0));
+        scale1 = Select(fromMask, _mm_setzero_ps(), Select(toMask, one, scale1));
+
+        __m128 qx = _mm_add_ps(_mm_mul_ps(x1, scale0), _mm_mul_ps(x2, scale1));
+        __m128 qy = _mm_add_ps(_mm_mul_ps(y1, scale0), _mm_mul_ps(y2, scale1));
+        __m128 qz = _mm_add_ps(_mm_mul_ps(z1, scale0), _mm_mul_ps(z2, scale1));
+        __m128 qw = _mm_add_ps(_mm_mul_ps(w1, scale0), _mm_mul_ps(w2, scale1));
+
+        // lerp translations and scales
+        __m128 tx = _mm_add_ps(c1[JointSampleGroup::Tx], _mm_mul_ps(t, _mm_sub_ps(c2[JointSampleGroup::Tx], c1[JointSampleGroup::Tx])));
+        __m128 ty = _mm_add_ps(c1[JointSampleGroup::Ty], _mm_mul_ps(t, _mm_sub_ps(c2[JointSampleGroup::Ty], c1[JointSampleGroup::Ty])));
+        __m128 tz = _mm_add_ps(c1[JointSampleGroup::Tz], _mm_mul_ps(t, _mm_sub_ps(c2[JointSampleGroup::Tz], c1[JointSampleGroup::Tz])));
+        __m128 sx = _mm_add_ps(c1[JointSampleGroup::Sx], _mm_mul_ps(t, _mm_sub_ps(c2[JointSampleGroup::Sx], c1[JointSampleGroup::Sx])));
+        const __m128 sy = _mm_add_ps(c1[JointSampleGroup::Sy], _mm_mul_ps(t, _mm_sub_ps(c2[JointSampleGroup::Sy], c1[JointSampleGroup::Sy])));
+        const __m128 sz = _mm_add_ps(c1[JointSampleGroup::Sz], _mm_mul_ps(t, _mm_sub_ps(c2[JointSampleGroup::Sz], c1[JointSampleGroup::Sz])));
+
+        // transpose to the joint poses, each joint pose is q.xyzw, t.xyz, s.xyz
+        _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+        _MM_TRANSPOSE4_PS(tx, ty, tz, sx);
+        const __m128 syz01 = _mm_unpacklo_ps(sy, sz);
+        const __m128 syz23 = _mm_unpackhi_ps(sy, sz);
+
+        float *dst0 = (float *)&joints[group.jointIndexes[0]];
+        float *dst1 = (float *)&joints[group.jointIndexes[1]];
+        float *dst2 = (float *)&joints[group.jointIndexes[2]];
+        float *dst3 = (float *)&joints[group.jointIndexes[3]];
+
+        _mm_storeu_ps(dst0, qx);
+        _mm_storeu_ps(dst0 + 4, tx);
+        _mm_storel_pi((__m64 *)(dst0 + 8), syz01);
+        _mm_storeu_ps(dst1, qy);
+        _mm_storeu_ps(dst1 + 4, ty);
+        _mm_storeh_pi((__m64 *)(dst1 + 8), syz01);
+        _mm_storeu_ps(dst2, qz);
+        _mm_storeu_ps(dst2 + 4, tz);
+        _mm_storel_pi((__m64 *)(dst2 + 8), syz23);
+        _mm_storeu_ps(dst3, qw);
+        _mm_storeu_ps(dst3 + 4, sx);
+        _mm_storeh_pi((__m64 *)(dst3 + 8), syz23);
+    }
+}
+
 #if 0
 
 static void SSE_Memcpy64B(void *dst, const void *src, const int count) {
@@ -16,6 +16,7 @@
 #include "Core/Heap.h"
 #include "Core/CVars.h"
 #include "Core/Cmds.h"
+#include "Core/Profiler.h"
 #include "Platform/PlatformTime.h"
 #include "Sound/SoundSystem.h"
 
@@ -220,6 +221,8 @@ Sound *SoundSystem::FindSound(const char *hashName) const {
 }
 
 Sound *SoundSystem::GetSound(const char *hashName) {
+    MemTagScope tagScope(MemTag::Sound);
+
     if (!initialized) {
         return nullptr;
     }
@@ -242,6 +245,9 @@ Sound *SoundSystem::GetSound(const char *hashName) {
 
 // TODO: SoundSystem::Update 함수를 별도 쓰레드로 바꿀것
 void SoundSystem::Update() {
+    BE_PROFILE_SCOPE("SoundSystem::Update");
+    MemTagScope tagScope(MemTag::Sound);
+
     static float lastTime = PlatformTime::Milliseconds();
     LinkList<Sound> *node;
     LinkList<Sound> *nextNode;
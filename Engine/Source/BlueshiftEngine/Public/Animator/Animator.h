@@ -82,7 +82,11 @@ public:
     bool                    SetParameterValue(const char *parmName, const float value);
 
                             // auto transitions happens in here
-    void                    UpdateFrame(Entity *entity, int previousTime, int currentTime);
+                            // If deferEvents is true, the events are called later in CallDeferredEvents()
+    void                    UpdateFrame(Entity *entity, int previousTime, int currentTime, bool deferEvents = false);
+
+                            /// Calls the events deferred in UpdateFrame()
+    void                    CallDeferredEvents(Entity *entity);
 
     void                    ClearAnimController();
     void                    SetAnimController(const Str &name);
@@ -107,12 +111,22 @@ public:
 
     void                    ResetState(int currentTime);
 
+                            /// Sets the number of the phase buckets in a normalized time cycle, 0 to disable.
+                            /// The poses are sampled at the start of the bucket, so the crowd animators in the same bucket share the poses in AnimPoseCache.
+    void                    SetPhaseBuckets(int phaseBuckets) { this->phaseBuckets = Max(phaseBuckets, 0); }
+    int                     GetPhaseBuckets() const { return phaseBuckets; }
+
+                            /// Snaps the normalized time to the phase bucket to sample the poses
+    float                   SnapToPhaseBucket(float normalizedTime) const;
+
     const AnimState *       CurrentAnimState(int layerNum) const;
     
     void                    TransitState(int layerNum, const char *stateName, int currentTime, float startOffset, int blendDuration, bool isAtomic);
 
                             // 모든 blending 을 계산한 current time 의 joint matrices 를 만든다 
-    void                    ComputeFrame(int currentTime);
+                            // If updateInterval is greater than 1, the poses are sampled every updateInterval frames ahead by updateInterval * frameTime,
+                            // and interpolated in between.
+    void                    ComputeFrame(int currentTime, int updateInterval = 1, int frameTime = 0);
 
                             // ComputeFrame() 결과 행렬들을 리턴
     Mat3x4 *                GetFrame() const { return jointMats; }
@@ -135,21 +149,43 @@ public:
     void                    GetMeshAABB(AABB &aabb) const { aabb = meshAABB; }
 
 private:
+    struct DeferredEvents {
+        AnimStateBlender    stateBlender;           // copy of the state blender at the time of UpdateFrame()
+        int                 fromTime;
+        int                 toTime;
+    };
+
     void                    PushStateBlenders(int layerNum, int currentTime, int blendDuration);
     void                    FreeData();
 
+                            // Blends all the layers to the joint poses, returns false if there is no anim
+    bool                    ComputePoses(int currentTime, JointPose *jointPoses) const;
+                            // Converts the joint poses to the joint matrices in jointMats
+    void                    ComputeJointMats(const JointPose *jointPoses);
+                            // Interpolates the two sampled poses of the reduced update rate
+    void                    InterpolateLodPoses(int currentTime, JointPose *jointPoses) const;
+
     AnimController *        animController;
     Array<AnimAABB>         animAABBs;
     AABB                    meshAABB;               // TEMP: to be replaced by animAABBs
 
     int                     numJoints;              // number of joints
     Mat3x4 *                jointMats;              // result of ComputeFrame() 
+    JointPose *             lodPoses;               // two sampled poses interpolated with the reduced update rate
+    Array<int>              lodJointIndexes;
+    int                     lodTimes[2];            // times of the two sampled poses
+    int                     lodFramesLeft;          // number of frames left to interpolate before sampling again
+    int                     lodPhase;               // spreads the first sampling of the reduced update rate across the frames
+    bool                    lodHasAnim;
+    int                     phaseBuckets;           // number of the phase buckets to snap the sampling time, 0 for no snapping
     AABB                    frameAABB;
     
     bool                    ignoreRootTranslation;
 
     Array<float>            parameters;
     AnimStateBlender        layerAnimStateBlenders[MaxLayers][MaxBlendersPerLayer];
+
+    Array<DeferredEvents>   deferredEvents;
 };
 
 BE_NAMESPACE_END
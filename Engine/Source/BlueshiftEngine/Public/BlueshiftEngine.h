@@ -47,6 +47,7 @@
 #include "Containers/HashMap.h"
 #include "Containers/Hierarchy.h"
 #include "Containers/BinSearch.h"
+#include "Containers/RadixSort.h"
 
 #include "Core/Timespan.h"
 #include "Core/DateTime.h"
@@ -76,6 +77,8 @@
 #include "Core/CVars.h"
 #include "Core/Cmds.h"
 #include "Core/Task.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
 #include "Core/Vertex.h"
 #include "Core/JointPose.h"
 
@@ -38,6 +38,9 @@ public:
 
     virtual bool            HasRenderEntity(int renderEntityHandle) const override;
 
+                            /// Returns the scene entity in the render world, nullptr if it is not added yet.
+    const SceneEntity *     GetRenderEntity() const;
+
     virtual const AABB      GetAABB() override;
 
     virtual bool            RayIntersection(const Vec3 &start, const Vec3 &dir, bool backFaceCull, float &lastScale) const override;
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "Core/Profiler.h"
 #include "Script/LuaVM.h"
 #include "Component.h"
 
@@ -92,6 +93,9 @@ protected:
 
 template <typename... Args>
 BE_INLINE void ComScript::CallFunc(const char *funcName, Args&&... args) {
+    BE_PROFILE_SCOPE("LuaVM::Call");
+    MemTagScope tagScope(MemTag::Script);
+
     auto func = sandbox[funcName];
     if (func.IsFunction()) {
         func(std::forward<Args>(args)...);
@@ -46,6 +46,15 @@ public:
 
     void                    UpdateAnimation(int time);
 
+                            /// Updates the animator and computes the joints and AABB of the current frame.
+                            /// Called in the jobs of GameWorld::UpdateAnimations(), so it touches nothing but this component.
+                            /// The joints are updated every updateInterval frames and interpolated in between,
+                            /// if updateInterval is 0, only the time and the AABB are updated.
+    void                    ComputeAnimationFrame(int updateInterval = 1);
+
+                            /// Calls the deferred animation events and updates the render entity after ComputeAnimationFrame().
+    void                    FinishAnimationFrame();
+
     Vec3                    GetTranslation(int currentTime) const;
 
     Vec3                    GetTranslationDelta(int fromTime, int toTime) const;
@@ -69,6 +78,8 @@ public:
 protected:
     void                    UpdateVisuals();
 
+    void                    ComputePose(int currentTime, int updateInterval = 1, int frameTime = 0);
+
     virtual void            MeshUpdated() override;
 
     void                    ChangeAnimationType();
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include "Core/Heap.h"
+
 /*
 -------------------------------------------------------------------------------
 
@@ -234,6 +236,10 @@ public:
     void            Swap(Array<T> &array);
 
 private:
+                    /// Allocates and default-constructs elements through Mem_* with MemTag::Containers.
+    static T *      AllocElements(int num);
+    static void     FreeElements(T *ptr, int num);
+
     int             count;          ///< Number of elements in use
     int             capacity;       ///< Size of elements allocated for
     int             granularity;    ///< Allocation granularity
@@ -370,18 +376,19 @@ BE_INLINE void Array<T>::Resize(int newCapacity) {
     }
 
     T *temp = elements;
+    const int oldCapacity = capacity;
     capacity = newCapacity;
     if (capacity < count) {
         count = capacity;
     }
 
-    elements = new T[capacity];
+    elements = AllocElements(capacity);
     for (int i = 0; i < count; i++) {
         elements[i] = temp[i];
     }
 
     if (temp) {
-        delete [] temp;
+        FreeElements(temp, oldCapacity);
     }
 }
 
@@ -398,18 +405,19 @@ BE_INLINE void Array<T>::Resize(int newCapacity, int newGranularity) {
     }
 
     T *temp = elements;
+    const int oldCapacity = capacity;
     capacity = newCapacity;
     if (capacity < count) {
         count = capacity;
     }
 
-    elements = new T[capacity];
+    elements = AllocElements(capacity);
     for (int i = 0; i < count; i++) {
         elements[i] = temp[i];
     }
 
     if (temp) {
-        delete [] temp;
+        FreeElements(temp, oldCapacity);
     }
 }
 
@@ -422,7 +430,7 @@ BE_INLINE Array<T> &Array<T>::operator=(const Array<T> &rhs) {
     granularity = rhs.granularity;
 
     if (capacity) {
-        elements = new T[capacity];
+        elements = AllocElements(capacity);
         for (int i = 0; i < count; i++) {
             elements[i] = rhs.elements[i];
         }
@@ -703,7 +711,7 @@ BE_INLINE T Array<T>::TakeAt(int index) {
 template <typename T> 
 BE_INLINE void Array<T>::Clear() {
     if (elements) {
-        delete [] elements;
+        FreeElements(elements, capacity);
     }
 
     elements = nullptr;
@@ -753,6 +761,24 @@ BE_INLINE void Array<T>::SortSubSection(int startIndex, int endIndex, Functor &&
     std::sort(&elements[startIndex], &elements[endIndex], std::forward<Functor>(compare));
 }
 
+template <typename T>
+BE_INLINE T *Array<T>::AllocElements(int num) {
+    MemTagScope tagScope(MemTag::Containers);
+    T *ptr = (T *)(alignof(T) > 16 ? Mem_Alloc32(num * sizeof(T)) : Mem_Alloc16(num * sizeof(T)));
+    for (int i = 0; i < num; i++) {
+        ::new (&ptr[i]) T;
+    }
+    return ptr;
+}
+
+template <typename T>
+BE_INLINE void Array<T>::FreeElements(T *ptr, int num) {
+    for (int i = 0; i < num; i++) {
+        ptr[i].~T();
+    }
+    Mem_AlignedFree(ptr);
+}
+
 template <typename T>
 BE_INLINE void Array<T>::Swap(Array<T> &array) {
     BE1::Swap(count, array.count);
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include "Core/Heap.h"
+
 /*
 -------------------------------------------------------------------------------
 
@@ -117,6 +119,9 @@ private:
                     /// Clears and allocates memory for use
     void            Allocate(const int newHashSize, const int newIndexSize);
 
+                    /// Allocates a table through Mem_* with MemTag::Containers.
+    static int *    AllocTable(int size);
+
     int             hashSize;           ///< hash size
     int *           hashTable;          ///< hash to index table
     int             indexSize;          ///< index size
@@ -135,32 +140,37 @@ BE_INLINE void HashIndex::SetGranularity(const int newGranularity) {
     granularity = newGranularity;
 }
 
+BE_INLINE int *HashIndex::AllocTable(int size) {
+    MemTagScope tagScope(MemTag::Containers);
+    return (int *)Mem_Alloc(size * sizeof(int));
+}
+
 BE_INLINE HashIndex &HashIndex::operator=(const HashIndex &rhs) {
     granularity = rhs.granularity;
     hashMask = rhs.hashMask;
     lookUpMask = rhs.lookUpMask;
 
     if (rhs.lookUpMask == 0) {
+        Free();
         hashSize = rhs.hashSize;
         indexSize = rhs.indexSize;
-        Free();
     } else {
         if (rhs.hashSize != hashSize || hashTable == EmptyTable) {
             if (hashTable != EmptyTable) {
-                delete [] hashTable;
+                Mem_Free(hashTable);
             }
             
             hashSize = rhs.hashSize;
-            hashTable = new int[hashSize];
+            hashTable = AllocTable(hashSize);
         }
 
         if (rhs.indexSize != indexSize || indexChain == EmptyTable) {
             if (indexChain != EmptyTable) {
-                delete [] indexChain;
+                Mem_Free(indexChain);
             }
 
             indexSize = rhs.indexSize;
-            indexChain = new int[indexSize];
+            indexChain = AllocTable(indexSize);
         }
         memcpy(hashTable, rhs.hashTable, hashSize * sizeof(hashTable[0]));
         memcpy(indexChain, rhs.indexChain, indexSize * sizeof(indexChain[0]));
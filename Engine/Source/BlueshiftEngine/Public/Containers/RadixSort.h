@@ -0,0 +1,47 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Radix Sort
+
+    LSD radix sort of 64 bit keys with 8 bit digits.
+    Keys are sorted together with a 32 bit index packed next to them,
+    so the caller can permute its own elements after sorting.
+    The sort is stable. Passes on which all keys have the same digit are skipped.
+
+-------------------------------------------------------------------------------
+*/
+
+BE_NAMESPACE_BEGIN
+
+/// Key and index of the element to be sorted
+struct RadixSortPair {
+    uint64_t                key;
+    uint32_t                index;
+    uint32_t                pad;
+};
+
+/// Sorts pairs in increasing order of keys.
+/// temp must be able to hold count pairs. The result is always stored in pairs.
+void BE_API                 RadixSort(RadixSortPair *pairs, RadixSortPair *temp, int count);
+
+/// Same as RadixSort but histogram and scatter steps are split over the job system.
+/// Falls back to RadixSort if count is less than minParallelCount.
+void BE_API                 ParallelRadixSort(RadixSortPair *pairs, RadixSortPair *temp, int count, int minParallelCount = 8192);
+
+BE_NAMESPACE_END
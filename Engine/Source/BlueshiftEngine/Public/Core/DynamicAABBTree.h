@@ -19,9 +19,16 @@
 
     Dynamic AABB Tree
 
+    Fat AABBs of the leaf proxies are also kept in SoA layout (centers and extents)
+    so that the frustum queries can cull the leaves in batches with SIMD.
+
+    Many proxies can be added at once with the bulk insertion which builds the tree
+    with the binned SAH (surface area heuristic) instead of inserting them one by one.
+
 -------------------------------------------------------------------------------
 */
 
+#include "Containers/Array.h"
 #include "Containers/Stack.h"
 #include "Math/Math.h"
 
@@ -45,6 +52,21 @@ public:
                     /// the function returns immediately. 
     bool            MoveProxy(int32_t proxyId, const AABB &aabb, float expansion, const Vec3 &displacement);
 
+                    /// Replace the AABB of a proxy keeping the tree structure. Cheaper than MoveProxy() for small changes
+                    /// but large ones degrade the tree quality. If deferRefit is true, the ancestors are not updated
+                    /// until Refit() is called.
+    void            RefitProxy(int32_t proxyId, const AABB &aabb, float expansion, bool deferRefit = false);
+
+                    /// Recompute the AABBs and heights of all the internal nodes bottom-up. O(N).
+    void            Refit();
+
+                    /// Proxies created after this are not inserted in the tree until EndBulkInsert().
+                    /// The tree should not be queried in between.
+    void            BeginBulkInsert();
+
+                    /// Build the tree with all the proxies including the ones created after BeginBulkInsert().
+    void            EndBulkInsert();
+
                     /// Get proxy user data.
     void *          GetUserData(int32_t proxyId) const;
 
@@ -64,11 +86,20 @@ public:
     int             GetMaxBalance() const;
 
                     /// Get the ratio of the sum of the node areas to the root area.
+                    /// This is the SAH cost of the tree with the unit traversal and intersection costs.
     float           GetAreaRatio() const;
 
                     /// Build an optimal tree. Very expensive. For testing.
     void            RebuildBottomUp();
 
+                    /// Build the tree from the current proxies with the binned SAH in O(N log N) time.
+                    /// Proxy ids are kept. Sub trees are built with the job system if parallel is true.
+    void            RebuildSAH(bool parallel = true);
+
+                    /// Rebuild the tree with RebuildSAH() if the area ratio has grown more than maxAreaRatioGrowth times
+                    /// since the last build. The area ratio is checked only after enough insertions. Returns true if rebuilt.
+    bool            RebuildIfDegraded(float maxAreaRatioGrowth);
+
     template <typename F>
     void            Query(const Sphere &boundingVolume, F &callback) const;
     template <typename F>
@@ -78,7 +109,28 @@ public:
     template <typename F>
     void            Query(const Frustum &boundingVolume, F &callback) const;
 
+                    /// Frustum query that collects the candidate leaves and culls them in batches with SIMD.
+    template <typename F>
+    void            QueryBatch(const Frustum &boundingVolume, F &callback) const;
+
+                    /// Frustum query that culls the sub trees in parallel with the job system.
+                    /// Callback is called on the calling thread after culling. Not reentrant.
+    template <typename F>
+    void            QueryParallel(const Frustum &boundingVolume, F &callback) const;
+
+                    /// Returns number of the proxies in the tree.
+    int             GetProxyCount() const { return (nodeCount + 1) / 2; }
+
 private:
+    enum {
+        BatchSize           = 64,       ///< Number of the leaves culled at once
+        MaxParallelSubtrees = 64,
+        NumSAHBins          = 16,
+        MaxSAHBuildDepth    = 48,       ///< Deeper ranges are split at the median to bound the tree height
+        ParallelBuildLeaves = 1024,     ///< Minimum number of the leaves to build the two sub trees in parallel
+        RebuildCheckInterval = 256      ///< Minimum number of the insertions between the area ratio checks
+    };
+
     int             AllocNode();
     void            FreeNode(int32_t node);
 
@@ -93,6 +145,22 @@ private:
     void            ValidateStructure(int32_t index) const;
     void            ValidateMetrics(int32_t index) const;
 
+    void            UpdateLeafBounds(int32_t leaf);
+
+    int32_t         BuildSAH(int32_t *leafIds, int begin, int end, const int32_t *internalNodes, int depth, bool parallel);
+
+                    /// Converts the frustum to 6 world space planes (normal, w) with the outside as the front side.
+    static void     FrustumToCullPlanes(const Frustum &frustum, Vec4 planes[6]);
+    static bool     CullAABBByPlanes(const Vec4 planes[6], const AABB &aabb);
+
+                    /// Culls the leaves and compacts the visible ones to the front. Returns number of the visible leaves.
+    int             CullLeaves(const Vec4 planes[6], int32_t *leafIds, int count) const;
+
+    int             CullParallel(const Vec4 planes[6]) const;
+
+    template <typename F>
+    bool            QueryBatch(int32_t startNode, const Vec4 planes[6], F &callback) const;
+
     struct Node {
         bool        IsLeaf() const { return child1 == -1; }
         
@@ -113,7 +181,13 @@ private:
     int32_t         nodeCapacity;
     int32_t         freeList;
     Node *          nodes;
+    float *         leafBounds;         // center x, y, z and extents x, y, z arrays of nodeCapacity floats
     int             insertionCount;
+    bool            bulkInsert;
+    float           builtAreaRatio;     // area ratio right after the last RebuildSAH()
+    int             checkedInsertionCount;
+
+    mutable Array<int32_t> subtreeLeaves[MaxParallelSubtrees];  // visible leaves of each sub tree in QueryParallel
 };
 
 BE_INLINE void *DynamicAABBTree::GetUserData(int32_t proxyId) const {
@@ -241,4 +315,77 @@ BE_INLINE void DynamicAABBTree::Query(const Frustum &frustum, F &callback) const
     }
 }
 
+template <typename F>
+BE_INLINE bool DynamicAABBTree::QueryBatch(int32_t startNode, const Vec4 planes[6], F &callback) const {
+    int32_t candidates[BatchSize];
+    int numCandidates = 0;
+
+    Stack<int32_t> stack(256);
+    stack.Push(startNode);
+
+    while (!stack.IsEmpty()) {
+        int32_t nodeId = stack.Pop();
+        if (nodeId == -1) {
+            continue;
+        }
+
+        const Node *node = nodes + nodeId;
+
+        // Leaves are tested later in batches
+        if (node->IsLeaf()) {
+            candidates[numCandidates++] = nodeId;
+
+            if (numCandidates == BatchSize) {
+                int numVisible = CullLeaves(planes, candidates, numCandidates);
+                for (int i = 0; i < numVisible; i++) {
+                    if (!callback(candidates[i])) {
+                        return false;
+                    }
+                }
+                numCandidates = 0;
+            }
+            continue;
+        }
+
+        if (!CullAABBByPlanes(planes, node->aabb)) {
+            stack.Push(node->child1);
+            stack.Push(node->child2);
+        }
+    }
+
+    int numVisible = CullLeaves(planes, candidates, numCandidates);
+    for (int i = 0; i < numVisible; i++) {
+        if (!callback(candidates[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename F>
+BE_INLINE void DynamicAABBTree::QueryBatch(const Frustum &frustum, F &callback) const {
+    Vec4 planes[6];
+    FrustumToCullPlanes(frustum, planes);
+
+    QueryBatch(root, planes, callback);
+}
+
+template <typename F>
+BE_INLINE void DynamicAABBTree::QueryParallel(const Frustum &frustum, F &callback) const {
+    Vec4 planes[6];
+    FrustumToCullPlanes(frustum, planes);
+
+    int numSubtrees = CullParallel(planes);
+
+    for (int subtreeIndex = 0; subtreeIndex < numSubtrees; subtreeIndex++) {
+        const Array<int32_t> &leaves = subtreeLeaves[subtreeIndex];
+
+        for (int i = 0; i < leaves.Count(); i++) {
+            if (!callback(leaves[i])) {
+                return;
+            }
+        }
+    }
+}
+
 BE_NAMESPACE_END
@@ -19,6 +19,19 @@
 
     Heap memory management
 
+    With BE_MEMORY_TRACKING, every block allocated by Mem_* carries a small
+    header with its size and the allocation tag of the calling thread.
+    Per-tag live/peak bytes and allocation counts are kept with atomic
+    counters, so it is cheap enough to be left on in release builds.
+
+    Memory not allocated by Mem_* (the Lua VM) is accounted by calling
+    Mem_TrackAlloc/Mem_TrackFree with an explicit tag.
+
+    Mem_* allocates blocks up to 2 KB from the built-in small object allocator
+    (size-class slabs with thread-local free caches) unless the system
+    allocator is selected with Mem_SetAllocator. Bigger blocks always come
+    from malloc.
+
 -------------------------------------------------------------------------------
 */
 
@@ -26,6 +39,87 @@ BE_NAMESPACE_BEGIN
 
 //#define DEBUG_MEMORY
 
+#ifndef BE_MEMORY_TRACKING
+#define BE_MEMORY_TRACKING      1
+#endif
+
+struct MemTag {
+    enum Enum {
+        General,
+        Render,
+        Anim,
+        Physics,
+        Script,
+        Asset,
+        Sound,
+        Containers,
+        Str,
+        Count
+    };
+};
+
+struct MemTagStats {
+    const char *            name;
+    int64_t                 liveBytes;
+    int64_t                 peakBytes;
+    int64_t                 liveAllocs;
+    int64_t                 totalAllocs;
+    int                     frameAllocs;        // allocations in the last frame
+    int                     frameFrees;         // frees in the last frame
+};
+
+                            /// Sets the allocation tag of the calling thread, returns the previous one.
+MemTag::Enum BE_API         Mem_SetTag(MemTag::Enum tag);
+MemTag::Enum BE_API         Mem_GetTag();
+
+                            /// Accounts memory which is not allocated by Mem_*.
+void BE_API                 Mem_TrackAlloc(MemTag::Enum tag, size_t size);
+void BE_API                 Mem_TrackFree(MemTag::Enum tag, size_t size);
+
+                            /// Rolls the per-frame allocation counts. Called once per frame.
+void BE_API                 Mem_SyncFrame();
+
+                            /// Fills stats[MemTag::Count].
+void BE_API                 Mem_GetTagStats(MemTagStats *stats);
+
+void BE_API                 Mem_PrintStats();
+
+                            /// Writes per-tag stats in CSV format.
+bool BE_API                 Mem_WriteStats(const char *filename);
+
+struct MemAllocator {
+    enum Enum {
+        System,                 ///< malloc/free
+        SmallObject             ///< Small object allocator for blocks up to 2 KB, malloc for bigger ones
+    };
+};
+
+struct MemAllocatorStats {
+    int                     numSegments;
+    int                     numPages;
+    int64_t                 reservedBytes;      // reserved by the small object allocator
+};
+
+                            /// Selects the allocator for the following allocations, usually before Engine::InitBase().
+                            /// Blocks allocated before are still freed by the allocator they came from.
+void BE_API                 Mem_SetAllocator(MemAllocator::Enum allocator);
+MemAllocator::Enum BE_API   Mem_GetAllocator();
+
+                            /// Gives back the free blocks cached by the calling thread. Should be called before a thread exits.
+void BE_API                 Mem_ThreadExit();
+
+void BE_API                 Mem_GetAllocatorStats(MemAllocatorStats *stats);
+
+// Sets the allocation tag of the calling thread for the scope
+class MemTagScope {
+public:
+    MemTagScope(MemTag::Enum tag) { prevTag = Mem_SetTag(tag); }
+    ~MemTagScope() { Mem_SetTag(prevTag); }
+
+private:
+    MemTag::Enum            prevTag;
+};
+
 #ifndef DEBUG_MEMORY
 
 void * BE_API       Mem_Alloc(size_t size);
@@ -0,0 +1,190 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Job System
+
+    Work-stealing job scheduler. Every worker (including the thread that called
+    JobSystem::Init) owns a lock-free job queue. Workers push and pop jobs at the
+    bottom of their own queue and steal from the top of the others.
+
+    Jobs can be grouped by creating them as children of a parent job.
+    A parent job is finished only when all of its children are finished,
+    so waiting on a parent (or an empty group job) waits on the whole tree.
+
+    Jobs are allocated from a per-worker ring buffer and recycled without being freed.
+    Only finished job slots are reused, so no more than MaxJobsPerWorker jobs may be
+    in flight per worker. ParallelFor processes a sub range inline instead of splitting
+    it further when the ring is full.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Platform/Intrinsics.h"
+
+BE_NAMESPACE_BEGIN
+
+struct Job;
+
+typedef void (*jobFunction_t)(Job *job, const void *data);
+
+struct Job {
+    enum {
+        MaxDataSize         = 64 - sizeof(jobFunction_t) - sizeof(Job *) - sizeof(atomic_t)
+    };
+
+    jobFunction_t           function;
+    Job *                   parent;
+    volatile atomic_t       unfinishedJobs;
+    char                    data[MaxDataSize];  ///< Inline user data, padded to a cache line
+};
+
+class BE_API JobSystem {
+public:
+    enum {
+        MaxWorkers          = 64,
+        MaxJobsPerWorker    = 4096,     // must be power of two
+        MinSplitsPerWorker  = 8         // ParallelFor never splits into more than numWorkers * MinSplitsPerWorker sub ranges
+    };
+
+                            /// Creates worker threads. numWorkers includes the calling thread.
+                            /// If numWorkers is negative, it is set to the number of logical processors.
+    static void             Init(int numWorkers = -1);
+    static void             Shutdown();
+
+                            /// Returns number of workers including the main thread.
+    static int              NumWorkers() { return numWorkers; }
+
+                            /// Returns index of the worker running on the calling thread. The main thread is always 0.
+                            /// Returns -1 if the calling thread is not owned by the job system.
+    static int              WorkerIndex();
+
+                            /// Creates a job. data is copied into the job.
+                            /// The job ring of the calling thread must not be full.
+    static Job *            CreateJob(jobFunction_t function, const void *data = nullptr, size_t dataSize = 0);
+
+                            /// Creates a child job of the given parent.
+                            /// The parent job will not be finished until this job is finished.
+    static Job *            CreateChildJob(Job *parent, jobFunction_t function, const void *data = nullptr, size_t dataSize = 0);
+
+                            /// Creates an empty job which can be used as a parent to group other jobs.
+                            /// The group must be Run after its children are created, and then can be waited on.
+    static Job *            CreateGroup() { return CreateJob(nullptr); }
+
+                            /// Pushes the job into the queue of the calling worker.
+                            /// The job is executed immediately if the calling thread is not a worker.
+    static void             Run(Job *job);
+
+                            /// Waits until the job and all of its children are finished.
+                            /// The calling thread executes other jobs while waiting.
+    static void             Wait(const Job *job);
+
+                            /// Returns true if the job and all of its children are finished.
+    static bool             IsFinished(const Job *job) { return job->unfinishedJobs == 0; }
+
+                            /// Calls function(rangeBegin, rangeEnd) over sub ranges of [begin, end) in parallel,
+                            /// splitting until each sub range has no more than grain elements.
+                            /// grain is clamped so that the range is never split into more than numWorkers * MinSplitsPerWorker sub ranges.
+                            /// Returns when the whole range has been processed.
+    template <typename Function>
+    static void             ParallelFor(int begin, int end, int grain, const Function &function);
+
+private:
+    template <typename Function>
+    struct ParallelForData {
+        const Function *    function;
+        int                 begin;
+        int                 end;
+        int                 grain;
+    };
+
+    template <typename Function>
+    static void             ParallelForJob(Job *job, const void *data);
+
+                            /// Returns nullptr if there is no finished job slot left in the job ring of the calling thread.
+    static Job *            TryCreateJob(Job *parent, jobFunction_t function, const void *data, size_t dataSize);
+
+    static void             Execute(Job *job);
+    static void             Finish(Job *job);
+
+    static int              numWorkers;
+
+    friend void             JobWorker_ThreadProc(void *param);
+};
+
+template <typename Function>
+BE_INLINE void JobSystem::ParallelForJob(Job *job, const void *data) {
+    const ParallelForData<Function> *forData = (const ParallelForData<Function> *)data;
+
+    if (forData->end - forData->begin > forData->grain) {
+        const int mid = forData->begin + (forData->end - forData->begin) / 2;
+
+        ParallelForData<Function> leftData = { forData->function, forData->begin, mid, forData->grain };
+        ParallelForData<Function> rightData = { forData->function, mid, forData->end, forData->grain };
+
+        Job *leftJob = TryCreateJob(job, ParallelForJob<Function>, &leftData, sizeof(leftData));
+        if (!leftJob) {
+            // Job ring is full, process the whole sub range here
+            (*forData->function)(forData->begin, forData->end);
+            return;
+        }
+        Run(leftJob);
+
+        Job *rightJob = TryCreateJob(job, ParallelForJob<Function>, &rightData, sizeof(rightData));
+        if (!rightJob) {
+            (*forData->function)(rightData.begin, rightData.end);
+            return;
+        }
+        Run(rightJob);
+    } else {
+        (*forData->function)(forData->begin, forData->end);
+    }
+}
+
+template <typename Function>
+BE_INLINE void JobSystem::ParallelFor(int begin, int end, int grain, const Function &function) {
+    if (end <= begin) {
+        return;
+    }
+
+    // Don't split into more sub ranges than the workers can usefully consume
+    grain = Max(grain, (end - begin) / (numWorkers * MinSplitsPerWorker));
+    if (grain < 1) {
+        grain = 1;
+    }
+
+    // Run it directly on the calling thread if there is nothing to split
+    if (numWorkers <= 1 || end - begin <= grain) {
+        function(begin, end);
+        return;
+    }
+
+    static_assert(sizeof(ParallelForData<Function>) <= Job::MaxDataSize, "ParallelForData too big");
+
+    ParallelForData<Function> forData = { &function, begin, end, grain };
+
+    Job *root = TryCreateJob(nullptr, ParallelForJob<Function>, &forData, sizeof(forData));
+    if (!root) {
+        function(begin, end);
+        return;
+    }
+    Run(root);
+    Wait(root);
+}
+
+BE_NAMESPACE_END
@@ -214,4 +214,104 @@ BE_INLINE Vec3 CompressedJointPose::ToScale() const {
     return Vec3(ShortToScale(t[0]), ShortToScale(t[1]), ShortToScale(t[2]));
 }
 
+/*
+-------------------------------------------------------------------------------
+
+    QuantizedJointKey
+
+    Key of the compressed animation tracks packed in three 16-bit words.
+    Rotation keys are the smallest three components of the quaternion with 15 bits each,
+    and the index of the largest component in the lowest bits of the first two words.
+    Translation and scale keys are quantized relative to the range of each track.
+
+-------------------------------------------------------------------------------
+*/
+
+class BE_API QuantizedJointKey {
+public:
+    static void         QuantizeQuat(const Quat &q, uint16_t *key);
+    static Quat         DequantizeQuat(const uint16_t *key);
+    static void         QuantizeVec3(const Vec3 &v, const Vec3 &rangeMin, const Vec3 &rangeScale, uint16_t *key);
+    static Vec3         DequantizeVec3(const uint16_t *key, const Vec3 &rangeMin, const Vec3 &rangeScale);
+};
+
+BE_INLINE void QuantizedJointKey::QuantizeQuat(const Quat &q, uint16_t *key) {
+    int largest = 0;
+    for (int i = 1; i < 4; i++) {
+        if (Math::Fabs(q[i]) > Math::Fabs(q[largest])) {
+            largest = i;
+        }
+    }
+
+    // q and -q are the same rotation, so the largest component is always positive
+    const float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+    for (int i = 0, n = 0; i < 4; i++) {
+        if (i == largest) {
+            continue;
+        }
+        // the smallest three components are in range [-1/sqrt(2), 1/sqrt(2)]
+        const float c = Clamp(q[i] * sign, -0.70710678f, 0.70710678f);
+        key[n++] = (uint16_t)(Math::Ftoi((c + 0.70710678f) * (32767.0f / 1.41421356f) + 0.5f) << 1);
+    }
+
+    key[0] |= largest & 1;
+    key[1] |= largest >> 1;
+}
+
+BE_INLINE Quat QuantizedJointKey::DequantizeQuat(const uint16_t *key) {
+    const int largest = (key[0] & 1) | ((key[1] & 1) << 1);
+    float c[4];
+
+    for (int i = 0; i < 3; i++) {
+        c[i] = (key[i] >> 1) * (1.41421356f / 32767.0f) - 0.70710678f;
+    }
+    c[3] = Math::Sqrt(Max(1.0f - (c[0] * c[0] + c[1] * c[1] + c[2] * c[2]), 0.0f));
+
+    Quat q;
+    for (int i = 0, n = 0; i < 4; i++) {
+        q[i] = i == largest ? c[3] : c[n++];
+    }
+    return q;
+}
+
+BE_INLINE void QuantizedJointKey::QuantizeVec3(const Vec3 &v, const Vec3 &rangeMin, const Vec3 &rangeScale, uint16_t *key) {
+    for (int i = 0; i < 3; i++) {
+        key[i] = rangeScale[i] > 0.0f ? (uint16_t)Clamp(Math::Ftoi((v[i] - rangeMin[i]) / rangeScale[i] + 0.5f), 0, 65535) : 0;
+    }
+}
+
+BE_INLINE Vec3 QuantizedJointKey::DequantizeVec3(const uint16_t *key, const Vec3 &rangeMin, const Vec3 &rangeScale) {
+    return Vec3(rangeMin[0] + rangeScale[0] * key[0], rangeMin[1] + rangeScale[1] * key[1], rangeMin[2] + rangeScale[2] * key[2]);
+}
+
+/*
+-------------------------------------------------------------------------------
+
+    JointSampleGroup
+
+    Sampling plan of four animated joints in SoA layout for SIMDProcessor::SampleJoints.
+    Each component of the joint pose has the offset into the frame components and the mask
+    to select between the animated value and the base frame value, so the joints are sampled
+    without any branch on the animated components. The unused lanes of the last group repeat
+    the last joint.
+
+-------------------------------------------------------------------------------
+*/
+
+struct JointSampleGroup {
+    enum Component {
+        Tx, Ty, Tz,
+        Qx, Qy, Qz,
+        Sx, Sy, Sz,
+        NumComponents
+    };
+
+    int32_t             componentOffsets[NumComponents][4]; ///< offsets into the frame components, 0 if not animated
+    int32_t             componentMasks[NumComponents][4];   ///< ~0 if the component is animated
+    int32_t             rotationMasks[4];                   ///< ~0 if any rotation component is animated, w is recomputed
+    float               baseComponents[NumComponents + 1][4]; ///< tx ty tz qx qy qz sx sy sz qw of the base frame
+    int32_t             jointIndexes[4];
+};
+
 BE_NAMESPACE_END
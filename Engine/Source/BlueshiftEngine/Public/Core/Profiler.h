@@ -0,0 +1,135 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Profiler
+
+    Hierarchical CPU scope profiler. Every thread records the scopes it closes
+    into its own ring buffer, so recording takes no lock. Timestamps are taken
+    with PlatformTime::Cycles(), the high resolution monotonic counter of
+    each platform (QueryPerformanceCounter, mach_absolute_time or
+    CLOCK_MONOTONIC).
+
+    Markers are named statically with BE_PROFILE_SCOPE("name") and registered
+    once by name, so the same name used in several places shares one marker.
+
+    SyncFrame() marks the frame boundary. It gathers the scopes recorded in the
+    last frame into per-marker frame histories used by the on-screen overlay.
+    DumpChromeTrace() writes all the events left in the ring buffers as a
+    Chrome trace_event JSON file (chrome://tracing).
+
+    Define BE_PROFILER to 0 to compile out all the scopes.
+
+-------------------------------------------------------------------------------
+*/
+
+#ifndef BE_PROFILER
+#define BE_PROFILER         1
+#endif
+
+BE_NAMESPACE_BEGIN
+
+class CmdArgs;
+
+class BE_API Profiler {
+public:
+    enum {
+        MaxThreads          = 64,
+        MaxMarkers          = 1024,
+        MaxDepth            = 64,
+        MaxEventsPerThread  = 16384,    // must be power of two
+        MaxFrameHistory     = 64        // must be power of two
+    };
+
+    struct MarkerStats {
+        const char *        name;
+        float               lastMsec;   ///< Time spent in the last frame, summed over all threads
+        float               avgMsec;    ///< Average time per frame over the frame history
+        float               maxMsec;    ///< Peak time per frame over the frame history
+        int                 lastCalls;  ///< Number of calls in the last frame
+    };
+
+    static void             Init();
+    static void             Shutdown();
+
+    static bool             IsEnabled() { return enabled; }
+                            /// Starts or stops recording. Recorded events are kept until the next start.
+    static void             SetEnabled(bool enable);
+
+                            /// Returns a marker index for the given name. The name must be a static string.
+    static int              RegisterMarker(const char *name);
+
+                            /// Sets the name of the calling thread shown in the trace.
+    static void             SetThreadName(const char *name);
+
+    static void             PushScope(int markerIndex);
+    static void             PopScope();
+
+                            /// Marks the end of the current frame. Should be called once per frame on the main thread.
+    static void             SyncFrame();
+
+                            /// Returns index of the current frame.
+    static int              FrameIndex() { return frameIndex; }
+
+                            /// Fills the stats of the markers which were recorded during the frame history, sorted by average time.
+    static int              GetMarkerStats(MarkerStats *stats, int maxStats);
+
+                            /// Returns average and peak frame time over the frame history.
+    static void             GetFrameTimes(float &avgMsec, float &maxMsec);
+
+                            /// Writes the recorded events in Chrome trace_event JSON format.
+    static bool             DumpChromeTrace(const char *filename);
+
+private:
+    static void             Cmd_ProfileStart(const CmdArgs &args);
+    static void             Cmd_ProfileStop(const CmdArgs &args);
+    static void             Cmd_ProfileDump(const CmdArgs &args);
+
+    static volatile bool    enabled;
+    static int              frameIndex;
+};
+
+class ProfileScope {
+public:
+    ProfileScope(int markerIndex) { 
+        recorded = Profiler::IsEnabled();
+        if (recorded) {
+            Profiler::PushScope(markerIndex);
+        }
+    }
+    ~ProfileScope() { 
+        if (recorded) {
+            Profiler::PopScope();
+        }
+    }
+
+private:
+    bool                    recorded;
+};
+
+BE_NAMESPACE_END
+
+#if BE_PROFILER
+#define BE_PROFILE_CONCAT_INNER(a, b)   a##b
+#define BE_PROFILE_CONCAT(a, b)         BE_PROFILE_CONCAT_INNER(a, b)
+#define BE_PROFILE_SCOPE(name) \
+    static const int BE_PROFILE_CONCAT(profileMarker, __LINE__) = BE1::Profiler::RegisterMarker(name); \
+    BE1::ProfileScope BE_PROFILE_CONCAT(profileScope, __LINE__)(BE_PROFILE_CONCAT(profileMarker, __LINE__))
+#else
+#define BE_PROFILE_SCOPE(name)
+#endif
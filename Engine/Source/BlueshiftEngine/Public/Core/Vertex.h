@@ -354,6 +354,86 @@ BE_INLINE uint32_t VertexLightingGeneric::GetColor() const {
     return *reinterpret_cast<const uint32_t *>(this->color);
 }
 
+/*
+-------------------------------------------------------------------------------
+
+    VertexCompact : quantized vertex for static meshes
+
+    Position is quantized to 16 bits relative to the sub mesh bounds,
+    and dequantized in the vertex programs with positionScale/positionBias.
+    Normal and tangent are packed in 32 bits : octahedral normal in 2 bytes,
+    tangent angle around the normal in 1 byte and bitangent sign in 1 byte.
+
+-------------------------------------------------------------------------------
+*/
+
+struct VertexCompact {
+    int16_t         xyz[4];             // w is always 32767 so that the vertex programs get 1.0
+    float16_t       st[2];
+    byte            normalTangent[4];
+    byte            color[4];
+};
+
+// Orthonormal basis around the normal (Duff et al. 2017, Building an Orthonormal Basis, Revisited).
+// Must be same as the one in the vertex programs.
+BE_INLINE void CompactTangentBasis(const Vec3 &n, Vec3 &b1, Vec3 &b2) {
+    const float s = n.z >= 0.0f ? 1.0f : -1.0f;
+    const float a = -1.0f / (s + n.z);
+    const float b = n.x * n.y * a;
+    b1.Set(1.0f + s * n.x * n.x * a, s * b, -s * n.x);
+    b2.Set(b, s + n.y * n.y * a, -n.y);
+}
+
+BE_INLINE void DecodeCompactNormal(const byte *normalTangent, Vec3 &normal) {
+    const float ex = BYTE_TO_SIGNED_FLOAT(normalTangent[0]);
+    const float ey = BYTE_TO_SIGNED_FLOAT(normalTangent[1]);
+
+    normal.Set(ex, ey, 1.0f - Math::Fabs(ex) - Math::Fabs(ey));
+    if (normal.z < 0.0f) {
+        normal.x = (1.0f - Math::Fabs(ey)) * (ex >= 0.0f ? 1.0f : -1.0f);
+        normal.y = (1.0f - Math::Fabs(ex)) * (ey >= 0.0f ? 1.0f : -1.0f);
+    }
+    normal.Normalize();
+}
+
+BE_INLINE void DecodeCompactNormalTangent(const byte *normalTangent, Vec3 &normal, Vec3 &tangent, float &bitangentSign) {
+    DecodeCompactNormal(normalTangent, normal);
+
+    Vec3 b1, b2;
+    CompactTangentBasis(normal, b1, b2);
+
+    const float angle = normalTangent[2] * (Math::TwoPi / 256.0f);
+    tangent = b1 * Math::Cos(angle) + b2 * Math::Sin(angle);
+
+    bitangentSign = normalTangent[3] < 128 ? -1.0f : 1.0f;
+}
+
+// tangent must be orthogonal to normal
+BE_INLINE void EncodeCompactNormalTangent(const Vec3 &normal, const Vec3 &tangent, float bitangentSign, byte *normalTangent) {
+    const float invL1Norm = 1.0f / (Math::Fabs(normal.x) + Math::Fabs(normal.y) + Math::Fabs(normal.z));
+    float ex = normal.x * invL1Norm;
+    float ey = normal.y * invL1Norm;
+    if (normal.z < 0.0f) {
+        const float x = ex;
+        ex = (1.0f - Math::Fabs(ey)) * (x >= 0.0f ? 1.0f : -1.0f);
+        ey = (1.0f - Math::Fabs(x)) * (ey >= 0.0f ? 1.0f : -1.0f);
+    }
+    normalTangent[0] = SIGNED_FLOAT_TO_BYTE(ex);
+    normalTangent[1] = SIGNED_FLOAT_TO_BYTE(ey);
+
+    // Tangent angle is measured around the decoded normal, so decoding gives the same basis
+    Vec3 decodedNormal, b1, b2;
+    DecodeCompactNormal(normalTangent, decodedNormal);
+    CompactTangentBasis(decodedNormal, b1, b2);
+
+    float angle = Math::ATan(tangent.Dot(b2), tangent.Dot(b1));
+    if (angle < 0.0f) {
+        angle += Math::TwoPi;
+    }
+    normalTangent[2] = (byte)((int)(angle * (256.0f / Math::TwoPi) + 0.5f) & 255);
+    normalTangent[3] = bitangentSign < 0.0f ? 0 : 255;
+}
+
 /*
 -------------------------------------------------------------------------------
 
@@ -35,6 +35,7 @@ class PhysicsWorld;
 class Prefab;
 class TagLayerSettings;
 class PhysicsSettings;
+class ComSkinnedMeshRenderer;
 
 class GameWorld : public Object {
     friend class GameEdit;
@@ -97,6 +98,10 @@ public:
     void                        UnregisterEntity(Entity *ent);
 
     Entity *                    CloneEntity(const Entity *originalEntity);
+
+                                // Registers the skinned mesh to compute its animation in the animation stage of this frame
+    void                        RegisterAnimation(ComSkinnedMeshRenderer *skinnedMeshRenderer);
+    void                        UnregisterAnimation(ComSkinnedMeshRenderer *skinnedMeshRenderer);
     
     bool                        SpawnEntityFromJson(Json::Value &entityValue, Entity **ent = nullptr);
     void                        SpawnEntitiesFromJson(Json::Value &entitiesValue);
@@ -138,6 +143,9 @@ private:
     void                        SaveObject(const char *filename, const Object *object) const;
     void                        ClearAllEntities();
     void                        UpdateEntities();   
+    void                        UpdateAnimations();
+    void                        CollectAnimationLodViews();
+    int                         AnimationUpdateInterval(const ComSkinnedMeshRenderer *skinnedMeshRenderer) const;
 
     Entity *                    entities[MaxEntities];
     HashIndex                   entityHash;
@@ -147,6 +155,16 @@ private:
     int                         spawnCount;
     Hierarchy<Entity>           entityHierarchy;
 
+    Array<ComSkinnedMeshRenderer *> pendingAnimations;  // skinned meshes registered in the Update() of this frame
+
+    struct AnimationLodView {
+        Vec3                    origin;
+        float                   projectionScale;    // 1 / tan(fovY / 2) for the perspective view
+        float                   orthogonalSize;     // half height of the orthogonal view, 0 for the perspective view
+    };
+    Array<AnimationLodView>     animationLodViews;  // camera views to select the animation LOD
+    int                         animationViewCount; // render world view count at the last animation update
+
     Json::Value                 snapshotValues;
 
     Str                         mapName;
@@ -43,6 +43,7 @@ private:
     static void     Cmd_Version(const CmdArgs &args);
     static void     Cmd_Error(const CmdArgs &args);
     static void     Cmd_Quit(const CmdArgs &args);
+    static void     Cmd_MemStats(const CmdArgs &args);
 };
 
 extern Common       common;
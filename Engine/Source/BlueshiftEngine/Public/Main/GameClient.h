@@ -101,6 +101,8 @@ private:
     void                DrawConsoleScreen();
     void                DrawConsoleNotify();
     void                DrawConsoleCmdLine();
+
+    void                DrawProfiler();
     
     ClientState         state;
 
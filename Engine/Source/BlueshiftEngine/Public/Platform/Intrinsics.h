@@ -136,6 +136,16 @@ BE_FORCE_INLINE void __cpuid(int out[4], int op) {
     asm volatile ("cpuid" : "=a"(out[0]), "=b"(out[1]), "=c"(out[2]), "=d"(out[3]) : "a"(op));
 }
 
+BE_FORCE_INLINE void __cpuidex(int out[4], int op, int subop) {
+    asm volatile ("cpuid" : "=a"(out[0]), "=b"(out[1]), "=c"(out[2]), "=d"(out[3]) : "a"(op), "c"(subop));
+}
+
+BE_FORCE_INLINE uint64_t __xgetbv(uint32_t index) {
+    uint32_t eax, edx;
+    asm volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    return (((uint64_t)edx) << 32) + (uint64_t)eax;
+}
+
 BE_FORCE_INLINE uint64_t __rdtsc()  {
     uint32_t high,low;
     asm volatile ("rdtsc" : "=d"(high), "=a"(low));
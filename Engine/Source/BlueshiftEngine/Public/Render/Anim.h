@@ -62,6 +62,22 @@ public:
         int32_t             firstComponent;
     };
 
+    enum TrackType {
+        TranslationTrack,
+        RotationTrack,
+        ScaleTrack,
+        NumTrackTypes
+    };
+
+    /// Keys of the compressed track are stored in keyFrameNums and keyValues from firstKey.
+    /// Translation and scale keys are dequantized by rangeMin + rangeScale * key.
+    struct CompressedTrack {
+        int32_t             firstKey;
+        int32_t             numKeys;        // 0 means the track is not animated and uses the base frame
+        Vec3                rangeMin;
+        Vec3                rangeScale;
+    };
+
     struct FrameInterpolation {
         int32_t             frame1;
         int32_t             frame2;
@@ -97,6 +113,17 @@ public:
                             /// Returns movement delta of root joint
     const Vec3 &            TotalMovementDelta() const { return totalDelta; }
 
+                            /// Returns true if the frames are stored as the compressed tracks
+    bool                    IsCompressed() const { return isCompressed; }
+
+                            /// Compresses the frames to the quantized tracks and removes the keys that can be interpolated.
+                            /// maxError is the maximum position error in world space of the joints and the virtual vertices 
+                            /// at skinDistance away from the each joint, accumulated along the joint hierarchy.
+    void                    Compress(float maxError = CentiToUnit(0.01f), float skinDistance = CentiToUnit(3.0f));
+
+                            /// Restores the frames from the compressed tracks.
+    void                    Decompress();
+
                             /// Returns total size of allocated memory
     size_t                  Allocated() const;
                             /// Returns total size of allocated memory including size of this type
@@ -153,6 +180,11 @@ private:
 
     void                    ComputeTimeFrames();
 
+    void                    ComputeSamplingPlan();
+
+    void                    GetRawFrame(int frameNum, JointPose *joints) const;
+    void                    GetCompressedFrame(float framePos, int numJointIndexes, const int *jointIndexes, JointPose *joints) const;
+
     void                    LerpFrame(int framenum1, int framenum2, float backlerp, JointPose *joints);
     void                    RemoveFrames(int numRemoveFrames, const int *removeFramenums);
     void                    OptimizeFrames(float epsilonT = CentiToUnit(0.01f), float epsilonQ = 0.0015f, float epsilonS = 0.0001f);
@@ -172,10 +204,16 @@ private:
     bool                    rootTranslationZ;
     bool                    isDefaultAnim;
     bool                    isAdditiveAnim;
+    bool                    isCompressed;
 
     Array<JointInfo>        jointInfo;
     Array<JointPose>        baseFrame;              // local transform for the first frame
-    Array<float>            frameComponents;
+    Array<float>            frameComponents;        // empty if the anim is compressed
+    Array<CompressedTrack>  compressedTracks;       // translation, rotation and scale track for each joint
+    Array<uint16_t>         keyFrameNums;           // frame number of each key
+    Array<uint16_t>         keyValues;              // three words for each key and one padding word for the SIMD loads
+    Array<JointSampleGroup> sampleGroups;           // sampling plan of the animated joints for the frame components
+    Array<int>              jointSampleLanes;       // lane in sampleGroups (group * 4 + lane) of each joint, -1 if the joint is not animated
     Array<int>              frameToTimeMap;         // times for each frame
     Array<int>              timeToFrameMap;         // frames for each 100 milliseconds
     Vec3                    totalDelta;             // 전체 animation 에서 root 가 이동한 offset
@@ -187,6 +225,7 @@ BE_INLINE Anim::Anim() {
     numFrames               = 0;
     numAnimatedComponents   = 0;
     animLength              = 0;
+    isCompressed            = false;
     totalDelta.SetFromScalar(0);
 }
 
@@ -222,6 +261,7 @@ public:
     const char *            JointNameByIndex(int index) const;
 
     static void             Cmd_ListAnims(const CmdArgs &args);
+    static void             Cmd_CompressAnim(const CmdArgs &args);
 
 private:
     StrIHashMap<Anim *>     animHashMap;
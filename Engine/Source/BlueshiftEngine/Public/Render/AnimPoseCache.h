@@ -0,0 +1,91 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    AnimPoseCache
+
+    Frame-scoped cache of the sampled anim poses.
+    Characters playing the same anim at the same time share the sampled poses
+    instead of sampling them again. The cache is valid only between BeginFrame()
+    and EndFrame() of the animation stage, and it is safe to use from the
+    animation jobs.
+
+    The poses are keyed on (anim, quantized time, joint mask). The time between
+    two anim frames can be quantized to a few steps, so the characters at the
+    nearby times share the poses too.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Platform/PlatformThread.h"
+#include "Containers/Array.h"
+#include "Containers/HashIndex.h"
+#include "Core/JointPose.h"
+#include "Render/Anim.h"
+
+BE_NAMESPACE_BEGIN
+
+class AnimPoseCache {
+public:
+    AnimPoseCache();
+
+    void                    Init();
+    void                    Shutdown();
+
+                            /// Discards the poses of the previous frame. If enable is false, the poses are not cached in this frame.
+                            /// If backlerpSteps is greater than 0, the time between two anim frames is quantized to the steps.
+    void                    BeginFrame(bool enable, int backlerpSteps = 0);
+
+                            /// Discards the poses and disables the cache until the next BeginFrame(),
+                            /// so the callers out of the animation stage never get the stale poses.
+    void                    EndFrame();
+
+                            /// Same as Anim::GetInterpolatedFrame(), but the poses are shared with the other callers in this frame.
+                            /// Joint masks are compared by the pointer of jointIndexes, so the callers should share the same mask array.
+    void                    GetInterpolatedFrame(const Anim *anim, const Anim::FrameInterpolation &frameInterpolation, int numJointIndexes, const int *jointIndexes, JointPose *joints);
+
+                            /// Returns number of the frames found in the cache in this frame
+    int                     NumHits() const { return numHits; }
+                            /// Returns number of the frames sampled in this frame
+    int                     NumMisses() const { return numMisses; }
+
+private:
+    struct Entry {
+        const Anim *        anim;
+        int32_t             frame1;
+        int32_t             frame2;
+        float               backlerp;
+        const int *         jointIndexes;   // nullptr for all joints
+        int32_t             firstPose;      // index of the first joint pose in poses
+    };
+
+    int                     FindEntry(const Anim *anim, const Anim::FrameInterpolation &frameInterpolation, const int *jointIndexes, int hash) const;
+
+    bool                    enabled;
+    int                     backlerpSteps;
+    PlatformMutex *         mutex;
+    Array<Entry>            entries;
+    HashIndex               entryHash;
+    Array<JointPose>        poses;
+    int                     numHits;
+    int                     numMisses;
+};
+
+extern AnimPoseCache        animPoseCache;
+
+BE_NAMESPACE_END
@@ -58,6 +58,9 @@ public:
 
     bool                        IsCached(const BufferCache *vc) const;
 
+                                // Returns remaining bytes of the texel buffer in the current frame, 0 if the texel buffer is not supported
+    int                         GetTexelMemAvailable() const;
+
                                 // Update PBO to Texture
     void                        UpdatePBOTexture() const;
 
@@ -92,6 +95,7 @@ private:
     uint32_t                    frameCount;
     int                         mappedNum;
     int                         unmappedNum;
+    bool                        persistentMap;      // buffer sets are kept mapped and reclaimed with fences
 
     int                         mostUsedVertexMem;
     int                         mostUsedIndexMem;
@@ -31,6 +31,7 @@ class MeshImporter;
 BE_NAMESPACE_BEGIN
 
 class CmdArgs;
+class File;
 class Skeleton;
 class Joint;
 class Mat3x4;
@@ -46,6 +47,14 @@ public:
     DrawSurf *              drawSurf;
 };
 
+// Lower detail level of a mesh. It has the same number of surfaces with the same materials as the base level,
+// so each surface can be swapped with the surface of the same index.
+class MeshLod {
+public:
+    float                   screenSize;         // used when the projected size of the mesh is smaller than this (fraction of the screen height)
+    Array<MeshSurf *>       surfaces;
+};
+
 class Mesh {
     friend class MeshManager;
     friend class RBSurf;
@@ -96,6 +105,11 @@ public:
     int                     NumSurfaces() const { return surfaces.Count(); }
     MeshSurf *              GetSurface(int index) const { assert(index >= 0 && index < surfaces.Count()); return surfaces[index]; }
 
+                            // Number of LOD levels including the base level 0
+    int                     NumLods() const { return lods.Count() + 1; }
+    float                   GetLodScreenSize(int lod) const;
+    MeshSurf *              GetLodSurface(int lod, int index) const;
+
     int                     NumJoints() const { return numJoints; }
     const Joint *           GetJoints() const { return joints; }
     int                     GetJointIndex(const char *name) const;
@@ -110,10 +124,23 @@ public:
     MeshSurf *              AllocSurface(int numVerts, int numIndexes) const;
     void                    FinishSurfaces(int finishFlags = 0);
 
+                            // Adds a lower detail level used below the given screen size.
+                            // Surfaces should be appended to the level in the order of the base surfaces.
+    MeshLod *               AllocLod(float screenSize);
+
+                            // Replaces LOD levels with simplified surfaces using quadric edge collapses.
+                            // reductionRatios are the ratios of triangles kept for each level in decreasing order.
+    bool                    GenerateLODs(int numLevels, const float *reductionRatios);
+
     void                    TransformVerts(const Mat3 &rotation, const Vec3 &translation);	
 
     void                    OptimizeIndexedTriangles();
 
+                            // Static surfaces use quantized VertexCompact format in the vertex buffers.
+                            // Skinned surfaces always use generic vertices. Should be called before the mesh is instantiated.
+    void                    SetCompactVertices(bool compact);
+    bool                    UseCompactVertices() const;
+
     void                    Voxelize();
 
     void                    UpdateSkinningJointCache(const Skeleton *skeleton, const Mat3x4 *joints);
@@ -141,6 +168,7 @@ public:
 
 private:
     void                    FreeSurface(MeshSurf *surf) const;
+    void                    FreeLods();
     MeshSurf *              AllocInstantiatedSurface(const MeshSurf *refSurf, int meshType) const;
 
     void                    Instantiate(int meshType);
@@ -156,7 +184,9 @@ private:
     bool                    CheckGPUJointSkinning(int skinning, int numJoints) const;
 
     bool                    LoadBMesh(const char *filename);
+    MeshSurf *              ReadBMeshSurf(byte *&ptr, int version) const;
     void                    WriteBMesh(const char *filename);
+    void                    WriteBMeshSurf(File *fp, const MeshSurf *meshSurf) const;
 
     Str                     hashName;
     Str                     name;
@@ -171,6 +201,7 @@ private:
     bool                    isSkinnedMesh;
     AABB                    aabb;
     Array<MeshSurf *>       surfaces;
+    Array<MeshLod *>        lods;                   // lower detail levels sorted by decreasing screen size
 
     bool                    useGpuSkinning;
     SkinningJointCache *    skinningJointCache;     // joint cache for HW skinning
@@ -230,6 +261,8 @@ public:
 private:
     static void             Cmd_ListMeshes(const CmdArgs &args);
     static void             Cmd_ReloadMesh(const CmdArgs &args);
+    static void             Cmd_GenerateMeshLods(const CmdArgs &args);
+    static void             Cmd_SetMeshVertexFormat(const CmdArgs &args);
 
     StrIHashMap<Mesh *>     meshHashMap;
 
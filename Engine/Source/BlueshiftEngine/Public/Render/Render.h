@@ -25,6 +25,7 @@
 #include "Render/Mesh.h"
 #include "Render/GuiMesh.h"
 #include "Render/Anim.h"
+#include "Render/AnimPoseCache.h"
 #include "Render/SceneEntity.h"
 #include "Render/SceneLight.h"
 #include "Render/SceneView.h"
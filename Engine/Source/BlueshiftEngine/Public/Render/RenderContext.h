@@ -69,6 +69,15 @@ struct RenderCounter {
 
     unsigned int            numShadowMapDraw;
     unsigned int            numSkinningEntities;
+
+                            // frontend stage times in microseconds, accumulated over all the views in a frame
+    unsigned int            numViews;
+    unsigned int            numDrawSurfs;
+    unsigned int            viewLightsAndEntitiesUsec;
+    unsigned int            addMeshesUsec;
+    unsigned int            addMeshesForLightsUsec;
+    unsigned int            flushDrawSurfsUsec;
+    unsigned int            optimizeLightsUsec;
 };
 
 class Texture;
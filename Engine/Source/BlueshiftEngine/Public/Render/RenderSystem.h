@@ -60,6 +60,10 @@ public:
 
     void                    CheckModifiedCVars();
 
+                            // Waits until the render thread finishes the issued commands and takes the GL context back to the calling thread.
+                            // Should be called before touching GL or the data read by the back end. Does nothing on the render thread itself.
+    void                    SyncRenderThread();
+
 private:
     void                    RecreateScreenMapRT();
     void                    RecreateHDRMapRT();
@@ -67,6 +71,9 @@ private:
     void *                  GetCommandBuffer(int bytes);
     void                    IssueCommands();
 
+    void                    StartRenderThread();
+    void                    StopRenderThread();
+
     void                    CmdDrawView(const view_t *view);
     void                    CmdScreenshot(int x, int y, int width, int height, const char *filename);
 
@@ -79,11 +86,14 @@ private:
     RenderContext *         currentContext;
     RenderContext *         mainContext;
 
+    bool                    syncAfterIssue;     // commands reading back the results should be finished in IssueCommands()
+
     static void             Cmd_ScreenShot(const CmdArgs &args);    
 };
 
 BE_INLINE RenderSystem::RenderSystem() {
     initialized = false;
+    syncAfterIssue = false;
 }
 
 extern RenderSystem         renderSystem;
@@ -27,6 +27,8 @@ BE_NAMESPACE_BEGIN
 */
 
 class DrawSurf;
+class DrawSurfBuffer;
+class OcclusionBuffer;
 struct view_t;
 
 // Proxy node in the dynamic bounding volume tree
@@ -37,6 +39,7 @@ struct DbvtProxy {
     SceneLight *                sceneLight;
     Mesh *                      mesh;           // static mesh
     int32_t                     meshSurfIndex;  // sub mesh index
+    LodGroup *                  lodGroup;       // nullptr if the static mesh has no LOD levels
 };
 
 class RenderWorld {
@@ -62,8 +65,13 @@ public:
 
     const AABB &                GetStaticAABB() const { return staticDbvt.GetRootFatAABB(); }
 
+                                /// Returns the view counter, increased by each rendered view.
+                                /// Entities seen in the views since the counter value have greater SceneEntity::viewCount.
+    int                         GetViewCount() const { return viewCount; }
+
     const GuiMesh &             GetTextMesh() const { return textMesh; }
 
+    void                        BeginMapLoading();
     void                        FinishMapLoading();
 
     void                        SetDebugColor(const Color4 &lineColor, const Color4 &fillColor) { debugLineColor = lineColor; debugFillColor = fillColor; }
@@ -102,14 +110,19 @@ private:
     viewEntity_t *              AddViewEntity(view_t *view, SceneEntity *sceneEntity);
     viewLight_t *               AddViewLight(view_t *view, SceneLight *sceneLight);
     void                        AddViewLightsAndEntities(view_t *view);
+    void                        CullOccludedEntities(view_t *view);
     void                        AddStaticMeshes(view_t *view);
     void                        AddSkinnedMeshes(view_t *view);
     void                        AddTextMeshes(view_t *view);
-    void                        AddStaticMeshesForLights(view_t *view);
-    void                        AddSkinnedMeshesForLights(view_t *view);
+    void                        AddMeshesForLights(view_t *view, bool parallel);
+    void                        AddStaticMeshesForLight(view_t *view, viewLight_t *viewLight);
+    void                        AddSkinnedMeshesForLight(view_t *view, viewLight_t *viewLight);
+    void                        ResolveShadowCasters(view_t *view);
     void                        OptimizeLights(view_t *view);
-    void                        AddDrawSurf(view_t *view, viewEntity_t *entity, const Material *material, SubMesh *subMesh, GuiSubMesh *guiSubMesh, int flags);
-    void                        SortDrawSurfs(view_t *view);
+    DrawSurf *                  AddDrawSurf(view_t *view, viewEntity_t *entity, const Material *material, SubMesh *subMesh, GuiSubMesh *guiSubMesh, int flags);
+    void                        FlushDrawSurfs(view_t *view, bool sort);
+    void                        InstanceDrawSurfs(view_t *view);
+    void                        CopyDefsToFrameData(view_t *view);
 
     void                        RenderView(view_t *view);
     void                        RenderSubView(viewEntity_t *viewEntity, const DrawSurf *drawSurf, const Material *material);
@@ -128,6 +141,12 @@ private:
 
     GuiMesh                     textMesh;
 
+                                /// Draw surfaces added by each worker, collected to the view in FlushDrawSurfs()
+    DrawSurfBuffer *            drawSurfBuffers;
+
+                                /// CPU depth buffer for the occlusion culling, created on the first use
+    OcclusionBuffer *           occlusionBuffer;
+
     Array<SceneEntity *>        sceneEntities;  ///< Array of scene entities
     Array<SceneLight *>         sceneLights;    ///< Array of scene lights
 
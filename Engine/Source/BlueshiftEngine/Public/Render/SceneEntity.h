@@ -37,6 +37,12 @@ class Skin;
 class Mesh;
 class Font;
 
+// LOD level selected for the surfaces of a static mesh entity
+struct LodGroup {
+    int32_t                 viewCount;      // view count when the level is selected
+    int32_t                 lodLevel;       // kept between views for the hysteresis
+};
+
 class SceneEntity {
     friend class RenderWorld;
 
@@ -137,6 +143,7 @@ public:
     DbvtProxy *             proxy;
     int                     numMeshSurfProxies;
     DbvtProxy *             meshSurfProxies;            // mesh surf proxy for static sub mesh
+    LodGroup                lodGroup;                   // shared by the mesh surf proxies
 };
 
 BE_NAMESPACE_END
@@ -65,6 +65,11 @@ public:
         LocalViewOriginConst,
         LocalLightOriginConst,
         LocalLightAxisConst,
+        PositionScaleConst,
+        PositionBiasConst,
+        CompactVertexConst,
+        ViewProjectionMatrixConst,
+        InstanceIndexBaseConst,
         MaxBuiltInConstants
     };
 
@@ -99,6 +104,10 @@ public:
     bool                    HasVertexShader() const { return hasVertexShader; }
     bool                    HasFragmentShader() const { return hasFragmentShader; }
 
+    const Shader *          GetAmbientLitVersion() const { return ambientLitVersion; }
+    const Shader *          GetPerforatedVersion() const { return perforatedVersion; }
+    const Shader *          GetInstancedVersion() const { return instancedVersion; }
+
     bool                    IsOriginalShader() const { return !originalShader; }
     bool                    IsInstantiatedShader() const { return !!originalShader; }
 
@@ -198,10 +207,11 @@ private:
     void                    Finish();
     Shader *                GenerateSubShader(const Str &shaderNamePostfix, const Str &vsHeaderText, const Str &fsHeaderText, int skinning);
     bool                    GenerateGpuSkinningVersion(Shader *shader, const Str &shaderNamePrefix, const Str &vpText, const Str &fpText);
-    bool                    GeneratePerforatedVersion(Shader *shader, const Str &shaderNamePrefix, const Str &vpText, const Str &fpText, bool generateGpuSkinningVersion);
+    bool                    GeneratePerforatedVersion(Shader *shader, const Str &shaderNamePrefix, const Str &vpText, const Str &fpText, bool generateGpuSkinningVersion, bool generateInstancedVersion);
+    bool                    GenerateInstancedVersion(Shader *shader, const Str &shaderNamePrefix, const Str &vpText, const Str &fpText);
     bool                    Instantiate(const Array<Define> &defineArray);	// internal function of instantiate
 
-    bool                    Finish(bool generatePerforatedVersion, bool genereateGpuSkinningVersion, bool generateParallelShadowVersion, bool generateSpotShadowVersion, bool generatePointShadowVersion, const char *baseDir);
+    bool                    Finish(bool generatePerforatedVersion, bool genereateGpuSkinningVersion, bool generateInstancedVersion, bool generateParallelShadowVersion, bool generateSpotShadowVersion, bool generatePointShadowVersion, const char *baseDir);
     bool                    ProcessShaderText(const char *text, const char *baseDir, const Array<Define> &defineArray, Str &outStr) const;
     bool                    ProcessIncludeRecursive(const char *baseDir, Str &text) const;
 
@@ -233,6 +243,7 @@ private:
     Shader *                spotShadowVersion;
     Shader *                pointShadowVersion;
     Shader *                gpuSkinningVersion[3];
+    Shader *                instancedVersion;       ///< Reads the entity data of each instance from the instance buffer
 
     StrHashMap<PropertySpec> specHashMap;
 };
@@ -253,6 +264,7 @@ BE_INLINE Shader::Shader() {
     gpuSkinningVersion[0]   = nullptr;
     gpuSkinningVersion[1]   = nullptr;
     gpuSkinningVersion[2]   = nullptr;
+    instancedVersion        = nullptr;
     originalShader          = nullptr;
 }
 
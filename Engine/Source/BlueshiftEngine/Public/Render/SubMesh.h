@@ -102,16 +102,32 @@ public:
     const Vec3              ComputeCentroid() const;
     const Mat3              ComputeInertiaTensor(const Vec3 &centroid, float mass) const;
 
+                            /// Reorders triangles for the post-transform vertex cache and overdraw, and vertices for the vertex fetch
     void                    OptimizeIndexedTriangles();
 
+                            /// Returns the number of vertex transforms with a FIFO vertex cache of the given size
+    int                     CountVertexCacheMisses(int cacheSize = 16) const;
+
     bool                    IsGpuSkinning() const { return useGpuSkinning; }
 
+                            /// Returns the sub mesh which owns the vertex data, instantiated static sub meshes share the buffers with the reference
+    const SubMesh *         GetSourceSubMesh() const { return refSubMesh ? refSubMesh : this; }
+
+                            /// Is the vertex buffer in VertexCompact format ?
+    bool                    IsCompactVertex() const { return useCompactVertex; }
+
+                            /// Position dequantization of the compact vertices (position = xyz * scale + bias)
+    const Vec3              CompactPositionScale() const;
+    const Vec3              CompactPositionBias() const;
+
     void                    CacheStaticDataToGpu();
     void                    CacheDynamicDataToGpu(const Mat3x4 *joints, const Material *material);
 
 private:
     void                    AllocSubMesh(int numVerts, int numIndexes);
     void                    AllocInstantiatedSubMesh(const SubMesh *refMesh, int meshType);
+                            // Allocates a sub mesh with the given triangles of the reference, keeping only the used vertices
+    void                    AllocSimplifiedSubMesh(const SubMesh *refMesh, const int *refIndexes, int numRefIndexes);
     void                    FreeSubMesh();
 
     void                    SplitMirroredVerts();
@@ -123,6 +139,10 @@ private:
     void                    ComputeTangents(bool includeNormals, bool useUnsmoothedTangents);
     void                    ComputeEdges();
 
+    void                    OptimizeVertexFetch();
+
+    void                    WriteCompactVerts(VertexCompact *dst) const;
+
     int                     type;
     bool                    alloced;
     const SubMesh *         refSubMesh;
@@ -151,6 +171,8 @@ private:
     bool                    useGpuSkinning;
     int                     gpuSkinningVersionIndex;
 
+    bool                    useCompactVertex;       // static meshes only
+
     AABB                    aabb;
 
     BufferCache *           ambientCache;
@@ -165,6 +187,14 @@ BE_INLINE SubMesh::~SubMesh() {
     FreeSubMesh();
 }
 
+BE_INLINE const Vec3 SubMesh::CompactPositionScale() const {
+    return useCompactVertex ? (aabb[1] - aabb[0]) * 0.5f : Vec3::one;
+}
+
+BE_INLINE const Vec3 SubMesh::CompactPositionBias() const {
+    return useCompactVertex ? aabb.Center() : Vec3::zero;
+}
+
 BE_INLINE int SubMesh::VertexWeightSize() const {
     if (!vertWeights) {
         return 0;
@@ -67,10 +67,13 @@ public:
     bool                    SupportsTextureCompressionLATC() const;
     bool                    SupportsTextureCompressionETC2() const;
     bool                    SupportsDebugLabel() const;
+    bool                    SupportsBufferStorage() const;
 
     Handle                  CreateContext(WindowHandle windowHandle, bool useSharedContext);
     void                    DestroyContext(Handle ctxHandle);
     void                    SetContext(Handle ctxHandle);
+                            // Releases the current context from the calling thread so that another thread can make it current
+    void                    ReleaseContext();
     void                    SetContextDisplayFunc(Handle ctxHandle, DisplayContextFunc displayFunc, void *dataPtr, bool onDemandDrawing);
     void                    DisplayContext(Handle ctxHandle);
     WindowHandle            GetWindowHandleFromContext(Handle ctxHandle);
@@ -189,6 +189,7 @@ public:
         WriteOnly,
         WriteOnlyExplicitFlush,
         WriteOnlyPersistent,
+        WriteOnlyOrphan,                    // orphans the data store before mapping so the GPU never stalls on it
     };
     
     enum TextureType {
@@ -269,6 +270,7 @@ public:
             UIntType                        = 1,
             FloatType                       = 2,
             HalfType                        = 3,
+            ShortType                       = 4,
         };
 
         enum Usage {
@@ -0,0 +1,61 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+===============================================================================
+
+    Null Renderer
+
+    When the engine is built with WITH_NULL_RENDERER, RendererGL is implemented
+    without any GL calls. Resources get handles and CPU side buffer storage,
+    and every command is only counted in NullRendererStats.
+    This makes it possible to run the whole render frontend and backend on
+    machines without a GPU (headless benchmarks, CI).
+
+===============================================================================
+*/
+
+BE_NAMESPACE_BEGIN
+
+struct NullRendererStats {
+    uint64_t                drawCalls;
+    uint64_t                instancedDrawCalls;
+    uint64_t                drawIndexes;
+    uint64_t                drawVerts;
+    uint64_t                clears;
+    uint64_t                stateChanges;
+    uint64_t                shaderBinds;
+    uint64_t                textureBinds;
+    uint64_t                bufferBinds;
+    uint64_t                vertexFormatBinds;
+    uint64_t                renderTargetBinds;
+    uint64_t                constantUpdates;
+    uint64_t                bufferUploadBytes;
+    uint64_t                textureUploadBytes;
+};
+
+class BE_API NullRenderer {
+public:
+                            /// Sets the size of the contexts created after this call. Default size is 1280x720.
+    static void             SetContextSize(int width, int height);
+
+                            /// Returns commands recorded since the last ResetStats() call.
+    static const NullRendererStats &GetStats();
+
+    static void             ResetStats();
+};
+
+BE_NAMESPACE_END
@@ -112,6 +112,7 @@ private:
     static void             RegisterGameWorld(LuaCpp::Module &module);
 
     static LuaCpp::State *  state;
+    static lua_State *      luaState;
 
     static const GameWorld *gameWorld;
 };
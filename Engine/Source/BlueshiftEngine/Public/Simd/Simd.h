@@ -26,10 +26,16 @@
 
 BE_NAMESPACE_BEGIN
 
+class SIMDProcessor;
+
 class SIMD {
 public:
     static void         Init(bool forceGeneric = false);
     static void         Shutdown();
+
+                        /// Creates a SIMD processor of the given instruction set (CPUID_GENERIC, CPUID_SSE4 or CPUID_AVX2).
+                        /// Returns nullptr if it is not supported on this CPU. The caller owns the returned processor.
+    static SIMDProcessor *CreateProcessor(CpuId instructionSet);
 };
 
 /*
@@ -43,10 +49,13 @@ public:
 struct DominantTri;
 struct VertexLightingGeneric;
 
+class Vec3;
 class Vec4;
+class Quat;
 class Plane;
 class JointPose;
 class CompressedJointPose;
+struct JointSampleGroup;
 class Mat3x4;
 
 class BE_API SIMDProcessor {
@@ -86,6 +95,29 @@ public:
     virtual void BE_FASTCALL            MultiplyJoints(Mat3x4 *result, const Mat3x4 *joints1, const Mat3x4 *joints2, const int numJoints) = 0;
     virtual void BE_FASTCALL            TransformVerts(VertexLightingGeneric *verts, const int numVerts, const Mat3x4 *joints, const Vec4 *weights, const int *index, const int numWeights) = 0;
     virtual void BE_FASTCALL            DeriveTriPlanes(Plane *planes, const VertexLightingGeneric *verts, const int numVerts, const int *indexes, const int numIndexes) = 0;
+
+                                        /// Dequantizes the pairs of translation or scale keys and interpolates them, dst[i] = rangeMins[i] + rangeScales[i] * lerp(key0, key1, fractions[i]).
+                                        /// keys are three 16-bit words each, and keyIndexes0/keyIndexes1 are the key numbers of each pair.
+                                        /// keys are read by 8 bytes, so one word after the last key should be readable.
+    virtual void BE_FASTCALL            DecompressVec3Keys(Vec3 *dst, const uint16_t *keys, const int *keyIndexes0, const int *keyIndexes1, const float *fractions, const Vec3 *rangeMins, const Vec3 *rangeScales, const int count) = 0;
+
+                                        /// Dequantizes the pairs of smallest three rotation keys and interpolates them with normalized lerp.
+                                        /// keys are laid out same as DecompressVec3Keys.
+    virtual void BE_FASTCALL            DecompressQuatKeys(Quat *dst, const uint16_t *keys, const int *keyIndexes0, const int *keyIndexes1, const float *fractions, const int count) = 0;
+
+                                        /// Samples the animated joints of the groups interpolating frame1 and frame2 by fraction, translation and scale with lerp and rotation with slerp.
+                                        /// The components which are not animated are taken from the base components of the group.
+    virtual void BE_FASTCALL            SampleJoints(JointPose *joints, const JointSampleGroup *groups, const int numGroups, const float *frame1, const float *frame2, const float fraction) = 0;
+
+                                        /// Rasterizes the triangles into the depth buffer keeping the maximum depth for each pixel.
+                                        /// triVerts are screen space (x, y, depth) of the triangles, three per triangle, and triIndexes are the triangle numbers to rasterize.
+                                        /// Only the pixels in [minX, maxX) x [minY, maxY) are written. minX, maxX and stride should be multiples of 4 and depthBuffer should be 16 byte aligned.
+    virtual void BE_FASTCALL            RasterizeOccluderTriangles(float *depthBuffer, const int stride, const Vec3 *triVerts, const int *triIndexes, const int numTris, const int minX, const int minY, const int maxX, const int maxY) = 0;
+
+                                        /// Tests the AABBs against the planes and sets cullBits[i] to 1 if the i'th box is completely in front of any of the planes.
+                                        /// bounds are the arrays of center x, y, z and extents x, y, z in a row, each array has stride floats.
+                                        /// planes are (normal, w) and the front side is dot(normal, p) + w > 0.
+    virtual void BE_FASTCALL            CullAABBsByPlanes(byte *cullBits, const Vec4 *planes, const int numPlanes, const float *bounds, const int stride, const int count) = 0;
 };
 
 BE_INLINE SIMDProcessor::~SIMDProcessor() {
@@ -22,11 +22,34 @@ typedef sseb simd8b;
 typedef ssef simd8f;
 typedef ssei simd8i;
 
+// AVX2 + FMA3 implementation.
+// Simd_AVX.cpp is the only file compiled with AVX2/FMA code generation, 
+// so this processor must be created only when both CPUID_AVX2 and CPUID_FMA are detected.
 class SIMD_AVX : public SIMD_SSE4 {
 public:
-    SIMD_AVX() { cpuid = CPUID_AVX; }
+    SIMD_AVX() { cpuid = CPUID_AVX2; }
 
-    virtual const char * BE_FASTCALL    GetName() const { return "SSE4 & AVX"; }
+    virtual const char * BE_FASTCALL    GetName() const { return "SSE4 & AVX2 & FMA"; }
+
+    virtual void BE_FASTCALL            Add(float *dst, const float constant, const float *src, const int count);
+    virtual void BE_FASTCALL            Add(float *dst, const float *src0, const float *src1, const int count);
+    virtual void BE_FASTCALL            Sub(float *dst, const float constant, const float *src, const int count);
+    virtual void BE_FASTCALL            Sub(float *dst, const float *src0, const float *src1, const int count);
+    virtual void BE_FASTCALL            Mul(float *dst, const float constant, const float *src, const int count);
+    virtual void BE_FASTCALL            Mul(float *dst, const float *src0, const float *src1, const int count);
+    virtual void BE_FASTCALL            Div(float *dst, const float constant, const float *src, const int count);
+    virtual void BE_FASTCALL            Div(float *dst, const float *src0, const float *src1, const int count);
+
+    virtual float BE_FASTCALL           Sum(const float *src, const int count);
+
+    virtual void BE_FASTCALL            BlendJoints(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints);
+    virtual void BE_FASTCALL            BlendJointsFast(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints);
+    virtual void BE_FASTCALL            ConvertJointPosesToJointMats(Mat3x4 *jointMats, const JointPose *jointPoses, const int numJoints);
+    virtual void BE_FASTCALL            TransformJoints(Mat3x4 *jointMats, const int *parents, const int firstJoint, const int lastJoint);
+    virtual void BE_FASTCALL            MultiplyJoints(Mat3x4 *result, const Mat3x4 *joints1, const Mat3x4 *joints2, const int numJoints);
+    virtual void BE_FASTCALL            TransformVerts(VertexLightingGeneric *verts, const int numVerts, const Mat3x4 *joints, const Vec4 *weights, const int *index, const int numWeights);
+    virtual void BE_FASTCALL            DeriveTriPlanes(Plane *planes, const VertexLightingGeneric *verts, const int numVerts, const int *indexes, const int numIndexes);
+    virtual void BE_FASTCALL            CullAABBsByPlanes(byte *cullBits, const Vec4 *planes, const int numPlanes, const float *bounds, const int stride, const int count);
 };
 
 BE_NAMESPACE_END
@@ -50,6 +50,11 @@ public:
     virtual void BE_FASTCALL            MultiplyJoints(Mat3x4 *result, const Mat3x4 *joints1, const Mat3x4 *joints2, const int numJoints);
     virtual void BE_FASTCALL            TransformVerts(VertexLightingGeneric *verts, const int numVerts, const Mat3x4 *joints, const Vec4 *weights, const int *index, const int numWeights);
     virtual void BE_FASTCALL            DeriveTriPlanes(Plane *planes, const VertexLightingGeneric *verts, const int numVerts, const int *indexes, const int numIndexes);
+    virtual void BE_FASTCALL            DecompressVec3Keys(Vec3 *dst, const uint16_t *keys, const int *keyIndexes0, const int *keyIndexes1, const float *fractions, const Vec3 *rangeMins, const Vec3 *rangeScales, const int count);
+    virtual void BE_FASTCALL            DecompressQuatKeys(Quat *dst, const uint16_t *keys, const int *keyIndexes0, const int *keyIndexes1, const float *fractions, const int count);
+    virtual void BE_FASTCALL            SampleJoints(JointPose *joints, const JointSampleGroup *groups, const int numGroups, const float *frame1, const float *frame2, const float fraction);
+    virtual void BE_FASTCALL            RasterizeOccluderTriangles(float *depthBuffer, const int stride, const Vec3 *triVerts, const int *triIndexes, const int numTris, const int minX, const int minY, const int maxX, const int maxY);
+    virtual void BE_FASTCALL            CullAABBsByPlanes(byte *cullBits, const Vec4 *planes, const int numPlanes, const float *bounds, const int stride, const int count);
 };
 
 BE_NAMESPACE_END
@@ -42,6 +42,12 @@ public:
     virtual void BE_FASTCALL            MatrixTranspose(float *dst, const float *src);
     virtual void BE_FASTCALL            MatrixMultiply(float *dst, const float *src0, const float *src1);
 
+    virtual void BE_FASTCALL            RasterizeOccluderTriangles(float *depthBuffer, const int stride, const Vec3 *triVerts, const int *triIndexes, const int numTris, const int minX, const int minY, const int maxX, const int maxY);
+    virtual void BE_FASTCALL            CullAABBsByPlanes(byte *cullBits, const Vec4 *planes, const int numPlanes, const float *bounds, const int stride, const int count);
+    virtual void BE_FASTCALL            DecompressVec3Keys(Vec3 *dst, const uint16_t *keys, const int *keyIndexes0, const int *keyIndexes1, const float *fractions, const Vec3 *rangeMins, const Vec3 *rangeScales, const int count);
+    virtual void BE_FASTCALL            DecompressQuatKeys(Quat *dst, const uint16_t *keys, const int *keyIndexes0, const int *keyIndexes1, const float *fractions, const int count);
+    virtual void BE_FASTCALL            SampleJoints(JointPose *joints, const JointSampleGroup *groups, const int numGroups, const float *frame1, const float *frame2, const float fraction);
+
     /*virtual void BE_FASTCALL            BlendJoints(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints);
     virtual void BE_FASTCALL            BlendJointsFast(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints);
     virtual void BE_FASTCALL            ConvertJointPosesToJointMats(Mat3x4 *jointMats, const JointPose *jointPoses, const int numJoints);